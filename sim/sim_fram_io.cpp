@@ -0,0 +1,32 @@
+#include "../src/hardware/fram_io.h"
+#include "sim_hal.h"
+
+// FRAM burst layer over the simulator's FRAM image (replaces fram_io.cpp)
+
+#define SIM_FRAM_CHUNK  126   // same split as the Wire buffer on the device
+
+static FramIOStats ioStats = {0, 0, 0, 0};
+
+bool framBurstRead(uint16_t addr, uint8_t* data, size_t len) {
+    if (!simFramRead(addr, data, len)) {
+        ioStats.errors++;
+        return false;
+    }
+    ioStats.transactions += (len + SIM_FRAM_CHUNK - 1) / SIM_FRAM_CHUNK;
+    ioStats.bytesRead += len;
+    return true;
+}
+
+bool framBurstWrite(uint16_t addr, const uint8_t* data, size_t len) {
+    if (!simFramWrite(addr, data, len)) {
+        ioStats.errors++;
+        return false;
+    }
+    ioStats.transactions += (len + SIM_FRAM_CHUNK - 1) / SIM_FRAM_CHUNK;
+    ioStats.bytesWritten += len;
+    return true;
+}
+
+const FramIOStats& getFramIOStats() {
+    return ioStats;
+}
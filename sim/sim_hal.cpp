@@ -0,0 +1,100 @@
+#include "sim_hal.h"
+#include <Arduino.h>
+#include <Wire.h>
+#include <esp_timer.h>
+
+static uint64_t nowUs = 0;
+static uint32_t epochAtStart = 1735689600;   // 2025-01-01 00:00:00 UTC
+static uint8_t pinLevel[SIM_PIN_COUNT];
+static void (*pinISR[SIM_PIN_COUNT])() = {nullptr};
+static bool pinsReady = false;
+static uint8_t framImage[SIM_FRAM_SIZE];
+static bool serialEcho = false;
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+// ============== CLOCK ==============
+
+uint64_t simTimeUs() { return nowUs; }
+void simAdvanceUs(uint64_t us) { nowUs += us; }
+void simSetEpoch(uint32_t unixTimeAtStart) { epochAtStart = unixTimeAtStart; }
+uint32_t simUnixTime() { return epochAtStart + (uint32_t)(nowUs / 1000000ULL); }
+
+unsigned long millis() { return (unsigned long)(uint32_t)(nowUs / 1000ULL); }
+unsigned long micros() { return (unsigned long)(uint32_t)nowUs; }
+int64_t esp_timer_get_time() { return (int64_t)nowUs; }
+
+// Firmware busy-waits (reset button LED feedback) just move the clock
+void delay(unsigned long ms) { nowUs += (uint64_t)ms * 1000ULL; }
+
+// ============== GPIO ==============
+
+static void initPins() {
+    if (pinsReady) return;
+    // Pull-ups everywhere: sensors not triggered, reset button released
+    for (int i = 0; i < SIM_PIN_COUNT; i++) pinLevel[i] = HIGH;
+    pinsReady = true;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) { initPins(); }
+
+int digitalRead(uint8_t pin) {
+    initPins();
+    return pin < SIM_PIN_COUNT ? pinLevel[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    initPins();
+    if (pin < SIM_PIN_COUNT) pinLevel[pin] = level;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+    if (pin < SIM_PIN_COUNT) pinISR[pin] = isr;
+}
+
+void simDriveInput(uint8_t pin, uint8_t level) {
+    initPins();
+    if (pin >= SIM_PIN_COUNT || pinLevel[pin] == level) return;
+    pinLevel[pin] = level;
+    if (pinISR[pin] != nullptr) pinISR[pin]();
+}
+
+uint8_t simOutputLevel(uint8_t pin) {
+    initPins();
+    return pin < SIM_PIN_COUNT ? pinLevel[pin] : LOW;
+}
+
+// ============== FRAM ==============
+
+bool simFramRead(uint16_t addr, uint8_t* data, size_t len) {
+    if ((size_t)addr + len > SIM_FRAM_SIZE) return false;
+    memcpy(data, framImage + addr, len);
+    return true;
+}
+
+bool simFramWrite(uint16_t addr, const uint8_t* data, size_t len) {
+    if ((size_t)addr + len > SIM_FRAM_SIZE) return false;
+    memcpy(framImage + addr, data, len);
+    return true;
+}
+
+void simFramErase() { memset(framImage, 0, sizeof(framImage)); }
+
+// ============== SERIAL ==============
+
+void simSetSerialEcho(bool enabled) { serialEcho = enabled; }
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    if (!serialEcho) return 0;
+    char buffer[320];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    // Prefix with simulated time so logs line up with the tank model
+    uint64_t s = nowUs / 1000000ULL;
+    fprintf(stdout, "[sim %3lud %02lu:%02lu:%02lu] %s", (unsigned long)(s / 86400), (unsigned long)(s / 3600 % 24),
+            (unsigned long)(s / 60 % 60), (unsigned long)(s % 60), buffer);
+    return n > 0 ? (size_t)n : 0;
+}
@@ -0,0 +1,37 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===============================
+// SIMULATED HARDWARE (native env)
+// ===============================
+// One virtual clock drives millis()/micros()/esp_timer_get_time() and the
+// RTC. Time only moves when the simulator advances it (or firmware calls
+// delay()), so weeks run in well under a second of wall time.
+
+#define SIM_FRAM_SIZE   32768   // MB85RC256V
+#define SIM_PIN_COUNT   32
+
+// Clock
+uint64_t simTimeUs();
+void simAdvanceUs(uint64_t us);
+void simSetEpoch(uint32_t unixTimeAtStart);
+uint32_t simUnixTime();
+void simSetRTCWorking(bool working);    // sim_rtc.cpp
+
+// GPIO - inputs are driven by the model; a level change runs the ISR
+// attached with attachInterrupt(), like the GPIO edge interrupt would
+void simDriveInput(uint8_t pin, uint8_t level);
+uint8_t simOutputLevel(uint8_t pin);
+
+// FRAM image
+bool simFramRead(uint16_t addr, uint8_t* data, size_t len);
+bool simFramWrite(uint16_t addr, const uint8_t* data, size_t len);
+void simFramErase();
+
+// Serial output of the firmware (LOG_*) - off by default
+void simSetSerialEcho(bool enabled);
+
+#endif
@@ -0,0 +1,393 @@
+// ===============================
+// WATER ALGORITHM SIMULATOR (native env)
+// ===============================
+// Runs the unmodified control code (WaterAlgorithm, water_sensors,
+// pump_controller, FRAM layer) against a tank model on a virtual clock.
+// The loop jumps straight to the next thing that can happen - the deadline
+// returned by runControlStep(), a sensor crossing or a queued pin edge - so
+// weeks of operation take a fraction of a second.
+//
+//   pio run -e native && .pio/build/native/program --days 28 --evap 40
+//   .pio/build/native/program replay trace.bin     (see sim_replay.cpp)
+//   .pio/build/native/program --soak --days 180    (see sim_soak.h)
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "sim_hal.h"
+#include "sim_vps.h"
+#include "sim_replay.h"
+#include "sim_soak.h"
+#include "tank_model.h"
+#include "../src/algorithm/water_algorithm.h"
+#include "../src/algorithm/algorithm_task.h"
+#include "../src/hardware/hardware_pins.h"
+#include "../src/hardware/water_sensors.h"
+#include "../src/hardware/pump_controller.h"
+#include "../src/hardware/i2c_bus.h"
+#include "../src/config/config.h"
+#include "../src/core/trace_recorder.h"
+#include "../src/algorithm/flow_estimator.h"
+#include "../src/algorithm/adaptive_delay.h"
+
+#define SIM_BOUNCE_GAP_US       2000ULL     // contact bounce spacing
+#define SIM_BUTTON_PRESS_US     300000ULL   // reset button held for 300 ms
+
+struct SimOptions {
+    double days = 28;
+    TankParams tank;
+    int bounceEdges = 0;            // extra edge pairs per sensor crossing
+    double resetAfterHours = 1.0;   // operator presses RESET this long after ERROR (<0: never)
+    uint32_t seed = 1;
+    bool verbose = false;
+    bool soak = false;              // long-uptime checks, exit code 3 on failure
+    double uptimeStartDays = -1;    // device uptime at the start (<0: 0, soak SOAK_DEFAULT_UPTIME_DAYS)
+    const char* csvPath = nullptr;
+    const char* tracePath = nullptr;
+    AlgorithmParams params = getDefaultAlgorithmParams();
+    bool paramsSet = false;         // --param given: stored in FRAM before boot
+    bool flowAutoAdjust = FLOW_AUTO_ADJUST;
+    bool adaptiveDelay = ADAPTIVE_TIME_TO_PUMP;
+};
+
+struct PinEvent {
+    uint64_t atUs;
+    uint8_t pin;
+    uint8_t level;
+};
+
+struct SimStats {
+    uint32_t steps = 0;
+    uint32_t pumpStarts = 0;
+    uint32_t errorsDailyLimit = 0;
+    uint32_t errorsPumpFailure = 0;
+    uint32_t operatorResets = 0;
+    uint64_t errorUs = 0;
+    double pumpLevelMin = 0;        // tank level at automatic pump starts
+    double pumpLevelMax = 0;
+    double pumpLevelSum = 0;
+    uint32_t pumpLevelCount = 0;
+};
+
+static void usage() {
+    printf("Usage: program [options] | program replay TRACE.bin [--sync N] [--verbose]\n"
+           "  --days N           simulated days (default 28)\n"
+           "  --evap ML_H        mean evaporation, ml/h (default 30)\n"
+           "  --evap-swing F     day/night swing, 0..1 (default 0.5)\n"
+           "  --leak ML_H        constant extra loss, ml/h (default 0)\n"
+           "  --flow ML_S        real pump flow, ml/s (default 1.0)\n"
+           "  --flow-drift F     flow change per day, fraction of --flow (default 0)\n"
+           "  --flow-auto 0|1    let the flow estimator adjust volumePerSecond (default: FLOW_AUTO_ADJUST)\n"
+           "  --adaptive 0|1     adaptive TIME_TO_PUMP (default: ADAPTIVE_TIME_TO_PUMP)\n"
+           "  --sensor-gap ML    volume between sensor 1 and 2 (default 2)\n"
+           "  --pump-fail P      probability a pump run delivers nothing (default 0)\n"
+           "  --bounce N         contact bounces per sensor crossing (default 0)\n"
+           "  --reset-after H    operator resets ERROR after H hours, <0 never (default 1)\n"
+           "  --seed N           RNG seed (default 1)\n"
+           "  --uptime-start D   device uptime at the start, days (default 0, --soak 49)\n"
+           "  --soak             check timers across millis() wraps, exit code 3 on failure\n"
+           "  --csv FILE         write every logged cycle to FILE\n"
+           "  --trace FILE       write the trace ring (/api/trace format) to FILE\n"
+           "  --param KEY=VALUE  algorithm parameter, repeatable (keys as /api/algorithm-params)\n"
+           "  --verbose          echo firmware log output\n");
+}
+
+static bool parseOptions(int argc, char** argv, SimOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--verbose") == 0) { opt.verbose = true; continue; }
+        if (strcmp(arg, "--soak") == 0) { opt.soak = true; continue; }
+        if (strcmp(arg, "--help") == 0 || value == nullptr) return false;
+
+        if      (strcmp(arg, "--days") == 0)        opt.days = atof(value);
+        else if (strcmp(arg, "--evap") == 0)        opt.tank.evapMlPerHour = atof(value);
+        else if (strcmp(arg, "--evap-swing") == 0)  opt.tank.evapDailySwing = atof(value);
+        else if (strcmp(arg, "--leak") == 0)        opt.tank.leakMlPerHour = atof(value);
+        else if (strcmp(arg, "--flow") == 0)        opt.tank.pumpFlowMlPerSec = atof(value);
+        else if (strcmp(arg, "--flow-drift") == 0)  opt.tank.pumpFlowDriftPerDay = atof(value);
+        else if (strcmp(arg, "--flow-auto") == 0)   opt.flowAutoAdjust = atoi(value) != 0;
+        else if (strcmp(arg, "--adaptive") == 0)    opt.adaptiveDelay = atoi(value) != 0;
+        else if (strcmp(arg, "--sensor-gap") == 0)  opt.tank.sensorGapMl = atof(value);
+        else if (strcmp(arg, "--pump-fail") == 0)   opt.tank.pumpFailRate = atof(value);
+        else if (strcmp(arg, "--bounce") == 0)      opt.bounceEdges = atoi(value);
+        else if (strcmp(arg, "--reset-after") == 0) opt.resetAfterHours = atof(value);
+        else if (strcmp(arg, "--seed") == 0)        opt.seed = (uint32_t)strtoul(value, nullptr, 10);
+        else if (strcmp(arg, "--uptime-start") == 0) opt.uptimeStartDays = atof(value);
+        else if (strcmp(arg, "--csv") == 0)         opt.csvPath = value;
+        else if (strcmp(arg, "--trace") == 0)       opt.tracePath = value;
+        else if (strcmp(arg, "--param") == 0) {
+            const char* eq = strchr(value, '=');
+            std::string key(value, eq ? eq - value : 0);
+            int index = findAlgorithmParam(key.c_str());
+            long number = eq ? atol(eq + 1) : 0;
+            if (index < 0 || number < 1 || number > 0xFFFF) {
+                fprintf(stderr, "Bad --param %s\n", value);
+                return false;
+            }
+            opt.params.*ALGORITHM_PARAM_FIELDS[index].member = (uint16_t)number;
+            opt.paramsSet = true;
+        }
+        else return false;
+        i++;
+    }
+
+    const char* error = nullptr;
+    if (!validateAlgorithmParams(opt.params, &error)) {
+        fprintf(stderr, "Invalid parameters: %s\n", error);
+        return false;
+    }
+    return opt.days > 0;
+}
+
+// Level change at a float switch, optionally with contact bounce
+static void queueSensorEdge(std::vector<PinEvent>& pending, uint8_t pin, uint8_t level, int bounces) {
+    uint64_t now = simTimeUs();
+    simDriveInput(pin, level);
+    for (int i = 0; i < bounces; i++) {
+        pending.push_back({now + (2 * i + 1) * SIM_BOUNCE_GAP_US, pin, (uint8_t)!level});
+        pending.push_back({now + (2 * i + 2) * SIM_BOUNCE_GAP_US, pin, level});
+    }
+}
+
+static void syncSensorPin(std::vector<PinEvent>& pending, uint8_t pin, bool triggered, uint8_t& modelLevel, int bounces) {
+    uint8_t level = triggered ? LOW : HIGH;
+    if (level == modelLevel) return;
+    modelLevel = level;
+    queueSensorEdge(pending, pin, level, bounces);
+}
+
+static void writeCsv(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (f == nullptr) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return;
+    }
+    fprintf(f, "unix_time,trigger_time,time_gap_1,time_gap_2,water_trigger_time,"
+               "pump_duration,pump_attempts,sensor_results,error_code,volume_dose\n");
+    for (const SimVpsCycle& r : simVpsCycles()) {
+        const PumpCycle& c = r.cycle;
+        fprintf(f, "%lu,%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u\n",
+                (unsigned long)r.unixTime, (unsigned long)c.trigger_time,
+                (unsigned long)c.time_gap_1, (unsigned long)c.time_gap_2,
+                (unsigned long)c.water_trigger_time, c.pump_duration, c.pump_attempts,
+                c.sensor_results, c.error_code, c.volume_dose);
+    }
+    fclose(f);
+}
+
+static void printReport(const SimOptions& opt, const TankModel& tank, const SimStats& stats,
+                        uint32_t startUnix, double wallSeconds) {
+    const std::vector<SimVpsCycle>& cycles = simVpsCycles();
+    uint32_t dayCount = (uint32_t)ceil(opt.days);
+    std::vector<uint32_t> perDay(dayCount, 0);
+    uint32_t gap1Fail = 0, gap2Fail = 0, waterFail = 0;
+    uint64_t countedMl = 0;
+
+    for (const SimVpsCycle& r : cycles) {
+        uint32_t day = (r.unixTime - startUnix) / 86400;
+        if (day < dayCount) perDay[day]++;
+        if (r.cycle.sensor_results & PumpCycle::RESULT_GAP1_FAIL) gap1Fail++;
+        if (r.cycle.sensor_results & PumpCycle::RESULT_GAP2_FAIL) gap2Fail++;
+        if (r.cycle.sensor_results & PumpCycle::RESULT_WATER_FAIL) waterFail++;
+        countedMl += r.cycle.volume_dose;
+    }
+    for (const SimVpsEvent& e : simVpsEvents()) {
+        countedMl += e.volumeML;
+    }
+
+    uint32_t minDay = perDay.empty() ? 0 : *std::min_element(perDay.begin(), perDay.end());
+    uint32_t maxDay = perDay.empty() ? 0 : *std::max_element(perDay.begin(), perDay.end());
+    double n = cycles.empty() ? 1.0 : (double)cycles.size();
+
+    const AlgorithmParams& params = waterAlgorithm.getParams();
+    printf("=== SIMULATION: %.1f days, TIME_TO_PUMP=%ds, seed %lu ===\n",
+           opt.days, params.timeToPump, (unsigned long)opt.seed);
+    if (opt.paramsSet) {
+        printf("Params: ");
+        for (uint8_t i = 0; i < ALGORITHM_PARAM_COUNT; i++) {
+            printf(" %s=%u", ALGORITHM_PARAM_FIELDS[i].key, params.*ALGORITHM_PARAM_FIELDS[i].member);
+        }
+        printf("\n");
+    }
+    printf("Tank:    evap %.1f ml/h (+-%.0f%%), leak %.1f ml/h, flow %.2f -> %.2f ml/s (firmware assumes %.2f), gap %.1f ml\n",
+           opt.tank.evapMlPerHour, opt.tank.evapDailySwing * 100, opt.tank.leakMlPerHour,
+           opt.tank.pumpFlowMlPerSec, tank.pumpFlow(), currentPumpSettings.volumePerSecond, opt.tank.sensorGapMl);
+    FlowEstimate flow = getFlowEstimate();
+    printf("Flow:    %s, baseline %u, window %u, estimate %.3f ml/s [%.3f-%.3f], %s%.3f ml/s, %u adjustments\n",
+           getFlowEstimatorStateString(flow.state), flow.baselineSamples, flow.windowSamples,
+           flow.estimatedVolumePerSecond, flow.anchorVolumePerSecond * flow.ratioLow,
+           flow.anchorVolumePerSecond * flow.ratioHigh, flow.recommend ? "recommend " : "keep ",
+           flow.recommendedVolumePerSecond, flow.adjustCount);
+    printf("Cycles:  %lu logged, %.2f/day (min %lu, max %lu)\n",
+           (unsigned long)cycles.size(), cycles.size() / opt.days, (unsigned long)minDay, (unsigned long)maxDay);
+    printf("Fails:   GAP1 %.1f%%  GAP2 %.1f%%  WATER %.1f%%\n",
+           100.0 * gap1Fail / n, 100.0 * gap2Fail / n, 100.0 * waterFail / n);
+    printf("Pump:    %lu starts, %lu failed runs (model)\n",
+           (unsigned long)stats.pumpStarts, (unsigned long)tank.failedRuns());
+    printf("Errors:  daily limit %lu, pump failure %lu, %.1f h in ERROR, %lu operator resets\n",
+           (unsigned long)stats.errorsDailyLimit, (unsigned long)stats.errorsPumpFailure,
+           stats.errorUs / 3.6e9, (unsigned long)stats.operatorResets);
+    printf("Water:   pumped %.0f ml, counted %llu ml, evaporated %.0f ml\n",
+           tank.pumpedMl(), (unsigned long long)countedMl, tank.evaporatedMl());
+    printf("Level:   min %.1f ml, max %.1f ml, end %.1f ml (sensor 1 = 0)\n",
+           tank.minLevel(), tank.maxLevel(), tank.level());
+    AdaptiveDelayStats adaptive = getAdaptiveDelayStats();
+    printf("Delay:   %s, TIME_TO_PUMP %u-%us, level at pump start %.1f..%.1f ml (mean %.1f)\n",
+           adaptive.enabled ? "adaptive" : "fixed", adaptive.minDelay, adaptive.maxDelay,
+           stats.pumpLevelMin, stats.pumpLevelMax,
+           stats.pumpLevelCount ? stats.pumpLevelSum / stats.pumpLevelCount : 0.0);
+    printf("Speed:   %lu control steps, %.3f s wall, %.0f simulated days/s\n",
+           (unsigned long)stats.steps, wallSeconds, wallSeconds > 0 ? opt.days / wallSeconds : 0.0);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "replay") == 0) {
+        return runReplay(argc - 1, argv + 1);
+    }
+
+    SimOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage();
+        return 1;
+    }
+
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    TankModel tank(opt.tank);
+    SimStats stats;
+    std::vector<PinEvent> pending;
+    uint8_t sensor1Level = HIGH;
+    uint8_t sensor2Level = HIGH;
+    bool pumpWasOn = false;
+    bool resetQueued = false;
+    uint64_t errorSinceUs = 0;
+    AlgorithmState lastState = STATE_IDLE;
+
+    simSetSerialEcho(opt.verbose);
+    simFramErase();
+
+    // Boot after a long uptime - soak starts just before the first millis() wrap
+    double uptimeStartDays = opt.uptimeStartDays >= 0 ? opt.uptimeStartDays
+                           : (opt.soak ? SOAK_DEFAULT_UPTIME_DAYS : 0.0);
+    simAdvanceUs((uint64_t)(uptimeStartDays * 86400.0 * 1e6));
+
+    // Same order as setup() in PRODUCTION_MODE, without network
+    initI2CBus();
+    initWaterSensors();
+    initPumpController();
+    initNVS();
+    loadVolumeFromNVS();
+    if (opt.paramsSet) {
+        saveAlgorithmParamsToFRAM(opt.params);   // as if set from the dashboard before this boot
+    }
+    waterAlgorithm.initParams();
+    setFlowAutoAdjust(opt.flowAutoAdjust);
+    initFlowEstimator();
+    setAdaptiveDelayEnabled(opt.adaptiveDelay);
+    initAdaptiveDelay(waterAlgorithm.getParams());
+    waterAlgorithm.initDailyVolume();
+    initTraceRecorder();
+    traceSyncPoint(TRACE_BOOT);
+
+    uint32_t startUnix = simUnixTime();
+    uint64_t endUs = simTimeUs() + (uint64_t)(opt.days * 86400.0 * 1e6);
+    auto wallStart = std::chrono::steady_clock::now();
+    if (opt.soak) soakBegin(endUs, opt.tank.pumpFailRate > 0);
+
+    while (simTimeUs() < endUs) {
+        uint32_t waitMs = runControlStep();
+        stats.steps++;
+        uint64_t now = simTimeUs();
+
+        bool pumpOn = simOutputLevel(PUMP_RELAY_PIN) == LOW;   // relay active LOW
+        if (pumpOn && !pumpWasOn) {
+            stats.pumpStarts++;
+            tank.onPumpStart(unit(rng));
+            if (waterAlgorithm.getState() == STATE_TRYB_2_PUMP) {
+                double level = tank.level();
+                if (stats.pumpLevelCount == 0 || level < stats.pumpLevelMin) stats.pumpLevelMin = level;
+                if (stats.pumpLevelCount == 0 || level > stats.pumpLevelMax) stats.pumpLevelMax = level;
+                stats.pumpLevelSum += level;
+                stats.pumpLevelCount++;
+            }
+        }
+        pumpWasOn = pumpOn;
+        uint64_t soakWakeUs = opt.soak ? soakStep(now, pumpOn, tank) : UINT64_MAX;
+
+        AlgorithmState state = waterAlgorithm.getState();
+        if (state == STATE_ERROR && lastState != STATE_ERROR) {
+            errorSinceUs = now;
+            ErrorCode error = waterAlgorithm.getLastError();
+            if (error == ERROR_DAILY_LIMIT || error == ERROR_BOTH) stats.errorsDailyLimit++;
+            if (error == ERROR_PUMP_FAILURE || error == ERROR_BOTH) stats.errorsPumpFailure++;
+            if (opt.soak) soakErrorEntered();
+        } else if (state != STATE_ERROR && lastState == STATE_ERROR) {
+            stats.errorUs += now - errorSinceUs;
+            resetQueued = false;
+        }
+        lastState = state;
+
+        // Operator walks over and presses RESET
+        if (state == STATE_ERROR && !resetQueued && opt.resetAfterHours >= 0 &&
+            now - errorSinceUs >= (uint64_t)(opt.resetAfterHours * 3.6e9)) {
+            pending.push_back({now, RESET_PIN, LOW});
+            pending.push_back({now + SIM_BUTTON_PRESS_US, RESET_PIN, HIGH});
+            resetQueued = true;
+            stats.operatorResets++;
+        }
+
+        // Next wake-up: control deadline, sensor crossing or queued pin edge
+        uint64_t stepUs = (uint64_t)std::max<uint32_t>(waitMs, 1) * 1000ULL;
+        uint32_t unixNow = simUnixTime();
+        const double heights[2] = { tank.sensor1Height(), tank.sensor2Height() };
+        for (double h : heights) {
+            double t = tank.secondsToCross(h, unixNow, pumpOn);
+            if (t >= 0) stepUs = std::min<uint64_t>(stepUs, (uint64_t)ceil(t * 1e6) + 1);
+        }
+        for (const PinEvent& e : pending) {
+            stepUs = std::min<uint64_t>(stepUs, e.atUs > now ? e.atUs - now : 0);
+        }
+        if (soakWakeUs > now) stepUs = std::min<uint64_t>(stepUs, soakWakeUs - now);
+        stepUs = std::min<uint64_t>(stepUs, endUs - now);
+
+        tank.advance(stepUs / 1e6, unixNow, pumpOn);
+        simAdvanceUs(stepUs);
+        now = simTimeUs();
+
+        syncSensorPin(pending, WATER_SENSOR_1_PIN, tank.sensor1Triggered(), sensor1Level, opt.bounceEdges);
+        syncSensorPin(pending, WATER_SENSOR_2_PIN, tank.sensor2Triggered(), sensor2Level, opt.bounceEdges);
+
+        for (size_t i = 0; i < pending.size();) {
+            if (pending[i].atUs <= now) {
+                simDriveInput(pending[i].pin, pending[i].level);
+                pending.erase(pending.begin() + i);
+            } else {
+                i++;
+            }
+        }
+    }
+
+    if (lastState == STATE_ERROR) stats.errorUs += simTimeUs() - errorSinceUs;
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    printReport(opt, tank, stats, startUnix, wallSeconds);
+    if (opt.csvPath != nullptr) writeCsv(opt.csvPath);
+    if (opt.tracePath != nullptr && !writeTraceDump(opt.tracePath)) {
+        fprintf(stderr, "Cannot write %s\n", opt.tracePath);
+    }
+    if (opt.soak && !soakReport(startUnix, opt.days)) {
+        return 3;
+    }
+    return 0;
+}
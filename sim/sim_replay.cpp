@@ -0,0 +1,417 @@
+// ===============================
+// TRACE REPLAY (native env)
+// ===============================
+// Feeds a trace downloaded from /api/trace back through the unmodified
+// control code: sensor edges are driven onto the pins at their recorded
+// millis(), web commands and the reset button call the same functions the
+// handlers do. The replay starts at a sync point (TRACE_BOOT, or a
+// TRACE_DAY_CHANGE taken in IDLE) and runs to the next boot or the end of
+// the trace. The replay records its own trace; pump starts, errors and the
+// logged cycles are then diffed against the device.
+//
+//   .pio/build/native/program replay trace.bin [--sync N] [--verbose]
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include "sim_hal.h"
+#include "sim_replay.h"
+#include "../src/core/trace_recorder.h"
+#include "../src/algorithm/water_algorithm.h"
+#include "../src/algorithm/algorithm_task.h"
+#include "../src/hardware/hardware_pins.h"
+#include "../src/hardware/water_sensors.h"
+#include "../src/hardware/pump_controller.h"
+#include "../src/hardware/i2c_bus.h"
+#include "../src/hardware/fram_controller.h"
+#include "../src/config/config.h"
+#include "../src/algorithm/flow_estimator.h"
+#include "../src/algorithm/adaptive_delay.h"
+
+#define REPLAY_TAIL_MS          2000    // keep running past the last record
+#define REPLAY_PUMP_TOLERANCE_MS 1000   // control step jitter on the device
+
+struct ReplayCycle {
+    uint32_t ms;
+    PumpCycle cycle;
+};
+
+struct ReplayOutputs {
+    std::vector<TraceRecord> pumpStarts;
+    std::vector<TraceRecord> errors;
+    std::vector<ReplayCycle> cycles;
+};
+
+bool loadTraceDump(const char* path, std::vector<TraceRecord>& records) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+
+    TraceDumpHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              header.magic == TRACE_DUMP_MAGIC &&
+              header.version == TRACE_DUMP_VERSION &&
+              header.recordSize == sizeof(TraceRecord);
+    if (!ok) {
+        fprintf(stderr, "%s: not a trace dump (or unsupported version)\n", path);
+        fclose(f);
+        return false;
+    }
+
+    uint32_t invalid = 0;
+    for (uint16_t i = 0; i < header.count; i++) {
+        TraceRecord record;
+        if (fread(&record, sizeof(record), 1, f) != 1) break;
+        if (traceRecordValid(record)) {
+            records.push_back(record);
+        } else {
+            invalid++;
+        }
+    }
+    fclose(f);
+
+    printf("Trace: %u records (%u failed CRC), %u dropped on device, %u boots\n",
+           (unsigned)records.size(), (unsigned)invalid, header.dropped, header.boots);
+    return true;
+}
+
+bool writeTraceDump(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (f == nullptr) return false;
+
+    size_t size = beginTraceDump();
+    uint8_t chunk[512];
+    for (size_t index = 0; index < size;) {
+        size_t n = readTraceDump(chunk, sizeof(chunk), index);
+        if (n == 0) break;
+        fwrite(chunk, 1, n, f);
+        index += n;
+    }
+    endTraceDump();
+    fclose(f);
+    return true;
+}
+
+// Sync point usable as a replay start: boot, or a day change in IDLE with the pump off
+static bool isReplayStart(const TraceRecord& r) {
+    if (r.type == TRACE_BOOT) return true;
+    return r.type == TRACE_DAY_CHANGE &&
+           (r.arg >> TRACE_SYNC_STATE_SHIFT) == STATE_IDLE &&
+           !(r.arg & TRACE_SYNC_PUMP) && r.data != 0;
+}
+
+static bool isOutput(uint8_t type) {
+    return type == TRACE_PUMP_START || type == TRACE_PUMP_STOP || type == TRACE_ERROR ||
+           type == TRACE_CYCLE_SENSORS || type == TRACE_CYCLE_PUMP;
+}
+
+static ReplayOutputs collectOutputs(const std::vector<TraceRecord>& records) {
+    ReplayOutputs out;
+    for (size_t i = 0; i < records.size(); i++) {
+        const TraceRecord& r = records[i];
+        if (r.type == TRACE_PUMP_START) out.pumpStarts.push_back(r);
+        if (r.type == TRACE_ERROR) out.errors.push_back(r);
+        if (r.type == TRACE_CYCLE_SENSORS && i + 1 < records.size() && records[i + 1].type == TRACE_CYCLE_PUMP) {
+            ReplayCycle c;
+            c.ms = r.ms;
+            traceDecodeCycle(r, records[i + 1], c.cycle);
+            out.cycles.push_back(c);
+        }
+    }
+    return out;
+}
+
+static std::vector<TraceRecord> readOwnTrace() {
+    std::vector<TraceRecord> records;
+    size_t size = beginTraceDump();
+    std::vector<uint8_t> dump(size);
+    readTraceDump(dump.data(), size, 0);
+    endTraceDump();
+    for (size_t off = sizeof(TraceDumpHeader); off + sizeof(TraceRecord) <= size; off += sizeof(TraceRecord)) {
+        TraceRecord r;
+        memcpy(&r, dump.data() + off, sizeof(r));
+        records.push_back(r);
+    }
+    return records;
+}
+
+// Same calls as the web handlers / reset button
+static void applyCommand(const TraceRecord& r) {
+    switch (r.arg) {
+        case TRACE_CMD_PUMP_NORMAL:    triggerPump((uint16_t)r.data, "MANUAL_NORMAL"); break;
+        case TRACE_CMD_PUMP_EXTENDED:  triggerPump((uint16_t)r.data, "MANUAL_EXTENDED"); break;
+        case TRACE_CMD_PUMP_STOP:      stopPump(); break;
+        case TRACE_CMD_PUMP_TOGGLE:    setPumpGlobalState(r.data != 0); break;
+        case TRACE_CMD_SYSTEM_TOGGLE:
+            systemDisableRequested = r.data != 0;
+            systemDisabledTime = r.data ? millis() : 0;
+            break;
+        case TRACE_CMD_RESET_STATS:        waterAlgorithm.resetErrorStatistics(); break;
+        case TRACE_CMD_RESET_DAILY_VOLUME: waterAlgorithm.resetDailyVolume(); break;
+        case TRACE_CMD_RESET_BUTTON:       waterAlgorithm.resetFromError(); break;
+        default: break;
+    }
+}
+
+static void applySettings(const TraceRecord& r) {
+    float volume;
+    memcpy(&volume, &r.data, sizeof(volume));
+    currentPumpSettings.volumePerSecond = volume;
+}
+
+// TRACE_PARAMS pairs written together - collected, then applied as one set
+static AlgorithmParams replayParams;
+static bool replayParamsChanged = false;
+
+static void applyParams() {
+    if (!replayParamsChanged) return;
+    replayParamsChanged = false;
+
+    // Day change sync points repeat the active set - nothing to apply
+    if (memcmp(&replayParams, &waterAlgorithm.getPendingParams(), sizeof(replayParams)) == 0) return;
+
+    const char* error = nullptr;
+    if (!waterAlgorithm.setParams(replayParams, &error)) {
+        printf("Trace params rejected: %s\n", error);
+    }
+}
+
+static void applyInput(const TraceRecord& r) {
+    switch (r.type) {
+        case TRACE_PARAMS:
+            traceDecodeParams(r, replayParams);
+            replayParamsChanged = true;
+            break;
+        case TRACE_SENSOR:
+            simDriveInput(r.arg == 1 ? WATER_SENSOR_1_PIN : WATER_SENSOR_2_PIN, r.data ? LOW : HIGH);
+            break;
+        case TRACE_COMMAND:  applyCommand(r); break;
+        case TRACE_SETTINGS: applySettings(r); break;
+        default: break;
+    }
+}
+
+static const char* pumpSourceName(uint8_t source) {
+    switch (source) {
+        case TRACE_PUMP_AUTO:            return "AUTO";
+        case TRACE_PUMP_MANUAL_NORMAL:   return "MANUAL_NORMAL";
+        case TRACE_PUMP_MANUAL_EXTENDED: return "MANUAL_EXTENDED";
+        default:                         return "OTHER";
+    }
+}
+
+static bool sameCycle(const PumpCycle& a, const PumpCycle& b) {
+    return a.time_gap_1 == b.time_gap_1 && a.time_gap_2 == b.time_gap_2 &&
+           a.water_trigger_time == b.water_trigger_time && a.pump_duration == b.pump_duration &&
+           a.pump_attempts == b.pump_attempts && a.sensor_results == b.sensor_results &&
+           a.error_code == b.error_code && a.volume_dose == b.volume_dose;
+}
+
+static void printCycle(const char* tag, const ReplayCycle* c) {
+    if (c == nullptr) {
+        printf("  %-7s -\n", tag);
+        return;
+    }
+    printf("  %-7s @%10lu ms  gap1=%lu gap2=%lu water=%lu pump=%us attempts=%u results=0x%02x err=%u vol=%uml\n",
+           tag, (unsigned long)c->ms, (unsigned long)c->cycle.time_gap_1, (unsigned long)c->cycle.time_gap_2,
+           (unsigned long)c->cycle.water_trigger_time, c->cycle.pump_duration, c->cycle.pump_attempts,
+           c->cycle.sensor_results, c->cycle.error_code, c->cycle.volume_dose);
+}
+
+static uint32_t diffOutputs(const ReplayOutputs& device, const ReplayOutputs& replay) {
+    uint32_t differences = 0;
+
+    size_t cycleCount = std::max(device.cycles.size(), replay.cycles.size());
+    printf("Cycles:  device %u, replay %u\n", (unsigned)device.cycles.size(), (unsigned)replay.cycles.size());
+    for (size_t i = 0; i < cycleCount; i++) {
+        const ReplayCycle* d = i < device.cycles.size() ? &device.cycles[i] : nullptr;
+        const ReplayCycle* r = i < replay.cycles.size() ? &replay.cycles[i] : nullptr;
+        if (d != nullptr && r != nullptr && sameCycle(d->cycle, r->cycle)) continue;
+
+        differences++;
+        printf(" cycle #%u differs:\n", (unsigned)i);
+        printCycle("device", d);
+        printCycle("replay", r);
+    }
+
+    size_t pumpCount = std::max(device.pumpStarts.size(), replay.pumpStarts.size());
+    printf("Pump:    device %u starts, replay %u\n", (unsigned)device.pumpStarts.size(), (unsigned)replay.pumpStarts.size());
+    for (size_t i = 0; i < pumpCount; i++) {
+        const TraceRecord* d = i < device.pumpStarts.size() ? &device.pumpStarts[i] : nullptr;
+        const TraceRecord* r = i < replay.pumpStarts.size() ? &replay.pumpStarts[i] : nullptr;
+        if (d != nullptr && r != nullptr && d->arg == r->arg && d->data == r->data &&
+            (d->ms > r->ms ? d->ms - r->ms : r->ms - d->ms) <= REPLAY_PUMP_TOLERANCE_MS) continue;
+
+        differences++;
+        printf(" pump start #%u differs: device %s, replay %s\n", (unsigned)i,
+               d ? pumpSourceName(d->arg) : "-", r ? pumpSourceName(r->arg) : "-");
+        if (d) printf("  device  @%10lu ms for %lus\n", (unsigned long)d->ms, (unsigned long)d->data);
+        if (r) printf("  replay  @%10lu ms for %lus\n", (unsigned long)r->ms, (unsigned long)r->data);
+    }
+
+    size_t errorCount = std::max(device.errors.size(), replay.errors.size());
+    printf("Errors:  device %u, replay %u\n", (unsigned)device.errors.size(), (unsigned)replay.errors.size());
+    for (size_t i = 0; i < errorCount; i++) {
+        const TraceRecord* d = i < device.errors.size() ? &device.errors[i] : nullptr;
+        const TraceRecord* r = i < replay.errors.size() ? &replay.errors[i] : nullptr;
+        if (d != nullptr && r != nullptr && d->arg == r->arg) continue;
+
+        differences++;
+        printf(" error #%u differs:\n", (unsigned)i);
+        if (d) printf("  device  @%10lu ms ERR code %u\n", (unsigned long)d->ms, d->arg);
+        if (r) printf("  replay  @%10lu ms ERR code %u\n", (unsigned long)r->ms, r->arg);
+    }
+
+    return differences;
+}
+
+int runReplay(int argc, char** argv) {
+    const char* path = nullptr;
+    int syncIndex = 0;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+        else if (strcmp(argv[i], "--sync") == 0 && i + 1 < argc) syncIndex = atoi(argv[++i]);
+        else if (path == nullptr) path = argv[i];
+        else path = nullptr, i = argc;
+    }
+    if (path == nullptr) {
+        printf("Usage: program replay TRACE.bin [--sync N] [--verbose]\n"
+               "  --sync N    start at the N-th usable sync point (boot / day change in IDLE)\n");
+        return 1;
+    }
+
+    std::vector<TraceRecord> records;
+    if (!loadTraceDump(path, records)) return 1;
+
+    // Segment: [sync point, next boot)
+    std::vector<size_t> starts;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (isReplayStart(records[i])) starts.push_back(i);
+    }
+    if (syncIndex < 0 || (size_t)syncIndex >= starts.size()) {
+        fprintf(stderr, "No usable sync point #%d (trace has %u)\n", syncIndex, (unsigned)starts.size());
+        return 1;
+    }
+    size_t first = starts[syncIndex];
+    size_t last = first + 1;
+    while (last < records.size() && records[last].type != TRACE_BOOT) last++;
+    std::vector<TraceRecord> segment(records.begin() + first, records.begin() + last);
+
+    const TraceRecord& sync = segment[0];
+    printf("Replaying records %u-%u from %s at %lu ms\n", (unsigned)first, (unsigned)(last - 1),
+           sync.type == TRACE_BOOT ? "boot" : "day change", (unsigned long)sync.ms);
+
+    // Device state at the sync point (traces without TRACE_PARAMS: defaults)
+    replayParams = getDefaultAlgorithmParams();
+    uint16_t dailyVolume = 0;
+    uint8_t flags = TRACE_FLAG_PUMP_ENABLED;
+    std::vector<TraceRecord> adaptiveState;
+    for (size_t i = 1; i < segment.size() && segment[i].ms == sync.ms; i++) {
+        if (segment[i].type == TRACE_DAILY_VOLUME) {
+            dailyVolume = (uint16_t)segment[i].data;
+            flags = segment[i].arg;
+        } else if (segment[i].type == TRACE_SETTINGS) {
+            applySettings(segment[i]);
+        } else if (segment[i].type == TRACE_PARAMS) {
+            traceDecodeParams(segment[i], replayParams);
+            replayParamsChanged = true;
+        } else if (segment[i].type == TRACE_ADAPTIVE) {
+            adaptiveState.push_back(segment[i]);
+        }
+    }
+
+    simSetSerialEcho(verbose);
+    simFramErase();
+    simAdvanceUs((uint64_t)sync.ms * 1000ULL);
+    if (sync.data != 0) {
+        simSetEpoch(sync.data - sync.ms / 1000);
+    } else {
+        simSetRTCWorking(false);
+    }
+    simDriveInput(WATER_SENSOR_1_PIN, (sync.arg & TRACE_SYNC_SENSOR1) ? LOW : HIGH);
+    simDriveInput(WATER_SENSOR_2_PIN, (sync.arg & TRACE_SYNC_SENSOR2) ? LOW : HIGH);
+
+    float volumePerSecond = currentPumpSettings.volumePerSecond;
+    initI2CBus();
+    initWaterSensors();
+    initPumpController();
+    initNVS();
+    currentPumpSettings.volumePerSecond = volumePerSecond;
+    if (replayParamsChanged) {
+        saveAlgorithmParamsToFRAM(replayParams);
+        replayParamsChanged = false;
+    }
+    waterAlgorithm.initParams();
+    // Auto-adjustments are in the trace as TRACE_SETTINGS inputs
+    setFlowAutoAdjust(false);
+    initFlowEstimator();
+    // Learned delay state replaces what the (empty) FRAM history gave
+    initAdaptiveDelay(waterAlgorithm.getParams());
+    for (const TraceRecord& r : adaptiveState) restoreAdaptiveDelayState(r);
+    if (sync.data != 0) saveDailyVolumeToFRAM(dailyVolume, sync.data / 86400);
+    waterAlgorithm.initDailyVolume();
+    pumpGlobalEnabled = (flags & TRACE_FLAG_PUMP_ENABLED) != 0;
+    if (flags & TRACE_FLAG_SYSTEM_DISABLED) {
+        systemDisableRequested = true;
+        systemDisabledTime = millis();
+    }
+    initTraceRecorder();
+
+    // Inputs in time order (sensor records carry the edge time, written ~50 ms later)
+    std::vector<TraceRecord> inputs;
+    uint32_t endMs = sync.ms;
+    for (size_t i = 1; i < segment.size(); i++) {
+        const TraceRecord& r = segment[i];
+        if ((int32_t)(r.ms - endMs) > 0) endMs = r.ms;
+        if (r.type == TRACE_SENSOR || r.type == TRACE_COMMAND ||
+            ((r.type == TRACE_SETTINGS || r.type == TRACE_PARAMS) && r.ms != sync.ms)) {
+            inputs.push_back(r);
+        }
+    }
+    std::stable_sort(inputs.begin(), inputs.end(),
+                     [](const TraceRecord& a, const TraceRecord& b) { return (int32_t)(a.ms - b.ms) < 0; });
+    endMs += REPLAY_TAIL_MS;
+
+    size_t next = 0;
+    while ((int32_t)(millis() - endMs) < 0) {
+        uint32_t waitMs = runControlStep();
+        uint64_t now = simTimeUs();
+        uint64_t wakeUs = now + (uint64_t)std::max<uint32_t>(waitMs, 1) * 1000ULL;
+        if (next < inputs.size()) {
+            uint64_t inputUs = (uint64_t)inputs[next].ms * 1000ULL;
+            wakeUs = std::min(wakeUs, std::max(inputUs, now));
+        }
+        wakeUs = std::min<uint64_t>(wakeUs, (uint64_t)endMs * 1000ULL);
+        simAdvanceUs(wakeUs - now);
+
+        while (next < inputs.size() && (uint64_t)inputs[next].ms * 1000ULL <= simTimeUs()) {
+            applyInput(inputs[next++]);
+        }
+        applyParams();
+    }
+
+    std::vector<TraceRecord> deviceOutputs;
+    for (const TraceRecord& r : segment) {
+        if (isOutput(r.type)) deviceOutputs.push_back(r);
+    }
+    std::vector<TraceRecord> replayOutputs;
+    for (const TraceRecord& r : readOwnTrace()) {
+        if (isOutput(r.type)) replayOutputs.push_back(r);
+    }
+
+    uint32_t differences = diffOutputs(collectOutputs(deviceOutputs), collectOutputs(replayOutputs));
+    if (differences == 0) {
+        printf("Replay matches the device\n");
+        return 0;
+    }
+    printf("%lu difference(s)\n", (unsigned long)differences);
+    return 2;
+}
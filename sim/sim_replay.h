@@ -0,0 +1,14 @@
+#ifndef SIM_REPLAY_H
+#define SIM_REPLAY_H
+
+#include <vector>
+#include "../src/core/trace_recorder.h"
+
+// `program replay TRACE.bin ...` - returns 0 when the replay matches the device
+int runReplay(int argc, char** argv);
+
+// /api/trace download format (TraceDumpHeader + records)
+bool loadTraceDump(const char* path, std::vector<TraceRecord>& records);
+bool writeTraceDump(const char* path);
+
+#endif
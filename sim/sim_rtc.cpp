@@ -0,0 +1,36 @@
+#include "../src/hardware/rtc_controller.h"
+#include "sim_hal.h"
+#include <time.h>
+
+// DS3231 stand-in (replaces rtc_controller.cpp): always valid, follows the
+// simulated clock. simSetRTCWorking(false) models a dead RTC.
+
+static bool rtcWorking = true;
+
+void simSetRTCWorking(bool working) { rtcWorking = working; }
+
+void initializeRTC() {}
+
+bool isRTCWorking() { return rtcWorking; }
+
+unsigned long getUnixTimestamp() { return simUnixTime(); }
+
+const char* getCurrentTimestamp() {
+    static char buf[24];
+    time_t t = (time_t)simUnixTime();
+    struct tm tmUtc;
+    gmtime_r(&t, &tmUtc);
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tmUtc);
+    return buf;
+}
+
+String getRTCInfo() { return String("Simulated DS3231"); }
+String getTimeSourceInfo() { return String("SIM"); }
+bool isRTCHardware() { return true; }
+bool rtcNeedsSynchronization() { return false; }
+void initInternalTimeFromCompileTime() {}
+bool setRTCFromNTP() { return true; }
+bool isBatteryIssueDetected() { return false; }
+
+void updateClock() {}
+ClockStats getClockStats() { return ClockStats(); }
@@ -0,0 +1,402 @@
+// ===============================
+// LONG-UPTIME SOAK (native env)
+// ===============================
+// Checks run alongside the normal simulation loop (see sim_soak.h). Probes
+// drive the same functions the web handlers and loop() call; their results
+// are compared against the 64-bit virtual clock.
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <vector>
+#include <algorithm>
+
+#include "sim_hal.h"
+#include "sim_vps.h"
+#include "sim_soak.h"
+#include "tank_model.h"
+#include "../src/algorithm/water_algorithm.h"
+#include "../src/hardware/pump_controller.h"
+#include "../src/config/config.h"
+#include "../src/security/session_manager.h"
+#include "../src/security/rate_limiter.h"
+
+#define SOAK_DAY_US                 86400000000ULL
+#define SOAK_MILLIS_WRAP_US         (4294967296ULL * 1000ULL)  // millis() period, 49.7 days
+#define SOAK_PROBE_INTERVAL_US      (7ULL * SOAK_DAY_US)
+#define SOAK_CONTROL_LEAD_US        1200000000ULL   // 20 min - the auto-enable lands after the wrap
+#define SOAK_SECURITY_LEAD_US       45000000ULL     // 45 s - so does the end of the IP block
+#define SOAK_EDGE_LEAD_US           600000000ULL    // 10 min - tank lowered so the sensor edges straddle the wrap
+#define SOAK_EDGE_MARGIN_S          60.0            // sensor 1 edge at least this far ahead when the level is set
+#define SOAK_EDGE_CYCLE_WAIT_US     SOAK_DAY_US     // edge probe cycle must be logged within a day
+#define SOAK_IDLE_RETRY_US          10000000ULL     // control probe waits for IDLE
+#define SOAK_SESSION_IDLE_US        1740000000ULL   // 29 min - below SESSION_TIMEOUT_MS
+#define SOAK_CHECK_MARGIN_US        1000000ULL      // before / after a security deadline
+#define SOAK_TOLERANCE_US           2000ULL         // ms truncation of uptimeMs() + 1 ms loop step
+#define SOAK_MAX_STEPS_PER_DAY      20000           // more = a deadline keeps returning 0
+#define SOAK_MAX_PRINTED_FAILURES   20
+
+enum SoakSecurityStage {
+    SECURITY_IDLE,
+    SECURITY_STILL_BLOCKED,     // BLOCK_DURATION_MS - 1 s
+    SECURITY_UNBLOCKED,         // BLOCK_DURATION_MS + 1 s
+    SECURITY_SESSION_ACTIVE,    // 29 min idle - still valid
+    SECURITY_SESSION_EXPIRED    // SESSION_TIMEOUT_MS after the last activity
+};
+
+enum SoakEdgeStage {
+    EDGE_IDLE,
+    EDGE_WAIT_SENSORS,          // level set, waiting for both sensors to trigger
+    EDGE_WAIT_CYCLE             // waiting for the cycle to be logged
+};
+
+enum SoakProbeKind {
+    PROBE_CONTROL,              // pump / system disable
+    PROBE_SECURITY,             // session + rate limiter
+    PROBE_EDGE                  // sensor 1 before a wrap, sensor 2 after it
+};
+
+struct SoakProbe {
+    uint64_t atUs;
+    SoakProbeKind kind;
+};
+
+static std::vector<SoakProbe> probes;
+static size_t nextControl = 0;
+static size_t nextSecurity = 0;
+static size_t nextEdge = 0;
+
+static uint64_t beginUs = 0;
+static uint64_t endUs = 0;
+static bool errorsExpected = false;
+
+static bool controlActive = false;
+static uint64_t controlStartUs = 0;
+static uint64_t pumpEnabledUs = 0;
+static uint64_t systemEnabledUs = 0;
+
+static SoakSecurityStage securityStage = SECURITY_IDLE;
+static uint64_t securityStartUs = 0;
+static uint64_t sessionActivityUs = 0;
+static String sessionToken;
+static const IPAddress soakIp(10, 0, 0, 99);
+
+static SoakEdgeStage edgeStage = EDGE_IDLE;
+static uint64_t edgeWrapUs = 0;
+static uint64_t edgeSensor1Us = 0;
+static uint64_t edgeSensor2Us = 0;
+static size_t edgeCycleIndex = 0;
+
+static bool pumpWasOn = false;
+static uint64_t pumpStartUs = 0;
+static uint32_t pumpExpectedMs = 0;
+
+static uint32_t failures = 0;
+static uint32_t pumpRuns = 0;
+static uint32_t controlProbes = 0;
+static uint32_t securityProbes = 0;
+static uint32_t edgeProbes = 0;
+static uint32_t errors = 0;
+static std::vector<uint32_t> stepsPerDay;
+
+// auth_manager.cpp is not in the native build - no whitelisted IPs
+bool isIPAllowed(IPAddress ip) {
+    return false;
+}
+
+static void fail(uint64_t nowUs, const char* format, ...) {
+    failures++;
+    if (failures > SOAK_MAX_PRINTED_FAILURES) return;
+
+    char message[160];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    printf("SOAK FAIL at uptime %.4f days: %s\n", nowUs / (double)SOAK_DAY_US, message);
+}
+
+static bool nearUs(uint64_t actual, uint64_t expected) {
+    uint64_t diff = actual > expected ? actual - expected : expected - actual;
+    return diff <= SOAK_TOLERANCE_US;
+}
+
+void soakBegin(uint64_t end, bool expectErrors) {
+    beginUs = simTimeUs();
+    endUs = end;
+    errorsExpected = expectErrors;
+    stepsPerDay.assign((size_t)((endUs - beginUs + SOAK_DAY_US - 1) / SOAK_DAY_US), 0);
+
+    // The control probe keeps the system disabled across the wrap, the edge
+    // probe needs it running - they take turns, starting with the edge probe
+    bool edgeWrap = true;
+    for (uint64_t wrap = (beginUs / SOAK_MILLIS_WRAP_US + 1) * SOAK_MILLIS_WRAP_US; wrap < endUs; wrap += SOAK_MILLIS_WRAP_US) {
+        if (edgeWrap) {
+            if (wrap - SOAK_EDGE_LEAD_US > beginUs) probes.push_back({wrap - SOAK_EDGE_LEAD_US, PROBE_EDGE});
+        } else if (wrap - SOAK_CONTROL_LEAD_US > beginUs) {
+            probes.push_back({wrap - SOAK_CONTROL_LEAD_US, PROBE_CONTROL});
+        }
+        if (wrap - SOAK_SECURITY_LEAD_US > beginUs) probes.push_back({wrap - SOAK_SECURITY_LEAD_US, PROBE_SECURITY});
+        edgeWrap = !edgeWrap;
+    }
+    for (uint64_t t = beginUs + SOAK_PROBE_INTERVAL_US / 2; t < endUs; t += SOAK_PROBE_INTERVAL_US) {
+        probes.push_back({t, PROBE_CONTROL});
+        probes.push_back({t, PROBE_SECURITY});
+    }
+    std::stable_sort(probes.begin(), probes.end(),
+                     [](const SoakProbe& a, const SoakProbe& b) { return a.atUs < b.atUs; });
+}
+
+void soakErrorEntered() {
+    errors++;
+    if (!errorsExpected) {
+        fail(simTimeUs(), "ERROR state entered (error %d)", (int)waterAlgorithm.getLastError());
+    }
+}
+
+static size_t nextProbe(size_t from, SoakProbeKind kind) {
+    while (from < probes.size() && probes[from].kind != kind) from++;
+    return from;
+}
+
+static void checkPump(uint64_t nowUs, bool pumpOn) {
+    if (pumpOn && !pumpWasOn) {
+        pumpStartUs = nowUs;
+        pumpExpectedMs = getPumpRemainingMs();
+    } else if (!pumpOn && pumpWasOn) {
+        pumpRuns++;
+        uint64_t ranUs = nowUs - pumpStartUs;
+        if (!nearUs(ranUs, (uint64_t)pumpExpectedMs * 1000ULL)) {
+            fail(nowUs, "pump ran %.3f s, timer was %.3f s", ranUs / 1e6, pumpExpectedMs / 1e3);
+        }
+    }
+    pumpWasOn = pumpOn;
+}
+
+// Pump + system disable from IDLE, both auto-enable after 30 min
+static uint64_t stepControlProbe(uint64_t nowUs, bool pumpOn) {
+    if (!controlActive) {
+        nextControl = nextProbe(nextControl, PROBE_CONTROL);
+        if (nextControl >= probes.size()) return UINT64_MAX;
+        if (probes[nextControl].atUs > nowUs) return probes[nextControl].atUs;
+
+        if (pumpOn || waterAlgorithm.getState() != STATE_IDLE) {
+            return nowUs + SOAK_IDLE_RETRY_US;      // never disable in the middle of a cycle
+        }
+        nextControl++;
+        controlProbes++;
+        controlActive = true;
+        controlStartUs = nowUs;
+        pumpEnabledUs = 0;
+        systemEnabledUs = 0;
+        setPumpGlobalState(false);
+        setSystemState(false);
+    }
+
+    if (pumpEnabledUs == 0 && pumpGlobalEnabled) pumpEnabledUs = nowUs;
+    if (systemEnabledUs == 0 && !systemDisableRequested) systemEnabledUs = nowUs;
+
+    uint64_t pumpDueUs = controlStartUs + (uint64_t)PUMP_AUTO_ENABLE_MS * 1000ULL;
+    uint64_t systemDueUs = controlStartUs + (uint64_t)SYSTEM_AUTO_ENABLE_MS * 1000ULL;
+    uint64_t lateUs = std::max(pumpDueUs, systemDueUs) + SOAK_TOLERANCE_US;
+
+    if (pumpEnabledUs != 0 && systemEnabledUs != 0) {
+        if (!nearUs(pumpEnabledUs, pumpDueUs)) {
+            fail(nowUs, "pump auto-enabled after %.3f s", (pumpEnabledUs - controlStartUs) / 1e6);
+        }
+        if (!nearUs(systemEnabledUs, systemDueUs)) {
+            fail(nowUs, "system auto-enabled after %.3f s", (systemEnabledUs - controlStartUs) / 1e6);
+        }
+        controlActive = false;
+        return nowUs + 1;
+    }
+    if (nowUs > lateUs) {
+        fail(nowUs, "auto-enable missing after %.3f s", (nowUs - controlStartUs) / 1e6);
+        setPumpGlobalState(true);
+        setSystemState(true);
+        controlActive = false;
+        return nowUs + 1;
+    }
+    return lateUs + 1;
+}
+
+static uint64_t securityDueUs() {
+    uint64_t blockUs = (uint64_t)BLOCK_DURATION_MS * 1000ULL;
+    switch (securityStage) {
+        case SECURITY_STILL_BLOCKED:   return securityStartUs + blockUs - SOAK_CHECK_MARGIN_US;
+        case SECURITY_UNBLOCKED:       return securityStartUs + blockUs + SOAK_CHECK_MARGIN_US;
+        case SECURITY_SESSION_ACTIVE:  return securityStartUs + SOAK_SESSION_IDLE_US;
+        case SECURITY_SESSION_EXPIRED: return sessionActivityUs + (uint64_t)SESSION_TIMEOUT_MS * 1000ULL + SOAK_CHECK_MARGIN_US;
+        default:                       return 0;
+    }
+}
+
+// Same calls as a web request that fails the login MAX_FAILED_ATTEMPTS
+// times, then a logged-in dashboard left open
+static uint64_t stepSecurityProbe(uint64_t nowUs) {
+    if (securityStage == SECURITY_IDLE) {
+        nextSecurity = nextProbe(nextSecurity, PROBE_SECURITY);
+        if (nextSecurity >= probes.size()) return UINT64_MAX;
+        if (probes[nextSecurity].atUs > nowUs) return probes[nextSecurity].atUs;
+
+        nextSecurity++;
+        securityProbes++;
+        securityStartUs = nowUs;
+        for (int i = 0; i < MAX_FAILED_ATTEMPTS; i++) {
+            recordRequest(soakIp);
+            recordFailedAttempt(soakIp);
+        }
+        if (!isIPBlocked(soakIp)) fail(nowUs, "IP not blocked after %d failed attempts", MAX_FAILED_ATTEMPTS);
+
+        sessionToken = createSession(soakIp);
+        if (!validateSession(sessionToken, soakIp)) fail(nowUs, "new session rejected");
+
+        securityStage = SECURITY_STILL_BLOCKED;
+        return securityDueUs();
+    }
+
+    if (nowUs < securityDueUs()) return securityDueUs();
+
+    switch (securityStage) {
+        case SECURITY_STILL_BLOCKED:
+            updateRateLimiter();
+            if (!isIPBlocked(soakIp)) fail(nowUs, "IP block ended early");
+            securityStage = SECURITY_UNBLOCKED;
+            break;
+
+        case SECURITY_UNBLOCKED:
+            updateRateLimiter();
+            if (isIPBlocked(soakIp)) fail(nowUs, "IP still blocked after %lu ms", (unsigned long)BLOCK_DURATION_MS);
+            securityStage = SECURITY_SESSION_ACTIVE;
+            break;
+
+        case SECURITY_SESSION_ACTIVE:
+            updateSessionManager();
+            if (!validateSession(sessionToken, soakIp)) fail(nowUs, "session expired after 29 min idle");
+            sessionActivityUs = nowUs;
+            securityStage = SECURITY_SESSION_EXPIRED;
+            break;
+
+        default:
+            updateSessionManager();
+            if (validateSession(sessionToken, soakIp)) fail(nowUs, "session still valid after SESSION_TIMEOUT_MS");
+            destroySession(sessionToken);
+            securityStage = SECURITY_IDLE;
+            return nowUs + 1;
+    }
+    return securityDueUs();
+}
+
+// Sets the tank level so that, at the current evaporation rate, sensor 1
+// triggers half a sensor gap before the millis() wrap and sensor 2 half a gap
+// after it. The logged cycle must report the real gap between the two edges.
+static uint64_t stepEdgeProbe(uint64_t nowUs, bool pumpOn, TankModel& tank) {
+    if (edgeStage == EDGE_IDLE) {
+        nextEdge = nextProbe(nextEdge, PROBE_EDGE);
+        if (nextEdge >= probes.size()) return UINT64_MAX;
+        if (probes[nextEdge].atUs > nowUs) return probes[nextEdge].atUs;
+
+        uint64_t wrapUs = probes[nextEdge].atUs + SOAK_EDGE_LEAD_US;
+        uint32_t unixNow = simUnixTime();
+        double toSensor1 = tank.secondsToCross(tank.sensor1Height(), unixNow, false);
+        double gapS = tank.secondsToCross(tank.sensor2Height(), unixNow, false) - toSensor1;
+        double untilSensor1S = (wrapUs - nowUs) / 1e6 - gapS / 2;
+
+        if (pumpOn || waterAlgorithm.getState() != STATE_IDLE || toSensor1 < 0) {
+            if (untilSensor1S - SOAK_IDLE_RETRY_US / 1e6 > SOAK_EDGE_MARGIN_S) {
+                return nowUs + SOAK_IDLE_RETRY_US;  // wait for IDLE with both sensors clear
+            }
+            nextEdge++;
+            fail(nowUs, "edge probe: no idle tank before the wrap");
+            return nowUs + 1;
+        }
+
+        nextEdge++;
+        edgeProbes++;
+        double rate = (tank.sensor1Height() - tank.sensor2Height()) / gapS;
+        tank.setLevel(tank.sensor1Height() + rate * untilSensor1S);
+        edgeWrapUs = wrapUs;
+        edgeSensor1Us = 0;
+        edgeSensor2Us = 0;
+        edgeCycleIndex = simVpsCycles().size();
+        edgeStage = EDGE_WAIT_SENSORS;
+        return UINT64_MAX;      // the main loop wakes up at the crossings
+    }
+
+    if (edgeStage == EDGE_WAIT_SENSORS) {
+        if (edgeSensor1Us == 0 && tank.sensor1Triggered()) edgeSensor1Us = nowUs;
+        if (edgeSensor2Us == 0 && tank.sensor2Triggered()) edgeSensor2Us = nowUs;
+        if (edgeSensor1Us == 0 || edgeSensor2Us == 0) return UINT64_MAX;
+
+        if (edgeSensor1Us >= edgeWrapUs || edgeSensor2Us < edgeWrapUs) {
+            fail(nowUs, "edge probe: sensor edges at %+.1f s / %+.1f s do not straddle the wrap",
+                 ((double)edgeSensor1Us - edgeWrapUs) / 1e6, ((double)edgeSensor2Us - edgeWrapUs) / 1e6);
+        }
+        edgeStage = EDGE_WAIT_CYCLE;
+        return nowUs + SOAK_EDGE_CYCLE_WAIT_US;
+    }
+
+    const std::vector<SimVpsCycle>& cycles = simVpsCycles();
+    if (cycles.size() > edgeCycleIndex) {
+        uint32_t expected = (uint32_t)((edgeSensor2Us - edgeSensor1Us) / 1000000ULL);
+        uint32_t gap = cycles[edgeCycleIndex].cycle.time_gap_1;
+        if (gap + 1 < expected || gap > expected + 1) {
+            fail(nowUs, "edge probe: time_gap_1 %lu s across the wrap, sensors were %lu s apart",
+                 (unsigned long)gap, (unsigned long)expected);
+        }
+        edgeStage = EDGE_IDLE;
+        return nowUs + 1;
+    }
+    if (nowUs >= edgeSensor2Us + SOAK_EDGE_CYCLE_WAIT_US) {
+        fail(nowUs, "edge probe: no cycle logged after the sensor edges");
+        edgeStage = EDGE_IDLE;
+        return nowUs + 1;
+    }
+    return edgeSensor2Us + SOAK_EDGE_CYCLE_WAIT_US;
+}
+
+uint64_t soakStep(uint64_t nowUs, bool pumpOn, TankModel& tank) {
+    size_t day = (size_t)((nowUs - beginUs) / SOAK_DAY_US);
+    if (day < stepsPerDay.size()) stepsPerDay[day]++;
+
+    uint32_t expectedSeconds = (uint32_t)(nowUs / 1000000ULL);
+    if (waterAlgorithm.getCurrentTimeSeconds() != expectedSeconds) {
+        fail(nowUs, "uptime %lu s, clock says %lu s",
+             (unsigned long)waterAlgorithm.getCurrentTimeSeconds(), (unsigned long)expectedSeconds);
+    }
+
+    checkPump(nowUs, pumpOn);
+    uint64_t wakeUs = stepControlProbe(nowUs, pumpOn);
+    wakeUs = std::min(wakeUs, stepSecurityProbe(nowUs));
+    return std::min(wakeUs, stepEdgeProbe(nowUs, pumpOn, tank));
+}
+
+bool soakReport(uint32_t startUnix, double days) {
+    uint32_t wraps = (uint32_t)(endUs / SOAK_MILLIS_WRAP_US - beginUs / SOAK_MILLIS_WRAP_US);
+    uint32_t maxSteps = stepsPerDay.empty() ? 0 : *std::max_element(stepsPerDay.begin(), stepsPerDay.end());
+    if (maxSteps > SOAK_MAX_STEPS_PER_DAY) {
+        fail(endUs, "%lu control steps in one day", (unsigned long)maxSteps);
+    }
+
+    // Every whole day logs cycles
+    uint32_t wholeDays = (uint32_t)days;
+    std::vector<uint32_t> perDay(wholeDays, 0);
+    for (const SimVpsCycle& r : simVpsCycles()) {
+        uint32_t day = (r.unixTime - startUnix) / 86400;
+        if (day < wholeDays) perDay[day]++;
+    }
+    for (uint32_t day = 0; day < wholeDays; day++) {
+        if (perDay[day] == 0) fail(beginUs + day * SOAK_DAY_US, "no cycle logged on day %lu", (unsigned long)day);
+    }
+
+    printf("Soak:    uptime %.1f -> %.1f days, %lu millis() wraps, %lu pump runs, %lu control / %lu security / %lu edge probes, max %lu steps/day, %lu errors\n",
+           beginUs / (double)SOAK_DAY_US, endUs / (double)SOAK_DAY_US, (unsigned long)wraps,
+           (unsigned long)pumpRuns, (unsigned long)controlProbes, (unsigned long)securityProbes,
+           (unsigned long)edgeProbes, (unsigned long)maxSteps, (unsigned long)errors);
+    if (failures == 0) {
+        printf("Soak:    PASS\n");
+        return true;
+    }
+    printf("Soak:    FAIL - %lu check(s)\n", (unsigned long)failures);
+    return false;
+}
@@ -0,0 +1,40 @@
+#ifndef SIM_SOAK_H
+#define SIM_SOAK_H
+
+#include <stdint.h>
+
+class TankModel;
+
+// ===============================
+// LONG-UPTIME SOAK (native env)
+// ===============================
+// `program --soak --days 180` runs the normal simulation from an uptime of
+// --uptime-start days (default 49, so millis() wraps 0.7 days in and every
+// 49.7 days after) and checks every timer that outlives a wrap:
+//
+//   - uptime seconds (state timers) follow the 64-bit clock, no jump back
+//   - every pump run stops after exactly its duration
+//   - pump / system disable auto-enables after 30 min, probed 20 min before
+//     each wrap and weekly
+//   - a session survives 29 min of idle and expires after SESSION_TIMEOUT_MS,
+//     an IP blocked by the rate limiter stays blocked for BLOCK_DURATION_MS -
+//     probed 45 s before each wrap and weekly
+//   - sensor 1 set to trigger just before each wrap and sensor 2 just after
+//     it - the logged time_gap_1 is the real gap between the two edges
+//   - the control loop never busy-waits, a cycle is logged every day and no
+//     ERROR is entered (unless --pump-fail is given)
+
+#define SOAK_DEFAULT_UPTIME_DAYS    49.0
+
+void soakBegin(uint64_t endUs, bool expectErrors);
+
+// After every control step; returns the next time a probe needs a wake-up.
+// The edge probe sets the tank level.
+uint64_t soakStep(uint64_t nowUs, bool pumpOn, TankModel& tank);
+
+void soakErrorEntered();
+
+// Prints the soak summary; true when every check passed
+bool soakReport(uint32_t startUnix, double days);
+
+#endif
@@ -0,0 +1,41 @@
+#include "../src/network/vps_logger.h"
+#include "sim_vps.h"
+
+// VPS uplink stand-in (replaces vps_logger.cpp): keeps every record in memory
+
+static std::vector<SimVpsCycle> cycles;
+static std::vector<SimVpsEvent> events;
+
+const std::vector<SimVpsCycle>& simVpsCycles() { return cycles; }
+const std::vector<SimVpsEvent>& simVpsEvents() { return events; }
+
+void initVPSLogger() {}
+
+void updateVPSLogger() {}
+
+bool logEventToVPS(const String& eventType, uint16_t volumeML, uint32_t unixTime, uint8_t channel) {
+    SimVpsEvent event;
+    event.type = eventType.c_str();
+    event.volumeML = volumeML;
+    event.unixTime = unixTime;
+    event.channel = channel;
+    events.push_back(event);
+    return true;
+}
+
+bool logCycleToVPS(const PumpCycle& cycle, uint32_t unixTime, uint8_t channel) {
+    SimVpsCycle record;
+    record.cycle = cycle;
+    record.unixTime = unixTime;
+    record.channel = channel;
+    cycles.push_back(record);
+    return true;
+}
+
+VPSUplinkMetrics getVPSUplinkMetrics() {
+    VPSUplinkMetrics metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.queueCapacity = 1;
+    metrics.sentCount = cycles.size() + events.size();
+    return metrics;
+}
@@ -0,0 +1,25 @@
+#ifndef SIM_VPS_H
+#define SIM_VPS_H
+
+#include "../src/algorithm/algorithm_config.h"
+#include <vector>
+#include <string>
+
+// What the firmware would have sent to the VPS
+struct SimVpsCycle {
+    PumpCycle cycle;
+    uint32_t unixTime;
+    uint8_t channel;
+};
+
+struct SimVpsEvent {
+    std::string type;
+    uint16_t volumeML;
+    uint32_t unixTime;
+    uint8_t channel;
+};
+
+const std::vector<SimVpsCycle>& simVpsCycles();
+const std::vector<SimVpsEvent>& simVpsEvents();
+
+#endif
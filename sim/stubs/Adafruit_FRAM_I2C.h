@@ -0,0 +1,17 @@
+#ifndef SIM_ADAFRUIT_FRAM_I2C_H
+#define SIM_ADAFRUIT_FRAM_I2C_H
+
+#include <Arduino.h>
+#include "sim_hal.h"
+
+// MB85RC256V stand-in backed by the simulator's FRAM image
+class Adafruit_FRAM_I2C {
+public:
+    bool begin(uint8_t addr = 0x50) { return true; }
+    bool write(uint16_t addr, uint8_t value) { return simFramWrite(addr, &value, 1); }
+    bool write(uint16_t addr, const uint8_t* data, size_t len) { return simFramWrite(addr, data, len); }
+    uint8_t read(uint16_t addr) { uint8_t v = 0; simFramRead(addr, &v, 1); return v; }
+    bool read(uint16_t addr, uint8_t* data, size_t len) { return simFramRead(addr, data, len); }
+};
+
+#endif
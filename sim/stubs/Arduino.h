@@ -0,0 +1,124 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// ===============================
+// ARDUINO CORE STAND-IN (native simulator)
+// ===============================
+// Just enough of the ESP32 Arduino API for the algorithm, pump, sensor and
+// FRAM modules. Time and pins come from the simulator (sim_hal.h).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define CHANGE          0x03
+#define IRAM_ATTR
+#define PROGMEM
+#define F(x)            (x)
+#define HEX             16
+#define DEC             10
+#define A0              0
+
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline int analogRead(uint8_t pin) { return 0; }
+inline void randomSeed(unsigned long seed) { srand((unsigned)seed); }
+inline long random(long lo, long hi) { return hi > lo ? lo + rand() % (hi - lo) : lo; }
+inline long random(long hi) { return random(0, hi); }
+
+class String {
+public:
+    String() {}
+    String(const char* c) : s(c ? c : "") {}
+    String(const std::string& x) : s(x) {}
+    String(char c) : s(1, c) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned int v) : s(std::to_string(v)) {}
+    String(unsigned char v, unsigned char base) { char buf[12]; snprintf(buf, sizeof(buf), base == HEX ? "%x" : "%u", v); s = buf; }
+    String(long v) : s(std::to_string(v)) {}
+    String(long v, unsigned char base) { char buf[24]; snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%ld", v); s = buf; }
+    String(unsigned long v) : s(std::to_string(v)) {}
+    String(float v, unsigned decimals = 2) { format(v, decimals); }
+    String(double v, unsigned decimals = 2) { format(v, decimals); }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return (unsigned int)s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned int n) { s.reserve(n); return true; }
+
+    String& operator+=(const String& o) { s += o.s; return *this; }
+    String& operator+=(const char* o) { s += o; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator==(const char* o) const { return s == o; }
+    bool operator!=(const String& o) const { return s != o.s; }
+    bool operator!=(const char* o) const { return s != o; }
+    bool operator<(const String& o) const { return s < o.s; }
+    char operator[](unsigned int i) const { return s[i]; }
+    char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+
+    bool startsWith(const String& p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+    bool endsWith(const String& p) const {
+        return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0;
+    }
+    int indexOf(const String& p, unsigned int from = 0) const {
+        size_t r = s.find(p.s, from);
+        return r == std::string::npos ? -1 : (int)r;
+    }
+    String substring(unsigned int a, unsigned int b = 0xFFFFFFFF) const {
+        a = std::min<size_t>(a, s.size());
+        b = std::min<size_t>(b, s.size());
+        return String(s.substr(a, b > a ? b - a : 0));
+    }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return (float)atof(s.c_str()); }
+
+    std::string s;
+
+private:
+    void format(double v, unsigned decimals) {
+        char buf[40];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        s = buf;
+    }
+};
+
+inline String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+inline String operator+(const String& a, const char* b) { return String(a.s + b); }
+inline String operator+(const char* a, const String& b) { return String(std::string(a) + b.s); }
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const String& s) { return printf("%s", s.c_str()); }
+    size_t print(const char* s) { return printf("%s", s); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t println() { return printf("\n"); }
+    size_t println(const String& s) { return printf("%s\n", s.c_str()); }
+    size_t println(const char* s) { return printf("%s\n", s); }
+    size_t println(long v) { return printf("%ld\n", v); }
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef SIM_IPADDRESS_H
+#define SIM_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress {
+public:
+    IPAddress() : addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : addr((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    bool operator==(const IPAddress& o) const { return addr == o.addr; }
+    operator uint32_t() const { return addr; }
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", addr & 0xFF, (addr >> 8) & 0xFF,
+                 (addr >> 16) & 0xFF, addr >> 24);
+        return String(buf);
+    }
+private:
+    uint32_t addr;
+};
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+// Only IPAddress - session_manager / rate_limiter use nothing else
+#include <IPAddress.h>
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include <Arduino.h>
+
+// Nothing talks I2C in the simulator - FRAM and RTC are modelled above the bus
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    bool setClock(uint32_t) { return true; }
+};
+
+extern TwoWire Wire;
+
+#endif
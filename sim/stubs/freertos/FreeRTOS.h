@@ -0,0 +1,30 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+// ===============================
+// FREERTOS STAND-IN (native simulator)
+// ===============================
+// The simulator is single threaded: it calls runControlStep() itself, so no
+// task is ever created. Mutexes are no-ops, queues report failure - which is
+// exactly the "no algorithm task" path of the firmware.
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void* TaskHandle_t;
+typedef void* QueueHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define pdFAIL                  0
+#define portMAX_DELAY           0xFFFFFFFFUL
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+#endif
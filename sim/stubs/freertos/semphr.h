@@ -0,0 +1,15 @@
+#ifndef SIM_SEMPHR_H
+#define SIM_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+static int simSemaphoreToken;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return &simSemaphoreToken; }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return &simSemaphoreToken; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t) { return pdTRUE; }
+
+#endif
@@ -0,0 +1,59 @@
+#include "tank_model.h"
+#include <math.h>
+
+#define SECONDS_PER_DAY     86400.0
+#define EVAP_PEAK_SECOND    (14 * 3600.0)
+
+TankModel::TankModel(const TankParams& params)
+    : params(params), levelMl(params.initialLevelMl), elapsedSeconds(0), currentRunFailed(false),
+      totalPumpedMl(0), totalEvaporatedMl(0),
+      minLevelMl(params.initialLevelMl), maxLevelMl(params.initialLevelMl),
+      failedPumpRuns(0) {}
+
+double TankModel::evapRate(uint32_t unixTime) const {
+    double secondOfDay = fmod((double)unixTime, SECONDS_PER_DAY);
+    double phase = 2.0 * M_PI * (secondOfDay - EVAP_PEAK_SECOND) / SECONDS_PER_DAY;
+    double perHour = params.evapMlPerHour * (1.0 + params.evapDailySwing * cos(phase));
+    return (perHour + params.leakMlPerHour) / 3600.0;
+}
+
+double TankModel::pumpFlow() const {
+    double flow = params.pumpFlowMlPerSec * (1.0 + params.pumpFlowDriftPerDay * elapsedSeconds / SECONDS_PER_DAY);
+    return flow > 0 ? flow : 0.0;
+}
+
+double TankModel::netRate(uint32_t unixTime, bool pumpOn) const {
+    double inflow = (pumpOn && !currentRunFailed) ? pumpFlow() : 0.0;
+    return inflow - evapRate(unixTime);
+}
+
+void TankModel::onPumpStart(double randomUnit) {
+    currentRunFailed = randomUnit < params.pumpFailRate;
+    if (currentRunFailed) failedPumpRuns++;
+}
+
+void TankModel::setLevel(double ml) {
+    levelMl = ml;
+    if (levelMl < minLevelMl) minLevelMl = levelMl;
+    if (levelMl > maxLevelMl) maxLevelMl = levelMl;
+}
+
+void TankModel::advance(double seconds, uint32_t unixTime, bool pumpOn) {
+    if (seconds <= 0) return;
+    double evap = evapRate(unixTime) * seconds;
+    double inflow = (pumpOn && !currentRunFailed) ? pumpFlow() * seconds : 0.0;
+
+    levelMl += inflow - evap;
+    totalPumpedMl += inflow;
+    totalEvaporatedMl += evap;
+    elapsedSeconds += seconds;
+    if (levelMl < minLevelMl) minLevelMl = levelMl;
+    if (levelMl > maxLevelMl) maxLevelMl = levelMl;
+}
+
+double TankModel::secondsToCross(double heightMl, uint32_t unixTime, bool pumpOn) const {
+    double rate = netRate(unixTime, pumpOn);
+    if (levelMl >= heightMl && rate < 0) return (levelMl - heightMl) / -rate;
+    if (levelMl < heightMl && rate > 0) return (heightMl - levelMl) / rate;
+    return -1.0;
+}
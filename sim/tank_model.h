@@ -0,0 +1,70 @@
+#ifndef TANK_MODEL_H
+#define TANK_MODEL_H
+
+#include <stdint.h>
+
+// ===============================
+// TANK / EVAPORATION MODEL
+// ===============================
+// Water level in ml relative to float sensor 1. Sensor 2 sits
+// sensorGapMl below it. A sensor is triggered (pin LOW) while the level is
+// below it. Evaporation follows a daily sine (peak at 14:00 UTC); the pump
+// adds pumpFlowMlPerSec while the relay is on, unless that run failed.
+// pumpFlowDriftPerDay ages the pump: flow changes linearly by that
+// fraction of pumpFlowMlPerSec per simulated day.
+
+struct TankParams {
+    double initialLevelMl = 150.0;
+    double sensorGapMl = 2.0;           // sensor 2 below sensor 1
+    double evapMlPerHour = 30.0;        // daily mean
+    double evapDailySwing = 0.5;        // +-50% over the day
+    double pumpFlowMlPerSec = 1.0;      // real flow (firmware assumes volumePerSecond)
+    double pumpFlowDriftPerDay = 0.0;   // e.g. -0.01 = flow drops 1% of the start value per day
+    double pumpFailRate = 0.0;          // probability a pump run delivers nothing
+    double leakMlPerHour = 0.0;         // constant extra loss
+};
+
+class TankModel {
+public:
+    explicit TankModel(const TankParams& params);
+
+    // Rates are evaluated at `unixTime` and held for the step
+    void advance(double seconds, uint32_t unixTime, bool pumpOn);
+
+    // Seconds until the level crosses `heightMl` at the current rate (<0: never)
+    double secondsToCross(double heightMl, uint32_t unixTime, bool pumpOn) const;
+
+    void onPumpStart(double randomUnit);
+
+    // Soak edge probe - puts the level where a sensor edge is wanted
+    void setLevel(double ml);
+
+    double level() const { return levelMl; }
+    double sensor1Height() const { return 0.0; }
+    double sensor2Height() const { return -params.sensorGapMl; }
+    bool sensor1Triggered() const { return levelMl < sensor1Height(); }
+    bool sensor2Triggered() const { return levelMl < sensor2Height(); }
+
+    double pumpFlow() const;                                // ml/s at the current time
+    double pumpedMl() const { return totalPumpedMl; }
+    double evaporatedMl() const { return totalEvaporatedMl; }
+    double minLevel() const { return minLevelMl; }
+    double maxLevel() const { return maxLevelMl; }
+    uint32_t failedRuns() const { return failedPumpRuns; }
+
+private:
+    double netRate(uint32_t unixTime, bool pumpOn) const;   // ml/s
+    double evapRate(uint32_t unixTime) const;               // ml/s
+
+    TankParams params;
+    double levelMl;
+    double elapsedSeconds;
+    bool currentRunFailed;
+    double totalPumpedMl;
+    double totalEvaporatedMl;
+    double minLevelMl;
+    double maxLevelMl;
+    uint32_t failedPumpRuns;
+};
+
+#endif
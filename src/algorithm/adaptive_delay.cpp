@@ -0,0 +1,140 @@
+#include "adaptive_delay.h"
+#include "algorithm_config.h"
+#include "../config/config.h"
+#include "../core/logging.h"
+#include "../core/trace_recorder.h"
+#include "../hardware/fram_controller.h"
+
+// TRACE_ADAPTIVE arg
+#define ADAPTIVE_TRACE_GAP1_REF     0
+#define ADAPTIVE_TRACE_INTERVAL_REF 1
+#define ADAPTIVE_TRACE_LAST_TRIGGER 2
+#define ADAPTIVE_TRACE_SAMPLES      3   // data = samples | enabled << 31
+
+static bool enabled = ADAPTIVE_TIME_TO_PUMP;
+static uint16_t samples = 0;
+static float gap1Ref = 0;
+static float intervalRef = 0;
+static uint32_t lastTriggerUnix = 0;
+static uint16_t lastDelay = 0;
+static uint16_t minDelay = 0;
+static uint16_t maxDelay = 0;
+
+// Cumulative mean for the first ADAPTIVE_LEARN_WEIGHT values, then exponential
+static void learn(float& ref, float value, uint16_t count) {
+    uint16_t weight = count < ADAPTIVE_LEARN_WEIGHT ? count : ADAPTIVE_LEARN_WEIGHT;
+    ref += (value - ref) / weight;
+}
+
+// TIME_GAP_1 really measured on both sensors (no timeout, no GAP1 fail)
+static bool gap1Usable(const PumpCycle& cycle, const AlgorithmParams& params) {
+    return cycle.time_gap_1 > 0 && cycle.time_gap_1 < params.timeGap1Max &&
+           !(cycle.sensor_results & PumpCycle::RESULT_GAP1_FAIL);
+}
+
+static void learnCycle(const PumpCycle& cycle, const AlgorithmParams& params) {
+    if (gap1Usable(cycle, params)) {
+        if (samples < 0xFFFF) samples++;
+        learn(gap1Ref, (float)cycle.time_gap_1, samples);
+    }
+
+    // Trigger-to-trigger interval - needs two unix timestamps in a row
+    if (cycle.timestamp >= FRAM_CYCLE_MIN_UNIX_TIME) {
+        if (lastTriggerUnix != 0 && cycle.timestamp > lastTriggerUnix &&
+            cycle.timestamp - lastTriggerUnix <= ADAPTIVE_MAX_INTERVAL) {
+            float interval = (float)(cycle.timestamp - lastTriggerUnix);
+            if (intervalRef == 0) {
+                intervalRef = interval;
+            } else {
+                intervalRef += (interval - intervalRef) / ADAPTIVE_LEARN_WEIGHT;
+            }
+        }
+        lastTriggerUnix = cycle.timestamp;
+    }
+}
+
+void initAdaptiveDelay(const AlgorithmParams& params) {
+    samples = 0;
+    gap1Ref = 0;
+    intervalRef = 0;
+    lastTriggerUnix = 0;
+
+    // Same learning as live cycles, over the newest part of the FRAM history
+    FRAMCycleCursor cursor;
+    uint16_t first = cursor.size() > ADAPTIVE_HISTORY_CYCLES ? cursor.size() - ADAPTIVE_HISTORY_CYCLES : 0;
+    for (uint16_t i = first; i < cursor.size(); i++) {
+        PumpCycle cycle;
+        if (cursor.read(i, cycle)) {
+            learnCycle(cycle, params);
+        }
+    }
+
+    LOG_INFO("Adaptive TIME_TO_PUMP %s: %d gap1 samples, gap1 ~%.0fs, trigger interval ~%.0fs",
+             enabled ? "enabled" : "disabled", samples, gap1Ref, intervalRef);
+}
+
+uint16_t adaptiveTimeToPump(const AlgorithmParams& params, const PumpCycle& cycle) {
+    uint16_t delay = params.timeToPump;
+
+    if (enabled && samples >= ADAPTIVE_MIN_SAMPLES && gap1Ref > 0 && gap1Usable(cycle, params)) {
+        uint32_t scaled = (uint32_t)(params.timeToPump * cycle.time_gap_1 / gap1Ref + 0.5f);
+        uint32_t lower = (uint32_t)params.timeToPump * ADAPTIVE_MIN_PERCENT / 100;
+        uint32_t upper = (uint32_t)params.timeToPump * ADAPTIVE_MAX_PERCENT / 100;
+        if (lower < cycle.time_gap_1 + ADAPTIVE_GAP1_MARGIN) lower = cycle.time_gap_1 + ADAPTIVE_GAP1_MARGIN;
+        if (upper > 0xFFFF) upper = 0xFFFF;
+        if (upper < lower) upper = lower;
+
+        if (scaled < lower) scaled = lower;
+        if (scaled > upper) scaled = upper;
+        delay = (uint16_t)scaled;
+    }
+
+    lastDelay = delay;
+    if (minDelay == 0 || delay < minDelay) minDelay = delay;
+    if (delay > maxDelay) maxDelay = delay;
+    return delay;
+}
+
+void adaptiveDelayAddCycle(const PumpCycle& cycle, const AlgorithmParams& params) {
+    learnCycle(cycle, params);
+}
+
+AdaptiveDelayStats getAdaptiveDelayStats() {
+    AdaptiveDelayStats stats;
+    stats.enabled = enabled;
+    stats.samples = samples;
+    stats.gap1Ref = gap1Ref;
+    stats.intervalRef = intervalRef;
+    stats.lastDelay = lastDelay;
+    stats.minDelay = minDelay;
+    stats.maxDelay = maxDelay;
+    return stats;
+}
+
+void setAdaptiveDelayEnabled(bool value) {
+    enabled = value;
+}
+
+void traceAdaptiveDelayState(uint32_t ms) {
+    uint32_t gap1Bits, intervalBits;
+    memcpy(&gap1Bits, &gap1Ref, sizeof(gap1Bits));
+    memcpy(&intervalBits, &intervalRef, sizeof(intervalBits));
+
+    traceRecordAt(ms, TRACE_ADAPTIVE, ADAPTIVE_TRACE_GAP1_REF, gap1Bits);
+    traceRecordAt(ms, TRACE_ADAPTIVE, ADAPTIVE_TRACE_INTERVAL_REF, intervalBits);
+    traceRecordAt(ms, TRACE_ADAPTIVE, ADAPTIVE_TRACE_LAST_TRIGGER, lastTriggerUnix);
+    traceRecordAt(ms, TRACE_ADAPTIVE, ADAPTIVE_TRACE_SAMPLES, samples | (enabled ? 0x80000000UL : 0));
+}
+
+void restoreAdaptiveDelayState(const TraceRecord& record) {
+    switch (record.arg) {
+        case ADAPTIVE_TRACE_GAP1_REF:     memcpy(&gap1Ref, &record.data, sizeof(gap1Ref)); break;
+        case ADAPTIVE_TRACE_INTERVAL_REF: memcpy(&intervalRef, &record.data, sizeof(intervalRef)); break;
+        case ADAPTIVE_TRACE_LAST_TRIGGER: lastTriggerUnix = record.data; break;
+        case ADAPTIVE_TRACE_SAMPLES:
+            samples = (uint16_t)record.data;
+            enabled = (record.data & 0x80000000UL) != 0;
+            break;
+        default: break;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef ADAPTIVE_DELAY_H
+#define ADAPTIVE_DELAY_H
+
+#include <Arduino.h>
+#include "algorithm_params.h"
+
+struct PumpCycle;
+struct TraceRecord;
+
+// ===============================
+// ADAPTIVE TIME_TO_PUMP
+// ===============================
+// The level keeps falling during the TRIGGER -> pump delay, so a fixed
+// TIME_TO_PUMP starts the pump deeper on a hot afternoon than at night.
+// TIME_GAP_1 is the time the level needs to fall through the (fixed)
+// sensor gap, i.e. inversely proportional to the current evaporation rate.
+// Scaling the delay by gap1 / typical gap1 starts the pump at about the
+// same depth below sensor 1 every cycle:
+//
+//     delay = timeToPump * time_gap_1 / gap1Ref
+//
+// gap1Ref and the typical trigger-to-trigger interval are learned as
+// running means (weight 1 / ADAPTIVE_LEARN_WEIGHT) - seeded at boot from
+// the FRAM cycle history, then updated with every logged cycle. Until
+// ADAPTIVE_MIN_SAMPLES cycles are known, after a GAP_1 timeout or with a
+// failed gap, the cycle uses timeToPump unchanged.
+
+#define ADAPTIVE_MIN_SAMPLES        8       // Learned gap1 values before the delay adapts
+#define ADAPTIVE_LEARN_WEIGHT       16      // Running mean ~ last 16 cycles (~4 days)
+#define ADAPTIVE_HISTORY_CYCLES     32      // FRAM cycles used to seed at boot
+#define ADAPTIVE_MIN_PERCENT        50      // Delay never below 50% of timeToPump...
+#define ADAPTIVE_MAX_PERCENT        150     // ...nor above 150%
+#define ADAPTIVE_GAP1_MARGIN        60      // s - and at least this long after sensor 2 triggered
+#define ADAPTIVE_MAX_INTERVAL       172800  // s - longer trigger-to-trigger gaps (downtime) are not learned
+
+struct AdaptiveDelayStats {
+    bool enabled;
+    uint16_t samples;               // gap1 values learned (saturating)
+    float gap1Ref;                  // s - typical TIME_GAP_1
+    float intervalRef;              // s - typical trigger-to-trigger interval (0: unknown)
+    uint16_t lastDelay;             // s - TIME_TO_PUMP used by the last cycle
+    uint16_t minDelay;              // s - since boot (0: none yet)
+    uint16_t maxDelay;
+};
+
+void initAdaptiveDelay(const AlgorithmParams& params);   // seeds from the FRAM cycle history
+
+// TIME_TO_PUMP for the running cycle, once TIME_GAP_1 is known
+uint16_t adaptiveTimeToPump(const AlgorithmParams& params, const PumpCycle& cycle);
+
+// Logged cycle (WaterAlgorithm::logCycleComplete) - updates the running means
+void adaptiveDelayAddCycle(const PumpCycle& cycle, const AlgorithmParams& params);
+
+AdaptiveDelayStats getAdaptiveDelayStats();
+
+// Default from ADAPTIVE_TIME_TO_PUMP (config.h); the simulator toggles it
+void setAdaptiveDelayEnabled(bool enabled);
+
+// Trace sync point: learned state as TRACE_ADAPTIVE records, and back (replay)
+void traceAdaptiveDelayState(uint32_t ms);
+void restoreAdaptiveDelayState(const TraceRecord& record);
+
+#endif
@@ -2,7 +2,9 @@
 #define ALGORITHM_CONFIG_H
 #include <Arduino.h>
 
+#ifndef TIME_TO_PUMP                    // nadpisywalne z build_flags (symulator: env:native)
 #define TIME_TO_PUMP            2400    // czas od TRIGGER do startu pompy
+#endif
 #define TIME_GAP_1_MAX          2300    // max oczekiwanie na drugi czujnik (TRYB_1)
 #define TIME_GAP_2_MAX          30    //  max oczekiwanie na drugi czujnik (TRYB_2)
 #define THRESHOLD_1             1000    // próg dla TIME_GAP_1
@@ -10,7 +12,7 @@
 #define WATER_TRIGGER_MAX_TIME  240    // max czas na reakcję czujników po starcie pompy
 #define THRESHOLD_WATER         120     // próg dla WATER_TRIGGER_TIME
 #define LOGGING_TIME            5      // czas na logowanie po cyklu
-#define SENSOR_DEBOUNCE_TIME    1      // debouncing czujników
+#define SENSOR_DEBOUNCE_MS      50     // debouncing czujników (ms, zbocza z przerwań GPIO)
 
 // #define TIME_TO_PUMP            10    // czas od TRIGGER do startu pompy
 // #define TIME_GAP_1_MAX          8    // max oczekiwanie na drugi czujnik (TRYB_1)
@@ -31,16 +33,22 @@
 #define ERROR_PULSE_HIGH        100    // ms - czas impulsu HIGH
 #define ERROR_PULSE_LOW         100    // ms - czas przerwy między impulsami
 #define ERROR_PAUSE             2000   // ms - pauza przed powtórzeniem sekwencji
+#define ERROR_SIGNAL_POLL_MS    20     // ms - krok zadania w stanie ERROR (LED + przycisk reset)
+
+// ============== SPRAWDZANIE DATY UTC ==============
+#define DATE_CHECK_RETRY_MS         1000   // ms - gdy RTC nie działa
 
 // ============== SPRAWDZENIA INTEGRALNOŚCI ==============
+// Wartości domyślne - te same reguły sprawdza validateAlgorithmParams() (algorithm_params.cpp)
 static_assert(TIME_TO_PUMP > (TIME_GAP_1_MAX * 1.04));
 static_assert(TIME_TO_PUMP > 1000);
 static_assert(TIME_GAP_1_MAX > (THRESHOLD_1 * 1.2));
 static_assert(WATER_TRIGGER_MAX_TIME > (THRESHOLD_WATER * 1.2));
-static_assert(SINGLE_DOSE_VOLUME > 100 || SINGLE_DOSE_VOLUME < 300);
-static_assert(FILL_WATER_MAX > 1000 || FILL_WATER_MAX < 3000);
+static_assert(SINGLE_DOSE_VOLUME > 100 && SINGLE_DOSE_VOLUME < 300);
+static_assert(FILL_WATER_MAX > 1000 && FILL_WATER_MAX < 3000);
 static_assert(LOGGING_TIME == 5);
-static_assert(SENSOR_DEBOUNCE_TIME == 1);
+static_assert(SENSOR_DEBOUNCE_MS > 0 && SENSOR_DEBOUNCE_MS < 1000);
+static_assert(ERROR_SIGNAL_POLL_MS < ERROR_PULSE_HIGH);
 
 
 
@@ -57,6 +65,9 @@ enum AlgorithmState {
     STATE_MANUAL_OVERRIDE     // Manual pump przerwał cykl
 };
 
+#define ALGORITHM_STATE_COUNT   9
+static_assert(STATE_MANUAL_OVERRIDE + 1 == ALGORITHM_STATE_COUNT, "ALGORITHM_STATE_COUNT out of date");
+
 // ============== KODY BŁĘDÓW ==============
 enum ErrorCode {
     ERROR_NONE = 0,
@@ -90,14 +101,14 @@ inline uint8_t sensor_time_match_function(uint16_t time_ms, uint16_t threshold_m
 }
 
 // ============== OBLICZANIE CZASU POMPY ==============
-inline uint16_t calculatePumpWorkTime(float volumePerSecond) {
+inline uint16_t calculatePumpWorkTime(uint16_t singleDoseVolume, float volumePerSecond) {
     // PUMP_WORK_TIME = SINGLE_DOSE_VOLUME / volumePerSecond
-    return (uint16_t)(SINGLE_DOSE_VOLUME / volumePerSecond);
+    return (uint16_t)(singleDoseVolume / volumePerSecond);
 }
 
 // Sprawdzenie zgodności z ograniczeniami
-inline bool validatePumpWorkTime(uint16_t pumpWorkTime) {
-    return pumpWorkTime <= WATER_TRIGGER_MAX_TIME;
+inline bool validatePumpWorkTime(uint16_t pumpWorkTime, uint16_t waterTriggerMaxTime) {
+    return pumpWorkTime <= waterTriggerMaxTime;
 }
 
 #endif
\ No newline at end of file
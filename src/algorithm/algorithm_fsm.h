@@ -0,0 +1,134 @@
+#ifndef ALGORITHM_FSM_H
+#define ALGORITHM_FSM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "algorithm_config.h"
+
+// ===============================
+// WATER ALGORITHM STATE MACHINE - TABLE TYPES
+// ===============================
+// Transitions of WaterAlgorithm live in one constexpr table
+// (algorithm_transitions.h). Each row: from -> to, what fires it, an optional
+// timeout, guard and action. The checks below run at compile time on that
+// table - C++11 constexpr (single return, recursion), no heap, no RTTI.
+
+class WaterAlgorithm;
+
+typedef bool (WaterAlgorithm::*TransitionGuard)(uint32_t now) const;
+typedef void (WaterAlgorithm::*TransitionAction)(uint32_t now);
+
+enum TransitionTrigger : uint8_t {
+    TRIGGER_TICK = 0,     // update() - evaluated on every control step
+    TRIGGER_SENSOR,       // onSensorStateChange() - debounced sensor edge
+    TRIGGER_COMMAND       // enterState() from outside the table (web, button,
+                          // manual pump, system disable) - no guard/action
+};
+
+// Clock a state's timeout rows count from
+enum StateTimerBase : uint8_t {
+    TIMER_STATE_ENTRY = 0,   // stateStartTime
+    TIMER_TRIGGER,           // triggerStartTime (TIME_TO_PUMP counts from TRIGGER)
+    TIMER_PUMP_START         // pumpStartTime (WATER_TRIGGER_MAX_TIME counts from pump start)
+};
+
+// Row timeout - a parameter id, resolved by WaterAlgorithm::timeoutSeconds()
+// against the active AlgorithmParams (tunable at run time)
+enum AlgorithmTimeout : uint8_t {
+    TIMEOUT_NONE = 0,
+    TIMEOUT_GAP_1_MAX,          // TIME_GAP_1_MAX
+    TIMEOUT_TO_PUMP,            // TIME_TO_PUMP
+    TIMEOUT_WATER_TRIGGER,      // WATER_TRIGGER_MAX_TIME
+    TIMEOUT_GAP_2_MAX,          // TIME_GAP_2_MAX
+    TIMEOUT_LOGGING             // LOGGING_TIME (fixed)
+};
+
+struct AlgorithmTransition {
+    AlgorithmState from;
+    AlgorithmState to;
+    TransitionTrigger trigger;
+    AlgorithmTimeout timeout;   // != NONE: row fires only once the state timer reached it
+    TransitionGuard guard;      // nullptr = always
+    TransitionAction action;    // nullptr = none
+};
+
+struct AlgorithmStateInfo {
+    AlgorithmState state;
+    const char* name;
+    StateTimerBase timerBase;
+    bool waitsForInput;         // IDLE / ERROR / MANUAL - may wait forever by design
+    TransitionAction onEnter;   // nullptr = none
+    uint8_t firstRow;           // Rows of this state: [firstRow, firstRow + rowCount)
+    uint8_t rowCount;
+};
+
+// ============== COMPILE-TIME CHECKS ==============
+
+#define FSM_STATE_BIT(s)    (1UL << (s))
+#define FSM_ALL_STATES      ((1UL << ALGORITHM_STATE_COUNT) - 1)
+
+constexpr uint8_t fsmFirstRow(const AlgorithmTransition* rows, size_t n, AlgorithmState s, size_t i = 0) {
+    return (i >= n || rows[i].from == s) ? (uint8_t)i : fsmFirstRow(rows, n, s, i + 1);
+}
+
+constexpr uint8_t fsmRowCount(const AlgorithmTransition* rows, size_t n, AlgorithmState s, size_t i = 0) {
+    return (i >= n) ? 0 : (uint8_t)((rows[i].from == s ? 1 : 0) + fsmRowCount(rows, n, s, i + 1));
+}
+
+// Rows grouped by source state - the per-state index relies on it
+constexpr bool fsmRowsSorted(const AlgorithmTransition* rows, size_t n) {
+    return n < 2 || (rows[0].from <= rows[1].from && fsmRowsSorted(rows + 1, n - 1));
+}
+
+constexpr bool fsmRowsInRange(const AlgorithmTransition* rows, size_t n) {
+    return n == 0 || (rows[0].from < ALGORITHM_STATE_COUNT && rows[0].to < ALGORITHM_STATE_COUNT &&
+                      fsmRowsInRange(rows + 1, n - 1));
+}
+
+// Command rows are plain declarations; table rows need a guard or a timeout
+// (an unconditional row would fire on every step) and no self loops.
+constexpr bool fsmRowWellFormed(const AlgorithmTransition& r) {
+    return r.from != r.to &&
+           (r.trigger == TRIGGER_COMMAND
+                ? (r.guard == nullptr && r.action == nullptr && r.timeout == TIMEOUT_NONE)
+                : (r.guard != nullptr || r.timeout != TIMEOUT_NONE)) &&
+           (r.timeout == TIMEOUT_NONE || r.trigger == TRIGGER_TICK);
+}
+
+constexpr bool fsmRowsWellFormed(const AlgorithmTransition* rows, size_t n) {
+    return n == 0 || (fsmRowWellFormed(rows[0]) && fsmRowsWellFormed(rows + 1, n - 1));
+}
+
+// One pass of forward (or reverse) reachability over all rows
+constexpr uint32_t fsmStep(const AlgorithmTransition* rows, size_t n, uint32_t mask, bool reverse) {
+    return n == 0 ? mask
+         : fsmStep(rows + 1, n - 1,
+                   (mask & FSM_STATE_BIT(reverse ? rows[0].to : rows[0].from))
+                       ? (mask | FSM_STATE_BIT(reverse ? rows[0].from : rows[0].to)) : mask,
+                   reverse);
+}
+
+constexpr uint32_t fsmClosure(const AlgorithmTransition* rows, size_t n, uint32_t mask, bool reverse,
+                              uint8_t passes = ALGORITHM_STATE_COUNT) {
+    return passes == 0 ? mask : fsmClosure(rows, n, fsmStep(rows, n, mask, reverse), reverse, passes - 1);
+}
+
+constexpr bool fsmHasTimeoutRow(const AlgorithmTransition* rows, size_t n, AlgorithmState s) {
+    return n > 0 && ((rows[0].from == s && rows[0].trigger == TRIGGER_TICK && rows[0].timeout != TIMEOUT_NONE) ||
+                     fsmHasTimeoutRow(rows + 1, n - 1, s));
+}
+
+// Every state table entry sits at its own index and owns the right row range;
+// every state that is not waiting for outside input has a timeout exit.
+constexpr bool fsmStatesValid(const AlgorithmStateInfo* states, const AlgorithmTransition* rows,
+                              size_t rowCount, uint8_t i = 0) {
+    return i >= ALGORITHM_STATE_COUNT ||
+           (states[i].state == i &&
+            states[i].firstRow == fsmFirstRow(rows, rowCount, (AlgorithmState)i) &&
+            states[i].rowCount == fsmRowCount(rows, rowCount, (AlgorithmState)i) &&
+            states[i].rowCount > 0 &&
+            (states[i].waitsForInput || fsmHasTimeoutRow(rows, rowCount, (AlgorithmState)i)) &&
+            fsmStatesValid(states, rows, rowCount, i + 1));
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "algorithm_params.h"
+#include "../core/logging.h"
+#include "../crypto/crc.h"
+#include "../hardware/fram_controller.h"
+#include "../hardware/fram_journal.h"
+
+const AlgorithmParamField ALGORITHM_PARAM_FIELDS[ALGORITHM_PARAM_COUNT] = {
+    { "time_to_pump",           "s",  &AlgorithmParams::timeToPump },
+    { "time_gap_1_max",         "s",  &AlgorithmParams::timeGap1Max },
+    { "time_gap_2_max",         "s",  &AlgorithmParams::timeGap2Max },
+    { "threshold_1",            "s",  &AlgorithmParams::threshold1 },
+    { "threshold_2",            "s",  &AlgorithmParams::threshold2 },
+    { "water_trigger_max_time", "s",  &AlgorithmParams::waterTriggerMaxTime },
+    { "threshold_water",        "s",  &AlgorithmParams::thresholdWater },
+    { "single_dose_volume",     "ml", &AlgorithmParams::singleDoseVolume },
+    { "fill_water_max",         "ml", &AlgorithmParams::fillWaterMax },
+};
+
+AlgorithmParams getDefaultAlgorithmParams() {
+    AlgorithmParams params;
+    params.timeToPump = TIME_TO_PUMP;
+    params.timeGap1Max = TIME_GAP_1_MAX;
+    params.timeGap2Max = TIME_GAP_2_MAX;
+    params.threshold1 = THRESHOLD_1;
+    params.threshold2 = THRESHOLD_2;
+    params.waterTriggerMaxTime = WATER_TRIGGER_MAX_TIME;
+    params.thresholdWater = THRESHOLD_WATER;
+    params.singleDoseVolume = SINGLE_DOSE_VOLUME;
+    params.fillWaterMax = FILL_WATER_MAX;
+    return params;
+}
+
+int findAlgorithmParam(const char* key) {
+    for (int i = 0; i < ALGORITHM_PARAM_COUNT; i++) {
+        if (strcmp(ALGORITHM_PARAM_FIELDS[i].key, key) == 0) return i;
+    }
+    return -1;
+}
+
+static bool fail(const char** error, const char* message) {
+    if (error != nullptr) *error = message;
+    return false;
+}
+
+bool validateAlgorithmParams(const AlgorithmParams& p, const char** error) {
+    // Same rules as the static_asserts in algorithm_config.h - ratios in
+    // integer math (x > y * 1.04  <=>  x * 100 > y * 104)
+    if (!(p.timeToPump * 100UL > p.timeGap1Max * 104UL)) {
+        return fail(error, "time_to_pump must be > time_gap_1_max * 1.04");
+    }
+    if (!(p.timeToPump > 1000)) {
+        return fail(error, "time_to_pump must be > 1000 s");
+    }
+    if (!(p.timeGap1Max * 10UL > p.threshold1 * 12UL)) {
+        return fail(error, "time_gap_1_max must be > threshold_1 * 1.2");
+    }
+    if (!(p.waterTriggerMaxTime * 10UL > p.thresholdWater * 12UL)) {
+        return fail(error, "water_trigger_max_time must be > threshold_water * 1.2");
+    }
+    if (!(p.singleDoseVolume > 100 && p.singleDoseVolume < 300)) {
+        return fail(error, "single_dose_volume must be 101-299 ml");
+    }
+    if (!(p.fillWaterMax > 1000 && p.fillWaterMax < 3000)) {
+        return fail(error, "fill_water_max must be 1001-2999 ml");
+    }
+
+    // Zero would turn a timeout row into "fire immediately"
+    if (p.timeGap2Max == 0 || p.threshold1 == 0 || p.threshold2 == 0 || p.thresholdWater == 0) {
+        return fail(error, "timeouts and thresholds must be > 0");
+    }
+    return true;
+}
+
+static uint16_t blockCRC(const AlgorithmParamsBlock& block) {
+    return crc16((const uint8_t*)&block, offsetof(AlgorithmParamsBlock, crc));
+}
+
+bool loadAlgorithmParamsFromFRAM(AlgorithmParams& params) {
+    AlgorithmParamsBlock block;
+    if (!readFRAMBlock(FRAM_ADDR_ALGORITHM_PARAMS, (uint8_t*)&block, sizeof(block))) {
+        return false;
+    }
+
+    if (block.magic != ALGORITHM_PARAMS_MAGIC) {
+        return false;   // never written - defaults
+    }
+    if (block.crc != blockCRC(block)) {
+        LOG_ERROR("Algorithm params: CRC error in FRAM");
+        return false;
+    }
+    if (block.version != ALGORITHM_PARAMS_VERSION) {
+        LOG_WARNING("Algorithm params: unsupported version %d", block.version);
+        return false;
+    }
+
+    const char* error = nullptr;
+    if (!validateAlgorithmParams(block.params, &error)) {
+        LOG_WARNING("Algorithm params in FRAM rejected: %s", error);
+        return false;
+    }
+
+    params = block.params;
+    return true;
+}
+
+bool saveAlgorithmParamsToFRAM(const AlgorithmParams& params) {
+    const char* error = nullptr;
+    if (!validateAlgorithmParams(params, &error)) {
+        LOG_ERROR("Algorithm params not saved: %s", error);
+        return false;
+    }
+
+    AlgorithmParamsBlock block;
+    block.magic = ALGORITHM_PARAMS_MAGIC;
+    block.version = ALGORITHM_PARAMS_VERSION;
+    block.params = params;
+    block.crc = blockCRC(block);
+
+    // Journaled - a reset mid-write keeps the previous block intact
+    FramTransaction tx;
+    if (!tx.write(FRAM_ADDR_ALGORITHM_PARAMS, &block, sizeof(block)) || !tx.commit()) {
+        LOG_ERROR("FRAM algorithm params commit failed");
+        return false;
+    }
+
+    LOG_INFO("Algorithm params saved to FRAM");
+    return true;
+}
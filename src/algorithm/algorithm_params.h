@@ -0,0 +1,67 @@
+#ifndef ALGORITHM_PARAMS_H
+#define ALGORITHM_PARAMS_H
+
+#include <Arduino.h>
+#include "algorithm_config.h"
+
+// ===============================
+// RUNTIME ALGORITHM PARAMETERS
+// ===============================
+// Tank tuning (timeouts, thresholds, dose, daily limit) without a reflash.
+// The macros in algorithm_config.h are the defaults; a validated copy is
+// kept in FRAM (AlgorithmParamsBlock at FRAM_ADDR_ALGORITHM_PARAMS).
+// WaterAlgorithm switches to new values on its next transition to IDLE,
+// so a running cycle always finishes with the values it started with.
+//
+// Set from the dashboard API (/api/algorithm-params) or, in programming
+// mode, from the CLI (`params`).
+
+#define ALGORITHM_PARAMS_MAGIC      0x5041  // "AP"
+#define ALGORITHM_PARAMS_VERSION    1
+
+struct AlgorithmParams {
+    uint16_t timeToPump;            // TIME_TO_PUMP (s)
+    uint16_t timeGap1Max;           // TIME_GAP_1_MAX (s)
+    uint16_t timeGap2Max;           // TIME_GAP_2_MAX (s)
+    uint16_t threshold1;            // THRESHOLD_1 (s)
+    uint16_t threshold2;            // THRESHOLD_2 (s)
+    uint16_t waterTriggerMaxTime;   // WATER_TRIGGER_MAX_TIME (s)
+    uint16_t thresholdWater;        // THRESHOLD_WATER (s)
+    uint16_t singleDoseVolume;      // SINGLE_DOSE_VOLUME (ml)
+    uint16_t fillWaterMax;          // FILL_WATER_MAX (ml)
+};
+
+#define ALGORITHM_PARAM_COUNT   9
+static_assert(sizeof(AlgorithmParams) == ALGORITHM_PARAM_COUNT * sizeof(uint16_t),
+              "AlgorithmParams is a plain array of uint16 fields");
+
+// FRAM image - magic/version first so a future layout can migrate
+struct AlgorithmParamsBlock {
+    uint16_t magic;                 // ALGORITHM_PARAMS_MAGIC
+    uint16_t version;               // ALGORITHM_PARAMS_VERSION
+    AlgorithmParams params;
+    uint16_t crc;                   // CRC16 of the fields above
+};
+
+static_assert(sizeof(AlgorithmParamsBlock) == 24, "AlgorithmParamsBlock must match the FRAM layout");
+
+// Field table - API/CLI key, unit and member, indexed like the FRAM layout
+struct AlgorithmParamField {
+    const char* key;
+    const char* unit;
+    uint16_t AlgorithmParams::*member;
+};
+
+extern const AlgorithmParamField ALGORITHM_PARAM_FIELDS[ALGORITHM_PARAM_COUNT];
+
+AlgorithmParams getDefaultAlgorithmParams();
+int findAlgorithmParam(const char* key);   // -1 if unknown
+
+// Runtime copy of the static_assert rules in algorithm_config.h.
+// On failure `error` (optional) points to a static description.
+bool validateAlgorithmParams(const AlgorithmParams& params, const char** error = nullptr);
+
+bool loadAlgorithmParamsFromFRAM(AlgorithmParams& params);    // false: missing, bad CRC/version or invalid
+bool saveAlgorithmParamsToFRAM(const AlgorithmParams& params); // validates, one journaled write
+
+#endif
@@ -0,0 +1,145 @@
+#include "algorithm_task.h"
+#include "water_algorithm.h"
+#include "../hardware/water_sensors.h"
+#include "../hardware/pump_controller.h"
+#include "../config/config.h"
+#include "../core/metrics.h"
+#include "../core/logging.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+static QueueHandle_t eventQueue = nullptr;
+static SemaphoreHandle_t controlMutex = nullptr;
+static TaskHandle_t algorithmTaskHandle = nullptr;
+
+static void lockControl() {
+    if (controlMutex != nullptr) {
+        xSemaphoreTakeRecursive(controlMutex, portMAX_DELAY);
+    }
+}
+
+static void unlockControl() {
+    if (controlMutex != nullptr) {
+        xSemaphoreGiveRecursive(controlMutex);
+    }
+}
+
+static uint32_t minWait(uint32_t a, uint32_t b) {
+    return (a < b) ? a : b;
+}
+
+uint32_t runControlStep() {
+    int64_t startUs = esp_timer_get_time();
+
+    lockControl();
+
+    // Shared scheduler: one step serves every channel - sensors and pumps
+    // are polled in one pass each, only the algorithms run per channel
+    checkWaterSensors();
+    updatePumpController();
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        waterChannels[ch].update();
+    }
+    checkSystemAutoEnable();
+    checkPumpAutoEnable();
+
+    // Legacy auto pump hook (shouldActivatePump() is owned by the algorithm now)
+    if (currentPumpSettings.autoModeEnabled &&
+        !isSystemDisabled() && shouldActivatePump() && !isPumpActive()) {
+        LOG_INFO("Auto pump triggered - water level low");
+        triggerPump(currentPumpSettings.manualCycleSeconds, "AUTO_PUMP");
+    }
+
+    uint32_t waitMs = ALGORITHM_MAX_SLEEP_MS;
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        waitMs = minWait(waitMs, waterChannels[ch].getNextDeadlineMs());
+    }
+    waitMs = minWait(waitMs, getNextPumpStopMs());
+    waitMs = minWait(waitMs, getSensorDebounceWaitMs());
+    waitMs = minWait(waitMs, getAutoEnableWaitMs());
+
+    unlockControl();
+
+    recordControlStep((uint32_t)(esp_timer_get_time() - startUs));
+    return waitMs;
+}
+
+static void algorithmTask(void* param) {
+    uint32_t waitMs = 0;
+
+    for (;;) {
+        AlgorithmEvent event;
+        if (xQueueReceive(eventQueue, &event, pdMS_TO_TICKS(waitMs)) == pdTRUE) {
+            // One step handles everything queued so far
+            do {
+                recordControlEvent();
+            } while (xQueueReceive(eventQueue, &event, 0) == pdTRUE);
+        }
+
+        waitMs = runControlStep();
+    }
+}
+
+void initAlgorithmTask() {
+    controlMutex = xSemaphoreCreateRecursiveMutex();
+
+    if (!ALGORITHM_EVENT_DRIVEN) {
+        LOG_INFO("Algorithm runs from loop() (event-driven task disabled)");
+        return;
+    }
+
+    eventQueue = xQueueCreate(ALGORITHM_EVENT_QUEUE_LEN, sizeof(AlgorithmEvent));
+
+    if (eventQueue == nullptr || controlMutex == nullptr ||
+        xTaskCreate(algorithmTask, "algorithm", ALGORITHM_TASK_STACK,
+                    nullptr, ALGORITHM_TASK_PRIORITY, &algorithmTaskHandle) != pdPASS) {
+        LOG_ERROR("Failed to start algorithm task - falling back to loop()");
+        algorithmTaskHandle = nullptr;
+        return;
+    }
+
+    LOG_INFO("Algorithm task started (event queue: %d)", ALGORITHM_EVENT_QUEUE_LEN);
+}
+
+bool isAlgorithmTaskRunning() {
+    return algorithmTaskHandle != nullptr;
+}
+
+void postAlgorithmEvent(AlgorithmEventType type, uint8_t arg) {
+    if (algorithmTaskHandle == nullptr) return;
+
+    AlgorithmEvent event;
+    event.type = type;
+    event.arg = arg;
+    event.postedUs = esp_timer_get_time();
+
+    // Full queue = the task already has a wake-up pending
+    xQueueSend(eventQueue, &event, 0);
+}
+
+void IRAM_ATTR postAlgorithmEventFromISR(AlgorithmEventType type, uint8_t arg) {
+    if (algorithmTaskHandle == nullptr) return;
+
+    AlgorithmEvent event;
+    event.type = type;
+    event.arg = arg;
+    event.postedUs = esp_timer_get_time();
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    xQueueSendFromISR(eventQueue, &event, &higherPriorityWoken);
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+AlgorithmCommand::AlgorithmCommand() {
+    lockControl();
+}
+
+AlgorithmCommand::~AlgorithmCommand() {
+    unlockControl();
+    postAlgorithmEvent(ALGO_EVENT_WEB_COMMAND);
+}
@@ -0,0 +1,45 @@
+#ifndef ALGORITHM_TASK_H
+#define ALGORITHM_TASK_H
+
+#include <Arduino.h>
+
+// ===============================
+// ALGORITHM TASK (EVENT DRIVEN)
+// ===============================
+// Sensors, every channel's WaterAlgorithm, pump timing and the auto-enable
+// checks run as one control step in a FreeRTOS task. The task sleeps on an event queue until
+// something arrives or the next deadline expires (state timeout, pump stop,
+// debounce confirm, UTC midnight, error LED pulse) - no fixed polling.
+// With ALGORITHM_EVENT_DRIVEN = false the step runs from loop() as before.
+
+enum AlgorithmEventType {
+    ALGO_EVENT_SENSOR_EDGE = 1,   // GPIO ISR - edge waiting in the sensor ring
+    ALGO_EVENT_PUMP_FINISHED,     // Pump stopped (timer, web stop, global disable)
+    ALGO_EVENT_WEB_COMMAND,       // A web handler changed pump / system / algorithm state
+    ALGO_EVENT_DAY_CHANGE         // Clock service - UTC day rolled over (midnight or clock step)
+};
+
+struct AlgorithmEvent {
+    uint8_t type;       // AlgorithmEventType
+    uint8_t arg;        // Sensor number for ALGO_EVENT_SENSOR_EDGE, channel for ALGO_EVENT_PUMP_FINISHED
+    int64_t postedUs;   // esp_timer time when posted
+};
+
+void initAlgorithmTask();
+bool isAlgorithmTaskRunning();
+
+// One control step; returns ms until the next deadline
+uint32_t runControlStep();
+
+void postAlgorithmEvent(AlgorithmEventType type, uint8_t arg = 0);
+void postAlgorithmEventFromISR(AlgorithmEventType type, uint8_t arg);
+
+// Web handlers (async_tcp task) hold this while changing pump / algorithm
+// state; on scope exit the control task is woken to recompute its deadline.
+class AlgorithmCommand {
+public:
+    AlgorithmCommand();
+    ~AlgorithmCommand();
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef ALGORITHM_TRANSITIONS_H
+#define ALGORITHM_TRANSITIONS_H
+
+#include "algorithm_fsm.h"
+#include "water_algorithm.h"
+
+// ===============================
+// WATER ALGORITHM TRANSITION TABLE
+// ===============================
+// Rows are grouped by source state and tried in order - the first row whose
+// trigger matches, timeout has expired and guard passes is taken.
+// Timeouts name a parameter (AlgorithmTimeout) - the seconds come from the
+// active AlgorithmParams, so retuning does not touch the table.
+// COMMAND rows declare transitions made by enterState() from outside the
+// table; enterState() logs any transition missing here.
+
+#define WA &WaterAlgorithm::
+
+struct WaterAlgorithmFsm {
+    static constexpr AlgorithmTransition rows[] = {
+        // from                    to                      trigger          timeout                guard                         action
+        { STATE_IDLE,              STATE_TRYB_1_WAIT,      TRIGGER_SENSOR,  TIMEOUT_NONE,          WA guardTriggerEdge,          WA actStartTryb1 },
+        { STATE_IDLE,              STATE_ERROR,            TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },   // daily limit after manual pump
+
+        { STATE_TRYB_1_WAIT,       STATE_TRYB_1_DELAY,     TRIGGER_SENSOR,  TIMEOUT_NONE,          WA guardBothTriggered,        WA actGap1Measured },
+        { STATE_TRYB_1_WAIT,       STATE_TRYB_1_DELAY,     TRIGGER_TICK,    TIMEOUT_GAP_1_MAX,     nullptr,                      WA actGap1Timeout },
+        { STATE_TRYB_1_WAIT,       STATE_IDLE,             TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },   // system disable
+        { STATE_TRYB_1_WAIT,       STATE_MANUAL_OVERRIDE,  TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+
+        { STATE_TRYB_1_DELAY,      STATE_TRYB_2_PUMP,      TRIGGER_TICK,    TIMEOUT_TO_PUMP,       nullptr,                      WA actStartPump },
+        { STATE_TRYB_1_DELAY,      STATE_IDLE,             TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+        { STATE_TRYB_1_DELAY,      STATE_ERROR,            TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+
+        { STATE_TRYB_2_PUMP,       STATE_TRYB_2_VERIFY,    TRIGGER_TICK,    TIMEOUT_NONE,          WA guardPumpStopped,          WA actPumpFinished },
+        { STATE_TRYB_2_PUMP,       STATE_TRYB_2_VERIFY,    TRIGGER_TICK,    TIMEOUT_WATER_TRIGGER, nullptr,                      WA actPumpOverrun },
+        { STATE_TRYB_2_PUMP,       STATE_IDLE,             TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+        { STATE_TRYB_2_PUMP,       STATE_ERROR,            TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+
+        { STATE_TRYB_2_VERIFY,     STATE_TRYB_2_WAIT_GAP2, TRIGGER_TICK,    TIMEOUT_NONE,          WA guardSensorsClearForGap2,  WA actWaterConfirmedGap2 },
+        { STATE_TRYB_2_VERIFY,     STATE_LOGGING,          TRIGGER_TICK,    TIMEOUT_NONE,          WA guardSensorsClear,         WA actWaterConfirmed },
+        { STATE_TRYB_2_VERIFY,     STATE_TRYB_1_DELAY,     TRIGGER_TICK,    TIMEOUT_WATER_TRIGGER, WA guardPumpAttemptsLeft,     WA actRetryPump },
+        { STATE_TRYB_2_VERIFY,     STATE_ERROR,            TRIGGER_TICK,    TIMEOUT_WATER_TRIGGER, nullptr,                      WA actPumpFailure },
+        { STATE_TRYB_2_VERIFY,     STATE_IDLE,             TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+
+        { STATE_TRYB_2_WAIT_GAP2,  STATE_LOGGING,          TRIGGER_SENSOR,  TIMEOUT_NONE,          WA guardBothReleased,         WA actGap2Measured },
+        { STATE_TRYB_2_WAIT_GAP2,  STATE_LOGGING,          TRIGGER_TICK,    TIMEOUT_NONE,          WA guardBothReleased,         WA actGap2Measured },
+        { STATE_TRYB_2_WAIT_GAP2,  STATE_LOGGING,          TRIGGER_TICK,    TIMEOUT_GAP_2_MAX,     nullptr,                      WA actGap2Timeout },
+        { STATE_TRYB_2_WAIT_GAP2,  STATE_IDLE,             TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+        { STATE_TRYB_2_WAIT_GAP2,  STATE_MANUAL_OVERRIDE,  TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+
+        { STATE_LOGGING,           STATE_ERROR,            TRIGGER_TICK,    TIMEOUT_NONE,          WA guardDailyLimitExceeded,   WA actDailyLimitError },
+        { STATE_LOGGING,           STATE_IDLE,             TRIGGER_TICK,    TIMEOUT_LOGGING,       nullptr,                      WA actCycleDone },
+        { STATE_LOGGING,           STATE_MANUAL_OVERRIDE,  TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+
+        { STATE_ERROR,             STATE_IDLE,             TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },   // reset button / system disable
+
+        { STATE_MANUAL_OVERRIDE,   STATE_IDLE,             TRIGGER_TICK,    TIMEOUT_NONE,          WA guardPumpStopped,          nullptr },
+        { STATE_MANUAL_OVERRIDE,   STATE_ERROR,            TRIGGER_COMMAND, TIMEOUT_NONE,          nullptr,                      nullptr },
+    };
+
+    static constexpr size_t ROW_COUNT = sizeof(rows) / sizeof(rows[0]);
+
+#define FSM_STATE(s, name, timer, waits, enter) \
+    { s, name, timer, waits, enter, fsmFirstRow(rows, ROW_COUNT, s), fsmRowCount(rows, ROW_COUNT, s) }
+
+    static constexpr AlgorithmStateInfo states[] = {
+        FSM_STATE(STATE_IDLE,             "IDLE",             TIMER_STATE_ENTRY, true,  WA enterClearCycle),
+        FSM_STATE(STATE_TRYB_1_WAIT,      "TRYB_1_WAIT",      TIMER_STATE_ENTRY, false, nullptr),
+        FSM_STATE(STATE_TRYB_1_DELAY,     "TRYB_1_DELAY",     TIMER_TRIGGER,     false, nullptr),
+        FSM_STATE(STATE_TRYB_2_PUMP,      "TRYB_2_PUMP",      TIMER_PUMP_START,  false, nullptr),
+        FSM_STATE(STATE_TRYB_2_VERIFY,    "TRYB_2_VERIFY",    TIMER_PUMP_START,  false, nullptr),
+        FSM_STATE(STATE_TRYB_2_WAIT_GAP2, "TRYB_2_WAIT_GAP2", TIMER_STATE_ENTRY, false, nullptr),
+        FSM_STATE(STATE_LOGGING,          "LOGGING",          TIMER_STATE_ENTRY, false, WA enterLogging),
+        FSM_STATE(STATE_ERROR,            "ERROR",            TIMER_STATE_ENTRY, true,  nullptr),
+        FSM_STATE(STATE_MANUAL_OVERRIDE,  "MANUAL_OVERRIDE",  TIMER_STATE_ENTRY, true,  WA enterClearCycle),
+    };
+
+#undef FSM_STATE
+};
+
+#undef WA
+
+// ============== SPRAWDZENIA TABELI ==============
+static_assert(sizeof(WaterAlgorithmFsm::states) / sizeof(WaterAlgorithmFsm::states[0]) == ALGORITHM_STATE_COUNT,
+              "One state table entry per AlgorithmState");
+static_assert(fsmRowsInRange(WaterAlgorithmFsm::rows, WaterAlgorithmFsm::ROW_COUNT),
+              "Transition references an unknown state");
+static_assert(fsmRowsSorted(WaterAlgorithmFsm::rows, WaterAlgorithmFsm::ROW_COUNT),
+              "Transition rows must be grouped by source state");
+static_assert(fsmRowsWellFormed(WaterAlgorithmFsm::rows, WaterAlgorithmFsm::ROW_COUNT),
+              "Table rows need a guard or timeout, command rows neither, no self loops");
+static_assert(fsmStatesValid(WaterAlgorithmFsm::states, WaterAlgorithmFsm::rows, WaterAlgorithmFsm::ROW_COUNT),
+              "State table out of order, a state without exits, or a timed state without a timeout row");
+static_assert(fsmClosure(WaterAlgorithmFsm::rows, WaterAlgorithmFsm::ROW_COUNT, FSM_STATE_BIT(STATE_IDLE), false) == FSM_ALL_STATES,
+              "Every state must be reachable from IDLE");
+static_assert(fsmClosure(WaterAlgorithmFsm::rows, WaterAlgorithmFsm::ROW_COUNT, FSM_STATE_BIT(STATE_IDLE), true) == FSM_ALL_STATES,
+              "Every state must lead back to IDLE");
+
+#endif
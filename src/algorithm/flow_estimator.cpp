@@ -0,0 +1,275 @@
+#include "flow_estimator.h"
+#include "algorithm_config.h"
+#include "../config/config.h"
+#include "../core/logging.h"
+#include "../core/trace_recorder.h"
+#include "../crypto/crc.h"
+#include "../hardware/fram_controller.h"
+#include "../hardware/fram_journal.h"
+#include <math.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// ~95% two-sided bound (normal approximation, window of 6-12 samples)
+#define FLOW_CI_Z   2.0f
+
+static FlowEstimatorBlock block;
+static bool autoAdjust = FLOW_AUTO_ADJUST;
+static uint32_t rejectedSamples = 0;
+static bool adjustPending = false;
+static SemaphoreHandle_t estimatorMutex = nullptr;
+
+static uint16_t blockCRC() {
+    return crc16((const uint8_t*)&block, offsetof(FlowEstimatorBlock, crc));
+}
+
+static bool validVolume(float volume) {
+    return isfinite(volume) && volume >= 0.1f && volume <= 20.0f;
+}
+
+static void resetBlock(float volumePerSecond) {
+    memset(&block, 0, sizeof(block));
+    block.magic = FLOW_ESTIMATOR_MAGIC;
+    block.version = FLOW_ESTIMATOR_VERSION;
+    block.anchorVolumePerSecond = volumePerSecond;
+    block.appliedVolumePerSecond = volumePerSecond;
+}
+
+static bool loadBlock() {
+    if (!readFRAMBlock(FRAM_ADDR_FLOW_ESTIMATOR, (uint8_t*)&block, sizeof(block))) {
+        return false;
+    }
+    if (block.magic != FLOW_ESTIMATOR_MAGIC) {
+        return false;   // never written
+    }
+    if (block.crc != blockCRC()) {
+        LOG_ERROR("Flow estimator: CRC error in FRAM");
+        return false;
+    }
+    if (block.version != FLOW_ESTIMATOR_VERSION ||
+        !validVolume(block.anchorVolumePerSecond) || !validVolume(block.appliedVolumePerSecond) ||
+        block.baselineCount > FLOW_BASELINE_CYCLES || block.windowCount > FLOW_WINDOW_CYCLES ||
+        block.windowHead >= FLOW_WINDOW_CYCLES) {
+        LOG_WARNING("Flow estimator: FRAM block rejected");
+        return false;
+    }
+    return true;
+}
+
+static void saveBlock() {
+    block.crc = blockCRC();
+
+    // Journaled - a reset mid-write keeps the previous block (and its anchor)
+    FramTransaction tx;
+    if (!tx.write(FRAM_ADDR_FLOW_ESTIMATOR, &block, sizeof(block)) || !tx.commit()) {
+        LOG_ERROR("FRAM flow estimator commit failed");
+    }
+}
+
+// Manual volumePerSecond change since the last cycle - new calibration, new baseline
+static void checkAnchor() {
+    float current = currentPumpSettings.volumePerSecond;
+    if (current != block.appliedVolumePerSecond) {
+        LOG_INFO("Flow estimator: volumePerSecond %.2f -> %.2f ml/s, restarting baseline",
+                 block.appliedVolumePerSecond, current);
+        resetBlock(current);
+    }
+}
+
+static FlowEstimate computeEstimate() {
+    FlowEstimate est = {};
+    est.baselineSamples = block.baselineCount;
+    est.windowSamples = block.windowCount;
+    est.rejectedSamples = rejectedSamples;
+    est.anchorVolumePerSecond = block.anchorVolumePerSecond;
+    est.ratio = 1.0f;
+    est.ratioLow = 1.0f;
+    est.ratioHigh = 1.0f;
+    est.estimatedVolumePerSecond = block.anchorVolumePerSecond;
+    est.recommendedVolumePerSecond = currentPumpSettings.volumePerSecond;
+    est.autoAdjust = autoAdjust;
+    est.adjustCount = block.adjustCount;
+
+    if (block.baselineCount < FLOW_BASELINE_CYCLES) {
+        est.state = FLOW_LEARNING_BASELINE;
+        return est;
+    }
+    if (block.windowCount < FLOW_MIN_WINDOW_CYCLES) {
+        est.state = FLOW_COLLECTING;
+        return est;
+    }
+    est.state = FLOW_TRACKING;
+
+    float sum = 0;
+    for (uint16_t i = 0; i < block.windowCount; i++) sum += block.window[i];
+    float windowMean = sum / block.windowCount;
+    float windowM2 = 0;
+    for (uint16_t i = 0; i < block.windowCount; i++) {
+        float d = block.window[i] - windowMean;
+        windowM2 += d * d;
+    }
+
+    // Relative standard errors of both means add in quadrature for the ratio
+    float windowVar = windowM2 / (block.windowCount - 1);
+    float baselineVar = block.baselineM2 / (block.baselineCount - 1);
+    float relErr = sqrtf(windowVar / (block.windowCount * windowMean * windowMean) +
+                         baselineVar / (block.baselineCount * block.baselineMean * block.baselineMean));
+
+    est.ratio = windowMean / block.baselineMean;
+    est.ratioLow = est.ratio * (1.0f - FLOW_CI_Z * relErr);
+    est.ratioHigh = est.ratio * (1.0f + FLOW_CI_Z * relErr);
+    est.estimatedVolumePerSecond = block.anchorVolumePerSecond * est.ratio;
+
+    float current = currentPumpSettings.volumePerSecond;
+    bool tight = FLOW_CI_Z * relErr * 100.0f <= FLOW_MAX_CI_PERCENT;
+    bool significant = fabsf(est.estimatedVolumePerSecond - current) * 100.0f >= FLOW_ADJUST_MIN_PERCENT * current;
+    bool outside = current < block.anchorVolumePerSecond * est.ratioLow ||
+                   current > block.anchorVolumePerSecond * est.ratioHigh;
+    if (tight && significant && outside && validVolume(est.estimatedVolumePerSecond)) {
+        est.recommend = true;
+        est.recommendedVolumePerSecond = est.estimatedVolumePerSecond;
+    }
+    return est;
+}
+
+static void applyAdjustment(const FlowEstimate& est) {
+    float current = currentPumpSettings.volumePerSecond;
+    float target = est.recommendedVolumePerSecond;
+    target = fminf(fmaxf(target, current * (1.0f - FLOW_ADJUST_MAX_STEP)), current * (1.0f + FLOW_ADJUST_MAX_STEP));
+    target = fminf(fmaxf(target, 0.1f), 20.0f);
+
+    currentPumpSettings.volumePerSecond = target;
+
+    uint32_t volumeBits;
+    memcpy(&volumeBits, &target, sizeof(volumeBits));
+    traceRecord(TRACE_SETTINGS, 0, volumeBits);
+    saveVolumeToNVS();
+
+    block.appliedVolumePerSecond = target;
+    if (block.adjustCount < 0xFFFF) block.adjustCount++;
+
+    LOG_WARNING("Flow estimator: volumePerSecond %.2f -> %.2f ml/s (estimate %.2f, ratio %.3f [%.3f-%.3f])",
+                current, target, est.estimatedVolumePerSecond, est.ratio, est.ratioLow, est.ratioHigh);
+}
+
+void initFlowEstimator() {
+    if (estimatorMutex == nullptr) {
+        estimatorMutex = xSemaphoreCreateMutex();
+    }
+
+    xSemaphoreTake(estimatorMutex, portMAX_DELAY);
+    if (!loadBlock()) {
+        resetBlock(currentPumpSettings.volumePerSecond);
+    }
+    checkAnchor();
+    FlowEstimate est = computeEstimate();
+    xSemaphoreGive(estimatorMutex);
+
+    LOG_INFO("Flow estimator: %s, anchor %.2f ml/s, baseline %d/%d, window %d, ratio %.3f%s",
+             getFlowEstimatorStateString(est.state), est.anchorVolumePerSecond,
+             est.baselineSamples, FLOW_BASELINE_CYCLES, est.windowSamples, est.ratio,
+             est.autoAdjust ? " (auto-adjust)" : "");
+}
+
+void flowEstimatorAddCycle(const PumpCycle& cycle, uint32_t gap1Ms, uint32_t gap2Ms) {
+    if (estimatorMutex == nullptr) return;
+
+    // Clean cycles only: first attempt, healthy sensors, both gaps measured on
+    // ms edges and both releases while the pump was still running
+    if (cycle.error_code != ERROR_NONE || cycle.pump_attempts != 1 || cycle.sensor_results != 0 ||
+        gap1Ms == 0 || gap2Ms == 0 ||
+        cycle.water_trigger_time + cycle.time_gap_2 >= cycle.pump_duration) {
+        return;
+    }
+
+    float sample = 1000.0f / gap2Ms + 1000.0f / gap1Ms;
+
+    xSemaphoreTake(estimatorMutex, portMAX_DELAY);
+    checkAnchor();
+
+    if (block.baselineCount < FLOW_BASELINE_CYCLES) {
+        // Welford - baseline stays fixed once complete
+        block.baselineCount++;
+        float delta = sample - block.baselineMean;
+        block.baselineMean += delta / block.baselineCount;
+        block.baselineM2 += delta * (sample - block.baselineMean);
+    } else if (sample > block.baselineMean * FLOW_SAMPLE_MAX_DEVIATION ||
+               sample < block.baselineMean / FLOW_SAMPLE_MAX_DEVIATION) {
+        rejectedSamples++;
+        LOG_WARNING("Flow estimator: sample %.4f/s outside baseline %.4f/s - ignored",
+                    sample, block.baselineMean);
+        xSemaphoreGive(estimatorMutex);
+        return;
+    } else {
+        block.window[block.windowHead] = sample;
+        block.windowHead = (block.windowHead + 1) % FLOW_WINDOW_CYCLES;
+        if (block.windowCount < FLOW_WINDOW_CYCLES) block.windowCount++;
+    }
+
+    FlowEstimate est = computeEstimate();
+    adjustPending = est.recommend && autoAdjust;
+    saveBlock();
+    xSemaphoreGive(estimatorMutex);
+
+    LOG_INFO("Flow estimator: %s, sample %.4f/s, ratio %.3f [%.3f-%.3f], estimate %.2f ml/s",
+             getFlowEstimatorStateString(est.state), sample, est.ratio, est.ratioLow, est.ratioHigh,
+             est.estimatedVolumePerSecond);
+    if (est.recommend && !autoAdjust) {
+        LOG_WARNING("Flow estimator: recommend volumePerSecond %.2f ml/s (set %.2f)",
+                    est.recommendedVolumePerSecond, currentPumpSettings.volumePerSecond);
+    }
+}
+
+void flowEstimatorApplyPending() {
+    if (!adjustPending || estimatorMutex == nullptr) return;
+    adjustPending = false;
+
+    xSemaphoreTake(estimatorMutex, portMAX_DELAY);
+    FlowEstimate est = computeEstimate();
+    if (est.recommend && autoAdjust && currentPumpSettings.volumePerSecond == block.appliedVolumePerSecond) {
+        applyAdjustment(est);
+        saveBlock();
+    }
+    xSemaphoreGive(estimatorMutex);
+}
+
+FlowEstimate getFlowEstimate() {
+    if (estimatorMutex == nullptr) {
+        FlowEstimate est = {};
+        est.ratio = est.ratioLow = est.ratioHigh = 1.0f;
+        est.anchorVolumePerSecond = est.estimatedVolumePerSecond =
+            est.recommendedVolumePerSecond = currentPumpSettings.volumePerSecond;
+        est.autoAdjust = autoAdjust;
+        return est;
+    }
+
+    xSemaphoreTake(estimatorMutex, portMAX_DELAY);
+    FlowEstimate est = computeEstimate();
+    if (currentPumpSettings.volumePerSecond != block.appliedVolumePerSecond) {
+        // Changed by hand - the next cycle restarts the baseline
+        est.state = FLOW_LEARNING_BASELINE;
+        est.baselineSamples = 0;
+        est.windowSamples = 0;
+        est.anchorVolumePerSecond = currentPumpSettings.volumePerSecond;
+        est.ratio = est.ratioLow = est.ratioHigh = 1.0f;
+        est.estimatedVolumePerSecond = currentPumpSettings.volumePerSecond;
+        est.recommend = false;
+        est.recommendedVolumePerSecond = currentPumpSettings.volumePerSecond;
+        est.adjustCount = 0;
+    }
+    xSemaphoreGive(estimatorMutex);
+    return est;
+}
+
+const char* getFlowEstimatorStateString(FlowEstimatorState state) {
+    switch (state) {
+        case FLOW_LEARNING_BASELINE: return "LEARNING";
+        case FLOW_COLLECTING:        return "COLLECTING";
+        case FLOW_TRACKING:          return "TRACKING";
+        default:                     return "UNKNOWN";
+    }
+}
+
+void setFlowAutoAdjust(bool enabled) {
+    autoAdjust = enabled;
+}
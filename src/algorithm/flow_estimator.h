@@ -0,0 +1,99 @@
+#ifndef FLOW_ESTIMATOR_H
+#define FLOW_ESTIMATOR_H
+
+#include <Arduino.h>
+
+struct PumpCycle;
+
+// ===============================
+// PUMP FLOW ESTIMATOR
+// ===============================
+// Tracks the real pump flow against the hand-entered volumePerSecond.
+//
+// The two float sensors sit a fixed (unknown) volume G apart. In a clean
+// cycle the level falls through that gap at the evaporation rate e
+// (TIME_GAP_1) and rises through it at pump flow minus evaporation
+// (TIME_GAP_2, both releases while the pump is still running):
+//
+//     1/gap2 + 1/gap1 = (q - e)/G + e/G = q/G
+//
+// so the sample is proportional to the flow q and independent of
+// evaporation. G cancels against a baseline taken right after
+// volumePerSecond was calibrated: flow = anchor * mean(window) / baseline.
+// The ratio carries an approximate 95% confidence bound from the spread
+// of both sample sets.
+//
+// Result is a recommended volumePerSecond in /api/status. With
+// FLOW_AUTO_ADJUST (config.h) the estimator also applies it, in bounded
+// steps, once the bound excludes the current setting - on the algorithm's
+// next transition to IDLE, like runtime params. Changing volumePerSecond
+// by hand re-anchors (restarts the baseline).
+
+#define FLOW_ESTIMATOR_MAGIC        0x4645  // "FE"
+#define FLOW_ESTIMATOR_VERSION      1
+
+#define FLOW_BASELINE_CYCLES        8       // Clean cycles averaged after a calibration
+#define FLOW_WINDOW_CYCLES          12      // Recent clean cycles compared against the baseline
+#define FLOW_MIN_WINDOW_CYCLES      6       // Before that - no estimate
+#define FLOW_MAX_CI_PERCENT         10.0f   // Half-width of the bound needed for a recommendation
+#define FLOW_ADJUST_MIN_PERCENT     5.0f    // Smaller deviations are left alone
+#define FLOW_ADJUST_MAX_STEP        0.2f    // Auto-adjust moves volumePerSecond by at most 20% per cycle
+#define FLOW_SAMPLE_MAX_DEVIATION   2.0f    // Samples outside baseline / 2 .. baseline * 2 are dropped
+
+enum FlowEstimatorState : uint8_t {
+    FLOW_LEARNING_BASELINE = 0,     // Collecting FLOW_BASELINE_CYCLES after (re)calibration
+    FLOW_COLLECTING,                // Baseline done, window below FLOW_MIN_WINDOW_CYCLES
+    FLOW_TRACKING                   // Estimate available
+};
+
+// FRAM image (FRAM_ADDR_FLOW_ESTIMATOR) - written once per accepted cycle
+struct FlowEstimatorBlock {
+    uint16_t magic;                 // FLOW_ESTIMATOR_MAGIC
+    uint16_t version;               // FLOW_ESTIMATOR_VERSION
+    float anchorVolumePerSecond;    // volumePerSecond the baseline was taken with
+    float appliedVolumePerSecond;   // Last value seen / set - a difference means a manual change
+    float baselineMean;             // Welford mean / M2 of the baseline samples (1/s)
+    float baselineM2;
+    uint16_t baselineCount;
+    uint16_t windowCount;
+    uint16_t windowHead;            // Next window slot
+    uint16_t adjustCount;           // Auto-adjustments since the anchor (saturating)
+    float window[FLOW_WINDOW_CYCLES];
+    uint16_t crc;                   // CRC16 of the fields above
+    uint16_t reserved;
+};
+
+static_assert(sizeof(FlowEstimatorBlock) == 80, "FlowEstimatorBlock must match the FRAM layout");
+
+struct FlowEstimate {
+    FlowEstimatorState state;
+    uint16_t baselineSamples;
+    uint16_t windowSamples;
+    uint32_t rejectedSamples;           // Since boot
+    float anchorVolumePerSecond;
+    float ratio;                        // Real flow / anchor (1.0 until FLOW_TRACKING)
+    float ratioLow;                     // ~95% bound
+    float ratioHigh;
+    float estimatedVolumePerSecond;     // anchor * ratio
+    bool recommend;                     // Bound is tight and excludes the current setting
+    float recommendedVolumePerSecond;   // Current setting when !recommend
+    bool autoAdjust;
+    uint16_t adjustCount;
+};
+
+void initFlowEstimator();
+
+// Completed cycle (called from WaterAlgorithm::logCycleComplete). gap1Ms /
+// gap2Ms are the ms edge gaps, 0 when not measured on both sensors.
+void flowEstimatorAddCycle(const PumpCycle& cycle, uint32_t gap1Ms, uint32_t gap2Ms);
+
+// WaterAlgorithm entering IDLE - applies an auto-adjustment decided by the last cycle
+void flowEstimatorApplyPending();
+
+FlowEstimate getFlowEstimate();
+const char* getFlowEstimatorStateString(FlowEstimatorState state);
+
+// Default from FLOW_AUTO_ADJUST (config.h); the simulator toggles it
+void setFlowAutoAdjust(bool enabled);
+
+#endif
@@ -8,36 +8,57 @@
 #include "../hardware/fram_controller.h"  
 #include "../network/vps_logger.h"
 #include "../hardware/rtc_controller.h" 
+#include "../core/metrics.h"
+#include "../core/trace_recorder.h"
+#include "algorithm_transitions.h"
+#include "flow_estimator.h"
+#include "adaptive_delay.h"
 
 
-WaterAlgorithm waterAlgorithm;
+// Storage for the constexpr tables (C++11 needs a namespace-scope definition)
+constexpr AlgorithmTransition WaterAlgorithmFsm::rows[];
+constexpr AlgorithmStateInfo WaterAlgorithmFsm::states[];
 
+WaterAlgorithm waterChannels[WATER_CHANNEL_COUNT] = {
+    WaterAlgorithm(0),
+#if WATER_CHANNEL_COUNT > 1
+    WaterAlgorithm(1),
+#endif
+};
 
+WaterAlgorithm& waterAlgorithm = waterChannels[0];
 
-WaterAlgorithm::WaterAlgorithm() {
+
+
+WaterAlgorithm::WaterAlgorithm(uint8_t channel) : channel(channel) {
     currentState = STATE_IDLE;
+    params = getDefaultAlgorithmParams();   // FRAM copy loaded by initParams()
+    cycleTimeToPump = params.timeToPump;
+    pendingParams = params;
+    paramsPending = false;
     resetCycle();
     dayStartTime = millis();
     
     dailyVolumeML = 0;
     lastResetUTCDay = 0;  // ← ZMIANA
     resetPending = false;
+    nextDateCheckMs = millis();
     
     lastError = ERROR_NONE;
     errorSignalActive = false;
     lastSensor1State = false;
     lastSensor2State = false;
+    lastEdgeTriggered = false;
     todayCycles.clear();
 
     framDataLoaded = false;
     lastFRAMCleanup = millis();
-    framCycles.clear();
     systemWasDisabled = false;
     
     loadCyclesFromStorage();
 
     ErrorStats stats;
-    if (loadErrorStatsFromFRAM(stats)) {
+    if (loadErrorStatsFromFRAM(stats, channel)) {
         LOG_INFO("Error statistics loaded from FRAM");
     } else {
         LOG_WARNING("Could not load error stats from FRAM");
@@ -59,11 +80,13 @@ void WaterAlgorithm::resetCycle() {
     sensor2TriggerTime = 0;
     sensor1ReleaseTime = 0;
     sensor2ReleaseTime = 0;
+    sensor1TriggerMs = 0;
+    sensor2TriggerMs = 0;
+    sensor1ReleaseMs = 0;
+    sensor2ReleaseMs = 0;
     pumpStartTime = 0;
     waitingForSecondSensor = false;
     pumpAttempts = 0;
-    cycleLogged = false;
-    permission_log = true;
     waterFailDetected = false;
 }
 
@@ -87,7 +110,9 @@ void WaterAlgorithm::handleSystemDisable() {
             LOG_INFO("⏳ System disable requested but waiting for logging to complete...");
             systemWasDisabled = true;  // Mark that we're handling it
         }
-        return;  // Will be handled on next update() when state changes to IDLE
+        // Let LOGGING run to IDLE (or ERROR) on its own rows
+        fireTransition(TRIGGER_TICK, getCurrentTimeSeconds());
+        return;
     }
     
     // ⚠️ First time handling disable request
@@ -103,8 +128,8 @@ void WaterAlgorithm::handleSystemDisable() {
     }
     
     // Stop pump immediately (hardware level) if running
-    if (isPumpActive()) {
-        stopPump();
+    if (isPumpActive(channel)) {
+        stopPump(channel);
         LOG_INFO("✅ Pump stopped due to system disable");
     }
     
@@ -116,16 +141,20 @@ void WaterAlgorithm::handleSystemDisable() {
         currentCycle.error_code = ERROR_NONE;
         currentCycle.pump_attempts = pumpAttempts;
         currentCycle.volume_dose = 0;  // No water delivered (interrupted)
+
+        // Unix timestamp like completed cycles (uptime would look expired to retention)
+        uint32_t cycleAge = currentCycle.trigger_time ? getCurrentTimeSeconds() - currentCycle.trigger_time : 0;
+        currentCycle.timestamp = getUnixTimestamp() - cycleAge;
         
         // Save to FRAM for debugging/history
         saveCycleToStorage(currentCycle);
         
-        // Log to VPS (non-critical - short timeout)
+        // Queue for VPS (sent by the uplink task)
         uint32_t unixTime = getUnixTimestamp();
-        if (logEventToVPS("SYSTEM_DISABLED_INTERRUPT", 0, unixTime)) {
-            LOG_INFO("✅ Interrupt event logged to VPS");
+        if (logEventToVPS("SYSTEM_DISABLED_INTERRUPT", 0, unixTime, channel)) {
+            LOG_INFO("✅ Interrupt event queued for VPS");
         } else {
-            LOG_WARNING("⚠️ VPS logging failed (non-critical)");
+            LOG_WARNING("⚠️ VPS queueing failed (non-critical)");
         }
         
         LOG_INFO("Interrupted cycle saved to FRAM");
@@ -137,8 +166,7 @@ void WaterAlgorithm::handleSystemDisable() {
     
     // Reset to IDLE
     LOG_INFO("Resetting algorithm to IDLE state...");
-    currentState = STATE_IDLE;
-    resetCycle();
+    enterState(STATE_IDLE, getCurrentTimeSeconds());
     
     LOG_WARNING("====================================");
     LOG_WARNING("✅ System paused in IDLE state");
@@ -156,10 +184,6 @@ void WaterAlgorithm::update() {
 
     if (systemDisableRequested) {
         handleSystemDisable();
-        
-        if (currentState != STATE_IDLE) {
-            return;
-        }
         return;
     }
     
@@ -171,11 +195,11 @@ void WaterAlgorithm::update() {
         LOG_INFO("====================================");
         LOG_INFO("✅ System re-enabled - resuming normal operation");
         LOG_INFO("Current state: %s", getStateString());
-        LOG_INFO("Daily volume: %dml / %dml", dailyVolumeML, FILL_WATER_MAX);
+        LOG_INFO("Daily volume: %dml / %dml", dailyVolumeML, params.fillWaterMax);
         LOG_INFO("====================================");
 
-        bool sensor1Active = readWaterSensor1();
-        bool sensor2Active = readWaterSensor2();
+        bool sensor1Active = readWaterSensor1(channel);
+        bool sensor2Active = readWaterSensor2(channel);
         
         LOG_INFO("Sensor states: S1=%s, S2=%s", 
                  sensor1Active ? "ACTIVE" : "INACTIVE",
@@ -189,330 +213,392 @@ void WaterAlgorithm::update() {
             
             uint32_t currentTime = getCurrentTimeSeconds();
             
-            // Initialize cycle (like a fresh trigger)
-            triggerStartTime = currentTime;
-            currentCycle.trigger_time = currentTime;
-            currentCycle.timestamp = currentTime;
-            
             // Record sensor states and times
             if (sensor1Active) {
                 sensor1TriggerTime = currentTime;
+                sensor1TriggerMs = millis();
                 lastSensor1State = true;
                 LOG_INFO("Sensor 1 recorded as ACTIVE");
             }
             
             if (sensor2Active) {
                 sensor2TriggerTime = currentTime;
+                sensor2TriggerMs = millis();
                 lastSensor2State = true;
                 LOG_INFO("Sensor 2 recorded as ACTIVE");
             }
             
-            // Enter TRYB_1_WAIT state
-            currentState = STATE_TRYB_1_WAIT;
-            stateStartTime = currentTime;
-            waitingForSecondSensor = !(sensor1Active && sensor2Active);  // Only if both not active
-            
-            LOG_INFO("State: %s", getStateString());
-            LOG_INFO("Waiting for second sensor: %s", waitingForSecondSensor ? "YES" : "NO");
-            
-            // If both sensors already active, calculate TIME_GAP_1 immediately
-            if (sensor1Active && sensor2Active) {
-                calculateTimeGap1();
-                waitingForSecondSensor = false;
-                
-                if (sensor_time_match_function(currentCycle.time_gap_1, THRESHOLD_1)) {
-                    currentCycle.sensor_results |= PumpCycle::RESULT_GAP1_FAIL;
-                }
-                
-                currentState = STATE_TRYB_1_DELAY;
-                stateStartTime = currentTime;
-                LOG_INFO("Both sensors active immediately - TIME_GAP_1=%ds", 
-                        currentCycle.time_gap_1);
-                LOG_INFO("Entering STATE_TRYB_1_DELAY");
+            // Same rows as a fresh trigger: IDLE -> TRYB_1_WAIT, and straight
+            // on to TRYB_1_DELAY when both sensors are already active
+            lastEdgeTriggered = true;
+            if (fireTransition(TRIGGER_SENSOR, currentTime)) {
+                fireTransition(TRIGGER_SENSOR, currentTime);
             }
             
+            LOG_INFO("State: %s", getStateString());
             LOG_INFO("====================================");
             
         } else {
             // No sensors active → Normal IDLE behavior
             LOG_INFO("No sensors active - waiting for trigger");
             LOG_INFO("Current state: %s", getStateString());
-            LOG_INFO("Daily volume: %dml / %dml", dailyVolumeML, FILL_WATER_MAX);
+            LOG_INFO("Daily volume: %dml / %dml", dailyVolumeML, params.fillWaterMax);
             LOG_INFO("====================================");
         }
     }
     
-    // UTC day check - throttled to 1x/second
-    static uint32_t lastDateCheck = 0;
-    
-    if (millis() - lastDateCheck >= 1000) {
-        // uint32_t currentTime = getCurrentTimeSeconds();
-        lastDateCheck = millis();
-        
-        if (!isRTCWorking()) {
-            static uint32_t lastWarning = 0;
-            if (millis() - lastWarning > 30000) {
-                LOG_ERROR("RTC not working - skipping date check");
-                lastWarning = millis();
-            }
-            goto skip_date_check;
-        }
-        
-        uint32_t currentUTCDay = getUnixTimestamp() / 86400;
-        
-        // ✅ SANITY CHECK: Sprawdź czy UTC day jest sensowny (2024-2035)
-        // 2024-01-01 = 19723 days, 2035-12-31 = 24106 days
-        if (currentUTCDay < 19723 || currentUTCDay > 24106) {
-            static uint32_t lastInvalidWarning = 0;
-            if (millis() - lastInvalidWarning > 10000) {
-                LOG_ERROR("Invalid UTC day from RTC: %lu (expected 19723-24106)", currentUTCDay);
-                LOG_ERROR("Skipping date check - RTC data corrupted");
-                lastInvalidWarning = millis();
-            }
-            goto skip_date_check;
-        }
-        
-        // ✅ DATE REGRESSION PROTECTION: Jeśli nowy < stary, ignoruj (RTC error)
-        if (currentUTCDay < lastResetUTCDay) {
-            static uint32_t lastRegressionWarning = 0;
-            if (millis() - lastRegressionWarning > 10000) {
-                LOG_ERROR("DATE REGRESSION DETECTED - IGNORING!");
-                LOG_ERROR("Current UTC day: %lu, Last: %lu (diff: %ld days BACK)", 
-                         currentUTCDay, lastResetUTCDay, 
-                         (long)(lastResetUTCDay - currentUTCDay));
-                LOG_ERROR("This indicates RTC read error - skipping reset");
-                lastRegressionWarning = millis();
-            }
-            goto skip_date_check;
-        }
-        
-        if (currentUTCDay != lastResetUTCDay) {
-            LOG_WARNING("===========================================");
-            LOG_WARNING("UTC DAY CHANGE DETECTED - RESET TRIGGERED!");
-            LOG_WARNING("===========================================");
-            LOG_WARNING("Previous UTC day: %lu", lastResetUTCDay);
-            LOG_WARNING("Current UTC day:  %lu", currentUTCDay);
-            LOG_WARNING("Difference: +%lu days", currentUTCDay - lastResetUTCDay);
-            LOG_WARNING("Daily volume BEFORE: %dml", dailyVolumeML);
-            LOG_WARNING("===========================================");
-            
-            if (isPumpActive()) {
-                if (!resetPending) {
-                    LOG_INFO("Reset delayed - pump active");
-                    resetPending = true;
-                }
-            } else {
-                dailyVolumeML = 0;
-                todayCycles.clear();
-                lastResetUTCDay = currentUTCDay;
-                saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay);
-                resetPending = false;
-                
-                LOG_WARNING("RESET EXECUTED: new UTC day = %lu", lastResetUTCDay);
-                LOG_WARNING("===========================================");
-            }
-        }
-    }
-       
-    skip_date_check:
+    checkUTCDayChange();
+
     uint32_t currentTime = getCurrentTimeSeconds();
     
     // Execute delayed reset when pump finishes
-    if (resetPending && !isPumpActive() && currentState == STATE_IDLE) {
+    if (resetPending && !isPumpActive(channel) && currentState == STATE_IDLE) {
         LOG_INFO("Executing delayed reset (pump finished)");
         
         uint32_t currentUTCDay = getUnixTimestamp() / 86400;
         dailyVolumeML = 0;
         todayCycles.clear();
         lastResetUTCDay = currentUTCDay;
-        saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay);
+        saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay, channel);
         resetPending = false;
         
         LOG_INFO("Delayed reset complete: 0ml (UTC day: %lu)", lastResetUTCDay);
+        if (isPrimaryChannel()) traceSyncPoint(TRACE_DAY_CHANGE);
     }
     
-    uint32_t stateElapsed = currentTime - stateStartTime;
+    // Table lookup for the current state's rows; a transition may enable the
+    // next state's rows right away (e.g. LOGGING -> ERROR), so keep stepping
+    for (uint8_t i = 0; i < ALGORITHM_STATE_COUNT; i++) {
+        if (!fireTransition(TRIGGER_TICK, currentTime)) break;
+    }
+}
 
-    // RESZTA FUNKCJI BEZ ZMIAN (switch statement itd.)
-    switch (currentState) {
-        case STATE_IDLE:
-            break;
-        case STATE_TRYB_1_WAIT:
-            if (stateElapsed >= TIME_GAP_1_MAX) {
-                currentCycle.time_gap_1 = TIME_GAP_1_MAX;
-                LOG_INFO("TRYB_1: TIME_GAP_1 timeout, using max: %ds", TIME_GAP_1_MAX);
-                
-                if (sensor_time_match_function(currentCycle.time_gap_1, THRESHOLD_1)) {
-                    currentCycle.sensor_results |= PumpCycle::RESULT_GAP1_FAIL;
-                }
-                
-                currentState = STATE_TRYB_1_DELAY;
-                stateStartTime = currentTime;
-                LOG_INFO("TRYB_1: Starting TIME_TO_PUMP delay (%ds)", TIME_TO_PUMP);
+// UTC day check - every step (the clock service makes it free of I2C);
+// nextDateCheckMs only wakes the task at midnight, clock steps post
+// ALGO_EVENT_DAY_CHANGE
+void WaterAlgorithm::checkUTCDayChange() {
+    if (!isRTCWorking()) {
+        nextDateCheckMs = millis() + DATE_CHECK_RETRY_MS;
+        static uint32_t lastWarning = 0;
+        if (millis() - lastWarning > 30000) {
+            LOG_ERROR("RTC not working - skipping date check");
+            lastWarning = millis();
+        }
+        return;
+    }
+    
+    uint32_t unixNow = getUnixTimestamp();
+    uint32_t currentUTCDay = unixNow / 86400;
+
+    // Wake-up just after UTC midnight (+1s margin)
+    nextDateCheckMs = millis() + (86400 - unixNow % 86400 + 1) * 1000UL;
+    
+    // ✅ SANITY CHECK: Sprawdź czy UTC day jest sensowny (2024-2035)
+    // 2024-01-01 = 19723 days, 2035-12-31 = 24106 days
+    if (currentUTCDay < 19723 || currentUTCDay > 24106) {
+        static uint32_t lastInvalidWarning = 0;
+        if (millis() - lastInvalidWarning > 10000) {
+            LOG_ERROR("Invalid UTC day from RTC: %lu (expected 19723-24106)", currentUTCDay);
+            LOG_ERROR("Skipping date check - RTC data corrupted");
+            lastInvalidWarning = millis();
+        }
+        return;
+    }
+    
+    // ✅ DATE REGRESSION PROTECTION: Jeśli nowy < stary, ignoruj (RTC error)
+    if (currentUTCDay < lastResetUTCDay) {
+        static uint32_t lastRegressionWarning = 0;
+        if (millis() - lastRegressionWarning > 10000) {
+            LOG_ERROR("DATE REGRESSION DETECTED - IGNORING!");
+            LOG_ERROR("Current UTC day: %lu, Last: %lu (diff: %ld days BACK)", 
+                     currentUTCDay, lastResetUTCDay, 
+                     (long)(lastResetUTCDay - currentUTCDay));
+            LOG_ERROR("This indicates RTC read error - skipping reset");
+            lastRegressionWarning = millis();
+        }
+        return;
+    }
+    
+    if (currentUTCDay != lastResetUTCDay) {
+        LOG_WARNING("===========================================");
+        LOG_WARNING("UTC DAY CHANGE DETECTED - RESET TRIGGERED!");
+        LOG_WARNING("===========================================");
+        LOG_WARNING("Previous UTC day: %lu", lastResetUTCDay);
+        LOG_WARNING("Current UTC day:  %lu", currentUTCDay);
+        LOG_WARNING("Difference: +%lu days", currentUTCDay - lastResetUTCDay);
+        LOG_WARNING("Daily volume BEFORE: %dml", dailyVolumeML);
+        LOG_WARNING("===========================================");
+        
+        if (isPumpActive(channel)) {
+            if (!resetPending) {
+                LOG_INFO("Reset delayed - pump active");
+                resetPending = true;
             }
-            break;
-                    
-        case STATE_TRYB_1_DELAY:
-            if (currentTime - triggerStartTime >= TIME_TO_PUMP) {
-                uint16_t pumpWorkTime = calculatePumpWorkTime(currentPumpSettings.volumePerSecond);
-                
-                // if (!validatePumpWorkTime(pumpWorkTime)) {
-                //     LOG_ERROR("PUMP_WORK_TIME (%ds) exceeds WATER_TRIGGER_MAX_TIME (%ds)", 
-                //             pumpWorkTime, WATER_TRIGGER_MAX_TIME);
-                //     pumpWorkTime = WATER_TRIGGER_MAX_TIME - 10;
-                // }
-                if (!validatePumpWorkTime(pumpWorkTime)) {
-                    LOG_ERROR("PUMP_WORK_TIME (%ds) exceeds WATER_TRIGGER_MAX_TIME (%ds)", 
-                            pumpWorkTime, WATER_TRIGGER_MAX_TIME);
-                    LOG_ERROR("Reducing pump time to safe value");
-                    pumpWorkTime = WATER_TRIGGER_MAX_TIME > 5 ? WATER_TRIGGER_MAX_TIME - 5 : 1;
-                    LOG_WARNING("Adjusted pump time: %ds", pumpWorkTime);
+        } else {
+            dailyVolumeML = 0;
+            todayCycles.clear();
+            lastResetUTCDay = currentUTCDay;
+            saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay, channel);
+            resetPending = false;
+            
+            LOG_WARNING("RESET EXECUTED: new UTC day = %lu", lastResetUTCDay);
+            LOG_WARNING("===========================================");
+            if (isPrimaryChannel()) traceSyncPoint(TRACE_DAY_CHANGE);
+        }
+    }
 }
-                
-                LOG_INFO("TRYB_2: Starting pump attempt %d/%d for %ds", 
-                        pumpAttempts + 1, PUMP_MAX_ATTEMPTS, pumpWorkTime);
-                
-                pumpStartTime = currentTime;
-                pumpAttempts++;
-                
-                triggerPump(pumpWorkTime, "AUTO_PUMP");
-                
-                currentCycle.pump_duration = pumpWorkTime;
-                currentState = STATE_TRYB_2_PUMP;
-                stateStartTime = currentTime;
-            }
-            break;
-               
-        case STATE_TRYB_2_PUMP:
-            if (!isPumpActive()) {
-                LOG_INFO("TRYB_2: Pump finished, checking sensors");
-                currentState = STATE_TRYB_2_VERIFY;
-                stateStartTime = currentTime;
-            }
+
+// ===============================================
+// STATE MACHINE - table driven (algorithm_transitions.h)
+// ===============================================
+
+bool WaterAlgorithm::fireTransition(TransitionTrigger trigger, uint32_t now) {
+    const AlgorithmStateInfo& state = WaterAlgorithmFsm::states[currentState];
+    uint32_t elapsed = now - stateTimerStart(currentState);
+
+    for (uint8_t i = state.firstRow; i < state.firstRow + state.rowCount; i++) {
+        const AlgorithmTransition& row = WaterAlgorithmFsm::rows[i];
+        if (row.trigger != trigger) continue;
+        if (row.timeout != TIMEOUT_NONE && elapsed < timeoutSeconds(row.timeout)) continue;
+        if (row.guard != nullptr && !(this->*row.guard)(now)) continue;
+
+        if (row.action != nullptr) {
+            (this->*row.action)(now);
+        }
+        enterState(row.to, now);
+        return true;
+    }
+    return false;
+}
+
+void WaterAlgorithm::enterState(AlgorithmState next, uint32_t now) {
+    const AlgorithmStateInfo& from = WaterAlgorithmFsm::states[currentState];
+
+    bool declared = false;
+    for (uint8_t i = from.firstRow; i < from.firstRow + from.rowCount; i++) {
+        if (WaterAlgorithmFsm::rows[i].to == next) {
+            declared = true;
             break;
+        }
+    }
+    if (!declared) {
+        LOG_ERROR("Undeclared transition %s -> %s", from.name, WaterAlgorithmFsm::states[next].name);
+    }
 
-        case STATE_TRYB_2_VERIFY: {
-            static uint32_t lastStatusLog = 0;
-            if (currentTime - lastStatusLog >= 5) {
-                uint32_t timeSincePumpStart = currentTime - pumpStartTime;
-                // LOG_INFO("TRYB_2_VERIFY: Waiting for sensors... %ds/%ds (attempt %d/%d)", 
-                //         timeSincePumpStart, WATER_TRIGGER_MAX_TIME, pumpAttempts, PUMP_MAX_ATTEMPTS);###################################################################
-                lastStatusLog = currentTime;
-            }
+    currentState = next;
+    stateStartTime = now;
 
-            bool sensorsOK = !readWaterSensor1() && !readWaterSensor2();
-            
-            if (sensorsOK) {
-                calculateWaterTrigger();
-                LOG_INFO("TRYB_2: Sensors deactivated, water_trigger_time: %ds", 
-                        currentCycle.water_trigger_time);
-                
-                uint8_t tryb1Result = sensor_time_match_function(currentCycle.time_gap_1, THRESHOLD_1);
-                if (tryb1Result == 0) {
-                    currentState = STATE_TRYB_2_WAIT_GAP2;
-                    stateStartTime = currentTime;
-                    waitingForSecondSensor = true;
-                    LOG_INFO("TRYB_2: TRYB_1_result=0, waiting for TIME_GAP_2");
-                } else {
-                    LOG_INFO("TRYB_2: TRYB_1_result=1, skipping TIME_GAP_2");
-                    currentState = STATE_LOGGING;
-                    stateStartTime = currentTime;
-                }
-            } else {
-                uint32_t timeSincePumpStart = currentTime - pumpStartTime;
-                
-                if (timeSincePumpStart >= WATER_TRIGGER_MAX_TIME) {
-                    currentCycle.water_trigger_time = WATER_TRIGGER_MAX_TIME;
+    // New parameters (and flow auto-adjustments) only take effect between cycles
+    if (next == STATE_IDLE) {
+        applyPendingParams();
+        if (isPrimaryChannel()) flowEstimatorApplyPending();
+    }
+
+    TransitionAction onEnter = WaterAlgorithmFsm::states[next].onEnter;
+    if (onEnter != nullptr) {
+        (this->*onEnter)(now);
+    }
+}
+
+uint16_t WaterAlgorithm::timeoutSeconds(AlgorithmTimeout timeout) const {
+    switch (timeout) {
+        case TIMEOUT_GAP_1_MAX:     return params.timeGap1Max;
+        case TIMEOUT_TO_PUMP:       return cycleTimeToPump;
+        case TIMEOUT_WATER_TRIGGER: return params.waterTriggerMaxTime;
+        case TIMEOUT_GAP_2_MAX:     return params.timeGap2Max;
+        case TIMEOUT_LOGGING:       return LOGGING_TIME;
+        default:                    return 0;
+    }
+}
+
+uint32_t WaterAlgorithm::stateTimerStart(AlgorithmState state) const {
+    switch (WaterAlgorithmFsm::states[state].timerBase) {
+        case TIMER_TRIGGER:    return triggerStartTime;
+        case TIMER_PUMP_START: return pumpStartTime;
+        default:               return stateStartTime;
+    }
+}
+
+// ============== GUARDS ==============
+
+bool WaterAlgorithm::guardTriggerEdge(uint32_t now) const {
+    return lastEdgeTriggered && (lastSensor1State || lastSensor2State);
+}
+
+bool WaterAlgorithm::guardBothTriggered(uint32_t now) const {
+    return waitingForSecondSensor && sensor1TriggerTime && sensor2TriggerTime;
+}
+
+bool WaterAlgorithm::guardPumpStopped(uint32_t now) const {
+    return !isPumpActive(channel);
+}
+
+bool WaterAlgorithm::guardSensorsClear(uint32_t now) const {
+    return !readWaterSensor1(channel) && !readWaterSensor2(channel);
+}
+
+bool WaterAlgorithm::guardSensorsClearForGap2(uint32_t now) const {
+    return guardSensorsClear(now) &&
+           sensor_time_match_function(currentCycle.time_gap_1, params.threshold1) == 0;
+}
+
+bool WaterAlgorithm::guardPumpAttemptsLeft(uint32_t now) const {
+    return pumpAttempts < PUMP_MAX_ATTEMPTS;
+}
+
+bool WaterAlgorithm::guardBothReleased(uint32_t now) const {
+    return waitingForSecondSensor && sensor1ReleaseTime && sensor2ReleaseTime;
+}
+
+bool WaterAlgorithm::guardDailyLimitExceeded(uint32_t now) const {
+    return dailyVolumeML > params.fillWaterMax;
+}
+
+// ============== ACTIONS ==============
+
+void WaterAlgorithm::actStartTryb1(uint32_t now) {
+    LOG_INFO("TRIGGER detected! Starting TRYB_1");
+    triggerStartTime = now;
+    currentCycle.trigger_time = now;
+    currentCycle.timestamp = now;
+    waitingForSecondSensor = true;
+    cycleTimeToPump = params.timeToPump;
+}
+
+void WaterAlgorithm::actGap1Measured(uint32_t now) {
+    // calculateTimeGap1() also evaluates THRESHOLD_1
+    calculateTimeGap1();
+    waitingForSecondSensor = false;
+    LOG_INFO("TRYB_1: Both sensors triggered, TIME_GAP_1=%ds", currentCycle.time_gap_1);
+
+    cycleTimeToPump = isPrimaryChannel() ? adaptiveTimeToPump(params, currentCycle) : params.timeToPump;
+    LOG_INFO("TRYB_1: Starting TIME_TO_PUMP delay (%ds, nominal %ds)", cycleTimeToPump, params.timeToPump);
+}
+
+void WaterAlgorithm::actGap1Timeout(uint32_t now) {
+    currentCycle.time_gap_1 = params.timeGap1Max;
+    LOG_INFO("TRYB_1: TIME_GAP_1 timeout, using max: %ds", params.timeGap1Max);
+    
+    if (sensor_time_match_function(currentCycle.time_gap_1, params.threshold1)) {
+        currentCycle.sensor_results |= PumpCycle::RESULT_GAP1_FAIL;
+    }
+    cycleTimeToPump = isPrimaryChannel() ? adaptiveTimeToPump(params, currentCycle)   // no usable gap1 - nominal
+                                         : params.timeToPump;
+    LOG_INFO("TRYB_1: Starting TIME_TO_PUMP delay (%ds)", cycleTimeToPump);
+}
+
+void WaterAlgorithm::actStartPump(uint32_t now) {
+    uint16_t pumpWorkTime = calculatePumpWorkTime(params.singleDoseVolume, currentPumpSettings.volumePerSecond);
+    
+    if (!validatePumpWorkTime(pumpWorkTime, params.waterTriggerMaxTime)) {
+        LOG_ERROR("PUMP_WORK_TIME (%ds) exceeds WATER_TRIGGER_MAX_TIME (%ds)", 
+                pumpWorkTime, params.waterTriggerMaxTime);
+        LOG_ERROR("Reducing pump time to safe value");
+        pumpWorkTime = params.waterTriggerMaxTime > 5 ? params.waterTriggerMaxTime - 5 : 1;
+        LOG_WARNING("Adjusted pump time: %ds", pumpWorkTime);
+    }
+    
+    LOG_INFO("TRYB_2: Starting pump attempt %d/%d for %ds", 
+            pumpAttempts + 1, PUMP_MAX_ATTEMPTS, pumpWorkTime);
+    
+    pumpStartTime = now;
+    pumpAttempts++;
+    
+    triggerPump(pumpWorkTime, "AUTO_PUMP", channel);
+    
+    currentCycle.pump_duration = pumpWorkTime;
+}
+
+void WaterAlgorithm::actPumpFinished(uint32_t now) {
+    LOG_INFO("TRYB_2: Pump finished, checking sensors");
+}
+
+void WaterAlgorithm::actPumpOverrun(uint32_t now) {
+    // Pump time is clamped below WATER_TRIGGER_MAX_TIME - only a stuck pump timer gets here
+    LOG_ERROR("TRYB_2: Pump still running after %ds - stopping", params.waterTriggerMaxTime);
+    stopPump(channel);
+}
 
-                    if (WATER_TRIGGER_MAX_TIME >= THRESHOLD_WATER) {
-                        waterFailDetected = true;
-                        LOG_INFO("WATER fail detected in attempt %d/%d", pumpAttempts, PUMP_MAX_ATTEMPTS);
-                    }
+void WaterAlgorithm::actWaterConfirmed(uint32_t now) {
+    calculateWaterTrigger();
+    LOG_INFO("TRYB_2: Sensors deactivated, water_trigger_time: %ds", 
+            currentCycle.water_trigger_time);
+    LOG_INFO("TRYB_2: TRYB_1_result=1, skipping TIME_GAP_2");
+}
+
+void WaterAlgorithm::actWaterConfirmedGap2(uint32_t now) {
+    calculateWaterTrigger();
+    LOG_INFO("TRYB_2: Sensors deactivated, water_trigger_time: %ds", 
+            currentCycle.water_trigger_time);
+    waitingForSecondSensor = true;
+    LOG_INFO("TRYB_2: TRYB_1_result=0, waiting for TIME_GAP_2");
+}
+
+void WaterAlgorithm::logPumpTimeout(uint32_t now) {
+    currentCycle.water_trigger_time = params.waterTriggerMaxTime;
+
+    if (params.waterTriggerMaxTime >= params.thresholdWater) {
+        waterFailDetected = true;
+        LOG_INFO("WATER fail detected in attempt %d/%d", pumpAttempts, PUMP_MAX_ATTEMPTS);
+    }
+    
+    LOG_WARNING("TRYB_2: Timeout after %ds (limit: %ds), attempt %d/%d", 
+            now - pumpStartTime, params.waterTriggerMaxTime, 
+            pumpAttempts, PUMP_MAX_ATTEMPTS);
+}
+
+void WaterAlgorithm::actRetryPump(uint32_t now) {
+    logPumpTimeout(now);
+    LOG_WARNING("TRYB_2: Retrying pump attempt %d/%d", 
+            pumpAttempts + 1, PUMP_MAX_ATTEMPTS);
+}
+
+void WaterAlgorithm::actPumpFailure(uint32_t now) {
+    logPumpTimeout(now);
+    LOG_ERROR("TRYB_2: All %d pump attempts failed!", PUMP_MAX_ATTEMPTS);
+    currentCycle.error_code = ERROR_PUMP_FAILURE;
                     
-                    LOG_WARNING("TRYB_2: Timeout after %ds (limit: %ds), attempt %d/%d", 
-                            timeSincePumpStart, WATER_TRIGGER_MAX_TIME, 
-                            pumpAttempts, PUMP_MAX_ATTEMPTS);
+    LOG_INFO("Logging failed cycle before entering ERROR state");
+    logCycleComplete();
                     
-                    if (pumpAttempts < PUMP_MAX_ATTEMPTS) {
-                        LOG_WARNING("TRYB_2: Retrying pump attempt %d/%d", 
-                                pumpAttempts + 1, PUMP_MAX_ATTEMPTS);
-                        
-                        currentState = STATE_TRYB_1_DELAY;
-                        stateStartTime = currentTime - TIME_TO_PUMP;
-                    } else {
-                        LOG_ERROR("TRYB_2: All %d pump attempts failed!", PUMP_MAX_ATTEMPTS);
-                        currentCycle.error_code = ERROR_PUMP_FAILURE;
-                                        
-                        LOG_INFO("Logging failed cycle before entering ERROR state");
-                        logCycleComplete();
-                                        
-                        startErrorSignal(ERROR_PUMP_FAILURE);
-                        currentState = STATE_ERROR;
-                    }
-                }
-            }
-            break;
-        }
+    startErrorSignal(ERROR_PUMP_FAILURE);
+}
 
-        case STATE_TRYB_2_WAIT_GAP2: 
-            static bool debugOnce = true;
-            if (debugOnce) {
-                LOG_INFO("DEBUG GAP2: s1Release=%ds, s2Release=%ds, waiting=%d", 
-                        sensor1ReleaseTime, sensor2ReleaseTime, waitingForSecondSensor);
-                debugOnce = false;
-            }
-            
-            if (sensor1ReleaseTime && sensor2ReleaseTime && waitingForSecondSensor) {
-                calculateTimeGap2();
-                waitingForSecondSensor = false;
-                LOG_INFO("TRYB_2: TIME_GAP_2 calculated successfully");
-                
-                currentState = STATE_LOGGING;
-                stateStartTime = currentTime;
-            } else if (stateElapsed >= TIME_GAP_2_MAX) {
-                currentCycle.time_gap_2 = TIME_GAP_2_MAX;
-
-                uint8_t result = sensor_time_match_function(currentCycle.time_gap_2, THRESHOLD_2);
-                if (result == 1) {
-                    currentCycle.sensor_results |= PumpCycle::RESULT_GAP2_FAIL;
-                }
+void WaterAlgorithm::actGap2Measured(uint32_t now) {
+    calculateTimeGap2();
+    waitingForSecondSensor = false;
+    LOG_INFO("TRYB_2: TIME_GAP_2 calculated successfully");
+}
 
-                LOG_WARNING("TRYB_2: TIME_GAP_2 timeout - s1Release=%ds, s2Release=%ds", 
-                        sensor1ReleaseTime, sensor2ReleaseTime);
-              
-                currentState = STATE_LOGGING;
-                stateStartTime = currentTime;
-            }
-            break;
-            
-        case STATE_LOGGING:
-            if(permission_log){
-                LOG_INFO("==================case STATE_LOGGING");
-                permission_log = false;      
-            } 
-        
-            if (!cycleLogged) {
-                logCycleComplete();
-                cycleLogged = true;
-                
-                if (dailyVolumeML > FILL_WATER_MAX) {
-                    LOG_ERROR("Daily limit exceeded! %dml > %dml", dailyVolumeML, FILL_WATER_MAX);
-                    currentCycle.error_code = ERROR_DAILY_LIMIT;
-                    startErrorSignal(ERROR_DAILY_LIMIT);
-                    currentState = STATE_ERROR;
-                    break;
-                }
-            }
-            
-            if (stateElapsed >= LOGGING_TIME) { 
-                LOG_INFO("Cycle complete, returning to IDLE######################################################");
-                currentState = STATE_IDLE;
-                resetCycle();
-            }
-            break;
+void WaterAlgorithm::actGap2Timeout(uint32_t now) {
+    currentCycle.time_gap_2 = params.timeGap2Max;
+
+    uint8_t result = sensor_time_match_function(currentCycle.time_gap_2, params.threshold2);
+    if (result == 1) {
+        currentCycle.sensor_results |= PumpCycle::RESULT_GAP2_FAIL;
     }
+
+    LOG_WARNING("TRYB_2: TIME_GAP_2 timeout - s1Release=%ds, s2Release=%ds", 
+            sensor1ReleaseTime, sensor2ReleaseTime);
+}
+
+void WaterAlgorithm::actDailyLimitError(uint32_t now) {
+    LOG_ERROR("Daily limit exceeded! %dml > %dml", dailyVolumeML, params.fillWaterMax);
+    currentCycle.error_code = ERROR_DAILY_LIMIT;
+    startErrorSignal(ERROR_DAILY_LIMIT);
+}
+
+void WaterAlgorithm::actCycleDone(uint32_t now) {
+    LOG_INFO("Cycle complete, returning to IDLE");
+}
+
+void WaterAlgorithm::enterClearCycle(uint32_t now) {
+    resetCycle();
+}
+
+void WaterAlgorithm::enterLogging(uint32_t now) {
+    logCycleComplete();
 }
-   
 
 void WaterAlgorithm::initDailyVolume() {
     LOG_INFO("====================================");
@@ -534,7 +620,7 @@ void WaterAlgorithm::initDailyVolume() {
     uint32_t loadedUTCDay = 0;
     uint16_t loadedVolume = 0;
     
-    if (loadDailyVolumeFromFRAM(loadedVolume, loadedUTCDay)) {
+    if (loadDailyVolumeFromFRAM(loadedVolume, loadedUTCDay, channel)) {
         LOG_INFO("FRAM data: %dml, UTC day=%lu", loadedVolume, loadedUTCDay);
         LOG_INFO("Current UTC day: %lu", currentUTCDay);
         
@@ -548,7 +634,7 @@ void WaterAlgorithm::initDailyVolume() {
             LOG_INFO("🔄 Day changed from %lu to %lu", loadedUTCDay, currentUTCDay);
             dailyVolumeML = 0;
             lastResetUTCDay = currentUTCDay;
-            saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay);
+            saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay, channel);
             LOG_INFO("✅ New day - reset to 0ml");
         }
     } else {
@@ -556,7 +642,7 @@ void WaterAlgorithm::initDailyVolume() {
         LOG_INFO("No valid FRAM data - initializing");
         dailyVolumeML = 0;
         lastResetUTCDay = currentUTCDay;
-        saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay);
+        saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay, channel);
         LOG_INFO("✅ Initialized to 0ml");
     }
     
@@ -564,90 +650,155 @@ void WaterAlgorithm::initDailyVolume() {
     LOG_INFO("  dailyVolumeML: %dml", dailyVolumeML);
     LOG_INFO("  lastResetUTCDay: %lu", lastResetUTCDay);
     LOG_INFO("====================================");
+
+    // Today's cycles can only be picked from FRAM once the UTC day is known
+    loadCyclesFromStorage();
+}
+
+// ===============================================
+// RUNTIME PARAMETERS (algorithm_params.h)
+// ===============================================
+
+void WaterAlgorithm::initParams() {
+    AlgorithmParams stored;
+    if (loadAlgorithmParamsFromFRAM(stored)) {
+        params = stored;
+        LOG_INFO("Algorithm params loaded from FRAM");
+    } else {
+        params = getDefaultAlgorithmParams();
+        LOG_INFO("Using default algorithm params");
+    }
+    paramsPending = false;
+
+    LOG_INFO("  TIME_TO_PUMP=%ds TIME_GAP_1_MAX=%ds TIME_GAP_2_MAX=%ds",
+             params.timeToPump, params.timeGap1Max, params.timeGap2Max);
+    LOG_INFO("  THRESHOLDS GAP1=%ds GAP2=%ds WATER=%ds (max %ds)",
+             params.threshold1, params.threshold2, params.thresholdWater, params.waterTriggerMaxTime);
+    LOG_INFO("  Dose %dml, daily limit %dml", params.singleDoseVolume, params.fillWaterMax);
+}
+
+bool WaterAlgorithm::setParams(const AlgorithmParams& newParams, const char** error) {
+    if (!validateAlgorithmParams(newParams, error)) {
+        return false;
+    }
+    // One FRAM block for every channel - channel 0 stores it
+    if (isPrimaryChannel() && !saveAlgorithmParamsToFRAM(newParams)) {
+        if (error != nullptr) *error = "FRAM write failed";
+        return false;
+    }
+
+    pendingParams = newParams;
+    paramsPending = true;
+
+    if (currentState == STATE_IDLE) {
+        applyPendingParams();
+    } else {
+        LOG_INFO("Algorithm params saved - applied when %s returns to IDLE", getStateString());
+    }
+    return true;
+}
+
+void WaterAlgorithm::applyPendingParams() {
+    if (!paramsPending) return;
+
+    params = pendingParams;
+    paramsPending = false;
+    if (isPrimaryChannel()) traceParams(params);
+
+    LOG_INFO("✅ Algorithm params applied: TIME_TO_PUMP=%ds, dose %dml, limit %dml",
+             params.timeToPump, params.singleDoseVolume, params.fillWaterMax);
+}
+
+uint32_t WaterAlgorithm::getNextDeadlineMs() const {
+    // Error LED pattern and reset button need short steps
+    if (errorSignalActive || currentState == STATE_ERROR) {
+        return ERROR_SIGNAL_POLL_MS;
+    }
+
+    uint32_t nowMs = millis();
+    int32_t toDateCheck = (int32_t)(nextDateCheckMs - nowMs);
+    uint32_t wait = (toDateCheck > 0) ? (uint32_t)toDateCheck : 0;
+
+    // Earliest timeout row of the current state - the other rows wait for
+    // events (sensor edge, pump finished, web command)
+    const AlgorithmStateInfo& state = WaterAlgorithmFsm::states[currentState];
+    uint64_t now = uptimeMs();
+    uint64_t timerStartMs = stateTimerStart(currentState) * 1000ULL;  // state timers count whole seconds
+
+    for (uint8_t i = state.firstRow; i < state.firstRow + state.rowCount; i++) {
+        const AlgorithmTransition& row = WaterAlgorithmFsm::rows[i];
+        if (row.trigger != TRIGGER_TICK || row.timeout == TIMEOUT_NONE) continue;
+
+        uint64_t deadlineMs = timerStartMs + timeoutSeconds(row.timeout) * 1000ULL;
+        uint32_t rowWait = (deadlineMs > now) ? (uint32_t)(deadlineMs - now) : 0;
+        if (rowWait < wait) wait = rowWait;
+    }
+    return wait;
 }
 
-void WaterAlgorithm::onSensorStateChange(uint8_t sensorNum, bool triggered) {
-    uint32_t currentTime = getCurrentTimeSeconds(); // <-- ZMIANA: sekundy zamiast millis()
+void WaterAlgorithm::onSensorStateChange(uint8_t sensorNum, bool triggered, uint32_t eventMs) {
+    uint32_t currentTime = (uint32_t)(uptimeFromMillis(eventMs) / 1000); // sekundy - czas zbocza, nie czas obsługi
     
     // Update sensor states
     if (sensorNum == 1) {
         lastSensor1State = triggered;
         if (triggered) {
             sensor1TriggerTime = currentTime;
+            sensor1TriggerMs = eventMs;
         } else {
             sensor1ReleaseTime = currentTime;
+            sensor1ReleaseMs = eventMs;
         }
     } else if (sensorNum == 2) {
         lastSensor2State = triggered;
         if (triggered) {
             sensor2TriggerTime = currentTime;
+            sensor2TriggerMs = eventMs;
         } else {
             sensor2ReleaseTime = currentTime;
+            sensor2ReleaseMs = eventMs;
         }
     }
     
-    // Handle state transitions based on sensor changes
-    switch (currentState) {
-        case STATE_IDLE:
-            if (triggered && (lastSensor1State || lastSensor2State)) {
-                // TRIGGER detected!
-                LOG_INFO("TRIGGER detected! Starting TRYB_1");
-                triggerStartTime = currentTime;
-                currentCycle.trigger_time = currentTime;
-                currentState = STATE_TRYB_1_WAIT;
-                stateStartTime = currentTime;
-                waitingForSecondSensor = true;
-            }
-            break;
-            
-        case STATE_TRYB_1_WAIT:
-            if (waitingForSecondSensor && sensor1TriggerTime && sensor2TriggerTime) {
-                // Both sensors triggered, calculate TIME_GAP_1
-                calculateTimeGap1();
-                waitingForSecondSensor = false;
-                
-                // Evaluate result
-                if (sensor_time_match_function(currentCycle.time_gap_1, THRESHOLD_1)) {
-                    currentCycle.sensor_results |= PumpCycle::RESULT_GAP1_FAIL;
-                }
-                
-                // Continue waiting for TIME_TO_PUMP
-                currentState = STATE_TRYB_1_DELAY;
-                stateStartTime = currentTime;
-                LOG_INFO("TRYB_1: Both sensors triggered, TIME_GAP_1=%ds", 
-                        currentCycle.time_gap_1);
-            }
-            break;
-            
-        case STATE_TRYB_2_WAIT_GAP2:
-            if (!triggered && waitingForSecondSensor && 
-                sensor1ReleaseTime && sensor2ReleaseTime) {
-                // Both sensors released, calculate TIME_GAP_2
-                calculateTimeGap2();
-                waitingForSecondSensor = false;
-                LOG_INFO("TRYB_2: TIME_GAP_2=%dms", currentCycle.time_gap_2);
-            }
-            break;
-            
-        default:
-            // Ignore sensor changes in other states
-            break;
+    // Sensor rows of the current state (algorithm_transitions.h)
+    lastEdgeTriggered = triggered;
+    fireTransition(TRIGGER_SENSOR, currentTime);
+}
+
+// 0 unless both edges were captured with ms timestamps. Modular difference,
+// so a gap across the millis() wrap (49.7 days) is still the real gap
+uint32_t WaterAlgorithm::edgeGapMs(uint32_t s1Ms, uint32_t s2Ms) {
+    if (s1Ms == 0 || s2Ms == 0) return 0;
+    uint32_t d = s2Ms - s1Ms;
+    return (int32_t)d < 0 ? (uint32_t)-d : d;
+}
+
+// Gap between the two sensors' edges. Whole seconds (floor) are stored, so
+// gap >= threshold holds exactly when gapMs >= threshold * 1000.
+uint32_t WaterAlgorithm::measureGapSeconds(uint32_t s1Ms, uint32_t s2Ms, uint32_t s1Sec, uint32_t s2Sec,
+                                           uint32_t& gapMs) const {
+    if (s1Ms && s2Ms) {
+        gapMs = edgeGapMs(s1Ms, s2Ms);
+    } else {
+        gapMs = abs((int32_t)s2Sec - (int32_t)s1Sec) * 1000;
     }
+    return gapMs / 1000;
 }
 
 void WaterAlgorithm::calculateTimeGap1() {
     if (sensor1TriggerTime && sensor2TriggerTime) {
-        currentCycle.time_gap_1 = abs((int32_t)sensor2TriggerTime - 
-                                      (int32_t)sensor1TriggerTime);
+        uint32_t gapMs;
+        currentCycle.time_gap_1 = measureGapSeconds(sensor1TriggerMs, sensor2TriggerMs,
+                                                    sensor1TriggerTime, sensor2TriggerTime, gapMs);
         
         // Wywołaj funkcję oceniającą zgodnie ze specyfikacją
-        uint8_t result = sensor_time_match_function(currentCycle.time_gap_1, THRESHOLD_1);
+        uint8_t result = sensor_time_match_function(currentCycle.time_gap_1, params.threshold1);
         if (result == 1) {
             currentCycle.sensor_results |= PumpCycle::RESULT_GAP1_FAIL;
         }
         
-        LOG_INFO("TIME_GAP_1: %ds, result: %d (threshold: %ds)", 
-                currentCycle.time_gap_1, result, THRESHOLD_1);
+        LOG_INFO("TIME_GAP_1: %lums, result: %d (threshold: %ds)", 
+                gapMs, result, params.threshold1);
     } else {
         LOG_WARNING("TIME_GAP_1 not calculated: s1Time=%ds, s2Time=%ds", 
                    sensor1TriggerTime, sensor2TriggerTime);
@@ -656,18 +807,18 @@ void WaterAlgorithm::calculateTimeGap1() {
 
 void WaterAlgorithm::calculateTimeGap2() {
     if (sensor1ReleaseTime && sensor2ReleaseTime) {
-        // Oblicz różnicę w sekundach (bez dzielenia przez 1000!)
-        currentCycle.time_gap_2 = abs((int32_t)sensor2ReleaseTime - 
-                                      (int32_t)sensor1ReleaseTime);
+        uint32_t gapMs;
+        currentCycle.time_gap_2 = measureGapSeconds(sensor1ReleaseMs, sensor2ReleaseMs,
+                                                    sensor1ReleaseTime, sensor2ReleaseTime, gapMs);
         
         // Wywołaj funkcję oceniającą zgodnie ze specyfikacją
-        uint8_t result = sensor_time_match_function(currentCycle.time_gap_2, THRESHOLD_2);
+        uint8_t result = sensor_time_match_function(currentCycle.time_gap_2, params.threshold2);
         if (result == 1) {
             currentCycle.sensor_results |= PumpCycle::RESULT_GAP2_FAIL;
         }
         
-        LOG_INFO("TIME_GAP_2: %ds, result: %d (threshold: %ds)", 
-                currentCycle.time_gap_2, result, THRESHOLD_2);
+        LOG_INFO("TIME_GAP_2: %lums, result: %d (threshold: %ds)", 
+                gapMs, result, params.threshold2);
     } else {
         LOG_WARNING("TIME_GAP_2 not calculated: s1Release=%ds, s2Release=%ds", 
                    sensor1ReleaseTime, sensor2ReleaseTime);
@@ -691,24 +842,24 @@ void WaterAlgorithm::calculateWaterTrigger() {
         currentCycle.water_trigger_time = earliestRelease - pumpStartTime;
         
         // Sanity check
-        if (currentCycle.water_trigger_time > WATER_TRIGGER_MAX_TIME) {
-            currentCycle.water_trigger_time = WATER_TRIGGER_MAX_TIME;
+        if (currentCycle.water_trigger_time > params.waterTriggerMaxTime) {
+            currentCycle.water_trigger_time = params.waterTriggerMaxTime;
         }
         
         LOG_INFO("WATER_TRIGGER_TIME: %ds", currentCycle.water_trigger_time);
         
         // Evaluate result
-        if (sensor_time_match_function(currentCycle.water_trigger_time, THRESHOLD_WATER)) {
+        if (sensor_time_match_function(currentCycle.water_trigger_time, params.thresholdWater)) {
             currentCycle.sensor_results |= PumpCycle::RESULT_WATER_FAIL;
         }
     } else {
         // No valid release detected
-        currentCycle.water_trigger_time = WATER_TRIGGER_MAX_TIME;
+        currentCycle.water_trigger_time = params.waterTriggerMaxTime;
         currentCycle.sensor_results |= PumpCycle::RESULT_WATER_FAIL;
         LOG_WARNING("No sensor release detected after pump start");
     }
 
-        if (currentCycle.water_trigger_time >= THRESHOLD_WATER) {
+        if (currentCycle.water_trigger_time >= params.thresholdWater) {
         waterFailDetected = true;
         LOG_INFO("WATER fail detected in successful attempt");
     }
@@ -766,45 +917,47 @@ void WaterAlgorithm::logCycleComplete() {
         LOG_INFO("Final WATER fail flag set due to timeout in any attempt");
     }
     
+    // Cycle timestamp = unix time of the trigger (retention compares it against RTC time)
+    uint32_t unixTime = getUnixTimestamp();
+    uint32_t cycleAge = currentCycle.trigger_time ? getCurrentTimeSeconds() - currentCycle.trigger_time : 0;
+    currentCycle.timestamp = unixTime - cycleAge;
+
     // Add to daily volume (use actual volume, not fixed SINGLE_DOSE_VOLUME)
     dailyVolumeML += actualVolumeML;
 
-    if (!saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay)) {
-        LOG_WARNING("⚠️ Failed to save daily volume to FRAM");
-    }
+    // Store in today's cycles (RAM ring - oldest dropped, FRAM keeps more)
+    todayCycles.push(currentCycle);
     
-    // Store in today's cycles (RAM)
-    todayCycles.push_back(currentCycle);
-    
-    // Keep only last 50 cycles in RAM (FRAM will store more)
-    if (todayCycles.size() > 50) {
-        todayCycles.erase(todayCycles.begin());
-    }
-    
-    // Save cycle to FRAM (for debugging and history)
-    saveCycleToStorage(currentCycle);
-    
-    // *** Update error statistics in FRAM ***
     uint8_t gap1_increment = (currentCycle.sensor_results & PumpCycle::RESULT_GAP1_FAIL) ? 1 : 0;
     uint8_t gap2_increment = (currentCycle.sensor_results & PumpCycle::RESULT_GAP2_FAIL) ? 1 : 0;
     uint8_t water_increment = (currentCycle.sensor_results & PumpCycle::RESULT_WATER_FAIL) ? 1 : 0;
     
-    if (gap1_increment || gap2_increment || water_increment) {
-        if (incrementErrorStats(gap1_increment, gap2_increment, water_increment)) {
+    // *** Cycle record, daily volume and error stats - one atomic FRAM commit ***
+    if (commitCycleToFRAM(currentCycle, dailyVolumeML, lastResetUTCDay,
+                          gap1_increment, gap2_increment, water_increment, channel)) {
+        if (gap1_increment || gap2_increment || water_increment) {
             LOG_INFO("Error stats updated: GAP1+%d, GAP2+%d, WATER+%d", 
                     gap1_increment, gap2_increment, water_increment);
-        } else {
-            LOG_WARNING("Failed to update error stats in FRAM");
         }
+        runPeriodicFRAMCleanup();
+    } else {
+        LOG_ERROR("Failed to commit cycle to FRAM");
     }
     
+    if (isPrimaryChannel()) {
+        traceCycle(currentCycle);
 
-    uint32_t unixTime = getUnixTimestamp();
-    
-    if (logCycleToVPS(currentCycle, unixTime)) {
-        LOG_INFO("Cycle data sent to VPS successfully");
+        adaptiveDelayAddCycle(currentCycle, params);
+
+        // Flow estimator wants the ms edge gaps - the record only keeps whole seconds
+        flowEstimatorAddCycle(currentCycle, edgeGapMs(sensor1TriggerMs, sensor2TriggerMs),
+                              edgeGapMs(sensor1ReleaseMs, sensor2ReleaseMs));
+    }
+
+    if (logCycleToVPS(currentCycle, unixTime, channel)) {
+        LOG_INFO("Cycle data queued for VPS");
     } else {
-        LOG_WARNING("Failed to send cycle data to VPS");
+        LOG_WARNING("Failed to queue cycle data for VPS");
     }
     
     LOG_INFO("=== CYCLE COMPLETE ===");
@@ -812,14 +965,14 @@ void WaterAlgorithm::logCycleComplete() {
     LOG_INFO("TIME_GAP_1: %ds (fail=%d)", currentCycle.time_gap_1, gap1_increment);
     LOG_INFO("TIME_GAP_2: %ds (fail=%d)", currentCycle.time_gap_2, gap2_increment);
     LOG_INFO("WATER_TRIGGER_TIME: %ds (fail=%d)", currentCycle.water_trigger_time, water_increment);
-    LOG_INFO("Daily volume: %dml / %dml", dailyVolumeML, FILL_WATER_MAX);
+    LOG_INFO("Daily volume: %dml / %dml", dailyVolumeML, params.fillWaterMax);
 }
 
 bool WaterAlgorithm::requestManualPump(uint16_t duration_ms) {
 
-    if (dailyVolumeML >= FILL_WATER_MAX) {
+    if (dailyVolumeML >= params.fillWaterMax) {
         LOG_ERROR("❌ Manual pump blocked: Daily limit reached (%dml / %dml)", 
-                  dailyVolumeML, FILL_WATER_MAX);
+                  dailyVolumeML, params.fillWaterMax);
         return false;  // Block manual pump when limit reached
     }
 
@@ -841,8 +994,7 @@ bool WaterAlgorithm::requestManualPump(uint16_t duration_ms) {
         } else {
             // Manual interrupt w innych stanach
             LOG_INFO("Manual pump interrupting current cycle");
-            currentState = STATE_MANUAL_OVERRIDE;
-            resetCycle();
+            enterState(STATE_MANUAL_OVERRIDE, getCurrentTimeSeconds());
         }
     }
     
@@ -852,36 +1004,24 @@ bool WaterAlgorithm::requestManualPump(uint16_t duration_ms) {
 void WaterAlgorithm::onManualPumpComplete() {
     if (currentState == STATE_MANUAL_OVERRIDE) {
         LOG_INFO("Manual pump complete, returning to IDLE");
-        currentState = STATE_IDLE;
-        resetCycle();
+        enterState(STATE_IDLE, getCurrentTimeSeconds());
     }
 }
 
 const char* WaterAlgorithm::getStateString() const {
-    switch (currentState) {
-        case STATE_IDLE: return "IDLE";
-        case STATE_TRYB_1_WAIT: return "TRYB_1_WAIT";
-        case STATE_TRYB_1_DELAY: return "TRYB_1_DELAY";
-        case STATE_TRYB_2_PUMP: return "TRYB_2_PUMP";
-        case STATE_TRYB_2_VERIFY: return "TRYB_2_VERIFY";
-        case STATE_TRYB_2_WAIT_GAP2: return "TRYB_2_WAIT_GAP2";
-        case STATE_LOGGING: return "LOGGING";
-        case STATE_ERROR: return "ERROR";
-        case STATE_MANUAL_OVERRIDE: return "MANUAL_OVERRIDE";
-        default: return "UNKNOWN";
-    }
+    return WaterAlgorithmFsm::states[currentState].name;
 }
 
 bool WaterAlgorithm::isInCycle() const {
     return currentState != STATE_IDLE && currentState != STATE_ERROR;
 }
 
-std::vector<PumpCycle> WaterAlgorithm::getRecentCycles(size_t count) {
-    size_t start = todayCycles.size() > count ? todayCycles.size() - count : 0;
-    return std::vector<PumpCycle>(todayCycles.begin() + start, todayCycles.end());
+CycleHistory::View WaterAlgorithm::getRecentCycles(size_t count) const {
+    return todayCycles.last(count);
 }
 
 void WaterAlgorithm::startErrorSignal(ErrorCode error) {
+    if (isPrimaryChannel()) traceRecord(TRACE_ERROR, error);
     lastError = error;
     errorSignalActive = true;
     errorSignalStart = millis();
@@ -895,8 +1035,16 @@ void WaterAlgorithm::startErrorSignal(ErrorCode error) {
              error == ERROR_PUMP_FAILURE ? "ERR2" : "ERR0");
 }
 
+// ERROR_SIGNAL_PIN is shared - the lowest channel in error drives it
+bool WaterAlgorithm::ownsErrorSignal() const {
+    for (uint8_t ch = 0; ch < channel; ch++) {
+        if (waterChannels[ch].errorSignalActive) return false;
+    }
+    return true;
+}
+
 void WaterAlgorithm::updateErrorSignal() {
-    if (!errorSignalActive) return;
+    if (!errorSignalActive || !ownsErrorSignal()) return;
     
     uint32_t elapsed = millis() - errorSignalStart;
     uint8_t pulsesNeeded = (lastError == ERROR_DAILY_LIMIT) ? 1 :
@@ -936,32 +1084,40 @@ void WaterAlgorithm::resetFromError() {
     errorSignalActive = false;
     pinMode(ERROR_SIGNAL_PIN, OUTPUT);
     digitalWrite(ERROR_SIGNAL_PIN, LOW);
-    currentState = STATE_IDLE;
-    resetCycle();
+    if (currentState == STATE_ERROR) {
+        enterState(STATE_IDLE, getCurrentTimeSeconds());
+    }
     LOG_INFO("System reset from error state");
 }
 
 void WaterAlgorithm::loadCyclesFromStorage() {
     LOG_INFO("Loading cycles from FRAM...");
     
-    // Load recent cycles from FRAM
-    if (loadCyclesFromFRAM(framCycles, 200)) { // Load max 200 cycles
+    // Walk the FRAM ring lazily - burst-read window, not the whole history
+    unsigned long startUs = micros();
+    FRAMCycleCursor cursor(channel);
+    if (isFRAMAvailable()) {
         framDataLoaded = true;
-        LOG_INFO("Loaded %d cycles from FRAM", framCycles.size());
-
+        LOG_INFO("Found %d cycles in FRAM", cursor.size());
 
         LOG_INFO("Daily volume already loaded from FRAM: %dml", dailyVolumeML);
 
-                // Just load today's cycles for display
-        uint32_t todayStart = (millis() / 1000) - (millis() / 1000) % 86400;
-        
-        for (const auto& cycle : framCycles) {
+        // Just load today's cycles for display (same UTC day as daily volume)
+        uint32_t todayStart = lastResetUTCDay * 86400UL;
+
+        todayCycles.clear();
+        PumpCycle cycle;
+        while (cursor.next(cycle)) {
             if (cycle.timestamp >= todayStart) {
-                todayCycles.push_back(cycle);
+                todayCycles.push(cycle);
             }
         }
         
-        LOG_INFO("Loaded %d cycles from today", todayCycles.size());
+ 
+        uint32_t elapsedUs = micros() - startUs;
+        recordCycleLoad(elapsedUs, cursor.size());
+        LOG_INFO("Loaded %d cycles from today (%d scanned in %luus)",
+                 todayCycles.size(), cursor.size(), elapsedUs);
         
     } else {
         LOG_WARNING("Failed to load cycles from FRAM, starting fresh");
@@ -970,43 +1126,36 @@ void WaterAlgorithm::loadCyclesFromStorage() {
 }
 
 void WaterAlgorithm::saveCycleToStorage(const PumpCycle& cycle) {
-    if (saveCycleToFRAM(cycle)) {
+    if (saveCycleToFRAM(cycle, channel)) {
         LOG_INFO("Cycle saved to FRAM successfully");
-        
-        // Add to framCycles for immediate access
-        framCycles.push_back(cycle);
-        
-        // Keep framCycles size reasonable
-        if (framCycles.size() > 200) {
-            framCycles.erase(framCycles.begin());
-        }
-        
-        // Periodic cleanup of old data (once per day)
-        if (millis() - lastFRAMCleanup > 86400000UL) { // 24 hours
-            clearOldCyclesFromFRAM(14); // Keep 14 days
-            lastFRAMCleanup = millis();
-            loadCyclesFromStorage(); // Reload after cleanup
-            LOG_INFO("FRAM cleanup completed");
-        }
+        runPeriodicFRAMCleanup();
     } else {
         LOG_ERROR("Failed to save cycle to FRAM");
     }
 }
 
+void WaterAlgorithm::runPeriodicFRAMCleanup() {
+    // Periodic cleanup of old data (once per day)
+    if (millis() - lastFRAMCleanup > 86400000UL) { // 24 hours
+        clearOldCyclesFromFRAM(14, channel); // Keep 14 days
+        lastFRAMCleanup = millis();
+        LOG_INFO("FRAM cleanup completed");
+    }
+}
+
 bool WaterAlgorithm::resetErrorStatistics() {
-    bool success = resetErrorStatsInFRAM();
+    bool success = resetErrorStatsInFRAM(channel);
     if (success) {
         LOG_INFO("Error statistics reset requested via web interface");
         
-        // ✅ PRZYWRÓĆ VPS logging z short timeout (3 seconds max)
+        // Queued - the uplink task sends it without blocking the web handler
         uint32_t unixTime = getUnixTimestamp();
-        String timestamp = getCurrentTimestamp();
-        bool vpsSuccess = logEventToVPS("STATISTICS_RESET", 0, unixTime);
+        bool vpsSuccess = logEventToVPS("STATISTICS_RESET", 0, unixTime, channel);
         
         if (vpsSuccess) {
-            LOG_INFO("✅ Statistics reset + VPS logging: SUCCESS");
+            LOG_INFO("✅ Statistics reset + VPS event queued");
         } else {
-            LOG_WARNING("⚠️ Statistics reset: SUCCESS, VPS logging: FAILED (non-critical)");
+            LOG_WARNING("⚠️ Statistics reset: SUCCESS, VPS queueing: FAILED (non-critical)");
         }
     }
     return success;
@@ -1014,7 +1163,7 @@ bool WaterAlgorithm::resetErrorStatistics() {
 
 bool WaterAlgorithm::getErrorStatistics(uint16_t& gap1_sum, uint16_t& gap2_sum, uint16_t& water_sum, uint32_t& last_reset) {
     ErrorStats stats;
-    bool success = loadErrorStatsFromFRAM(stats);
+    bool success = loadErrorStatsFromFRAM(stats, channel);
     
     if (success) {
         gap1_sum = stats.gap1_fail_sum;
@@ -1035,22 +1184,24 @@ void WaterAlgorithm::addManualVolume(uint16_t volumeML) {
     // dailyVolumeML += volumeML;    //############################################################################################################################################
     
     // Save to FRAM
-    if (!saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay)) {
+    if (!saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay, channel)) {
         LOG_WARNING("⚠️ Failed to save daily volume to FRAM after manual pump");
     }
     
     LOG_INFO("✅ Manual volume added: +%dml → Total: %dml / %dml", 
-             volumeML, dailyVolumeML, FILL_WATER_MAX);
+             volumeML, dailyVolumeML, params.fillWaterMax);
     
     // 🆕 NEW: Check if limit exceeded after manual pump
-    if (dailyVolumeML >= FILL_WATER_MAX) {
+    if (dailyVolumeML >= params.fillWaterMax) {
         LOG_ERROR("❌ Daily limit reached after manual pump: %dml / %dml", 
-                  dailyVolumeML, FILL_WATER_MAX);
+                  dailyVolumeML, params.fillWaterMax);
         
         // Trigger error state
         currentCycle.error_code = ERROR_DAILY_LIMIT;
         startErrorSignal(ERROR_DAILY_LIMIT);
-        currentState = STATE_ERROR;
+        if (currentState != STATE_ERROR) {
+            enterState(STATE_ERROR, getCurrentTimeSeconds());
+        }
         
         LOG_ERROR("System entering ERROR state - press reset button to clear");
     }
@@ -1091,23 +1242,15 @@ void WaterAlgorithm::checkResetButton() {
             buttonPressed = false;
             LOG_INFO("🔘 Reset button released");
             
-            // Sprawdź czy system jest w stanie błędu
-            if (currentState == STATE_ERROR) {
-                LOG_INFO("====================================");
-                LOG_INFO("✅ RESET FROM ERROR STATE");
-                LOG_INFO("====================================");
-                LOG_INFO("Previous error: %s", 
-                         lastError == ERROR_DAILY_LIMIT ? "ERR1 (Daily Limit)" :
-                         lastError == ERROR_PUMP_FAILURE ? "ERR2 (Pump Failure)" : 
-                         "ERR0 (Both)");
-                
-                // Wywołaj reset z błędu
-                resetFromError();
-                
-                LOG_INFO("System state: %s", getStateString());
-                LOG_INFO("Error signal: CLEARED");
-                LOG_INFO("====================================");
-                
+            // Jeden przycisk dla wszystkich kanałów - kasuje każdy błąd
+            bool cleared = false;
+            for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+                if (waterChannels[ch].clearErrorFromButton()) {
+                    cleared = true;
+                }
+            }
+
+            if (cleared) {
                 // Visual feedback - krótkie mignięcie LED (potwierdzenie)
                 digitalWrite(ERROR_SIGNAL_PIN, HIGH);
                 delay(100);
@@ -1128,6 +1271,28 @@ void WaterAlgorithm::checkResetButton() {
     lastButtonState = currentButtonState;
 }
 
+bool WaterAlgorithm::clearErrorFromButton() {
+    // Sprawdź czy kanał jest w stanie błędu
+    if (currentState != STATE_ERROR) return false;
+
+    LOG_INFO("====================================");
+    LOG_INFO("✅ RESET FROM ERROR STATE (channel %d)", channel);
+    LOG_INFO("====================================");
+    LOG_INFO("Previous error: %s", 
+             lastError == ERROR_DAILY_LIMIT ? "ERR1 (Daily Limit)" :
+             lastError == ERROR_PUMP_FAILURE ? "ERR2 (Pump Failure)" : 
+             "ERR0 (Both)");
+    
+    // Wywołaj reset z błędu
+    if (isPrimaryChannel()) traceRecord(TRACE_COMMAND, TRACE_CMD_RESET_BUTTON);
+    resetFromError();
+    
+    LOG_INFO("System state: %s", getStateString());
+    LOG_INFO("Error signal: CLEARED");
+    LOG_INFO("====================================");
+    return true;
+}
+
 bool WaterAlgorithm::resetDailyVolume() {
     LOG_INFO("====================================");
     LOG_INFO("MANUAL DAILY VOLUME RESET REQUESTED");
@@ -1135,7 +1300,7 @@ bool WaterAlgorithm::resetDailyVolume() {
     LOG_INFO("Previous volume: %dml", dailyVolumeML);
     LOG_INFO("Current UTC day: %lu", lastResetUTCDay);
     
-    if (isPumpActive()) {
+    if (isPumpActive(channel)) {
         LOG_WARNING("❌ Reset blocked - pump is active");
         return false;
     }
@@ -1143,7 +1308,7 @@ bool WaterAlgorithm::resetDailyVolume() {
     dailyVolumeML = 0;
     todayCycles.clear();
     
-    if (!saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay)) {
+    if (!saveDailyVolumeToFRAM(dailyVolumeML, lastResetUTCDay, channel)) {
         LOG_ERROR("⚠️ Failed to save reset volume to FRAM");
         return false;
     }
@@ -1152,14 +1317,14 @@ bool WaterAlgorithm::resetDailyVolume() {
     LOG_INFO("UTC day remains: %lu", lastResetUTCDay);
     LOG_INFO("====================================");
     
-    // Log to VPS
+    // Queue for VPS
     uint32_t unixTime = getUnixTimestamp();
-    bool vpsSuccess = logEventToVPS("STATISTICS_RESET", 0, unixTime);
+    bool vpsSuccess = logEventToVPS("STATISTICS_RESET", 0, unixTime, channel);
     
     if (vpsSuccess) {
-        LOG_INFO("✅ Volume reset + VPS logging: SUCCESS");
+        LOG_INFO("✅ Volume reset + VPS event queued");
     } else {
-        LOG_WARNING("⚠️ Volume reset: SUCCESS, VPS logging: FAILED (non-critical)");
+        LOG_WARNING("⚠️ Volume reset: SUCCESS, VPS queueing: FAILED (non-critical)");
     }
     
     return true;
@@ -1230,39 +1395,39 @@ uint32_t WaterAlgorithm::getRemainingSeconds() const {
         case STATE_TRYB_1_WAIT:
             // Waiting for second sensor (TIME_GAP_1_MAX)
             elapsed = currentTime - stateStartTime;
-            if (elapsed >= TIME_GAP_1_MAX) {
+            if (elapsed >= params.timeGap1Max) {
                 return 0;
             }
-            return TIME_GAP_1_MAX - elapsed;
+            return params.timeGap1Max - elapsed;
             
         case STATE_TRYB_1_DELAY:
             // Waiting from TRIGGER to pump start (TIME_TO_PUMP)
             elapsed = currentTime - triggerStartTime;
-            if (elapsed >= TIME_TO_PUMP) {
+            if (elapsed >= cycleTimeToPump) {
                 return 0;
             }
-            return TIME_TO_PUMP - elapsed;
+            return cycleTimeToPump - elapsed;
             
         case STATE_TRYB_2_PUMP:
             // Pump is running - return pump remaining time
             // Use getPumpRemainingTime() from pump_controller
-            return getPumpRemainingTime();
+            return getPumpRemainingTime(channel);
             
         case STATE_TRYB_2_VERIFY:
             // Waiting for sensors to respond (WATER_TRIGGER_MAX_TIME)
             elapsed = currentTime - pumpStartTime;
-            if (elapsed >= WATER_TRIGGER_MAX_TIME) {
+            if (elapsed >= params.waterTriggerMaxTime) {
                 return 0;
             }
-            return WATER_TRIGGER_MAX_TIME - elapsed;
+            return params.waterTriggerMaxTime - elapsed;
             
         case STATE_TRYB_2_WAIT_GAP2:
             // Waiting for TIME_GAP_2 measurement
             elapsed = currentTime - stateStartTime;
-            if (elapsed >= TIME_GAP_2_MAX) {
+            if (elapsed >= params.timeGap2Max) {
                 return 0;
             }
-            return TIME_GAP_2_MAX - elapsed;
+            return params.timeGap2Max - elapsed;
             
         default:
             return 0;
@@ -4,8 +4,17 @@
 #define WATER_ALGORITHM_H
 
 #include "algorithm_config.h"
+#include "algorithm_fsm.h"
+#include "algorithm_params.h"
 #include "../hardware/fram_controller.h"
-#include <vector>
+#include "../hardware/hardware_pins.h"
+#include "../core/ring_buffer.h"
+#include "../core/uptime.h"
+
+// Cycles kept in RAM - older history is read lazily from FRAM (FRAMCycleCursor)
+#define RAM_CYCLE_HISTORY       50
+
+typedef RingBuffer<PumpCycle, RAM_CYCLE_HISTORY> CycleHistory;
 
 // extern uint32_t getPumpRemainingTime();  // z pump_controller.h
 // extern bool readWaterSensor1();          // z water_sensors.h  
@@ -13,10 +22,19 @@
 
 class WaterAlgorithm
 {
+    friend struct WaterAlgorithmFsm;   // transition table (algorithm_transitions.h)
+
 private:
+    uint8_t channel;            // Water channel: pins, pump, FRAM partition (hardware_pins.h)
     AlgorithmState currentState;
     PumpCycle currentCycle;
 
+    // Runtime parameters - pending values wait for the next IDLE
+    AlgorithmParams params;
+    AlgorithmParams pendingParams;
+    bool paramsPending;
+    uint16_t cycleTimeToPump;   // TIME_TO_PUMP of the running cycle (adaptive_delay.h)
+
     // Timing variables
     uint32_t stateStartTime;
     uint32_t triggerStartTime;
@@ -24,15 +42,18 @@ private:
     uint32_t sensor2TriggerTime;
     uint32_t sensor1ReleaseTime;
     uint32_t sensor2ReleaseTime;
+    // Edge times in ms (millis() base) - gaps are measured from these
+    uint32_t sensor1TriggerMs;
+    uint32_t sensor2TriggerMs;
+    uint32_t sensor1ReleaseMs;
+    uint32_t sensor2ReleaseMs;
     uint32_t pumpStartTime;
     uint32_t lastPumpTime;
-    bool permission_log;
     bool systemWasDisabled;
 
     bool waterFailDetected = false;
 
     // FRAM cycle management
-    std::vector<PumpCycle> framCycles;
     uint32_t lastFRAMCleanup;
     bool framDataLoaded;
 
@@ -40,11 +61,9 @@ private:
     bool lastSensor1State;
     bool lastSensor2State;
     bool waitingForSecondSensor;
+    bool lastEdgeTriggered;     // Edge being handled by TRIGGER_SENSOR rows
     uint8_t pumpAttempts;
 
-    // State control flags
-    bool cycleLogged;
-
     // Error handling
     ErrorCode lastError;
     bool errorSignalActive;
@@ -53,45 +72,101 @@ private:
     bool errorPulseState;
 
     // Daily volume tracking
-    std::vector<PumpCycle> todayCycles;
+    CycleHistory todayCycles;
     uint32_t dayStartTime;
     uint16_t dailyVolumeML;
     uint32_t lastResetUTCDay;
     bool resetPending;
+    uint32_t nextDateCheckMs;
 
     // Private methods
     void resetCycle();
     void calculateTimeGap1();
     void calculateTimeGap2();
+    static uint32_t edgeGapMs(uint32_t s1Ms, uint32_t s2Ms);
+    uint32_t measureGapSeconds(uint32_t s1Ms, uint32_t s2Ms, uint32_t s1Sec, uint32_t s2Sec, uint32_t& gapMs) const;
     void calculateWaterTrigger();
     void logCycleComplete();
     uint16_t calculateDailyVolume();
     void startErrorSignal(ErrorCode error);
     void updateErrorSignal();
+    bool ownsErrorSignal() const;
     void checkResetButton();
+    bool clearErrorFromButton();
+
+    // Trace/replay and the learning modules (adaptive delay, flow
+    // estimator) follow channel 0 - trace records carry no channel
+    bool isPrimaryChannel() const { return channel == 0; }
 
     // FRAM integration methods
     void loadCyclesFromStorage();
     void saveCycleToStorage(const PumpCycle &cycle);
+    void runPeriodicFRAMCleanup();
+    void checkUTCDayChange();
+
+    // State machine (rows in algorithm_transitions.h)
+    bool fireTransition(TransitionTrigger trigger, uint32_t now);
+    void enterState(AlgorithmState next, uint32_t now);
+    uint32_t stateTimerStart(AlgorithmState state) const;
+    uint16_t timeoutSeconds(AlgorithmTimeout timeout) const;
+    void applyPendingParams();
+    void logPumpTimeout(uint32_t now);
+
+    // Guards
+    bool guardTriggerEdge(uint32_t now) const;
+    bool guardBothTriggered(uint32_t now) const;
+    bool guardPumpStopped(uint32_t now) const;
+    bool guardSensorsClear(uint32_t now) const;
+    bool guardSensorsClearForGap2(uint32_t now) const;
+    bool guardPumpAttemptsLeft(uint32_t now) const;
+    bool guardBothReleased(uint32_t now) const;
+    bool guardDailyLimitExceeded(uint32_t now) const;
+
+    // Actions
+    void actStartTryb1(uint32_t now);
+    void actGap1Measured(uint32_t now);
+    void actGap1Timeout(uint32_t now);
+    void actStartPump(uint32_t now);
+    void actPumpFinished(uint32_t now);
+    void actPumpOverrun(uint32_t now);
+    void actWaterConfirmed(uint32_t now);
+    void actWaterConfirmedGap2(uint32_t now);
+    void actRetryPump(uint32_t now);
+    void actPumpFailure(uint32_t now);
+    void actGap2Measured(uint32_t now);
+    void actGap2Timeout(uint32_t now);
+    void actDailyLimitError(uint32_t now);
+    void actCycleDone(uint32_t now);
+
+    // State entry
+    void enterClearCycle(uint32_t now);
+    void enterLogging(uint32_t now);
 
 public:
-    WaterAlgorithm();
+    explicit WaterAlgorithm(uint8_t channel = 0);
+
+    uint8_t getChannel() const { return channel; }
 
     // 🆕 NEW: Initialize daily volume AFTER RTC is ready
     void initDailyVolume();
 
     bool resetDailyVolume();
 
-    uint32_t getCurrentTimeSeconds() const { return millis() / 1000; }
+    uint32_t getCurrentTimeSeconds() const { return uptimeSeconds(); }   // no jump at the millis() wrap
 
     void handleSystemDisable();
     bool isSystemDisabled() const;
 
-    // Main algorithm update - call this from loop()
+    // Main algorithm update - call from the control step (algorithm task or loop())
     void update();
 
-    // Sensor inputs
-    void onSensorStateChange(uint8_t sensorNum, bool triggered);
+    // ms until update() has time-based work to do (state timeout, UTC day
+    // check, error LED pulse). Sensor edges and pump stops arrive as events.
+    uint32_t getNextDeadlineMs() const;
+
+    // Sensor inputs - eventMs is the debounced edge time (millis() base)
+    void onSensorStateChange(uint8_t sensorNum, bool triggered, uint32_t eventMs);
+    void onSensorStateChange(uint8_t sensorNum, bool triggered) { onSensorStateChange(sensorNum, triggered, millis()); }
 
     // Status and data access
     AlgorithmState getState() const { return currentState; }
@@ -100,8 +175,8 @@ public:
     uint16_t getDailyVolume() const { return dailyVolumeML; }
     ErrorCode getLastError() const { return lastError; }
 
-    // Get recent cycles for debugging
-    std::vector<PumpCycle> getRecentCycles(size_t count = 10);
+    // Get recent cycles for debugging (view into RAM history, no copy)
+    CycleHistory::View getRecentCycles(size_t count = 10) const;
 
     // ============== UI STATUS GETTERS ==============
     uint8_t getPumpAttempts() const { return pumpAttempts; }
@@ -121,9 +196,20 @@ public:
 
     uint32_t getLastResetUTCDay() const { return lastResetUTCDay; }
 
+    // ============== RUNTIME PARAMETERS ==============
+    // Load the FRAM copy - call after initFRAM()
+    void initParams();
+    const AlgorithmParams& getParams() const { return params; }
+    const AlgorithmParams& getPendingParams() const { return paramsPending ? pendingParams : params; }
+    bool hasPendingParams() const { return paramsPending; }
+    // Validate + save to FRAM; applied now in IDLE, otherwise on the next IDLE
+    bool setParams(const AlgorithmParams& newParams, const char** error = nullptr);
+
     void addManualVolume(uint16_t volumeML);
 };
 
-extern WaterAlgorithm waterAlgorithm;
+// One algorithm per water channel; waterAlgorithm = channel 0
+extern WaterAlgorithm waterChannels[WATER_CHANNEL_COUNT];
+extern WaterAlgorithm& waterAlgorithm;
 
 #endif
\ No newline at end of file
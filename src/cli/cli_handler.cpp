@@ -7,6 +7,8 @@
 #include "../crypto/fram_encryption.h"
 #include "../hardware/rtc_controller.h"
 #include "../core/logging.h"
+#include "../crypto/crc.h"
+#include "../algorithm/algorithm_params.h"
 #include <ArduinoJson.h>
 #include <Wire.h>
 
@@ -66,6 +68,8 @@ CLICommand parseCommand(const String& input) {
     if (cmd == "verify" || cmd == "v") return CMD_VERIFY;
     if (cmd == "config" || cmd == "c") return CMD_CONFIG;
     if (cmd == "test" || cmd == "t") return CMD_TEST;
+    if (cmd == "crc" || cmd == "x") return CMD_CRC_BENCH;
+    if (cmd == "params" || cmd == "a") return CMD_PARAMS;
     
     return CMD_UNKNOWN;
 }
@@ -83,6 +87,8 @@ void executeCommand(CLICommand cmd, const String& args) {
         case CMD_VERIFY:    cmdVerify(); break;
         case CMD_CONFIG:    cmdConfig(); break;
         case CMD_TEST:      cmdTest(); break;
+        case CMD_CRC_BENCH: cmdCrcBench(); break;
+        case CMD_PARAMS:    cmdParams(args); break;
         case CMD_UNKNOWN:
         default:
             printError("Unknown command. Type 'help' for available commands.");
@@ -102,11 +108,15 @@ void cmdHelp() {
     Serial.println("  verify (v)   - Verify stored credentials");
     Serial.println("  config (c)   - Configure via JSON input");
     Serial.println("  test (t)     - Test FRAM read/write");
+    Serial.println("  crc (x)      - Benchmark CRC16/CRC32 vs old byte sum");
+    Serial.println("  params (a)   - Show/set algorithm parameters");
     Serial.println();
     Serial.println("Examples:");
     Serial.println("  program      - Interactive credential input");
     Serial.println("  config       - JSON configuration mode");
     Serial.println("  backup       - Creates hex dump for external storage");
+    Serial.println("  params set time_to_pump=1800 fill_water_max=1500");
+    Serial.println("  params reset - Back to the compiled defaults");
     Serial.println();
     Serial.println("🔒 Programming Mode Features:");
     Serial.println("  • Full CLI access via Serial");
@@ -536,6 +546,105 @@ void cmdTest() {
     }
 }
 
+void cmdCrcBench() {
+    printInfo("=== Checksum Benchmark (1 KB x 100) ===");
+
+    ChecksumBenchmark bench = benchmarkChecksums(1024, 100);
+    uint32_t totalKB = (uint32_t)bench.bytes * bench.rounds / 1024;
+
+    Serial.printf("  byte sum : %6lu us (%lu us/KB)\n", bench.sumUs, bench.sumUs / totalKB);
+    Serial.printf("  CRC16    : %6lu us (%lu us/KB)\n", bench.crc16Us, bench.crc16Us / totalKB);
+    Serial.printf("  CRC32    : %6lu us (%lu us/KB)\n", bench.crc32Us, bench.crc32Us / totalKB);
+
+    // What the sum misses: two swapped bytes give the same value
+    uint8_t a[4] = {0x12, 0x34, 0x56, 0x78};
+    uint8_t b[4] = {0x34, 0x12, 0x56, 0x78};
+    Serial.printf("  swapped bytes - sum: %s, CRC16: %s\n",
+                  additiveSum16(a, 4) == additiveSum16(b, 4) ? "missed" : "detected",
+                  crc16(a, 4) == crc16(b, 4) ? "missed" : "detected");
+}
+
+
+static void printAlgorithmParams(const AlgorithmParams& params) {
+    AlgorithmParams defaults = getDefaultAlgorithmParams();
+    for (uint8_t i = 0; i < ALGORITHM_PARAM_COUNT; i++) {
+        const AlgorithmParamField& field = ALGORITHM_PARAM_FIELDS[i];
+        uint16_t value = params.*field.member;
+        uint16_t defaultValue = defaults.*field.member;
+        Serial.printf("  %-24s %5u %-2s", field.key, value, field.unit);
+        if (value != defaultValue) {
+            Serial.printf("  (default %u)", defaultValue);
+        }
+        Serial.println();
+    }
+}
+
+// params                      - show the block stored in FRAM
+// params set key=value ...    - validate and store (device applies on next boot)
+// params reset                - store the compiled defaults
+void cmdParams(const String& args) {
+    String rest = "";
+    int spaceIndex = args.indexOf(' ');
+    if (spaceIndex > 0) {
+        rest = args.substring(spaceIndex + 1);
+        rest.trim();
+    }
+
+    AlgorithmParams params;
+    bool stored = loadAlgorithmParamsFromFRAM(params);
+    if (!stored) {
+        params = getDefaultAlgorithmParams();
+    }
+
+    if (rest.length() == 0) {
+        printInfo(stored ? "=== Algorithm Parameters (FRAM) ===" : "=== Algorithm Parameters (defaults - none in FRAM) ===");
+        printAlgorithmParams(params);
+        return;
+    }
+
+    if (rest == "reset") {
+        params = getDefaultAlgorithmParams();
+    } else if (rest.startsWith("set ")) {
+        String assignments = rest.substring(4);
+        assignments.trim();
+
+        while (assignments.length() > 0) {
+            int end = assignments.indexOf(' ');
+            String token = end > 0 ? assignments.substring(0, end) : assignments;
+            assignments = end > 0 ? assignments.substring(end + 1) : "";
+            assignments.trim();
+
+            int eq = token.indexOf('=');
+            int index = eq > 0 ? findAlgorithmParam(token.substring(0, eq).c_str()) : -1;
+            if (index < 0) {
+                printError("Unknown parameter: " + token);
+                return;
+            }
+            long value = token.substring(eq + 1).toInt();
+            if (value < 1 || value > 0xFFFF) {
+                printError("Value out of range (1-65535): " + token);
+                return;
+            }
+            params.*ALGORITHM_PARAM_FIELDS[index].member = (uint16_t)value;
+        }
+    } else {
+        printError("Usage: params | params set key=value ... | params reset");
+        return;
+    }
+
+    const char* error = nullptr;
+    if (!validateAlgorithmParams(params, &error)) {
+        printError(String("Rejected: ") + error);
+        return;
+    }
+    if (!saveAlgorithmParamsToFRAM(params)) {
+        printError("Failed to write parameters to FRAM");
+        return;
+    }
+
+    printSuccess("Algorithm parameters stored in FRAM");
+    printAlgorithmParams(params);
+}
 
 bool parseJSONCredentials(const String& json, DeviceCredentials& creds) {
     JsonDocument doc;
@@ -17,6 +17,8 @@ enum CLICommand {
     CMD_VERIFY,
     CMD_CONFIG,
     CMD_TEST,
+    CMD_CRC_BENCH,
+    CMD_PARAMS,
     CMD_UNKNOWN
 };
 
@@ -36,6 +38,8 @@ void cmdProgram();
 void cmdVerify();
 void cmdConfig();
 void cmdTest();
+void cmdCrcBench();
+void cmdParams(const String& args);
 
 // Utility functions
 String readSerialLine();
@@ -1,6 +1,7 @@
 
 #include "config.h"
 #include "../core/logging.h"
+#include "../core/uptime.h"
 #include "../hardware/fram_controller.h"
 
 // ===============================
@@ -30,11 +31,11 @@ const char* DEVICE_ID = "UNCONFIGURED_DEVICE";
 
 // Global pump control
 bool pumpGlobalEnabled = true;  // Default ON
-unsigned long pumpDisabledTime = 0;
+uint64_t pumpDisabledTime = 0;          // uptimeMs(), 0: not disabled
 const unsigned long PUMP_AUTO_ENABLE_MS = 30 * 60 * 1000; // 30 minutes
 
 bool systemDisableRequested = false;
-unsigned long systemDisabledTime = 0;
+uint64_t systemDisabledTime = 0;        // uptimeMs(), 0: not disabled
 const unsigned long SYSTEM_AUTO_ENABLE_MS = 30 * 60 * 1000; // 30 minutes
 
 PumpSettings currentPumpSettings;
@@ -72,7 +73,7 @@ void saveVolumeToNVS() {
 
 void checkPumpAutoEnable() {
     if (!pumpGlobalEnabled && pumpDisabledTime > 0) {
-        if (millis() - pumpDisabledTime >= PUMP_AUTO_ENABLE_MS) {
+        if (uptimeMs() - pumpDisabledTime >= PUMP_AUTO_ENABLE_MS) {
             pumpGlobalEnabled = true;
             pumpDisabledTime = 0;
             LOG_INFO("Pump auto-enabled after 30 minutes");
@@ -83,7 +84,7 @@ void checkPumpAutoEnable() {
 void setPumpGlobalState(bool enabled) {
     pumpGlobalEnabled = enabled;
     if (!enabled) {
-        pumpDisabledTime = millis();
+        pumpDisabledTime = uptimeMs();
         LOG_INFO("Pump globally disabled for 30 minutes");
     } else {
         pumpDisabledTime = 0;
@@ -96,7 +97,7 @@ void setPumpGlobalState(bool enabled) {
 void setSystemState(bool enabled) {
     if (!enabled) {
         systemDisableRequested = true;
-        systemDisabledTime = millis();
+        systemDisabledTime = uptimeMs();
         LOG_INFO("🛑 System disable requested - will pause at safe point");
         LOG_INFO("System will auto-enable in 30 minutes");
     } else {
@@ -108,7 +109,7 @@ void setSystemState(bool enabled) {
 
 void checkSystemAutoEnable() {
     if (systemDisableRequested && systemDisabledTime > 0) {
-        unsigned long elapsed = millis() - systemDisabledTime;
+        uint64_t elapsed = uptimeMs() - systemDisabledTime;
         
         if (elapsed >= SYSTEM_AUTO_ENABLE_MS) {
             systemDisableRequested = false;
@@ -120,4 +121,16 @@ void checkSystemAutoEnable() {
 
 bool isSystemDisabled() {
     return systemDisableRequested;
+}
+
+uint32_t getAutoEnableWaitMs() {
+    uint32_t wait = UINT32_MAX;
+    if (!pumpGlobalEnabled && pumpDisabledTime > 0) {
+        wait = uptimeRemainingMs(pumpDisabledTime, PUMP_AUTO_ENABLE_MS);
+    }
+    if (systemDisableRequested && systemDisabledTime > 0) {
+        uint32_t systemWait = uptimeRemainingMs(systemDisabledTime, SYSTEM_AUTO_ENABLE_MS);
+        if (systemWait < wait) wait = systemWait;
+    }
+    return wait;
 }
\ No newline at end of file
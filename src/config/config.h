@@ -23,11 +23,11 @@ extern const char* DEVICE_ID;
 
 // Global pump control
 extern bool pumpGlobalEnabled;
-extern unsigned long pumpDisabledTime;
+extern uint64_t pumpDisabledTime;           // uptimeMs() (core/uptime.h)
 extern const unsigned long PUMP_AUTO_ENABLE_MS;
 
 extern bool systemDisableRequested;
-extern unsigned long systemDisabledTime;
+extern uint64_t systemDisabledTime;
 extern const unsigned long SYSTEM_AUTO_ENABLE_MS;
 
 
@@ -38,6 +38,40 @@ const int MAX_REQUESTS_PER_SECOND = 5;
 const int MAX_FAILED_ATTEMPTS = 10;
 const unsigned long BLOCK_DURATION_MS = 60000;
 
+// VPS uplink (network/vps_logger.cpp)
+const uint32_t VPS_UPLINK_TASK_STACK = 8192;      // HTTPClient + JSON need ~6KB
+const unsigned long VPS_RETRY_MIN_MS = 5000;      // First retry after a failed POST
+const unsigned long VPS_RETRY_MAX_MS = 300000;    // Backoff cap (5 min)
+const uint8_t VPS_BATCH_MAX_RECORDS = 8;          // Records coalesced into one POST
+const unsigned long VPS_BATCH_LINGER_MS = 2000;   // Max wait for more records before sending a partial batch
+const uint16_t VPS_PAYLOAD_BUFFER_SIZE = 8192;    // Preallocated batch payload (JSON worst case ~8 x 650B)
+const bool VPS_BINARY_PAYLOAD = false;            // Opt-in MessagePack body (application/msgpack), JSON fallback on HTTP 415
+
+// Algorithm control task (algorithm/algorithm_task.cpp)
+const bool ALGORITHM_EVENT_DRIVEN = true;         // false = run the control step from loop() every pass (old behaviour)
+const uint32_t ALGORITHM_TASK_STACK = 6144;       // FRAM commit + logging
+const uint8_t ALGORITHM_TASK_PRIORITY = 2;        // Above loop() (1) and the VPS uplink (1)
+const uint8_t ALGORITHM_EVENT_QUEUE_LEN = 16;
+const uint32_t ALGORITHM_MAX_SLEEP_MS = 60000;    // Safety net - deadlines normally wake the task first
+
+// Scheduled restart (main.cpp) - not needed for long uptime, all timers are
+// 64-bit or wraparound-safe (core/uptime.h). When enabled it waits for a safe
+// point: every channel IDLE, no pump running.
+const bool DAILY_RESTART_ENABLED = false;
+const uint32_t DAILY_RESTART_HOURS = 24;
+
+// Boot sequencer (main.cpp) - the web server starts once Wi-Fi is up or after this wait
+const uint32_t BOOT_WIFI_WAIT_MS = 10000;
+
+// Trace recorder (core/trace_recorder.cpp) - FRAM ring for /api/trace + replay
+const bool TRACE_RECORDER_ENABLED = true;
+
+// Pump flow estimator (algorithm/flow_estimator.cpp)
+const bool FLOW_AUTO_ADJUST = false;             // false = only recommend a new volumePerSecond in /api/status
+
+// Adaptive trigger-to-pump delay (algorithm/adaptive_delay.cpp)
+const bool ADAPTIVE_TIME_TO_PUMP = true;          // false = always wait the full TIME_TO_PUMP
+
 struct PumpSettings {
     uint16_t manualCycleSeconds = 60;
     uint16_t calibrationCycleSeconds = 30;
@@ -51,6 +85,9 @@ void setSystemState(bool enabled);
 void checkSystemAutoEnable();
 bool isSystemDisabled();
 
+// ms until the next pump / system auto-enable (UINT32_MAX if none pending)
+uint32_t getAutoEnableWaitMs();
+
 // Functions
 void checkPumpAutoEnable();
 void setPumpGlobalState(bool enabled);
@@ -51,8 +51,8 @@ bool loadCredentialsFromFRAM() {
         return false;
     }
     
-    // Check version compatibility - support v2 (without VPS_URL) and v3 (with VPS_URL)
-    if (fram_creds.version != 0x0002 && fram_creds.version != 0x0003) {
+    // Check version compatibility - v2 (without VPS_URL), v3 (with VPS_URL), v4 (CRC16 checksum)
+    if (fram_creds.version < 0x0002 || fram_creds.version > FRAM_CREDENTIALS_VERSION) {
         LOG_ERROR("Unsupported FRAM credentials version: %d", fram_creds.version);
         return false;
     }
@@ -0,0 +1,40 @@
+#include "boot_profile.h"
+#include "logging.h"
+#include <esp_timer.h>
+
+static const char* const BOOT_STAGE_NAMES[BOOT_STAGE_COUNT] = {
+    "hardware", "storage", "clock", "control", "services", "wifi", "web", "ntp"
+};
+
+static uint32_t stageMs[BOOT_STAGE_COUNT] = {0};
+static BootStage latestStage = BOOT_STAGE_HARDWARE;
+
+void bootStageReached(BootStage stage) {
+    if (stage >= BOOT_STAGE_COUNT || stageMs[stage] != 0) {
+        return;
+    }
+
+    uint32_t ms = (uint32_t)(esp_timer_get_time() / 1000);
+    stageMs[stage] = ms > 0 ? ms : 1;
+    if (stage > latestStage) {
+        latestStage = stage;
+    }
+
+    if (stage == BOOT_STAGE_CONTROL && ms > BOOT_CONTROL_TARGET_MS) {
+        LOG_WARNING("Boot: control up after %lums (target %dms)", (unsigned long)ms, BOOT_CONTROL_TARGET_MS);
+    } else {
+        LOG_INFO("Boot: %s at %lums", BOOT_STAGE_NAMES[stage], (unsigned long)ms);
+    }
+}
+
+uint32_t getBootStageMs(BootStage stage) {
+    return stage < BOOT_STAGE_COUNT ? stageMs[stage] : 0;
+}
+
+const char* getBootStageName(BootStage stage) {
+    return stage < BOOT_STAGE_COUNT ? BOOT_STAGE_NAMES[stage] : "unknown";
+}
+
+BootStage getBootStage() {
+    return latestStage;
+}
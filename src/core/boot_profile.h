@@ -0,0 +1,36 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <Arduino.h>
+
+// ===============================
+// BOOT STAGES
+// ===============================
+// setup() brings up everything the control loop needs (up to
+// BOOT_STAGE_CONTROL) and returns; network, web server and NTP follow from
+// loop() without blocking it (main.cpp). Each stage records the esp_timer
+// time it was first reached, reported as boot_*_ms in /api/status, so the
+// boot-to-control latency can be compared between releases.
+
+#define BOOT_CONTROL_TARGET_MS  500     // Boot -> control target, a slower boot logs a warning
+
+enum BootStage {
+    BOOT_STAGE_HARDWARE,        // Sensors and pump relay (off)
+    BOOT_STAGE_STORAGE,         // FRAM, pump settings, algorithm params, learned state
+    BOOT_STAGE_CLOCK,           // DS3231 (or fallback) anchored
+    BOOT_STAGE_CONTROL,         // Daily volume, trace, algorithm task running
+    BOOT_STAGE_SERVICES,        // Credentials, VPS uplink, auth / sessions / rate limiter
+    BOOT_STAGE_WIFI,            // Connected
+    BOOT_STAGE_WEB,             // Web server listening
+    BOOT_STAGE_NTP,             // First NTP sync
+    BOOT_STAGE_COUNT
+};
+
+// First call per stage records the time since boot and logs it
+void bootStageReached(BootStage stage);
+
+uint32_t getBootStageMs(BootStage stage);     // 0: not reached yet
+const char* getBootStageName(BootStage stage);
+BootStage getBootStage();                     // Latest stage reached
+
+#endif
@@ -3,8 +3,7 @@
 
 void initLogging() {
 #if ENABLE_SERIAL_DEBUG || ENABLE_FULL_LOGGING
-    Serial.begin(115200);
-    delay(1000);
+    Serial.begin(115200);   // No wait for a monitor - boot time counts (core/boot_profile.h)
     
     #if ENABLE_FULL_LOGGING
         LOG_INFO("Logging system initialized");
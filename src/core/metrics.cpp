@@ -0,0 +1,87 @@
+#include "metrics.h"
+
+static LoopMetrics loopMetrics = {0, 0, 0, 0};
+
+void recordLoopDuration(uint32_t durationUs) {
+    loopMetrics.lastLoopUs = durationUs;
+    loopMetrics.loopCount++;
+
+    if (durationUs > loopMetrics.maxLoopUs) {
+        loopMetrics.maxLoopUs = durationUs;
+    }
+    if (durationUs > LOOP_STALL_THRESHOLD_US) {
+        loopMetrics.stallCount++;
+    }
+}
+
+const LoopMetrics& getLoopMetrics() {
+    return loopMetrics;
+}
+
+void resetLoopMetrics() {
+    loopMetrics = {0, 0, 0, 0};
+}
+
+static StorageMetrics storageMetrics = {0, 0, 0, 0};
+
+void recordCycleSave(uint32_t durationUs) {
+    storageMetrics.lastCycleSaveUs = durationUs;
+    if (durationUs > storageMetrics.maxCycleSaveUs) {
+        storageMetrics.maxCycleSaveUs = durationUs;
+    }
+}
+
+void recordCycleLoad(uint32_t durationUs, uint16_t records) {
+    storageMetrics.cycleLoadUs = durationUs;
+    storageMetrics.cycleLoadCount = records;
+}
+
+const StorageMetrics& getStorageMetrics() {
+    return storageMetrics;
+}
+
+static ControlMetrics controlMetrics = {0, 0, 0, 0, 0, 0, 0, 0};
+static uint32_t windowStartUs = 0;
+static uint32_t windowBusyUs = 0;
+static uint32_t windowSteps = 0;
+static uint32_t reactionCount = 0;
+
+void recordControlStep(uint32_t busyUs) {
+    uint32_t now = micros();
+    if (windowStartUs == 0) windowStartUs = now;
+
+    controlMetrics.steps++;
+    windowSteps++;
+    windowBusyUs += busyUs;
+    if (busyUs > controlMetrics.maxStepUs) {
+        controlMetrics.maxStepUs = busyUs;
+    }
+
+    uint32_t windowUs = now - windowStartUs;
+    if (windowUs >= CONTROL_METRICS_WINDOW_US) {
+        controlMetrics.busyPermille = (uint16_t)((uint64_t)windowBusyUs * 1000 / windowUs);
+        controlMetrics.stepsPerMin = (uint32_t)((uint64_t)windowSteps * 60000000ULL / windowUs);
+        windowStartUs = now;
+        windowBusyUs = 0;
+        windowSteps = 0;
+    }
+}
+
+void recordControlEvent() {
+    controlMetrics.events++;
+}
+
+void recordSensorReaction(uint32_t latencyUs) {
+    controlMetrics.reactionLastUs = latencyUs;
+    if (latencyUs > controlMetrics.reactionMaxUs) {
+        controlMetrics.reactionMaxUs = latencyUs;
+    }
+    // Running average, first samples weighted fully
+    reactionCount++;
+    uint32_t n = (reactionCount < 16) ? reactionCount : 16;
+    controlMetrics.reactionAvgUs += ((int32_t)latencyUs - (int32_t)controlMetrics.reactionAvgUs) / (int32_t)n;
+}
+
+const ControlMetrics& getControlMetrics() {
+    return controlMetrics;
+}
@@ -0,0 +1,55 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+// ===============================
+// RUNTIME METRICS
+// ===============================
+
+// Loop iterations longer than this count as a stall (excludes the idle delay)
+#define LOOP_STALL_THRESHOLD_US  50000
+
+struct LoopMetrics {
+    uint32_t lastLoopUs;    // Busy time of the last loop() pass
+    uint32_t maxLoopUs;     // Worst busy time since boot / reset
+    uint32_t stallCount;    // Passes above LOOP_STALL_THRESHOLD_US
+    uint32_t loopCount;
+};
+
+void recordLoopDuration(uint32_t durationUs);
+const LoopMetrics& getLoopMetrics();
+void resetLoopMetrics();
+
+// FRAM cycle storage timing (hardware/fram_controller.cpp, algorithm load)
+struct StorageMetrics {
+    uint32_t lastCycleSaveUs;
+    uint32_t maxCycleSaveUs;
+    uint32_t cycleLoadUs;     // Last FRAM cycle history scan (boot / day change)
+    uint16_t cycleLoadCount;  // Records scanned by that load
+};
+
+void recordCycleSave(uint32_t durationUs);
+void recordCycleLoad(uint32_t durationUs, uint16_t records);
+const StorageMetrics& getStorageMetrics();
+
+// Control path (algorithm task, or loop() when event-driven mode is off)
+#define CONTROL_METRICS_WINDOW_US  60000000   // busy / wake-up rates over 60 s
+
+struct ControlMetrics {
+    uint32_t steps;            // Control steps since boot
+    uint32_t events;           // Queue events received (sensor edges, pump, web)
+    uint32_t stepsPerMin;      // Last complete window
+    uint16_t busyPermille;     // Share of wall time spent in control steps (last window)
+    uint32_t maxStepUs;
+    uint32_t reactionLastUs;   // Sensor level valid (edge + debounce) -> algorithm notified
+    uint32_t reactionMaxUs;
+    uint32_t reactionAvgUs;
+};
+
+void recordControlStep(uint32_t busyUs);
+void recordControlEvent();
+void recordSensorReaction(uint32_t latencyUs);
+const ControlMetrics& getControlMetrics();
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+
+// ===============================
+// FIXED-CAPACITY RING BUFFER
+// ===============================
+// Static storage, no heap. push() is O(1) and overwrites the oldest
+// element when full. Index 0 is always the oldest element.
+
+template <typename T, size_t N>
+class RingBuffer {
+public:
+    static_assert(N > 0, "RingBuffer capacity must be > 0");
+
+    // Non-allocating window over consecutive elements (oldest -> newest).
+    // Valid until the next push()/clear() on the owning buffer.
+    class View {
+    public:
+        class const_iterator {
+        public:
+            const_iterator(const RingBuffer* ring, size_t pos) : ring(ring), pos(pos) {}
+            const T& operator*() const { return (*ring)[pos]; }
+            const T* operator->() const { return &(*ring)[pos]; }
+            const_iterator& operator++() { ++pos; return *this; }
+            bool operator!=(const const_iterator& other) const { return pos != other.pos; }
+            bool operator==(const const_iterator& other) const { return pos == other.pos; }
+        private:
+            const RingBuffer* ring;
+            size_t pos;
+        };
+
+        View(const RingBuffer* ring, size_t first, size_t count)
+            : ring(ring), first(first), count(count) {}
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const T& operator[](size_t i) const { return (*ring)[first + i]; }
+        const_iterator begin() const { return const_iterator(ring, first); }
+        const_iterator end() const { return const_iterator(ring, first + count); }
+
+    private:
+        const RingBuffer* ring;
+        size_t first;
+        size_t count;
+    };
+
+    RingBuffer() : head(0), count(0) {}
+
+    void push(const T& item) {
+        items[head] = item;
+        head = (head + 1) % N;
+        if (count < N) count++;
+    }
+
+    void clear() { head = 0; count = 0; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    static size_t capacity() { return N; }
+
+    // 0 = oldest
+    const T& operator[](size_t i) const { return items[(head + N - count + i) % N]; }
+    const T& back() const { return items[(head + N - 1) % N]; }
+
+    View all() const { return View(this, 0, count); }
+
+    // Newest `n` elements (fewer if not that many stored)
+    View last(size_t n) const {
+        if (n > count) n = count;
+        return View(this, count - n, n);
+    }
+
+    typename View::const_iterator begin() const { return all().begin(); }
+    typename View::const_iterator end() const { return all().end(); }
+
+private:
+    T items[N];
+    size_t head;   // next slot to write
+    size_t count;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// ===============================
+// LOCK-FREE SPSC RING
+// ===============================
+// One producer context and one consumer (loop task), no locks.
+// The producer only writes `head`, the consumer only writes `tail`.
+// Several ISRs may share the producer side only while they cannot preempt
+// each other: on the single-core C3 all GPIO ISRs run at one interrupt
+// level, so each push() completes before the next one starts. On a
+// multi-core target or with nested interrupt levels, give each ISR its own
+// ring.
+// push() never blocks - it returns false when the ring is full.
+
+template <typename T, size_t N>
+class SpscRing {
+public:
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+    SpscRing() : head(0), tail(0) {}
+
+    // Producer side (ISR safe)
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    static size_t capacity() { return N; }
+
+private:
+    T items[N];
+    std::atomic<uint32_t> head;   // next slot to write (producer)
+    std::atomic<uint32_t> tail;   // next slot to read (consumer)
+};
+
+#endif
@@ -0,0 +1,333 @@
+#include "trace_recorder.h"
+#include "logging.h"
+#include "../crypto/crc.h"
+#include "../config/config.h"
+#include "../algorithm/water_algorithm.h"
+#include "../algorithm/adaptive_delay.h"
+#include "../hardware/water_sensors.h"
+#include "../hardware/pump_controller.h"
+#include "../hardware/rtc_controller.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define TRACE_MAGIC     0x5452  // "TR"
+
+struct TraceHeader {
+    uint16_t magic;
+    uint16_t head;      // next slot to write
+    uint16_t count;     // valid records
+    uint16_t dropped;   // records overwritten while full (saturating)
+    uint16_t boots;     // TRACE_BOOT records (saturating)
+    uint16_t crc;       // CRC16 of the fields above
+};
+
+static TraceHeader header;
+static bool traceReady = false;
+static uint32_t writeErrors = 0;
+static SemaphoreHandle_t traceMutex = nullptr;
+
+// Ring position frozen by beginTraceDump() - one download at a time
+static bool dumpOpen = false;
+static uint16_t dumpTail = 0;
+static uint16_t dumpCount = 0;
+
+// Slot writes started since boot (bumped before the FRAM write, so a read
+// racing the writer sees it). The download compares it to its start value
+// to tell when the writer has wrapped onto the records it still has to send.
+static volatile uint32_t slotWrites = 0;
+static uint32_t dumpStartWrites = 0;
+static bool dumpOverrun = false;
+
+static uint16_t slotAddress(uint16_t slot) {
+    return FRAM_ADDR_TRACE_DATA + slot * FRAM_TRACE_RECORD_SIZE;
+}
+
+static uint16_t headerCRC() {
+    return crc16((const uint8_t*)&header, offsetof(TraceHeader, crc));
+}
+
+static uint16_t recordCRC(const TraceRecord& record) {
+    TraceRecord copy = record;
+    copy.crc = 0;
+    return crc16((const uint8_t*)&copy, sizeof(copy));
+}
+
+static bool writeHeader() {
+    header.crc = headerCRC();
+    return writeFRAMBlock(FRAM_ADDR_TRACE_HEADER, (const uint8_t*)&header, sizeof(header));
+}
+
+static void resetHeader() {
+    header.magic = TRACE_MAGIC;
+    header.head = 0;
+    header.count = 0;
+    header.dropped = 0;
+    header.boots = 0;
+}
+
+static size_t minSize(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+static uint16_t saturate16(uint32_t value) {
+    return value > 0xFFFF ? 0xFFFF : (uint16_t)value;
+}
+
+bool initTraceRecorder() {
+    if (!TRACE_RECORDER_ENABLED) {
+        traceReady = false;
+        return false;
+    }
+
+    if (traceMutex == nullptr) {
+        traceMutex = xSemaphoreCreateMutex();
+    }
+
+    if (!readFRAMBlock(FRAM_ADDR_TRACE_HEADER, (uint8_t*)&header, sizeof(header))) {
+        LOG_ERROR("Trace recorder: FRAM not available");
+        traceReady = false;
+        return false;
+    }
+
+    if (header.magic != TRACE_MAGIC || header.head >= FRAM_TRACE_SLOTS ||
+        header.count > FRAM_TRACE_SLOTS || header.crc != headerCRC()) {
+        LOG_WARNING("Trace header invalid - starting empty");
+        resetHeader();
+        writeHeader();
+    }
+
+    traceReady = true;
+    LOG_INFO("Trace recorder ready: %d/%d records (dropped: %d)",
+             header.count, FRAM_TRACE_SLOTS, header.dropped);
+    return true;
+}
+
+void traceRecordAt(uint32_t ms, TraceType type, uint8_t arg, uint32_t data) {
+    if (!traceReady) return;
+
+    TraceRecord record;
+    record.ms = ms;
+    record.type = type;
+    record.arg = arg;
+    record.crc = 0;
+    record.data = data;
+    record.crc = recordCRC(record);
+
+    xSemaphoreTake(traceMutex, portMAX_DELAY);
+
+    slotWrites = slotWrites + 1;
+    if (!writeFRAMBlock(slotAddress(header.head), (const uint8_t*)&record, sizeof(record))) {
+        writeErrors++;
+        xSemaphoreGive(traceMutex);
+        return;
+    }
+
+    header.head = (header.head + 1) % FRAM_TRACE_SLOTS;
+    if (header.count < FRAM_TRACE_SLOTS) {
+        header.count++;
+    } else if (header.dropped < 0xFFFF) {
+        header.dropped++;
+    }
+    if (type == TRACE_BOOT && header.boots < 0xFFFF) {
+        header.boots++;
+    }
+
+    if (!writeHeader()) writeErrors++;
+    xSemaphoreGive(traceMutex);
+}
+
+void traceRecord(TraceType type, uint8_t arg, uint32_t data) {
+    traceRecordAt(millis(), type, arg, data);
+}
+
+void traceSyncPoint(TraceType anchor) {
+    if (!traceReady) return;
+
+    uint8_t sync = (uint8_t)(waterAlgorithm.getState() << TRACE_SYNC_STATE_SHIFT);
+    if (readWaterSensor1()) sync |= TRACE_SYNC_SENSOR1;
+    if (readWaterSensor2()) sync |= TRACE_SYNC_SENSOR2;
+    if (isPumpActive()) sync |= TRACE_SYNC_PUMP;
+
+    uint8_t flags = 0;
+    if (pumpGlobalEnabled) flags |= TRACE_FLAG_PUMP_ENABLED;
+    if (systemDisableRequested) flags |= TRACE_FLAG_SYSTEM_DISABLED;
+
+    uint32_t volumeBits;
+    memcpy(&volumeBits, &currentPumpSettings.volumePerSecond, sizeof(volumeBits));
+
+    uint32_t now = millis();
+    traceRecordAt(now, anchor, sync, isRTCWorking() ? getUnixTimestamp() : 0);
+    traceRecordAt(now, TRACE_DAILY_VOLUME, flags, waterAlgorithm.getDailyVolume());
+    traceRecordAt(now, TRACE_SETTINGS, 0, volumeBits);
+    traceParams(waterAlgorithm.getParams());
+    traceAdaptiveDelayState(now);
+}
+
+void traceCycle(const PumpCycle& cycle) {
+    uint8_t result = (cycle.sensor_results & 0x07) |
+                     ((cycle.error_code & 0x03) << 3) |
+                     ((cycle.pump_attempts & 0x03) << 5);
+    uint32_t timing = saturate16(cycle.time_gap_1) | ((uint32_t)saturate16(cycle.water_trigger_time) << 16);
+    uint8_t gap2 = cycle.time_gap_2 > 0xFF ? 0xFF : (uint8_t)cycle.time_gap_2;
+    uint32_t pump = cycle.pump_duration | ((uint32_t)cycle.volume_dose << 16);
+
+    uint32_t now = millis();
+    traceRecordAt(now, TRACE_CYCLE_SENSORS, result, timing);
+    traceRecordAt(now, TRACE_CYCLE_PUMP, gap2, pump);
+}
+
+void traceParams(const AlgorithmParams& params) {
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < ALGORITHM_PARAM_COUNT; i += 2) {
+        uint32_t data = params.*ALGORITHM_PARAM_FIELDS[i].member;
+        if (i + 1 < ALGORITHM_PARAM_COUNT) {
+            data |= (uint32_t)(params.*ALGORITHM_PARAM_FIELDS[i + 1].member) << 16;
+        }
+        traceRecordAt(now, TRACE_PARAMS, i, data);
+    }
+}
+
+void traceDecodeParams(const TraceRecord& record, AlgorithmParams& params) {
+    if (record.arg >= ALGORITHM_PARAM_COUNT) return;
+    params.*ALGORITHM_PARAM_FIELDS[record.arg].member = record.data & 0xFFFF;
+    if (record.arg + 1 < ALGORITHM_PARAM_COUNT) {
+        params.*ALGORITHM_PARAM_FIELDS[record.arg + 1].member = record.data >> 16;
+    }
+}
+
+void traceDecodeCycle(const TraceRecord& sensors, const TraceRecord& pump, PumpCycle& cycle) {
+    cycle = {};
+    cycle.sensor_results = sensors.arg & 0x07;
+    cycle.error_code = (sensors.arg >> 3) & 0x03;
+    cycle.pump_attempts = (sensors.arg >> 5) & 0x03;
+    cycle.time_gap_1 = sensors.data & 0xFFFF;
+    cycle.water_trigger_time = sensors.data >> 16;
+    cycle.time_gap_2 = pump.arg;
+    cycle.pump_duration = pump.data & 0xFFFF;
+    cycle.volume_dose = pump.data >> 16;
+}
+
+uint8_t tracePumpSource(const String& actionType) {
+    if (actionType.startsWith("AUTO")) return TRACE_PUMP_AUTO;
+    if (actionType == "MANUAL_NORMAL") return TRACE_PUMP_MANUAL_NORMAL;
+    if (actionType == "MANUAL_EXTENDED") return TRACE_PUMP_MANUAL_EXTENDED;
+    return TRACE_PUMP_OTHER;
+}
+
+bool traceRecordValid(const TraceRecord& record) {
+    return record.crc == recordCRC(record);
+}
+
+// ============== DOWNLOAD ==============
+
+// Oldest dump records already overwritten (or being overwritten) by the
+// writer. It starts at the free slots past the frozen head, so the first
+// FRAM_TRACE_SLOTS - dumpCount writes never touch the dump.
+static uint32_t dumpRecordsOverwritten() {
+    uint32_t writes = slotWrites - dumpStartWrites;
+    uint32_t freeSlots = FRAM_TRACE_SLOTS - dumpCount;
+    return writes > freeSlots ? writes - freeSlots : 0;
+}
+
+size_t beginTraceDump() {
+    if (!traceReady) {
+        dumpCount = 0;
+        dumpOverrun = false;
+        return sizeof(TraceDumpHeader);
+    }
+
+    xSemaphoreTake(traceMutex, portMAX_DELAY);
+    if (dumpOpen) {
+        xSemaphoreGive(traceMutex);
+        return 0;
+    }
+    dumpOpen = true;
+    dumpOverrun = false;
+    dumpCount = header.count;
+    dumpTail = (header.head + FRAM_TRACE_SLOTS - header.count) % FRAM_TRACE_SLOTS;
+    dumpStartWrites = slotWrites;
+    xSemaphoreGive(traceMutex);
+
+    return sizeof(TraceDumpHeader) + (size_t)dumpCount * FRAM_TRACE_RECORD_SIZE;
+}
+
+size_t readTraceDump(uint8_t* buffer, size_t maxLen, size_t index) {
+    size_t total = sizeof(TraceDumpHeader) + (size_t)dumpCount * FRAM_TRACE_RECORD_SIZE;
+    size_t written = 0;
+
+    if (dumpOverrun) return 0;
+
+    while (written < maxLen && index < total) {
+        if (index < sizeof(TraceDumpHeader)) {
+            TraceDumpHeader dump;
+            dump.magic = TRACE_DUMP_MAGIC;
+            dump.version = TRACE_DUMP_VERSION;
+            dump.recordSize = FRAM_TRACE_RECORD_SIZE;
+            dump.count = dumpCount;
+            dump.dropped = header.dropped;
+            dump.boots = header.boots;
+            dump.reserved = 0;
+
+            size_t n = minSize(sizeof(dump) - index, maxLen - written);
+            memcpy(buffer + written, (const uint8_t*)&dump + index, n);
+            written += n;
+            index += n;
+            continue;
+        }
+
+        // Contiguous run of slots up to the end of the ring
+        size_t offset = index - sizeof(TraceDumpHeader);
+        uint16_t slot = (dumpTail + offset / FRAM_TRACE_RECORD_SIZE) % FRAM_TRACE_SLOTS;
+        size_t inSlot = offset % FRAM_TRACE_RECORD_SIZE;
+        size_t toRingEnd = (size_t)(FRAM_TRACE_SLOTS - slot) * FRAM_TRACE_RECORD_SIZE - inSlot;
+        size_t n = minSize(minSize(total - index, maxLen - written), toRingEnd);
+
+        if (!readFRAMBlock(slotAddress(slot) + inSlot, buffer + written, n)) {
+            break;
+        }
+
+        // Recording keeps running during the download. Once the writer has
+        // reached a record in this chunk the rest of the frozen window is
+        // newer data - end the dump short rather than mix the two.
+        if (dumpRecordsOverwritten() > offset / FRAM_TRACE_RECORD_SIZE) {
+            dumpOverrun = true;
+            LOG_WARNING("Trace dump overrun by the writer - ended after %u bytes", (unsigned)index);
+            break;
+        }
+        written += n;
+        index += n;
+    }
+
+    return written;
+}
+
+void endTraceDump() {
+    if (!traceReady) return;
+
+    xSemaphoreTake(traceMutex, portMAX_DELAY);
+    dumpOpen = false;
+    xSemaphoreGive(traceMutex);
+}
+
+bool clearTrace() {
+    if (!traceReady) return false;
+
+    xSemaphoreTake(traceMutex, portMAX_DELAY);
+    resetHeader();
+    slotWrites = slotWrites + FRAM_TRACE_SLOTS;   // ends an open dump
+    bool ok = writeHeader();
+    xSemaphoreGive(traceMutex);
+
+    LOG_INFO("Trace cleared");
+    return ok;
+}
+
+TraceStats getTraceStats() {
+    TraceStats stats;
+    stats.count = traceReady ? header.count : 0;
+    stats.capacity = FRAM_TRACE_SLOTS;
+    stats.dropped = header.dropped;
+    stats.boots = header.boots;
+    stats.writeErrors = writeErrors;
+    return stats;
+}
@@ -0,0 +1,133 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <Arduino.h>
+#include "../hardware/fram_controller.h"
+#include "../algorithm/algorithm_params.h"
+
+// ===============================
+// TRACE RECORDER (FRAM RING)
+// ===============================
+// Compact binary history of everything that drives WaterAlgorithm - sensor
+// edges, pump start/stop, web commands, RTC day changes - plus the cycles
+// the device logged. Each record carries a millis() timestamp. The oldest
+// records are overwritten when the ring is full.
+//
+// GET /api/trace downloads the ring (TraceDumpHeader + records, oldest
+// first); the native simulator replays it (`program replay trace.bin`) and
+// diffs the resulting cycles against the TRACE_CYCLE_* records.
+
+#define TRACE_DUMP_MAGIC    0x43525457  // "WTRC"
+#define TRACE_DUMP_VERSION  1
+
+enum TraceType : uint8_t {
+    TRACE_BOOT = 1,          // Sync point after setup(): arg = TRACE_SYNC_*, data = unix time (0: RTC down)
+    TRACE_SENSOR,            // Debounced level change: arg = sensor, data = 1 triggered / 0 normal, ms = edge time
+    TRACE_PUMP_START,        // arg = TracePumpSource, data = duration (s)
+    TRACE_PUMP_STOP,         // arg = TracePumpStop, data = run time (ms)
+    TRACE_COMMAND,           // arg = TraceCommand, data = command parameter
+    TRACE_DAY_CHANGE,        // Sync point after the UTC day reset - same layout as TRACE_BOOT
+    TRACE_DAILY_VOLUME,      // Follows a sync point: arg = TRACE_FLAG_*, data = daily volume (ml)
+    TRACE_SETTINGS,          // volumePerSecond changed or sync point: data = float bits
+    TRACE_ERROR,             // Error signal started: arg = ErrorCode
+    TRACE_CYCLE_SENSORS,     // Cycle logged (1/2): arg = results | error << 3 | attempts << 5, data = gap1 | water_trigger << 16
+    TRACE_CYCLE_PUMP,        // Cycle logged (2/2): arg = gap2, data = pump_duration | volume << 16
+    TRACE_PARAMS,            // Algorithm params applied or sync point: arg = field index (ALGORITHM_PARAM_FIELDS),
+                             // data = field[arg] | field[arg + 1] << 16 - one record per field pair
+    TRACE_ADAPTIVE           // Sync point: learned adaptive TIME_TO_PUMP state, arg = item (adaptive_delay.cpp)
+};
+
+enum TraceCommand : uint8_t {
+    TRACE_CMD_PUMP_NORMAL = 1,   // data = duration (s)
+    TRACE_CMD_PUMP_EXTENDED,     // data = duration (s)
+    TRACE_CMD_PUMP_STOP,
+    TRACE_CMD_PUMP_TOGGLE,       // data = new pumpGlobalEnabled
+    TRACE_CMD_SYSTEM_TOGGLE,     // data = 1 disable / 0 enable
+    TRACE_CMD_RESET_STATS,
+    TRACE_CMD_RESET_DAILY_VOLUME,
+    TRACE_CMD_RESET_BUTTON       // Physical reset released in ERROR
+};
+
+enum TracePumpSource : uint8_t {
+    TRACE_PUMP_AUTO = 0,
+    TRACE_PUMP_MANUAL_NORMAL,
+    TRACE_PUMP_MANUAL_EXTENDED,
+    TRACE_PUMP_OTHER
+};
+
+enum TracePumpStop : uint8_t {
+    TRACE_STOP_TIMER = 0,
+    TRACE_STOP_DISABLED,         // pumpGlobalEnabled cleared
+    TRACE_STOP_COMMAND           // stopPump()
+};
+
+// Sync point arg (TRACE_BOOT / TRACE_DAY_CHANGE)
+#define TRACE_SYNC_SENSOR1      0x01
+#define TRACE_SYNC_SENSOR2      0x02
+#define TRACE_SYNC_PUMP         0x04
+#define TRACE_SYNC_STATE_SHIFT  4
+
+// TRACE_DAILY_VOLUME arg
+#define TRACE_FLAG_PUMP_ENABLED     0x01
+#define TRACE_FLAG_SYSTEM_DISABLED  0x02
+
+struct TraceRecord {
+    uint32_t ms;        // millis() (edge time for TRACE_SENSOR)
+    uint8_t  type;      // TraceType
+    uint8_t  arg;
+    uint16_t crc;       // CRC16 of the record with crc = 0
+    uint32_t data;
+};
+
+static_assert(sizeof(TraceRecord) == FRAM_TRACE_RECORD_SIZE, "TraceRecord must match the FRAM slot size");
+
+// Download format: header, then `count` records oldest first
+struct TraceDumpHeader {
+    uint32_t magic;         // TRACE_DUMP_MAGIC
+    uint16_t version;       // TRACE_DUMP_VERSION
+    uint16_t recordSize;    // sizeof(TraceRecord)
+    uint16_t count;
+    uint16_t dropped;       // Records overwritten while full (saturating)
+    uint16_t boots;         // TRACE_BOOT records written (saturating)
+    uint16_t reserved;
+};
+
+static_assert(sizeof(TraceDumpHeader) == 16, "TraceDumpHeader is part of the download format");
+
+struct TraceStats {
+    uint16_t count;
+    uint16_t capacity;
+    uint16_t dropped;
+    uint16_t boots;
+    uint32_t writeErrors;
+};
+
+bool initTraceRecorder();
+
+void traceRecord(TraceType type, uint8_t arg = 0, uint32_t data = 0);
+void traceRecordAt(uint32_t ms, TraceType type, uint8_t arg, uint32_t data);
+
+// Sync point: TRACE_BOOT or TRACE_DAY_CHANGE + TRACE_DAILY_VOLUME + TRACE_SETTINGS + TRACE_PARAMS
+// + TRACE_ADAPTIVE
+void traceSyncPoint(TraceType anchor);
+void traceCycle(const PumpCycle& cycle);
+void traceParams(const AlgorithmParams& params);
+uint8_t tracePumpSource(const String& actionType);
+
+bool traceRecordValid(const TraceRecord& record);
+void traceDecodeCycle(const TraceRecord& sensors, const TraceRecord& pump, PumpCycle& cycle);
+void traceDecodeParams(const TraceRecord& record, AlgorithmParams& params);   // updates the fields in `record`
+
+// Download: beginTraceDump() freezes the ring position and returns the
+// full size, or 0 while another dump is open; readTraceDump() is a chunked
+// AwsResponseFiller (FRAM reads) and endTraceDump() releases the dump.
+// Recording is not paused - if the writer wraps onto records not yet sent,
+// readTraceDump() returns 0 early (the body is shorter than `count`).
+size_t beginTraceDump();
+size_t readTraceDump(uint8_t* buffer, size_t maxLen, size_t index);
+void endTraceDump();
+bool clearTrace();
+
+TraceStats getTraceStats();
+
+#endif
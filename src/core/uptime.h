@@ -0,0 +1,40 @@
+#ifndef UPTIME_H
+#define UPTIME_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// ===============================
+// MONOTONIC TIME BASE
+// ===============================
+// millis() is 32 bits and wraps after 49.7 days: "until > millis()" checks
+// break there and millis() / 1000 jumps back from 4294967 to 0. esp_timer
+// counts us since boot in 64 bits (no wrap for ~292,000 years), so every
+// timer that has to survive months of uptime is kept as a uint64_t
+// uptimeMs() stamp and compared directly.
+
+inline uint64_t uptimeMs() {
+    return (uint64_t)esp_timer_get_time() / 1000ULL;
+}
+
+// Whole seconds since boot - state timers and cycle trigger times
+inline uint32_t uptimeSeconds() {
+    return (uint32_t)(uptimeMs() / 1000ULL);
+}
+
+// Widens a recent 32-bit millis() stamp (sensor edge, trace record) to the
+// 64-bit base - valid while it is less than 49.7 days old
+inline uint64_t uptimeFromMillis(uint32_t ms) {
+    uint64_t now = uptimeMs();
+    return now - (uint32_t)((uint32_t)now - ms);
+}
+
+// ms left until since + period (0 once passed) - deadline waits for the control task
+inline uint32_t uptimeRemainingMs(uint64_t since, uint64_t period) {
+    uint64_t elapsed = uptimeMs() - since;
+    if (elapsed >= period) return 0;
+    uint64_t remaining = period - elapsed;
+    return remaining > UINT32_MAX ? UINT32_MAX : (uint32_t)remaining;
+}
+
+#endif
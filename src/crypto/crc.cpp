@@ -0,0 +1,105 @@
+#include "crc.h"
+
+#if defined(ESP_PLATFORM)
+
+#include <esp_rom_crc.h>
+
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc) {
+    return esp_rom_crc16_le(crc, data, len);
+}
+
+uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc) {
+    return esp_rom_crc32_le(crc, data, len);
+}
+
+#else
+
+// ===============================
+// TABLE-DRIVEN (HOST)
+// ===============================
+
+static uint16_t crc16Table[256];
+static uint32_t crc32Table[256];
+static bool tablesReady = false;
+
+static void buildTables() {
+    for (uint16_t i = 0; i < 256; i++) {
+        uint16_t c16 = i;
+        uint32_t c32 = i;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            c16 = (c16 & 1) ? (c16 >> 1) ^ 0x8408 : (c16 >> 1);
+            c32 = (c32 & 1) ? (c32 >> 1) ^ 0xEDB88320UL : (c32 >> 1);
+        }
+        crc16Table[i] = c16;
+        crc32Table[i] = c32;
+    }
+    tablesReady = true;
+}
+
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc) {
+    if (!tablesReady) buildTables();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc >> 8) ^ crc16Table[(crc ^ data[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc) {
+    if (!tablesReady) buildTables();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc >> 8) ^ crc32Table[(crc ^ data[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+#endif
+
+uint16_t additiveSum16(const uint8_t* data, size_t len) {
+    uint16_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+// ===============================
+// BENCHMARK
+// ===============================
+
+#define CHECKSUM_BENCH_MAX_BYTES 1024
+
+ChecksumBenchmark benchmarkChecksums(uint16_t bytes, uint16_t rounds) {
+    static uint8_t buffer[CHECKSUM_BENCH_MAX_BYTES];
+    if (bytes > CHECKSUM_BENCH_MAX_BYTES) bytes = CHECKSUM_BENCH_MAX_BYTES;
+    if (rounds == 0) rounds = 1;
+
+    for (uint16_t i = 0; i < bytes; i++) {
+        buffer[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    ChecksumBenchmark result;
+    result.bytes = bytes;
+    result.rounds = rounds;
+
+    // volatile sink - keeps the loops from being optimised away
+    volatile uint32_t sink = 0;
+
+    unsigned long start = micros();
+    for (uint16_t r = 0; r < rounds; r++) sink += additiveSum16(buffer, bytes);
+    result.sumUs = micros() - start;
+
+    start = micros();
+    for (uint16_t r = 0; r < rounds; r++) sink += crc16(buffer, bytes);
+    result.crc16Us = micros() - start;
+
+    start = micros();
+    for (uint16_t r = 0; r < rounds; r++) sink += crc32(buffer, bytes);
+    result.crc32Us = micros() - start;
+
+    (void)sink;
+    return result;
+}
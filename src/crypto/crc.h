@@ -0,0 +1,32 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <Arduino.h>
+
+// ===============================
+// CRC INTEGRITY
+// ===============================
+// On the ESP32-C3 both CRCs run from the ROM routines (esp_rom_crc16_le /
+// esp_rom_crc32_le); host builds use a 256-entry table. Results are
+// identical - pass the previous result to chain blocks.
+
+// CRC-16/X-25 (reflected poly 0x1021, init/xorout 0xFFFF) - check("123456789") = 0x906E
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0);
+
+// CRC-32/ISO-HDLC (zlib, reflected poly 0x04C11DB7) - check("123456789") = 0xCBF43926
+uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+// Old additive byte sum - only for reading blocks written before the CRC layout
+uint16_t additiveSum16(const uint8_t* data, size_t len);
+
+struct ChecksumBenchmark {
+    uint16_t bytes;       // Buffer size per round
+    uint16_t rounds;
+    uint32_t sumUs;       // additiveSum16, total over all rounds
+    uint32_t crc16Us;
+    uint32_t crc32Us;
+};
+
+ChecksumBenchmark benchmarkChecksums(uint16_t bytes = 1024, uint16_t rounds = 100);
+
+#endif
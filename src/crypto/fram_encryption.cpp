@@ -1,4 +1,5 @@
 #include "fram_encryption.h"
+#include "crc.h"
 #include "../core/logging.h"
 #include <cstring>
 #include <new> 
@@ -230,9 +231,9 @@ bool encryptCredentials(const DeviceCredentials& creds, FRAMCredentials& fram_cr
     // Clear the structure
     memset(&fram_creds, 0, sizeof(FRAMCredentials));
     
-    // Set magic and version - INCREMENT VERSION TO 3
+    // Set magic and version (v4 = CRC16 checksum)
     fram_creds.magic = FRAM_MAGIC_NUMBER;
-    fram_creds.version = 0x0003;  // 🆕 NEW VERSION
+    fram_creds.version = FRAM_CREDENTIALS_VERSION;
     
     // Copy device name (plain text)
     strncpy(fram_creds.device_name, creds.device_name.c_str(), 31);
@@ -312,9 +313,7 @@ bool encryptCredentials(const DeviceCredentials& creds, FRAMCredentials& fram_cr
     }
     
     // Calculate checksum (only bytes before checksum field)
-    size_t checksum_offset = offsetof(FRAMCredentials, checksum);
-    uint16_t temp_checksum = calculateChecksum((uint8_t*)&fram_creds, checksum_offset);
-    fram_creds.checksum = temp_checksum;
+    fram_creds.checksum = calculateCredentialsChecksum(fram_creds);
     
     LOG_INFO("SUCCESS: Credentials encrypted with VPS URL");
     return true;
@@ -427,12 +426,15 @@ bool validateVPSToken(const String& token) {
     return (token.length() > 0 && token.length() <= MAX_VPS_TOKEN_LEN);
 }
 
-uint16_t calculateChecksum(const uint8_t* data, size_t size) {
-    uint16_t sum = 0;
-    for (size_t i = 0; i < size; i++) {
-        sum += data[i];
+uint16_t calculateCredentialsChecksum(const FRAMCredentials& creds) {
+    size_t checksum_offset = offsetof(FRAMCredentials, checksum);
+    const uint8_t* data = (const uint8_t*)&creds;
+
+    // Blocks written by older programmers keep their byte sum
+    if (creds.version < FRAM_CREDENTIALS_CRC_MIN) {
+        return additiveSum16(data, checksum_offset);
     }
-    return sum;
+    return crc16(data, checksum_offset);
 }
 
 // NEW FUNCTIONS 
@@ -142,8 +142,8 @@ bool validateVPSURL(const String& url);        // 🆕 NEW
 bool sha256Hash(const String& input, uint8_t* hash);
 bool sha256Hash(const uint8_t* data, size_t len, uint8_t* hash);
 
-// Checksum calculation
-uint16_t calculateChecksum(const uint8_t* data, size_t size);
+// Checksum over the bytes before `checksum` (CRC16 from v4, byte sum before)
+uint16_t calculateCredentialsChecksum(const FRAMCredentials& creds);
 
 void secureZeroMemory(void* ptr, size_t size);
 
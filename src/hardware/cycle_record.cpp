@@ -0,0 +1,186 @@
+#include "cycle_record.h"
+#include "fram_journal.h"
+#include "../algorithm/algorithm_config.h"
+#include "../crypto/crc.h"
+#include "../core/logging.h"
+
+// ===============================
+// LITTLE-ENDIAN HELPERS
+// ===============================
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t saturate16(uint32_t v) {
+    return (v > 0xFFFF) ? 0xFFFF : (uint16_t)v;
+}
+
+// ===============================
+// CODEC
+// ===============================
+
+void encodeCycleRecord(const PumpCycle& cycle, uint8_t out[CYCLE_RECORD_ENCODED_SIZE]) {
+    out[0] = CYCLE_RECORD_VERSION;
+    out[1] = cycle.sensor_results;
+    put32(out + 2, cycle.timestamp);
+    put16(out + 6, saturate16(cycle.time_gap_1));
+    put16(out + 8, saturate16(cycle.time_gap_2));
+    put16(out + 10, saturate16(cycle.water_trigger_time));
+    put16(out + 12, cycle.pump_duration);
+    put16(out + 14, cycle.volume_dose);
+    out[16] = cycle.pump_attempts;
+    out[17] = cycle.error_code;
+    put32(out + 18, cycle.trigger_time);
+    put16(out + 22, crc16(out, 22));
+}
+
+bool decodeCycleRecord(const uint8_t in[CYCLE_RECORD_ENCODED_SIZE], PumpCycle& cycle) {
+    if (in[0] != CYCLE_RECORD_VERSION) return false;
+    if (get16(in + 22) != crc16(in, 22)) return false;
+
+    cycle = {};
+    cycle.sensor_results = in[1];
+    cycle.timestamp = get32(in + 2);
+    cycle.time_gap_1 = get16(in + 6);
+    cycle.time_gap_2 = get16(in + 8);
+    cycle.water_trigger_time = get16(in + 10);
+    cycle.pump_duration = get16(in + 12);
+    cycle.volume_dose = get16(in + 14);
+    cycle.pump_attempts = in[16];
+    cycle.error_code = in[17];
+    cycle.trigger_time = get32(in + 18);
+    return true;
+}
+
+// ===============================
+// V3 -> V4 MIGRATION
+// ===============================
+// v3 wrote the raw 28-byte PumpCycle into 24-byte slots, so bytes 24-27
+// (error_code, padding, volume_dose) of every record were overwritten by
+// the next record's timestamp. Only the newest record still has them.
+
+#define V3_RECORD_SIZE 28
+
+static void decodeV3Record(const uint8_t* raw, bool hasTail, PumpCycle& cycle) {
+    cycle = {};
+    cycle.timestamp = get32(raw + 0);
+    cycle.trigger_time = get32(raw + 4);
+    cycle.time_gap_1 = get32(raw + 8);
+    cycle.time_gap_2 = get32(raw + 12);
+    cycle.water_trigger_time = get32(raw + 16);
+    cycle.pump_duration = get16(raw + 20);
+    cycle.pump_attempts = raw[22];
+    cycle.sensor_results = raw[23];
+    if (hasTail) {
+        cycle.error_code = raw[24];
+        cycle.volume_dose = get16(raw + 26);
+    }
+}
+
+static uint16_t cycleSlotAddress(uint16_t index) {
+    return FRAM_ADDR_CYCLE_DATA + (index * FRAM_CYCLE_SIZE);
+}
+
+// One converted slot + the ring header in one transaction. `progress` is
+// the header the slot is committed with: the next step, or the final v4 header.
+static bool migrateRecord(uint16_t index, const PumpCycle& cycle, CycleRingHeader progress) {
+    uint8_t encoded[CYCLE_RECORD_ENCODED_SIZE];
+    encodeCycleRecord(cycle, encoded);
+    progress.crc = cycleRingHeaderCRC(progress);
+
+    FramTransaction tx;
+    return tx.write(cycleSlotAddress(index), encoded, sizeof(encoded)) &&
+           tx.write(FRAM_ADDR_CYCLE_COUNT, &progress, sizeof(progress)) &&
+           tx.commit();
+}
+
+static bool isMigrationInProgress(const CycleRingHeader& header) {
+    return (header.format & CYCLE_FORMAT_MIGRATING) &&
+           header.crc == cycleRingHeaderCRC(header) &&
+           header.count <= FRAM_MAX_CYCLES && header.writeIndex < FRAM_MAX_CYCLES;
+}
+
+bool migrateCycleRecords() {
+    CycleRingHeader header;
+    if (!readFRAMBlock(FRAM_ADDR_CYCLE_COUNT, (uint8_t*)&header, sizeof(header))) return false;
+    if (header.format == CYCLE_RECORD_VERSION) return true;
+
+    uint16_t cycleCount = header.count;
+    uint16_t writeIndex = header.writeIndex;
+
+    if (cycleCount > FRAM_MAX_CYCLES || writeIndex >= FRAM_MAX_CYCLES) {
+        LOG_WARNING("Cycle ring header invalid - starting empty (v%d records)", CYCLE_RECORD_VERSION);
+        header.count = 0;
+        header.writeIndex = 0;
+        header.format = CYCLE_RECORD_VERSION;
+        return saveCycleRingHeader(header);
+    }
+
+    if (cycleCount == 0) {
+        header.format = CYCLE_RECORD_VERSION;
+        return saveCycleRingHeader(header);
+    }
+
+    // count/writeIndex stay at their v3 values until the last step, so a
+    // resumed migration derives the same tail, newest and `first`
+    uint16_t step = 0;
+    if (isMigrationInProgress(header)) {
+        step = header.format & CYCLE_FORMAT_PROGRESS_MASK;
+        LOG_WARNING("Resuming FRAM cycle migration at record %d/%d", step, cycleCount);
+    } else {
+        LOG_INFO("Migrating %d FRAM cycle records v3 -> v%d", cycleCount, CYCLE_RECORD_VERSION);
+    }
+
+    uint16_t tailIndex = (writeIndex + FRAM_MAX_CYCLES - cycleCount) % FRAM_MAX_CYCLES;
+    uint16_t newestIndex = (writeIndex + FRAM_MAX_CYCLES - 1) % FRAM_MAX_CYCLES;
+
+    // The newest record's tail bytes live in the next slot, which the
+    // migration never writes - still readable when resuming
+    uint8_t raw[V3_RECORD_SIZE];
+    PumpCycle newest;
+    readFRAMBlock(cycleSlotAddress(newestIndex), raw, V3_RECORD_SIZE);
+    decodeV3Record(raw, true, newest);
+
+    // In a full ring that next slot is the oldest record: its timestamp is gone
+    uint16_t first = (cycleCount == FRAM_MAX_CYCLES && newestIndex != FRAM_MAX_CYCLES - 1) ? 1 : 0;
+    if (step < first) step = first;
+
+    CycleRingHeader progress = header;
+    for (uint16_t i = step; i + 1 < cycleCount; i++) {
+        uint16_t index = (tailIndex + i) % FRAM_MAX_CYCLES;
+        PumpCycle cycle;
+        readFRAMBlock(cycleSlotAddress(index), raw, FRAM_CYCLE_SIZE);
+        decodeV3Record(raw, false, cycle);
+
+        progress.format = CYCLE_FORMAT_MIGRATING | (i + 1);
+        if (!migrateRecord(index, cycle, progress)) return false;
+    }
+
+    // Newest record with the final header: drop the clobbered oldest record
+    // (if any) by advancing the tail; count, index and format land together
+    CycleRingHeader done = header;
+    done.count = cycleCount - first;
+    done.writeIndex = writeIndex;
+    done.format = CYCLE_RECORD_VERSION;
+    if (!migrateRecord(newestIndex, newest, done)) return false;
+
+    LOG_INFO("Cycle migration complete: %d records", done.count);
+    return true;
+}
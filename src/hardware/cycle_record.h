@@ -0,0 +1,50 @@
+#ifndef CYCLE_RECORD_H
+#define CYCLE_RECORD_H
+
+#include <Arduino.h>
+#include "fram_controller.h"
+
+struct PumpCycle;
+
+// ===============================
+// FRAM CYCLE RECORD CODEC
+// ===============================
+// Explicit little-endian layout - independent of PumpCycle padding.
+//
+//  off size field
+//   0   1   record version (CYCLE_RECORD_VERSION)
+//   1   1   sensor_results
+//   2   4   timestamp (unix)
+//   6   2   time_gap_1          (saturated to 0xFFFF)
+//   8   2   time_gap_2          (saturated to 0xFFFF)
+//  10   2   water_trigger_time  (saturated to 0xFFFF)
+//  12   2   pump_duration
+//  14   2   volume_dose
+//  16   1   pump_attempts
+//  17   1   error_code
+//  18   4   trigger_time (uptime seconds)
+//  22   2   CRC16 of bytes 0-21
+
+#define CYCLE_RECORD_VERSION      4      // v3 = raw PumpCycle memcpy (overlapping slots)
+#define CYCLE_RECORD_ENCODED_SIZE 24
+#define CYCLE_RECORD_TIMESTAMP_OFFSET 2  // Retention reads only this field
+
+static_assert(CYCLE_RECORD_ENCODED_SIZE == FRAM_CYCLE_SIZE,
+              "Encoded cycle record must fill exactly one FRAM cycle slot");
+
+void encodeCycleRecord(const PumpCycle& cycle, uint8_t out[CYCLE_RECORD_ENCODED_SIZE]);
+
+// false on version or CRC mismatch
+bool decodeCycleRecord(const uint8_t in[CYCLE_RECORD_ENCODED_SIZE], PumpCycle& cycle);
+
+// Ring header `format` while a v3 -> v4 migration is in progress: the low
+// bits are the next record (oldest first) still to convert
+#define CYCLE_FORMAT_MIGRATING      0x8000
+#define CYCLE_FORMAT_PROGRESS_MASK  0x7FFF
+
+// Convert v3 records in place (called from initFRAM). Each slot is committed
+// together with the progress in the ring header, so a reset mid-way resumes
+// instead of decoding converted slots as v3.
+bool migrateCycleRecords();
+
+#endif
@@ -0,0 +1,71 @@
+#include "fram_cache.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+struct CacheSlot {
+    bool valid;
+    uint8_t len;
+    uint8_t data[FRAM_CACHE_MAX_ENTRY_SIZE];
+};
+
+static CacheSlot slots[FRAM_CACHE_ENTRY_COUNT];
+static FramCacheStats cacheStats = {0, 0};
+
+// Web handlers (async_tcp task) read stats while the loop task updates them
+static SemaphoreHandle_t cacheMutex = nullptr;
+
+static void lockCache() {
+    if (cacheMutex == nullptr) {
+        cacheMutex = xSemaphoreCreateMutex();
+    }
+    xSemaphoreTake(cacheMutex, portMAX_DELAY);
+}
+
+static void unlockCache() {
+    xSemaphoreGive(cacheMutex);
+}
+
+bool framCacheGet(FramCacheEntry entry, void* out, size_t len) {
+    if (entry >= FRAM_CACHE_ENTRY_COUNT) return false;
+
+    lockCache();
+    bool hit = slots[entry].valid && slots[entry].len == len;
+    if (hit) {
+        memcpy(out, slots[entry].data, len);
+        cacheStats.hits++;
+    } else {
+        cacheStats.misses++;
+    }
+    unlockCache();
+    return hit;
+}
+
+void framCachePut(FramCacheEntry entry, const void* data, size_t len) {
+    if (entry >= FRAM_CACHE_ENTRY_COUNT || len > FRAM_CACHE_MAX_ENTRY_SIZE) return;
+
+    lockCache();
+    memcpy(slots[entry].data, data, len);
+    slots[entry].len = len;
+    slots[entry].valid = true;
+    unlockCache();
+}
+
+void framCacheInvalidate(FramCacheEntry entry) {
+    if (entry >= FRAM_CACHE_ENTRY_COUNT) return;
+
+    lockCache();
+    slots[entry].valid = false;
+    unlockCache();
+}
+
+void reloadFRAMCache() {
+    lockCache();
+    for (uint8_t i = 0; i < FRAM_CACHE_ENTRY_COUNT; i++) {
+        slots[i].valid = false;
+    }
+    unlockCache();
+}
+
+const FramCacheStats& getFramCacheStats() {
+    return cacheStats;
+}
@@ -0,0 +1,40 @@
+#ifndef FRAM_CACHE_H
+#define FRAM_CACHE_H
+
+#include <Arduino.h>
+
+// ===============================
+// FRAM SHADOW CACHE
+// ===============================
+// RAM copies of hot FRAM metadata. fram_controller serves loads from here
+// and writes every save through to FRAM first, then into the cache.
+// Entries are only dropped by reloadFRAMCache() - anything that edits
+// these regions behind fram_controller's back must call it.
+
+enum FramCacheEntry {
+    FRAM_CACHE_ERROR_STATS = 0,   // ErrorStats
+    FRAM_CACHE_DAILY_VOLUME,      // DailyVolumeData
+    FRAM_CACHE_RING_HEADER,       // CycleRingHeader
+    FRAM_CACHE_PUMP_CALIBRATION,  // float volumePerSecond
+    FRAM_CACHE_CH1_ERROR_STATS,   // Water channel 1 partition (fram_controller.h)
+    FRAM_CACHE_CH1_DAILY_VOLUME,
+    FRAM_CACHE_CH1_RING_HEADER,
+    FRAM_CACHE_ENTRY_COUNT
+};
+
+#define FRAM_CACHE_MAX_ENTRY_SIZE 16
+
+struct FramCacheStats {
+    uint32_t hits;     // Loads served from RAM
+    uint32_t misses;   // Loads that went to FRAM
+};
+
+// false = not cached, caller reads FRAM and calls framCachePut()
+bool framCacheGet(FramCacheEntry entry, void* out, size_t len);
+void framCachePut(FramCacheEntry entry, const void* data, size_t len);
+void framCacheInvalidate(FramCacheEntry entry);   // After a failed write-through
+
+void reloadFRAMCache();
+const FramCacheStats& getFramCacheStats();
+
+#endif
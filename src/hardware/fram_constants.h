@@ -8,7 +8,12 @@
 
 // Magic number and version (shared between FRAM programmer and ESP32)
 #define FRAM_MAGIC_NUMBER      0x57415452  // "WATR" in hex
-#define FRAM_DATA_VERSION      0x0003      // 🆕 Version 3 (with VPS_URL support)
+#define FRAM_DATA_VERSION      0x0004      // Version 4 (CRC16 integrity on every block)
+
+// Credentials block version written by encryptCredentials()
+// v3: VPS_URL support, v4: CRC16 checksum (v1-v3 use the old byte sum)
+#define FRAM_CREDENTIALS_VERSION  0x0004
+#define FRAM_CREDENTIALS_CRC_MIN  0x0004
 
 // FRAM Programmer encryption constants
 #define ENCRYPTION_SALT "ESP32_FRAM_SALT_2024"
@@ -5,6 +5,13 @@
 #include <Adafruit_FRAM_I2C.h>
 #include "../algorithm/algorithm_config.h"
 #include "rtc_controller.h"
+#include "cycle_record.h"
+#include "fram_io.h"
+#include "i2c_bus.h"
+#include "fram_cache.h"
+#include "fram_journal.h"
+#include "../core/metrics.h"
+#include "../crypto/crc.h"
 
 #include "../crypto/fram_encryption.h"
 
@@ -15,20 +22,42 @@
 Adafruit_FRAM_I2C fram = Adafruit_FRAM_I2C();
 bool framInitialized = false;
 
-// Calculate simple checksum
-uint16_t calculateChecksum(uint8_t* data, size_t len) {
-    uint16_t sum = 0;
-    for (size_t i = 0; i < len; i++) {
-        sum += data[i];
-    }
-    return sum;
+static void resealLegacyChecksums();
+
+// ===============================
+// WATER CHANNEL PARTITIONS
+// ===============================
+
+struct FramChannelLayout {
+    uint16_t statsAddr;         // 12-byte error stats block
+    uint16_t dailyVolumeAddr;   // 8-byte daily volume block
+    uint16_t cycleHeaderAddr;   // CycleRingHeader
+    uint16_t cycleDataAddr;     // FRAM_MAX_CYCLES x FRAM_CYCLE_SIZE
+    FramCacheEntry statsCache;
+    FramCacheEntry dailyVolumeCache;
+    FramCacheEntry ringHeaderCache;
+};
+
+static const FramChannelLayout channelLayouts[FRAM_WATER_CHANNELS] = {
+    { FRAM_ADDR_GAP1_SUM, FRAM_ADDR_DAILY_VOLUME, FRAM_ADDR_CYCLE_COUNT, FRAM_ADDR_CYCLE_DATA,
+      FRAM_CACHE_ERROR_STATS, FRAM_CACHE_DAILY_VOLUME, FRAM_CACHE_RING_HEADER },
+    { FRAM_ADDR_CH1_STATS, FRAM_ADDR_CH1_DAILY_VOLUME, FRAM_ADDR_CH1_CYCLE_HEADER, FRAM_ADDR_CH1_CYCLE_DATA,
+      FRAM_CACHE_CH1_ERROR_STATS, FRAM_CACHE_CH1_DAILY_VOLUME, FRAM_CACHE_CH1_RING_HEADER },
+};
+
+static_assert(WATER_CHANNEL_COUNT <= FRAM_WATER_CHANNELS, "FRAM has no partition for every water channel");
+static_assert(FRAM_ADDR_CH1_CYCLE_DATA + FRAM_MAX_CYCLES * FRAM_CYCLE_SIZE <= 0x8000,
+              "Channel 1 cycle ring exceeds the 32 KB FRAM");
+
+static const FramChannelLayout& layoutFor(uint8_t channel) {
+    return channelLayouts[channel < FRAM_WATER_CHANNELS ? channel : 0];
 }
 
 bool initFRAM() {
     LOG_INFO("Initializing FRAM at address 0x50...");
     
-    // FRAM uses same I2C as RTC - already initialized in rtc_controller
-    // Just begin FRAM communication
+    // FRAM shares the bus with the RTC - started by initI2CBus()
+    I2CBusGuard guard;
     if (!fram.begin(0x50)) {
         LOG_ERROR("FRAM not found at address 0x50!");
         framInitialized = false;
@@ -37,6 +66,12 @@ bool initFRAM() {
     
     framInitialized = true;
     LOG_INFO("FRAM initialized successfully (256Kbit = 32KB)");
+
+    // Finish or roll back a transaction interrupted by reset / power loss
+    // (before the layout check - replayed blocks may still need resealing)
+    if (!recoverFramJournal()) {
+        LOG_ERROR("FRAM journal recovery failed");
+    }
     
     // Verify FRAM integrity
     if (!verifyFRAM()) {
@@ -57,16 +92,25 @@ bool initFRAM() {
         // Calculate and write checksum
         uint8_t buffer[4];
         fram.read(FRAM_ADDR_VOLUME_ML, buffer, 4);
-        uint16_t checksum = calculateChecksum(buffer, 4);
+        uint16_t checksum = crc16(buffer, 4);
         fram.write(FRAM_ADDR_CHECKSUM, (uint8_t*)&checksum, 2);
         
         LOG_INFO("FRAM initialized with defaults");
     }
+
+    // Convert cycle history written by older firmware
+    if (!migrateCycleRecords()) {
+        LOG_ERROR("FRAM cycle record migration failed");
+    }
+
+    // Start with an empty shadow cache - first loads come from FRAM
+    reloadFRAMCache();
     
     return true;
 }
 bool verifyFRAM() {
     if (!framInitialized) return false;
+    I2CBusGuard guard;
     
     // Check magic number
     uint32_t magic = 0;
@@ -82,6 +126,16 @@ bool verifyFRAM() {
     fram.read(FRAM_ADDR_VERSION, (uint8_t*)&version, 2);
     
     if (version != FRAM_DATA_VERSION) {
+        // v3 -> v4: same layout, byte sums replaced by CRC16
+        if (version == 0x0002 || version == 0x0003) {
+            LOG_INFO("Upgrading FRAM checksums v%d -> v%d (CRC16)", version, FRAM_DATA_VERSION);
+            resealLegacyChecksums();
+
+            uint16_t newVersion = FRAM_DATA_VERSION;
+            fram.write(FRAM_ADDR_VERSION, (uint8_t*)&newVersion, 2);
+            return true;
+        }
+
         // Auto-upgrade from version 1 to 2
         if (version == 0x0001) {
             LOG_INFO("Auto-upgrading FRAM from v1 to v2 (unified layout)");
@@ -94,6 +148,7 @@ bool verifyFRAM() {
             defaultStats.last_reset_timestamp = millis() / 1000;
                 
             saveErrorStatsToFRAM(defaultStats);
+            resealLegacyChecksums();
                 
             // Update version
             uint16_t newVersion = FRAM_DATA_VERSION;
@@ -109,7 +164,7 @@ bool verifyFRAM() {
     // Verify ESP32 data checksum
     uint8_t buffer[4];
     fram.read(FRAM_ADDR_VOLUME_ML, buffer, 4);
-    uint16_t calculatedChecksum = calculateChecksum(buffer, 4);
+    uint16_t calculatedChecksum = crc16(buffer, 4);
     
     uint16_t storedChecksum = 0;
     fram.read(FRAM_ADDR_CHECKSUM, (uint8_t*)&storedChecksum, 2);
@@ -124,19 +179,96 @@ bool verifyFRAM() {
     return true;
 }
 
+bool isFRAMAvailable() {
+    return framInitialized;
+}
+
+bool readFRAMBlock(uint16_t addr, uint8_t* data, size_t len) {
+    if (!framInitialized) {
+        return false;
+    }
+    return framBurstRead(addr, data, len);
+}
+
+bool writeFRAMBlock(uint16_t addr, const uint8_t* data, size_t len) {
+    if (!framInitialized) {
+        return false;
+    }
+    return framBurstWrite(addr, data, len);
+}
+
+// ===============================
+// CYCLE RING HEADER
+// ===============================
+
+uint16_t cycleRingHeaderCRC(const CycleRingHeader& header) {
+    return crc16((const uint8_t*)&header, offsetof(CycleRingHeader, crc));
+}
+
+bool loadCycleRingHeader(CycleRingHeader& header, uint8_t channel) {
+    if (!framInitialized) return false;
+
+    const FramChannelLayout& layout = layoutFor(channel);
+    if (framCacheGet(layout.ringHeaderCache, &header, sizeof(header))) {
+        return true;
+    }
+
+    if (!framBurstRead(layout.cycleHeaderAddr, (uint8_t*)&header, sizeof(header))) {
+        return false;
+    }
+
+    if (header.crc != cycleRingHeaderCRC(header)) {
+        // Count/index can't be trusted - restart the ring rather than read garbage
+        LOG_WARNING("FRAM cycle header CRC mismatch (channel %d) - starting empty ring", channel);
+        header.count = 0;
+        header.writeIndex = 0;
+        header.format = CYCLE_RECORD_VERSION;
+        return saveCycleRingHeader(header, channel);
+    }
+
+    if (header.count > FRAM_MAX_CYCLES || header.writeIndex >= FRAM_MAX_CYCLES) {
+        LOG_WARNING("FRAM cycle header invalid (count %d, index %d)", header.count, header.writeIndex);
+        return false;
+    }
+
+    framCachePut(layout.ringHeaderCache, &header, sizeof(header));
+    return true;
+}
+
+bool saveCycleRingHeader(const CycleRingHeader& header, uint8_t channel) {
+    if (!framInitialized) return false;
+
+    const FramChannelLayout& layout = layoutFor(channel);
+    CycleRingHeader sealed = header;
+    sealed.crc = cycleRingHeaderCRC(sealed);
+
+    if (!framBurstWrite(layout.cycleHeaderAddr, (const uint8_t*)&sealed, sizeof(sealed))) {
+        framCacheInvalidate(layout.ringHeaderCache);
+        return false;
+    }
+
+    framCachePut(layout.ringHeaderCache, &sealed, sizeof(sealed));
+    return true;
+}
+
 bool loadVolumeFromFRAM(float& volume) {
     if (!framInitialized) {
         LOG_ERROR("FRAM not initialized, cannot load volume");
         return false;
     }
+
+    if (framCacheGet(FRAM_CACHE_PUMP_CALIBRATION, &volume, sizeof(volume))) {
+        return true;
+    }
     
     // Read volume value
+    I2CBusGuard guard;
     fram.read(FRAM_ADDR_VOLUME_ML, (uint8_t*)&volume, 4);
     
     // Verify checksum
     uint8_t buffer[4];
     memcpy(buffer, &volume, 4);
-    uint16_t calculatedChecksum = calculateChecksum(buffer, 4);
+    uint16_t calculatedChecksum = crc16(buffer, 4);
     
     uint16_t storedChecksum = 0;
     fram.read(FRAM_ADDR_CHECKSUM, (uint8_t*)&storedChecksum, 2);
@@ -153,6 +285,7 @@ bool loadVolumeFromFRAM(float& volume) {
         return false;
     }
     
+    framCachePut(FRAM_CACHE_PUMP_CALIBRATION, &volume, sizeof(volume));
     LOG_INFO("Loaded volume from FRAM: %.1f ml/s", volume);
     return true;
 }
@@ -169,24 +302,19 @@ bool saveVolumeToFRAM(float volume) {
         return false;
     }
     
-    // Write volume
-    fram.write(FRAM_ADDR_VOLUME_ML, (uint8_t*)&volume, 4);
-    
-    // Calculate and write checksum
-    uint8_t buffer[4];
-    memcpy(buffer, &volume, 4);
-    uint16_t checksum = calculateChecksum(buffer, 4);
-    fram.write(FRAM_ADDR_CHECKSUM, (uint8_t*)&checksum, 2);
-    
-    // Verify write by reading back
-    float readBack = 0;
-    fram.read(FRAM_ADDR_VOLUME_ML, (uint8_t*)&readBack, 4);
-    
-    if (abs(readBack - volume) > 0.01) {
-        LOG_ERROR("FRAM write verification failed! Wrote: %.2f, Read: %.2f", 
-                  volume, readBack);
+    // Volume + checksum are adjacent - one burst, checksum validates on load
+    uint8_t block[6];
+    memcpy(block, &volume, 4);
+    uint16_t checksum = crc16(block, 4);
+    memcpy(block + 4, &checksum, 2);
+
+    if (!framBurstWrite(FRAM_ADDR_VOLUME_ML, block, sizeof(block))) {
+        LOG_ERROR("FRAM volume write failed");
+        framCacheInvalidate(FRAM_CACHE_PUMP_CALIBRATION);
         return false;
     }
+
+    framCachePut(FRAM_CACHE_PUMP_CALIBRATION, &volume, sizeof(volume));
     
     LOG_INFO("SUCCESS: Saved volume to FRAM: %.1f ml/s", volume);
     return true;
@@ -205,6 +333,7 @@ void testFRAM() {
                             0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
     uint8_t readData[16];
     
+    I2CBusGuard guard;
     fram.write(0x1000, testData, 16);  // Test address at 4KB offset
     fram.read(0x1000, readData, 16);
     
@@ -241,137 +370,166 @@ void testFRAM() {
     LOG_INFO("=== FRAM Test Complete ===");
 }
 
-bool saveCycleToFRAM(const PumpCycle& cycle) {
-    if (!framInitialized) {
-        LOG_ERROR("FRAM not initialized for cycle save");
+// Stage record + advanced ring header into a transaction
+static bool stageCycleRecord(FramTransaction& tx, const PumpCycle& cycle, uint8_t channel, uint16_t& savedIndex) {
+    CycleRingHeader header;
+    if (!loadCycleRingHeader(header, channel)) {
         return false;
     }
     
-    // Read current cycle count and index
-    uint16_t cycleCount = 0;
-    uint16_t writeIndex = 0;
-    
-    fram.read(FRAM_ADDR_CYCLE_COUNT, (uint8_t*)&cycleCount, 2);
-    fram.read(FRAM_ADDR_CYCLE_INDEX, (uint8_t*)&writeIndex, 2);
-    
-    // Calculate write address
-    uint16_t writeAddr = FRAM_ADDR_CYCLE_DATA + (writeIndex * FRAM_CYCLE_SIZE);
-    
-    // Write cycle data
-    fram.write(writeAddr, (uint8_t*)&cycle, sizeof(PumpCycle));
+    // Versioned, CRC-protected, exactly one slot
+    uint8_t encoded[CYCLE_RECORD_ENCODED_SIZE];
+    encodeCycleRecord(cycle, encoded);
+    savedIndex = header.writeIndex;
     
-    // Update circular buffer index
-    writeIndex = (writeIndex + 1) % FRAM_MAX_CYCLES;
-    fram.write(FRAM_ADDR_CYCLE_INDEX, (uint8_t*)&writeIndex, 2);
-    
-    // Update count (max FRAM_MAX_CYCLES)
-    if (cycleCount < FRAM_MAX_CYCLES) {
-        cycleCount++;
-        fram.write(FRAM_ADDR_CYCLE_COUNT, (uint8_t*)&cycleCount, 2);
+    // Update circular buffer index and count (max FRAM_MAX_CYCLES)
+    header.writeIndex = (header.writeIndex + 1) % FRAM_MAX_CYCLES;
+    if (header.count < FRAM_MAX_CYCLES) {
+        header.count++;
     }
-    
-    LOG_INFO("Cycle saved to FRAM at index %d (total: %d)", 
-             (writeIndex - 1 + FRAM_MAX_CYCLES) % FRAM_MAX_CYCLES, cycleCount);
-    
-    return true;
+    header.crc = cycleRingHeaderCRC(header);
+
+    const FramChannelLayout& layout = layoutFor(channel);
+    return tx.write(layout.cycleDataAddr + (savedIndex * FRAM_CYCLE_SIZE), encoded, sizeof(encoded)) &&
+           tx.write(layout.cycleHeaderAddr, &header, sizeof(header)) &&
+           tx.cacheOnCommit(layout.ringHeaderCache, &header, sizeof(header));
 }
 
-bool loadCyclesFromFRAM(std::vector<PumpCycle>& cycles, uint16_t maxCount) {
+bool saveCycleToFRAM(const PumpCycle& cycle, uint8_t channel) {
     if (!framInitialized) {
-        LOG_ERROR("FRAM not initialized for cycle load");
+        LOG_ERROR("FRAM not initialized for cycle save");
         return false;
     }
-    
-    cycles.clear();
-    
-    // Read cycle count and current index
-    uint16_t cycleCount = 0;
-    uint16_t writeIndex = 0;
-    
-    fram.read(FRAM_ADDR_CYCLE_COUNT, (uint8_t*)&cycleCount, 2);
-    fram.read(FRAM_ADDR_CYCLE_INDEX, (uint8_t*)&writeIndex, 2);
-    
-    if (cycleCount == 0) {
-        LOG_INFO("No cycles found in FRAM");
-        return true;
+
+    unsigned long startUs = micros();
+
+    FramTransaction tx;
+    uint16_t savedIndex = 0;
+    if (!stageCycleRecord(tx, cycle, channel, savedIndex) || !tx.commit()) {
+        LOG_ERROR("FRAM cycle commit failed");
+        return false;
     }
+
+    uint32_t elapsedUs = micros() - startUs;
+    recordCycleSave(elapsedUs);
     
-    // Limit count to requested max
-    uint16_t loadCount = (cycleCount > maxCount) ? maxCount : cycleCount;
-    
-    // Calculate start index (load most recent cycles)
-    uint16_t startIndex;
-    if (cycleCount < FRAM_MAX_CYCLES) {
-        // Buffer not full, start from beginning
-        startIndex = (cycleCount >= loadCount) ? (cycleCount - loadCount) : 0;
-    } else {
-        // Buffer full, start from writeIndex - loadCount
-        startIndex = (writeIndex + FRAM_MAX_CYCLES - loadCount) % FRAM_MAX_CYCLES;
+    LOG_INFO("Cycle saved to FRAM at index %d (%luus)", savedIndex, elapsedUs);
+    return true;
+}
+
+uint16_t getCycleCountFromFRAM(uint8_t channel) {
+    CycleRingHeader header;
+    return loadCycleRingHeader(header, channel) ? header.count : 0;
+}
+
+// ===============================
+// LAZY CYCLE CURSOR
+// ===============================
+
+FRAMCycleCursor::FRAMCycleCursor(uint8_t channel) : channel(channel) {
+    rewind();
+}
+
+void FRAMCycleCursor::rewind() {
+    cycleCount = 0;
+    startIndex = 0;
+    position = 0;
+    windowFirst = 0;
+    windowCount = 0;
+
+    CycleRingHeader header;
+    if (!loadCycleRingHeader(header, channel)) return;
+
+    // Tail (oldest record) is implicit: count records behind the write index.
+    // Retention shrinks count, which advances the tail without moving data.
+    cycleCount = header.count;
+    startIndex = (header.writeIndex + FRAM_MAX_CYCLES - header.count) % FRAM_MAX_CYCLES;
+}
+
+bool FRAMCycleCursor::fillWindow(uint16_t i) const {
+    // Burst-read consecutive slots starting at record i (stops at the ring end)
+    uint16_t slot = (startIndex + i) % FRAM_MAX_CYCLES;
+    uint16_t count = FRAM_CURSOR_WINDOW;
+    if (count > cycleCount - i) count = cycleCount - i;
+    if (count > FRAM_MAX_CYCLES - slot) count = FRAM_MAX_CYCLES - slot;
+
+    windowCount = 0;
+    if (!framBurstRead(layoutFor(channel).cycleDataAddr + (slot * FRAM_CYCLE_SIZE), window, count * FRAM_CYCLE_SIZE)) {
+        return false;
     }
-    
-    // Load cycles
-    for (uint16_t i = 0; i < loadCount; i++) {
-        uint16_t readIndex = (startIndex + i) % FRAM_MAX_CYCLES;
-        uint16_t readAddr = FRAM_ADDR_CYCLE_DATA + (readIndex * FRAM_CYCLE_SIZE);
-        
-        PumpCycle cycle;
-        fram.read(readAddr, (uint8_t*)&cycle, sizeof(PumpCycle));
-        
-        // Basic validation
-        if (cycle.timestamp > 0 && cycle.timestamp < 0xFFFFFFFF) {
-            cycles.push_back(cycle);
-        }
+    windowFirst = i;
+    windowCount = count;
+    return true;
+}
+
+bool FRAMCycleCursor::read(uint16_t i, PumpCycle& cycle) const {
+    if (!framInitialized || i >= cycleCount) return false;
+
+    if (i < windowFirst || i >= windowFirst + windowCount) {
+        if (!fillWindow(i)) return false;
+    }
+
+    const uint8_t* encoded = window + (i - windowFirst) * FRAM_CYCLE_SIZE;
+    if (!decodeCycleRecord(encoded, cycle)) {
+        LOG_WARNING("FRAM cycle record %d failed CRC/version check", (startIndex + i) % FRAM_MAX_CYCLES);
+        return false;
     }
-    
-    LOG_INFO("Loaded %d cycles from FRAM (requested: %d, available: %d)", 
-             cycles.size(), loadCount, cycleCount);
-    
     return true;
 }
 
-uint16_t getCycleCountFromFRAM() {
-    if (!framInitialized) return 0;
-    
-    uint16_t cycleCount = 0;
-    fram.read(FRAM_ADDR_CYCLE_COUNT, (uint8_t*)&cycleCount, 2);
-    return cycleCount;
+bool FRAMCycleCursor::next(PumpCycle& cycle) {
+    while (position < cycleCount) {
+        // Corrupted records are skipped, not fatal
+        if (read(position++, cycle) && cycle.timestamp > 0 && cycle.timestamp < 0xFFFFFFFF) {
+            return true;
+        }
+    }
+    return false;
 }
 
-bool clearOldCyclesFromFRAM(uint32_t olderThanDays) {
+bool clearOldCyclesFromFRAM(uint32_t olderThanDays, uint8_t channel) {
     if (!framInitialized) return false;
-    
-    uint32_t cutoffTime = (millis() / 1000) - (olderThanDays * 24 * 3600);
-    
-    // For now, simple implementation - clear all if any is too old
-    // More sophisticated implementation would compact the data
-    
-    std::vector<PumpCycle> allCycles;
-    if (!loadCyclesFromFRAM(allCycles)) return false;
-    
-    // Filter recent cycles
-    std::vector<PumpCycle> recentCycles;
-    for (const auto& cycle : allCycles) {
-        if (cycle.timestamp >= cutoffTime) {
-            recentCycles.push_back(cycle);
-        }
+
+    // Cycle timestamps are unix time - without a trusted clock we cannot date them
+    if (!isRTCWorking() || rtcNeedsSynchronization()) {
+        LOG_WARNING("FRAM cleanup skipped - RTC time not trusted");
+        return false;
     }
-    
-    if (recentCycles.size() == allCycles.size()) {
+
+    uint32_t cutoffTime = getUnixTimestamp() - (olderThanDays * 24UL * 3600UL);
+
+    CycleRingHeader header;
+    if (!loadCycleRingHeader(header, channel)) {
+        return false;
+    }
+
+    // Records are chronological - count expired ones from the tail,
+    // reading only the 4-byte timestamp of each
+    uint16_t tailIndex = (header.writeIndex + FRAM_MAX_CYCLES - header.count) % FRAM_MAX_CYCLES;
+    uint16_t expired = 0;
+
+    while (expired < header.count) {
+        uint16_t readIndex = (tailIndex + expired) % FRAM_MAX_CYCLES;
+        uint32_t timestamp = 0;
+        framBurstRead(layoutFor(channel).cycleDataAddr + (readIndex * FRAM_CYCLE_SIZE) + CYCLE_RECORD_TIMESTAMP_OFFSET,
+                      (uint8_t*)&timestamp, 4);
+
+        // Pre-unix (uptime based) records from older firmware cannot be dated
+        bool isExpired = (timestamp < FRAM_CYCLE_MIN_UNIX_TIME) || (timestamp < cutoffTime);
+        if (!isExpired) break;
+        expired++;
+    }
+
+    if (expired == 0) {
         LOG_INFO("No old cycles to clear");
         return true;
     }
-    
-    // Reset FRAM cycle data
-    uint16_t zero = 0;
-    fram.write(FRAM_ADDR_CYCLE_COUNT, (uint8_t*)&zero, 2);
-    fram.write(FRAM_ADDR_CYCLE_INDEX, (uint8_t*)&zero, 2);
-    
-    // Save recent cycles back
-    for (const auto& cycle : recentCycles) {
-        saveCycleToFRAM(cycle);
-    }
-    
-    LOG_INFO("Cleared old cycles, kept %d recent cycles", recentCycles.size());
+
+    // Advance the tail: one header write, live records are never rewritten
+    header.count -= expired;
+    saveCycleRingHeader(header, channel);
+
+    LOG_INFO("Cleared %d old cycles, kept %d recent cycles", expired, header.count);
     return true;
 }
 
@@ -379,32 +537,53 @@ bool clearOldCyclesFromFRAM(uint32_t olderThanDays) {
 // ERROR STATISTICS MANAGEMENT
 // ===============================
 
+// FRAM_ADDR_GAP1_SUM..FRAM_ADDR_STATS_CHKSUM as one 12-byte block
+#define STATS_BLOCK_SIZE 12
+#define STATS_BLOCK_CRC_OFFSET 10
+
 uint16_t calculateStatsChecksum(const ErrorStats& stats) {
-    uint16_t sum = 0;
-    sum += stats.gap1_fail_sum;
-    sum += stats.gap2_fail_sum;
-    sum += stats.water_fail_sum;
-    sum += (stats.last_reset_timestamp >> 16) & 0xFFFF;
-    sum += stats.last_reset_timestamp & 0xFFFF;
-    return sum;
+    uint8_t data[STATS_BLOCK_CRC_OFFSET];
+    memcpy(data + 0, &stats.gap1_fail_sum, 2);
+    memcpy(data + 2, &stats.gap2_fail_sum, 2);
+    memcpy(data + 4, &stats.water_fail_sum, 2);
+    memcpy(data + 6, &stats.last_reset_timestamp, 4);
+    return crc16(data, sizeof(data));
+}
+
+static void encodeStatsBlock(const ErrorStats& stats, uint8_t block[STATS_BLOCK_SIZE]) {
+    uint16_t checksum = calculateStatsChecksum(stats);
+    memcpy(block + 0, &stats.gap1_fail_sum, 2);
+    memcpy(block + 2, &stats.gap2_fail_sum, 2);
+    memcpy(block + 4, &stats.water_fail_sum, 2);
+    memcpy(block + 6, &stats.last_reset_timestamp, 4);
+    memcpy(block + STATS_BLOCK_CRC_OFFSET, &checksum, 2);
 }
 
-bool loadErrorStatsFromFRAM(ErrorStats& stats) {
+bool loadErrorStatsFromFRAM(ErrorStats& stats, uint8_t channel) {
     if (!framInitialized) {
         LOG_ERROR("FRAM not initialized for stats load");
         return false;
     }
+
+    const FramChannelLayout& layout = layoutFor(channel);
+    if (framCacheGet(layout.statsCache, &stats, sizeof(stats))) {
+        return true;
+    }
     
     // Read stats data
-    fram.read(FRAM_ADDR_GAP1_SUM, (uint8_t*)&stats.gap1_fail_sum, 2);
-    fram.read(FRAM_ADDR_GAP2_SUM, (uint8_t*)&stats.gap2_fail_sum, 2);
-    fram.read(FRAM_ADDR_WATER_SUM, (uint8_t*)&stats.water_fail_sum, 2);
-    fram.read(FRAM_ADDR_LAST_RESET, (uint8_t*)&stats.last_reset_timestamp, 4);
+    uint8_t block[STATS_BLOCK_SIZE];
+    if (!framBurstRead(layout.statsAddr, block, sizeof(block))) {
+        return false;
+    }
+    memcpy(&stats.gap1_fail_sum, block + 0, 2);
+    memcpy(&stats.gap2_fail_sum, block + 2, 2);
+    memcpy(&stats.water_fail_sum, block + 4, 2);
+    memcpy(&stats.last_reset_timestamp, block + 6, 4);
     
     // Verify checksum
     uint16_t calculatedChecksum = calculateStatsChecksum(stats);
     uint16_t storedChecksum = 0;
-    fram.read(FRAM_ADDR_STATS_CHKSUM, (uint8_t*)&storedChecksum, 2);
+    memcpy(&storedChecksum, block + STATS_BLOCK_CRC_OFFSET, 2);
     
     if (calculatedChecksum != storedChecksum) {
         LOG_WARNING("Stats checksum mismatch: stored=%d, calculated=%d", 
@@ -416,45 +595,35 @@ bool loadErrorStatsFromFRAM(ErrorStats& stats) {
         stats.water_fail_sum = 0;
         stats.last_reset_timestamp = getUnixTimestamp(); // Current time as reset time
         
-        saveErrorStatsToFRAM(stats); // Save defaults
+        saveErrorStatsToFRAM(stats, channel); // Save defaults
         return false;
     }
     
+    framCachePut(layout.statsCache, &stats, sizeof(stats));
     LOG_INFO("Loaded error stats: GAP1=%d, GAP2=%d, WATER=%d", 
              stats.gap1_fail_sum, stats.gap2_fail_sum, stats.water_fail_sum);
     
     return true;
 }
 
-bool saveErrorStatsToFRAM(const ErrorStats& stats) {
+bool saveErrorStatsToFRAM(const ErrorStats& stats, uint8_t channel) {
     if (!framInitialized) {
         LOG_ERROR("FRAM not initialized for stats save");
         return false;
     }
     
-    // Write stats data
-    fram.write(FRAM_ADDR_GAP1_SUM, (uint8_t*)&stats.gap1_fail_sum, 2);
-    fram.write(FRAM_ADDR_GAP2_SUM, (uint8_t*)&stats.gap2_fail_sum, 2);
-    fram.write(FRAM_ADDR_WATER_SUM, (uint8_t*)&stats.water_fail_sum, 2);
-    fram.write(FRAM_ADDR_LAST_RESET, (uint8_t*)&stats.last_reset_timestamp, 4);
-    
-    // Calculate and write checksum
-    uint16_t checksum = calculateStatsChecksum(stats);
-    fram.write(FRAM_ADDR_STATS_CHKSUM, (uint8_t*)&checksum, 2);
-    
-    // Verify write by reading back
-    ErrorStats readBack;
-    fram.read(FRAM_ADDR_GAP1_SUM, (uint8_t*)&readBack.gap1_fail_sum, 2);
-    fram.read(FRAM_ADDR_GAP2_SUM, (uint8_t*)&readBack.gap2_fail_sum, 2);
-    fram.read(FRAM_ADDR_WATER_SUM, (uint8_t*)&readBack.water_fail_sum, 2);
-    
-    if (readBack.gap1_fail_sum != stats.gap1_fail_sum ||
-        readBack.gap2_fail_sum != stats.gap2_fail_sum ||
-        readBack.water_fail_sum != stats.water_fail_sum) {
-        
-        LOG_ERROR("FRAM stats write verification failed!");
+    // One burst - the checksum inside the block validates it on load
+    const FramChannelLayout& layout = layoutFor(channel);
+    uint8_t block[STATS_BLOCK_SIZE];
+    encodeStatsBlock(stats, block);
+
+    if (!framBurstWrite(layout.statsAddr, block, sizeof(block))) {
+        LOG_ERROR("FRAM stats write failed!");
+        framCacheInvalidate(layout.statsCache);
         return false;
     }
+
+    framCachePut(layout.statsCache, &stats, sizeof(stats));
     
     LOG_INFO("Saved error stats to FRAM: GAP1=%d, GAP2=%d, WATER=%d", 
              stats.gap1_fail_sum, stats.gap2_fail_sum, stats.water_fail_sum);
@@ -462,7 +631,7 @@ bool saveErrorStatsToFRAM(const ErrorStats& stats) {
     return true;
 }
 
-bool resetErrorStatsInFRAM() {
+bool resetErrorStatsInFRAM(uint8_t channel) {
     if (!framInitialized) {
         LOG_ERROR("FRAM not initialized for stats reset");
         return false;
@@ -474,7 +643,7 @@ bool resetErrorStatsInFRAM() {
     stats.water_fail_sum = 0;
     stats.last_reset_timestamp = getUnixTimestamp(); // Current time
     
-    bool success = saveErrorStatsToFRAM(stats);
+    bool success = saveErrorStatsToFRAM(stats, channel);
     if (success) {
         LOG_INFO("Error statistics reset to zero");
     }
@@ -482,22 +651,7 @@ bool resetErrorStatsInFRAM() {
     return success;
 }
 
-bool incrementErrorStats(uint8_t gap1_increment, uint8_t gap2_increment, uint8_t water_increment) {
-    if (!framInitialized) {
-        LOG_ERROR("FRAM not initialized for stats increment");
-        return false;
-    }
-    
-    // Load current stats
-    ErrorStats stats;
-    if (!loadErrorStatsFromFRAM(stats)) {
-        // If load fails, start with defaults
-        stats.gap1_fail_sum = 0;
-        stats.gap2_fail_sum = 0;
-        stats.water_fail_sum = 0;
-        stats.last_reset_timestamp = millis() / 1000;
-    }
-    
+static void applyErrorIncrements(ErrorStats& stats, uint8_t gap1_increment, uint8_t gap2_increment, uint8_t water_increment) {
     // Increment with overflow protection
     if (stats.gap1_fail_sum + gap1_increment <= 65535) {
         stats.gap1_fail_sum += gap1_increment;
@@ -519,9 +673,32 @@ bool incrementErrorStats(uint8_t gap1_increment, uint8_t gap2_increment, uint8_t
         stats.water_fail_sum = 65535;
         LOG_WARNING("WATER sum capped at 65535");
     }
+}
+
+static void loadErrorStatsOrDefaults(ErrorStats& stats, uint8_t channel) {
+    if (!loadErrorStatsFromFRAM(stats, channel)) {
+        // If load fails, start with defaults
+        stats.gap1_fail_sum = 0;
+        stats.gap2_fail_sum = 0;
+        stats.water_fail_sum = 0;
+        stats.last_reset_timestamp = millis() / 1000;
+    }
+}
+
+bool incrementErrorStats(uint8_t gap1_increment, uint8_t gap2_increment, uint8_t water_increment,
+                         uint8_t channel) {
+    if (!framInitialized) {
+        LOG_ERROR("FRAM not initialized for stats increment");
+        return false;
+    }
+    
+    // Load current stats
+    ErrorStats stats;
+    loadErrorStatsOrDefaults(stats, channel);
+    applyErrorIncrements(stats, gap1_increment, gap2_increment, water_increment);
     
     // Save updated stats
-    bool success = saveErrorStatsToFRAM(stats);
+    bool success = saveErrorStatsToFRAM(stats, channel);
     
     if (success && (gap1_increment || gap2_increment || water_increment)) {
         LOG_INFO("Incremented stats: GAP1+%d=%d, GAP2+%d=%d, WATER+%d=%d", 
@@ -544,6 +721,7 @@ bool readCredentialsFromFRAM(FRAMCredentials& creds) {
     }
     
     // Read credentials structure from FRAM
+    I2CBusGuard guard;
     fram.read(FRAM_CREDENTIALS_ADDR, (uint8_t*)&creds, sizeof(FRAMCredentials));
     
     LOG_INFO("Read credentials from FRAM at address 0x%04X", FRAM_CREDENTIALS_ADDR);
@@ -557,6 +735,7 @@ bool writeCredentialsToFRAM(const FRAMCredentials& creds) {
     }
     
     // Write credentials structure to FRAM
+    I2CBusGuard guard;
     fram.write(FRAM_CREDENTIALS_ADDR, (uint8_t*)&creds, sizeof(FRAMCredentials));
     
     // Verify write by reading back
@@ -590,15 +769,14 @@ bool verifyCredentialsInFRAM() {
         return false;
     }
     
-    // 🔄 UPDATED: Check version (accept v1, v2, and v3)
-    if (creds.version != 0x0001 && creds.version != 0x0002 && creds.version != 0x0003) {
+    // 🔄 UPDATED: Check version (accept v1 - v4)
+    if (creds.version < 0x0001 || creds.version > FRAM_CREDENTIALS_VERSION) {
         LOG_WARNING("Invalid credentials version: %d", creds.version);
         return false;
     }
     
-    // Verify checksum
-    size_t checksum_offset = offsetof(FRAMCredentials, checksum);
-    uint16_t calculated_checksum = calculateChecksum((uint8_t*)&creds, checksum_offset);
+    // Verify checksum (CRC16 from v4, byte sum for older programmers)
+    uint16_t calculated_checksum = calculateCredentialsChecksum(creds);
     
     if (creds.checksum != calculated_checksum) {
         LOG_WARNING("Credentials checksum mismatch: stored=%d, calculated=%d", 
@@ -615,15 +793,25 @@ bool verifyCredentialsInFRAM() {
 // DAILY VOLUME MANAGEMENT
 // ===============================
 
+// FRAM_ADDR_DAILY_VOLUME..FRAM_ADDR_DAILY_CHECKSUM as one 8-byte block
+#define DAILY_BLOCK_SIZE 8
+#define DAILY_BLOCK_CRC_OFFSET 6
+
 uint16_t calculateDailyVolumeChecksum(const DailyVolumeData& data) {
-    uint16_t sum = 0;
-    sum += data.volume_ml;
-    sum += (data.last_reset_utc_day >> 16) & 0xFFFF;
-    sum += data.last_reset_utc_day & 0xFFFF;
-    return sum;
+    uint8_t bytes[DAILY_BLOCK_CRC_OFFSET];
+    memcpy(bytes + 0, &data.volume_ml, 2);
+    memcpy(bytes + 2, &data.last_reset_utc_day, 4);
+    return crc16(bytes, sizeof(bytes));
 }
 
-bool saveDailyVolumeToFRAM(uint16_t dailyVolume, uint32_t utcDay) {
+static void encodeDailyBlock(const DailyVolumeData& data, uint8_t block[DAILY_BLOCK_SIZE]) {
+    uint16_t checksum = calculateDailyVolumeChecksum(data);
+    memcpy(block + 0, &data.volume_ml, 2);
+    memcpy(block + 2, &data.last_reset_utc_day, 4);
+    memcpy(block + DAILY_BLOCK_CRC_OFFSET, &checksum, 2);
+}
+
+bool saveDailyVolumeToFRAM(uint16_t dailyVolume, uint32_t utcDay, uint8_t channel) {
     if (!framInitialized) {
         LOG_ERROR("FRAM not initialized for daily volume save");
         return false;
@@ -638,44 +826,48 @@ bool saveDailyVolumeToFRAM(uint16_t dailyVolume, uint32_t utcDay) {
     data.volume_ml = dailyVolume;
     data.last_reset_utc_day = utcDay;
     
-    // Write volume
-    fram.write(FRAM_ADDR_DAILY_VOLUME, (uint8_t*)&data.volume_ml, 2);
-    
-    // Write UTC day
-    fram.write(FRAM_ADDR_LAST_RESET_UTC, (uint8_t*)&data.last_reset_utc_day, 4);
-    
-    // Calculate and write checksum
-    uint16_t checksum = calculateDailyVolumeChecksum(data);
-    fram.write(FRAM_ADDR_DAILY_CHECKSUM, (uint8_t*)&checksum, 2);
-    
-    // Verify write
-    DailyVolumeData verify;
-    fram.read(FRAM_ADDR_DAILY_VOLUME, (uint8_t*)&verify.volume_ml, 2);
-    fram.read(FRAM_ADDR_LAST_RESET_UTC, (uint8_t*)&verify.last_reset_utc_day, 4);
-    
-    if (verify.volume_ml != dailyVolume || verify.last_reset_utc_day != utcDay) {
-        LOG_ERROR("FRAM daily volume write verification failed!");
+    // One burst - the checksum inside the block validates it on load
+    const FramChannelLayout& layout = layoutFor(channel);
+    uint8_t block[DAILY_BLOCK_SIZE];
+    encodeDailyBlock(data, block);
+
+    if (!framBurstWrite(layout.dailyVolumeAddr, block, sizeof(block))) {
+        LOG_ERROR("FRAM daily volume write failed!");
+        framCacheInvalidate(layout.dailyVolumeCache);
         return false;
     }
+
+    framCachePut(layout.dailyVolumeCache, &data, sizeof(data));
     
     LOG_INFO("✅ Daily volume saved to FRAM: %dml (UTC day: %lu)", dailyVolume, utcDay);
     return true;
 }
 
-bool loadDailyVolumeFromFRAM(uint16_t& dailyVolume, uint32_t& utcDay) {
+bool loadDailyVolumeFromFRAM(uint16_t& dailyVolume, uint32_t& utcDay, uint8_t channel) {
     if (!framInitialized) {
         LOG_ERROR("FRAM not initialized for daily volume load");
         return false;
     }
     
+    const FramChannelLayout& layout = layoutFor(channel);
     DailyVolumeData data;
-    fram.read(FRAM_ADDR_DAILY_VOLUME, (uint8_t*)&data.volume_ml, 2);
-    fram.read(FRAM_ADDR_LAST_RESET_UTC, (uint8_t*)&data.last_reset_utc_day, 4);
+    if (framCacheGet(layout.dailyVolumeCache, &data, sizeof(data))) {
+        dailyVolume = data.volume_ml;
+        utcDay = data.last_reset_utc_day;
+        return true;
+    }
+
+    uint8_t block[DAILY_BLOCK_SIZE];
+    if (!framBurstRead(layout.dailyVolumeAddr, block, sizeof(block))) {
+        return false;
+    }
+    memcpy(&data.volume_ml, block + 0, 2);
+    memcpy(&data.last_reset_utc_day, block + 2, 4);
     
     // Verify checksum
     uint16_t calculatedChecksum = calculateDailyVolumeChecksum(data);
     uint16_t storedChecksum = 0;
-    fram.read(FRAM_ADDR_DAILY_CHECKSUM, (uint8_t*)&storedChecksum, 2);
+    memcpy(&storedChecksum, block + DAILY_BLOCK_CRC_OFFSET, 2);
     
     if (calculatedChecksum != storedChecksum) {
         LOG_WARNING("Daily volume checksum mismatch: stored=%d, calculated=%d", 
@@ -691,9 +883,120 @@ bool loadDailyVolumeFromFRAM(uint16_t& dailyVolume, uint32_t& utcDay) {
     
     dailyVolume = data.volume_ml;
     utcDay = data.last_reset_utc_day;
+    framCachePut(layout.dailyVolumeCache, &data, sizeof(data));
     
     LOG_INFO("✅ Daily volume loaded from FRAM: %dml (UTC day: %lu)", 
              dailyVolume, utcDay);
     
     return true;
-}
\ No newline at end of file
+}
+
+// ===============================
+// CYCLE COMPLETION (ATOMIC)
+// ===============================
+
+bool commitCycleToFRAM(const PumpCycle& cycle, uint16_t dailyVolume, uint32_t utcDay,
+                       uint8_t gap1_increment, uint8_t gap2_increment, uint8_t water_increment,
+                       uint8_t channel) {
+    if (!framInitialized) {
+        LOG_ERROR("FRAM not initialized for cycle commit");
+        return false;
+    }
+
+    unsigned long startUs = micros();
+    const FramChannelLayout& layout = layoutFor(channel);
+    FramTransaction tx;
+
+    uint16_t savedIndex = 0;
+    bool staged = stageCycleRecord(tx, cycle, channel, savedIndex);
+
+    DailyVolumeData daily;
+    daily.volume_ml = dailyVolume;
+    daily.last_reset_utc_day = utcDay;
+    uint8_t dailyBlock[DAILY_BLOCK_SIZE];
+    encodeDailyBlock(daily, dailyBlock);
+    staged = staged && tx.write(layout.dailyVolumeAddr, dailyBlock, sizeof(dailyBlock)) &&
+             tx.cacheOnCommit(layout.dailyVolumeCache, &daily, sizeof(daily));
+
+    ErrorStats stats;
+    if (gap1_increment || gap2_increment || water_increment) {
+        loadErrorStatsOrDefaults(stats, channel);
+        applyErrorIncrements(stats, gap1_increment, gap2_increment, water_increment);
+        uint8_t statsBlock[STATS_BLOCK_SIZE];
+        encodeStatsBlock(stats, statsBlock);
+        staged = staged && tx.write(layout.statsAddr, statsBlock, sizeof(statsBlock)) &&
+                 tx.cacheOnCommit(layout.statsCache, &stats, sizeof(stats));
+    }
+
+    if (!staged || !tx.commit()) {
+        LOG_ERROR("FRAM cycle commit failed");
+        return false;
+    }
+
+    uint32_t elapsedUs = micros() - startUs;
+    recordCycleSave(elapsedUs);
+
+    LOG_INFO("Cycle committed to FRAM: channel %d, slot %d, daily %dml, %d records (%luus)",
+             channel, savedIndex, dailyVolume, tx.entryCount(), elapsedUs);
+    return true;
+}
+
+// ===============================
+// LEGACY CHECKSUM UPGRADE (v2/v3 -> v4)
+// ===============================
+// Blocks whose old byte/word sum still matches are rewritten with CRC16.
+// Anything that fails the old sum is left alone - the CRC check on load
+// then resets it to defaults, as a corrupted block always did.
+
+static uint16_t legacyWordSum(const uint8_t* data, size_t len) {
+    uint16_t sum = 0;
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        sum += (uint16_t)data[i] | ((uint16_t)data[i + 1] << 8);
+    }
+    return sum;
+}
+
+static void resealLegacyChecksums() {
+    uint8_t volumeBlock[6];
+    if (framBurstRead(FRAM_ADDR_VOLUME_ML, volumeBlock, sizeof(volumeBlock))) {
+        uint16_t stored;
+        memcpy(&stored, volumeBlock + 4, 2);
+        if (stored == additiveSum16(volumeBlock, 4)) {
+            uint16_t checksum = crc16(volumeBlock, 4);
+            memcpy(volumeBlock + 4, &checksum, 2);
+            framBurstWrite(FRAM_ADDR_VOLUME_ML, volumeBlock, sizeof(volumeBlock));
+        }
+    }
+
+    // Old stats/daily sums added the fields as 16-bit words
+    uint8_t statsBlock[STATS_BLOCK_SIZE];
+    if (framBurstRead(FRAM_ADDR_GAP1_SUM, statsBlock, sizeof(statsBlock))) {
+        uint16_t stored;
+        memcpy(&stored, statsBlock + STATS_BLOCK_CRC_OFFSET, 2);
+        if (stored == legacyWordSum(statsBlock, STATS_BLOCK_CRC_OFFSET)) {
+            uint16_t checksum = crc16(statsBlock, STATS_BLOCK_CRC_OFFSET);
+            memcpy(statsBlock + STATS_BLOCK_CRC_OFFSET, &checksum, 2);
+            framBurstWrite(FRAM_ADDR_GAP1_SUM, statsBlock, sizeof(statsBlock));
+        }
+    }
+
+    uint8_t dailyBlock[DAILY_BLOCK_SIZE];
+    if (framBurstRead(FRAM_ADDR_DAILY_VOLUME, dailyBlock, sizeof(dailyBlock))) {
+        uint16_t stored;
+        memcpy(&stored, dailyBlock + DAILY_BLOCK_CRC_OFFSET, 2);
+        if (stored == legacyWordSum(dailyBlock, DAILY_BLOCK_CRC_OFFSET)) {
+            uint16_t checksum = crc16(dailyBlock, DAILY_BLOCK_CRC_OFFSET);
+            memcpy(dailyBlock + DAILY_BLOCK_CRC_OFFSET, &checksum, 2);
+            framBurstWrite(FRAM_ADDR_DAILY_VOLUME, dailyBlock, sizeof(dailyBlock));
+        }
+    }
+
+    // Ring header had no checksum - seal it if the values are plausible
+    CycleRingHeader header;
+    if (framBurstRead(FRAM_ADDR_CYCLE_COUNT, (uint8_t*)&header, sizeof(header)) &&
+        header.count <= FRAM_MAX_CYCLES && header.writeIndex < FRAM_MAX_CYCLES) {
+        saveCycleRingHeader(header);
+    }
+
+    LOG_INFO("FRAM blocks resealed with CRC16");
+}
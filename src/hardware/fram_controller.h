@@ -6,7 +6,6 @@
 #define FRAM_CONTROLLER_H
 
 #include <Arduino.h>
-#include <vector>
 
 #include "fram_constants.h" 
 
@@ -30,27 +29,60 @@ struct PumpCycle;
 
 // ESP32 volume settings
 #define FRAM_ADDR_VOLUME_ML    (FRAM_ESP32_BASE + 0x06)  // 4 bytes - volume per second (float)
-#define FRAM_ADDR_CHECKSUM     (FRAM_ESP32_BASE + 0x0A)  // 2 bytes - simple checksum
+#define FRAM_ADDR_CHECKSUM     (FRAM_ESP32_BASE + 0x0A)  // 2 bytes - CRC16 of volume
 
 // ESP32 error statistics
 #define FRAM_ADDR_GAP1_SUM     (FRAM_ESP32_BASE + 0x0C)  // 2 bytes - gap1_fail_sum
 #define FRAM_ADDR_GAP2_SUM     (FRAM_ESP32_BASE + 0x0E)  // 2 bytes - gap2_fail_sum  
 #define FRAM_ADDR_WATER_SUM    (FRAM_ESP32_BASE + 0x10)  // 2 bytes - water_fail_sum
 #define FRAM_ADDR_LAST_RESET   (FRAM_ESP32_BASE + 0x12)  // 4 bytes - timestamp ostatniego resetu
-#define FRAM_ADDR_STATS_CHKSUM (FRAM_ESP32_BASE + 0x16)  // 2 bytes - checksum statystyk
+#define FRAM_ADDR_STATS_CHKSUM (FRAM_ESP32_BASE + 0x16)  // 2 bytes - CRC16 statystyk
 
 // 🆕 NEW: Daily volume tracking
 #define FRAM_ADDR_DAILY_VOLUME    (FRAM_ESP32_BASE + 0x18)  // 2 bytes - uint16_t
 #define FRAM_ADDR_LAST_RESET_UTC  (FRAM_ESP32_BASE + 0x1A)  // 4 bytes - uint32_t (było 12)
-#define FRAM_ADDR_DAILY_CHECKSUM  (FRAM_ESP32_BASE + 0x1E)  // 2 bytes - checksum
+#define FRAM_ADDR_DAILY_CHECKSUM  (FRAM_ESP32_BASE + 0x1E)  // 2 bytes - CRC16
 
-// ESP32 cycle management  
+// ESP32 cycle management (count/index/format = CycleRingHeader, one transaction)
 #define FRAM_ADDR_CYCLE_COUNT  (FRAM_ESP32_BASE + 0x28)  // 2 bytes - liczba zapisanych cykli
 #define FRAM_ADDR_CYCLE_INDEX  (FRAM_ESP32_BASE + 0x2A)  // 2 bytes - current write index (circular buffer)
+#define FRAM_ADDR_CYCLE_FORMAT (FRAM_ESP32_BASE + 0x2C)  // 2 bytes - cycle record version (see cycle_record.h)
+#define FRAM_ADDR_CYCLE_CRC    (FRAM_ESP32_BASE + 0x2E)  // 2 bytes - CRC16 of count/index/format
 #define FRAM_ADDR_CYCLE_DATA   (FRAM_ESP32_BASE + 0x100) // Start danych cykli
 
 #define FRAM_MAX_CYCLES        200     // Maksymalnie 200 cykli (~20 dni)
 #define FRAM_CYCLE_SIZE        24      // Rozmiar jednego cyklu w bajtach
+#define FRAM_CYCLE_MIN_UNIX_TIME 1577836800  // 2020-01-01 - older timestamps are uptime based (pre-unix records)
+
+// ESP32 VPS outbox (persistent uplink queue, see network/vps_outbox.h)
+#define FRAM_ADDR_OUTBOX_HEADER 0x1F00  // 16 bytes - OutboxHeader
+#define FRAM_ADDR_OUTBOX_DATA   0x2000  // Start of outbox slots
+#define FRAM_OUTBOX_SLOTS       64      // 64 pending VPS records
+#define FRAM_OUTBOX_SLOT_SIZE   80      // Bytes per outbox slot (0x2000-0x33FF)
+
+// Runtime algorithm parameters (algorithm/algorithm_params.h)
+#define FRAM_ADDR_ALGORITHM_PARAMS 0x3400  // 24 bytes - AlgorithmParamsBlock
+
+// Pump flow estimator (algorithm/flow_estimator.h)
+#define FRAM_ADDR_FLOW_ESTIMATOR   0x3420  // 80 bytes - FlowEstimatorBlock
+
+// DS3231 drift estimate and aging offset (hardware/rtc_drift.h)
+#define FRAM_ADDR_RTC_DRIFT        0x3470  // 24 bytes - RtcDriftBlock
+
+// Trace recorder (core/trace_recorder.cpp) - sensor/pump/command history for replay
+#define FRAM_ADDR_TRACE_HEADER  0x3F00  // 12 bytes - TraceHeader
+#define FRAM_ADDR_TRACE_DATA    0x4000  // Start of trace records
+#define FRAM_TRACE_SLOTS        680     // 680 records (0x4000-0x5FDF)
+#define FRAM_TRACE_RECORD_SIZE  12      // Bytes per trace record
+
+// Water channel 1 partition (hardware_pins.h) - same blocks as channel 0's
+// error stats / daily volume / cycle ring above, in the free upper 8 KB
+#define FRAM_CHANNEL_1_BASE            0x6000
+#define FRAM_ADDR_CH1_STATS            (FRAM_CHANNEL_1_BASE + 0x00)   // 12 bytes - as FRAM_ADDR_GAP1_SUM
+#define FRAM_ADDR_CH1_DAILY_VOLUME     (FRAM_CHANNEL_1_BASE + 0x10)   // 8 bytes - as FRAM_ADDR_DAILY_VOLUME
+#define FRAM_ADDR_CH1_CYCLE_HEADER     (FRAM_CHANNEL_1_BASE + 0x20)   // 8 bytes - CycleRingHeader
+#define FRAM_ADDR_CH1_CYCLE_DATA       (FRAM_CHANNEL_1_BASE + 0x100)  // FRAM_MAX_CYCLES records (0x6100-0x73BF)
+#define FRAM_WATER_CHANNELS            2
 
 // Common constants
 // #define FRAM_MAGIC_NUMBER      0x57415452  // "WATR" in hex
@@ -58,24 +90,81 @@ struct PumpCycle;
 
 // Basic FRAM functions
 bool initFRAM();
+bool isFRAMAvailable();
 bool loadVolumeFromFRAM(float& volume);
 bool saveVolumeToFRAM(float volume);
 bool verifyFRAM();
 void testFRAM();
 
+// Raw block access for modules that own their own FRAM region
+bool readFRAMBlock(uint16_t addr, uint8_t* data, size_t len);
+bool writeFRAMBlock(uint16_t addr, const uint8_t* data, size_t len);
+
 struct DailyVolumeData {
     uint16_t volume_ml;
     uint32_t last_reset_utc_day;
 };
 
-bool saveDailyVolumeToFRAM(uint16_t dailyVolume, uint32_t utcDay);
-bool loadDailyVolumeFromFRAM(uint16_t& dailyVolume, uint32_t& utcDay);
+// ===============================
+// PER-CHANNEL PARTITIONS
+// ===============================
+// Error stats, daily volume and the cycle ring belong to one water channel.
+// The functions below take the channel (default 0 = the original layout).
+
+bool saveDailyVolumeToFRAM(uint16_t dailyVolume, uint32_t utcDay, uint8_t channel = 0);
+bool loadDailyVolumeFromFRAM(uint16_t& dailyVolume, uint32_t& utcDay, uint8_t channel = 0);
+
+// Cycle completion: record + ring header, daily volume and error stats
+// committed atomically through the FRAM journal (see fram_journal.h)
+bool commitCycleToFRAM(const PumpCycle& cycle, uint16_t dailyVolume, uint32_t utcDay,
+                       uint8_t gap1_increment, uint8_t gap2_increment, uint8_t water_increment,
+                       uint8_t channel = 0);
+
+// Cycle ring metadata - mirrors FRAM_ADDR_CYCLE_COUNT..FRAM_ADDR_CYCLE_FORMAT
+struct CycleRingHeader {
+    uint16_t count;        // Live records (tail = writeIndex - count)
+    uint16_t writeIndex;   // Next slot to write
+    uint16_t format;       // Record version (CYCLE_RECORD_VERSION)
+    uint16_t crc;          // CRC16 of the fields above (set by saveCycleRingHeader)
+};
+
+static_assert(sizeof(CycleRingHeader) == 8, "CycleRingHeader must match the FRAM layout");
+
+bool loadCycleRingHeader(CycleRingHeader& header, uint8_t channel = 0);   // false if unreadable or out of range; CRC mismatch restarts the ring
+bool saveCycleRingHeader(const CycleRingHeader& header, uint8_t channel = 0);
+uint16_t cycleRingHeaderCRC(const CycleRingHeader& header);              // for headers staged in a FramTransaction
 
 // Cycle management functions (implemented in fram_controller.cpp)
-bool saveCycleToFRAM(const PumpCycle& cycle);
-bool loadCyclesFromFRAM(std::vector<PumpCycle>& cycles, uint16_t maxCount = FRAM_MAX_CYCLES);
-uint16_t getCycleCountFromFRAM();
-bool clearOldCyclesFromFRAM(uint32_t olderThanDays = 14);
+bool saveCycleToFRAM(const PumpCycle& cycle, uint8_t channel = 0);
+uint16_t getCycleCountFromFRAM(uint8_t channel = 0);
+bool clearOldCyclesFromFRAM(uint32_t olderThanDays = 14, uint8_t channel = 0);  // O(1) writes - advances the ring tail
+
+#define FRAM_CURSOR_WINDOW     5       // Records per burst read (120 bytes, one Wire buffer)
+
+// Lazy reader over the FRAM cycle ring - keeps a small burst-read window
+// instead of copying the whole history into RAM. Index 0 = oldest cycle.
+// Snapshot of count/index is taken in the constructor (and by rewind()).
+class FRAMCycleCursor {
+public:
+    explicit FRAMCycleCursor(uint8_t channel = 0);
+
+    uint16_t size() const { return cycleCount; }
+    bool read(uint16_t i, PumpCycle& cycle) const;
+    bool next(PumpCycle& cycle);   // Skips records failing CRC / validation
+    void rewind();
+
+private:
+    bool fillWindow(uint16_t i) const;
+
+    uint8_t channel;
+    uint16_t cycleCount;
+    uint16_t startIndex;
+    uint16_t position;
+
+    mutable uint8_t window[FRAM_CURSOR_WINDOW * FRAM_CYCLE_SIZE];
+    mutable uint16_t windowFirst;
+    mutable uint16_t windowCount;
+};
 
 // Struktura statystyk błędów
 struct ErrorStats {
@@ -86,10 +175,11 @@ struct ErrorStats {
 };
 
 // Funkcje obsługi statystyk błędów
-bool loadErrorStatsFromFRAM(ErrorStats& stats);
-bool saveErrorStatsToFRAM(const ErrorStats& stats);
-bool resetErrorStatsInFRAM();
-bool incrementErrorStats(uint8_t gap1_increment, uint8_t gap2_increment, uint8_t water_increment);
+bool loadErrorStatsFromFRAM(ErrorStats& stats, uint8_t channel = 0);
+bool saveErrorStatsToFRAM(const ErrorStats& stats, uint8_t channel = 0);
+bool resetErrorStatsInFRAM(uint8_t channel = 0);
+bool incrementErrorStats(uint8_t gap1_increment, uint8_t gap2_increment, uint8_t water_increment,
+                         uint8_t channel = 0);
 
 // ===============================
 // FRAM CREDENTIALS SECTION
@@ -0,0 +1,86 @@
+#include "fram_io.h"
+#include "i2c_bus.h"
+#include "../core/logging.h"
+#include <Wire.h>
+
+// Two bytes of every write transaction are the memory address
+#define FRAM_WRITE_CHUNK    (I2C_BUFFER_LENGTH - 2)
+#define FRAM_READ_CHUNK     I2C_BUFFER_LENGTH
+
+static FramIOStats ioStats = {0, 0, 0, 0};
+
+static void sendAddress(uint16_t addr) {
+    Wire.beginTransmission(FRAM_I2C_ADDRESS);
+    Wire.write((uint8_t)(addr >> 8));
+    Wire.write((uint8_t)(addr & 0xFF));
+}
+
+bool framBurstRead(uint16_t addr, uint8_t* data, size_t len) {
+    I2CBusGuard guard;
+    Wire.setClock(I2C_FRAM_FAST_CLOCK_HZ);
+
+    bool ok = true;
+    while (len > 0) {
+        size_t chunk = (len > FRAM_READ_CHUNK) ? FRAM_READ_CHUNK : len;
+
+        sendAddress(addr);
+        if (Wire.endTransmission(false) != 0 ||
+            Wire.requestFrom((uint8_t)FRAM_I2C_ADDRESS, chunk, true) != chunk) {
+            ok = false;
+            break;
+        }
+        for (size_t i = 0; i < chunk; i++) {
+            data[i] = Wire.read();
+        }
+
+        ioStats.transactions++;
+        ioStats.bytesRead += chunk;
+        addr += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+
+    Wire.setClock(I2C_STANDARD_CLOCK_HZ);
+
+    if (!ok) {
+        ioStats.errors++;
+        LOG_ERROR("FRAM burst read failed at 0x%04X", addr);
+    }
+    return ok;
+}
+
+bool framBurstWrite(uint16_t addr, const uint8_t* data, size_t len) {
+    I2CBusGuard guard;
+    Wire.setClock(I2C_FRAM_FAST_CLOCK_HZ);
+
+    bool ok = true;
+    while (len > 0) {
+        size_t chunk = (len > FRAM_WRITE_CHUNK) ? FRAM_WRITE_CHUNK : len;
+
+        // FRAM has no page boundary or write delay - any length is one burst
+        sendAddress(addr);
+        Wire.write(data, chunk);
+        if (Wire.endTransmission() != 0) {
+            ok = false;
+            break;
+        }
+
+        ioStats.transactions++;
+        ioStats.bytesWritten += chunk;
+        addr += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+
+    Wire.setClock(I2C_STANDARD_CLOCK_HZ);
+
+    if (!ok) {
+        ioStats.errors++;
+        LOG_ERROR("FRAM burst write failed at 0x%04X", addr);
+    }
+    return ok;
+}
+
+const FramIOStats& getFramIOStats() {
+    return ioStats;
+}
@@ -0,0 +1,28 @@
+#ifndef FRAM_IO_H
+#define FRAM_IO_H
+
+#include <Arduino.h>
+
+// ===============================
+// FRAM BURST I/O
+// ===============================
+// Sequential reads/writes split only at the Wire buffer size - one I2C
+// transaction per chunk instead of one per field. Each burst holds the
+// shared bus lock and runs at I2C_FRAM_FAST_CLOCK_HZ, then restores the
+// standard clock for the DS3231.
+
+#define FRAM_I2C_ADDRESS    0x50
+
+struct FramIOStats {
+    uint32_t bytesRead;
+    uint32_t bytesWritten;
+    uint32_t transactions;   // I2C chunks since boot
+    uint32_t errors;
+};
+
+bool framBurstRead(uint16_t addr, uint8_t* data, size_t len);
+bool framBurstWrite(uint16_t addr, const uint8_t* data, size_t len);
+
+const FramIOStats& getFramIOStats();
+
+#endif
@@ -0,0 +1,172 @@
+#include "fram_journal.h"
+#include "fram_io.h"
+#include "i2c_bus.h"
+#include "../crypto/crc.h"
+#include "../core/logging.h"
+
+#define JOURNAL_MAGIC           0x4A4E  // "JN"
+#define JOURNAL_STATE_EMPTY     0x00
+#define JOURNAL_STATE_COMMITTED 0xC3
+
+// Header field offsets
+#define JOURNAL_OFF_MAGIC   0
+#define JOURNAL_OFF_STATE   2
+#define JOURNAL_OFF_ENTRIES 3
+#define JOURNAL_OFF_LENGTH  4
+#define JOURNAL_OFF_CRC     6
+
+// Each entry: addr(2) len(1) data[len]
+#define JOURNAL_ENTRY_OVERHEAD 3
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+// CRC over header (without the CRC field) + entries
+static uint16_t journalCRC(const uint8_t* journal, uint16_t length) {
+    uint16_t crc = crc16(journal, JOURNAL_OFF_CRC);
+    return crc16(journal + FRAM_JOURNAL_HEADER, length, crc);
+}
+
+static bool applyEntries(const uint8_t* journal, uint8_t entries, uint16_t length) {
+    uint16_t pos = FRAM_JOURNAL_HEADER;
+    uint16_t end = FRAM_JOURNAL_HEADER + length;
+
+    for (uint8_t i = 0; i < entries; i++) {
+        if (pos + JOURNAL_ENTRY_OVERHEAD > end) return false;
+        uint16_t addr = get16(journal + pos);
+        uint8_t len = journal[pos + 2];
+        pos += JOURNAL_ENTRY_OVERHEAD;
+        if (pos + len > end) return false;
+
+        if (!framBurstWrite(addr, journal + pos, len)) return false;
+        pos += len;
+    }
+    return true;
+}
+
+static bool clearJournal() {
+    uint8_t state = JOURNAL_STATE_EMPTY;
+    return framBurstWrite(FRAM_ADDR_JOURNAL + JOURNAL_OFF_STATE, &state, 1);
+}
+
+// ===============================
+// TRANSACTION
+// ===============================
+
+FramTransaction::FramTransaction()
+    : used(FRAM_JOURNAL_HEADER), entries(0), overflow(false), cacheEntries(0) {
+}
+
+bool FramTransaction::write(uint16_t addr, const void* data, uint8_t len) {
+    if (entries >= FRAM_JOURNAL_MAX_ENTRIES ||
+        used + JOURNAL_ENTRY_OVERHEAD + len > FRAM_JOURNAL_SIZE) {
+        LOG_ERROR("FRAM journal full (%d bytes, %d entries)", used, entries);
+        overflow = true;
+        return false;
+    }
+
+    put16(journal + used, addr);
+    journal[used + 2] = len;
+    memcpy(journal + used + JOURNAL_ENTRY_OVERHEAD, data, len);
+    used += JOURNAL_ENTRY_OVERHEAD + len;
+    entries++;
+    return true;
+}
+
+bool FramTransaction::cacheOnCommit(FramCacheEntry entry, const void* data, uint8_t len) {
+    if (cacheEntries >= FRAM_CACHE_ENTRY_COUNT || len > FRAM_CACHE_MAX_ENTRY_SIZE) {
+        return false;
+    }
+    cacheIds[cacheEntries] = entry;
+    cacheLens[cacheEntries] = len;
+    memcpy(cacheData[cacheEntries], data, len);
+    cacheEntries++;
+    return true;
+}
+
+bool FramTransaction::commit() {
+    if (overflow) return false;
+    if (entries == 0) return true;
+
+    uint16_t length = used - FRAM_JOURNAL_HEADER;
+    put16(journal + JOURNAL_OFF_MAGIC, JOURNAL_MAGIC);
+    journal[JOURNAL_OFF_STATE] = JOURNAL_STATE_COMMITTED;
+    journal[JOURNAL_OFF_ENTRIES] = entries;
+    put16(journal + JOURNAL_OFF_LENGTH, length);
+    put16(journal + JOURNAL_OFF_CRC, journalCRC(journal, length));
+
+    // Journal region is shared - serialize the whole commit (recursive lock,
+    // the burst reads/writes below take it again)
+    I2CBusGuard guard;
+
+    // 1. Journal first - this burst is the commit point
+    if (!framBurstWrite(FRAM_ADDR_JOURNAL, journal, used)) {
+        LOG_ERROR("FRAM journal write failed - transaction dropped");
+        for (uint8_t i = 0; i < cacheEntries; i++) {
+            framCacheInvalidate(cacheIds[i]);
+        }
+        return false;
+    }
+
+    // 2. Home locations - a crash here is finished by recoverFramJournal()
+    bool applied = applyEntries(journal, entries, length);
+
+    for (uint8_t i = 0; i < cacheEntries; i++) {
+        if (applied) {
+            framCachePut(cacheIds[i], cacheData[i], cacheLens[i]);
+        } else {
+            framCacheInvalidate(cacheIds[i]);
+        }
+    }
+
+    if (!applied) {
+        // Leave the journal committed - next boot replays it
+        LOG_ERROR("FRAM journal apply failed - will replay on boot");
+        return false;
+    }
+
+    // 3. Done
+    clearJournal();
+    return true;
+}
+
+// ===============================
+// BOOT RECOVERY
+// ===============================
+
+bool recoverFramJournal() {
+    uint8_t journal[FRAM_JOURNAL_SIZE];
+    I2CBusGuard guard;
+    if (!framBurstRead(FRAM_ADDR_JOURNAL, journal, FRAM_JOURNAL_HEADER)) {
+        return false;
+    }
+
+    if (get16(journal + JOURNAL_OFF_MAGIC) != JOURNAL_MAGIC ||
+        journal[JOURNAL_OFF_STATE] != JOURNAL_STATE_COMMITTED) {
+        return true;  // Empty / never used
+    }
+
+    uint8_t entries = journal[JOURNAL_OFF_ENTRIES];
+    uint16_t length = get16(journal + JOURNAL_OFF_LENGTH);
+
+    if (length > FRAM_JOURNAL_SIZE - FRAM_JOURNAL_HEADER || entries > FRAM_JOURNAL_MAX_ENTRIES ||
+        !framBurstRead(FRAM_ADDR_JOURNAL + FRAM_JOURNAL_HEADER, journal + FRAM_JOURNAL_HEADER, length) ||
+        get16(journal + JOURNAL_OFF_CRC) != journalCRC(journal, length)) {
+        // Torn journal write - home data was never touched
+        LOG_WARNING("FRAM journal incomplete - rolling back");
+        return clearJournal();
+    }
+
+    LOG_WARNING("FRAM journal committed but not applied - replaying %d records", entries);
+    if (!applyEntries(journal, entries, length)) {
+        LOG_ERROR("FRAM journal replay failed");
+        return false;
+    }
+    return clearJournal();
+}
@@ -0,0 +1,56 @@
+#ifndef FRAM_JOURNAL_H
+#define FRAM_JOURNAL_H
+
+#include <Arduino.h>
+#include "fram_cache.h"
+
+// ===============================
+// FRAM WRITE-AHEAD JOURNAL
+// ===============================
+// FramTransaction stages several FRAM writes in RAM. commit():
+//   1. writes all staged records + a CRC16 into the journal region
+//      in one burst (a torn write fails the CRC and is discarded)
+//   2. applies each record to its home address
+//   3. marks the journal empty
+// recoverFramJournal() runs on boot: a committed journal is replayed
+// (idempotent), anything else is discarded - home data is untouched
+// until step 2, so an interrupted commit rolls back.
+//
+// There is one journal region for the whole device and commits come from
+// any task (control, web, loop). commit() holds the I2C bus lock from
+// step 1 through step 3, so one transaction's journal can't be overwritten
+// or cleared by another before it has been applied.
+
+#define FRAM_ADDR_JOURNAL       0x1A00  // 0x1A00-0x1A7F, between cycle ring and outbox
+#define FRAM_JOURNAL_SIZE       128
+#define FRAM_JOURNAL_HEADER     8       // magic(2) state(1) entries(1) length(2) crc16(2)
+#define FRAM_JOURNAL_MAX_ENTRIES 8
+
+class FramTransaction {
+public:
+    FramTransaction();
+
+    // Stage `len` bytes for `addr`. Optionally refresh a shadow cache entry
+    // once the commit has reached FRAM.
+    bool write(uint16_t addr, const void* data, uint8_t len);
+    bool cacheOnCommit(FramCacheEntry entry, const void* data, uint8_t len);
+
+    bool commit();
+    uint8_t entryCount() const { return entries; }
+
+private:
+    uint8_t journal[FRAM_JOURNAL_SIZE];
+    uint16_t used;
+    uint8_t entries;
+    bool overflow;
+
+    uint8_t cacheEntries;
+    FramCacheEntry cacheIds[FRAM_CACHE_ENTRY_COUNT];
+    uint8_t cacheLens[FRAM_CACHE_ENTRY_COUNT];
+    uint8_t cacheData[FRAM_CACHE_ENTRY_COUNT][FRAM_CACHE_MAX_ENTRY_SIZE];
+};
+
+// Boot: replay a committed journal or discard a torn one
+bool recoverFramJournal();
+
+#endif
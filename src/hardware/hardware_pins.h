@@ -1,6 +1,8 @@
 #ifndef HARDWARE_PINS_H
 #define HARDWARE_PINS_H
 
+#include <stdint.h>
+
 // Seeed Xiao ESP32-C3 Pin Mapping
 #define PUMP_RELAY_PIN      10            // Pump relay control (HIGH = pump ON)
 // #define STATUS_LED_PIN      2            // ERROR signal
@@ -13,4 +15,34 @@
 #define ERROR_SIGNAL_PIN    2   // 2 Pin sygnalizacji błędów ERR0/1/2
 #define RESET_PIN          8  // Pin fizycznego resetu
 
-#endif
\ No newline at end of file
+// ============== KANAŁY WODY ==============
+// One channel = one tank: a pump relay and a float sensor pair, driven by its
+// own WaterAlgorithm (waterChannels[], water_algorithm.h). Channel 0 uses the
+// pins above. Build with -DWATER_CHANNEL_COUNT=2 to run a second tank from
+// the same controller - the Xiao has exactly one more free pin triple (GPIO9
+// is a strapping pin and stays unused), and FRAM holds two partitions
+// (fram_controller.h). ERROR_SIGNAL_PIN and RESET_PIN are shared.
+#ifndef WATER_CHANNEL_COUNT
+#define WATER_CHANNEL_COUNT  1
+#endif
+
+#define CHANNEL_1_PUMP_RELAY_PIN    5     // D3
+#define CHANNEL_1_SENSOR_1_PIN      20    // D7 (UART0 RX - serial runs over USB CDC)
+#define CHANNEL_1_SENSOR_2_PIN      21    // D6 (UART0 TX)
+
+struct WaterChannelPins {
+    uint8_t pumpRelay;
+    uint8_t sensor1;
+    uint8_t sensor2;
+};
+
+static const WaterChannelPins WATER_CHANNEL_PINS[] = {
+    { PUMP_RELAY_PIN, WATER_SENSOR_1_PIN, WATER_SENSOR_2_PIN },
+    { CHANNEL_1_PUMP_RELAY_PIN, CHANNEL_1_SENSOR_1_PIN, CHANNEL_1_SENSOR_2_PIN },
+};
+
+static_assert(WATER_CHANNEL_COUNT >= 1 &&
+              WATER_CHANNEL_COUNT <= sizeof(WATER_CHANNEL_PINS) / sizeof(WATER_CHANNEL_PINS[0]),
+              "WATER_CHANNEL_COUNT exceeds the pin table");
+
+#endif
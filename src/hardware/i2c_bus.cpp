@@ -0,0 +1,29 @@
+#include "i2c_bus.h"
+#include "hardware_pins.h"
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static SemaphoreHandle_t i2cBusMutex = nullptr;
+
+void initI2CBus() {
+    if (i2cBusMutex == nullptr) {
+        i2cBusMutex = xSemaphoreCreateRecursiveMutex();
+    }
+
+    I2CBusGuard guard;
+    Wire.begin(RTC_SDA_PIN, RTC_SCL_PIN);
+    Wire.setClock(I2C_STANDARD_CLOCK_HZ);
+}
+
+void lockI2CBus() {
+    if (i2cBusMutex != nullptr) {
+        xSemaphoreTakeRecursive(i2cBusMutex, portMAX_DELAY);
+    }
+}
+
+void unlockI2CBus() {
+    if (i2cBusMutex != nullptr) {
+        xSemaphoreGiveRecursive(i2cBusMutex);
+    }
+}
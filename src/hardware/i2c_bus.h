@@ -0,0 +1,30 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+// ===============================
+// SHARED I2C BUS (DS3231 + FRAM)
+// ===============================
+
+#define I2C_STANDARD_CLOCK_HZ   100000   // DS3231 / default bus clock
+#define I2C_FRAM_FAST_CLOCK_HZ  400000   // Fast mode - ESP32-C3 controller max, DS3231 rated for it too
+
+// First call in setup(), before FRAM or the DS3231 are touched: creates the
+// bus lock and starts Wire at the standard clock. The lock is recursive, so
+// nested locks from the same task are fine.
+void initI2CBus();
+void lockI2CBus();
+void unlockI2CBus();
+
+// Scope guard - holds the bus so FRAM fast mode never overlaps a DS3231 transfer
+class I2CBusGuard {
+public:
+    I2CBusGuard() { lockI2CBus(); }
+    ~I2CBusGuard() { unlockI2CBus(); }
+private:
+    I2CBusGuard(const I2CBusGuard&);
+    I2CBusGuard& operator=(const I2CBusGuard&);
+};
+
+#endif
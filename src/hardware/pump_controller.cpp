@@ -4,81 +4,123 @@
 #include "../network/vps_logger.h"
 #include "../hardware/rtc_controller.h"
 #include "../core/logging.h"
+#include "../core/uptime.h"
 #include <math.h>
 
 #include "../algorithm/water_algorithm.h"  // <-- DODAJ
+#include "../algorithm/algorithm_task.h"
+#include "../core/trace_recorder.h"
+
+// One relay per water channel (WATER_CHANNEL_PINS)
+struct PumpChannel {
+    bool running;
+    uint64_t startTime;         // uptimeMs()
+    uint32_t duration;          // ms
+    String actionType;
+    bool manualActive;
+    bool wasManualActive;
+};
+
+static PumpChannel pumps[WATER_CHANNEL_COUNT];
+
+static uint32_t runMs(const PumpChannel& pump) {
+    return (uint32_t)(uptimeMs() - pump.startTime);
+}
 
+// Trace/replay covers channel 0 only (trace records carry no channel)
+static void tracePumpStop(uint8_t channel, uint8_t reason, uint32_t runMs) {
+    if (channel == 0) {
+        traceRecord(TRACE_PUMP_STOP, reason, runMs);
+    }
+}
 
-
-
-bool pumpRunning = false;
-unsigned long pumpStartTime = 0;
-unsigned long pumpDuration = 0;
-String currentActionType = "";
-
-static bool pumpActive = false;
-static bool manualPumpActive = false;
+static void relayOff(uint8_t channel) {
+    digitalWrite(WATER_CHANNEL_PINS[channel].pumpRelay, HIGH);
+    pumps[channel].running = false;
+}
 
 void initPumpController() {
-
-    pinMode(PUMP_RELAY_PIN, OUTPUT);
-    digitalWrite(PUMP_RELAY_PIN, HIGH);
-    
-    pumpRunning = false;
-    LOG_INFO("Pump controller initialized");
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        pinMode(WATER_CHANNEL_PINS[ch].pumpRelay, OUTPUT);
+        digitalWrite(WATER_CHANNEL_PINS[ch].pumpRelay, HIGH);
+
+        pumps[ch].running = false;
+        pumps[ch].startTime = 0;
+        pumps[ch].duration = 0;
+        pumps[ch].actionType = "";
+        pumps[ch].manualActive = false;
+        pumps[ch].wasManualActive = false;
+    }
+    LOG_INFO("Pump controller initialized (%d channel%s)", WATER_CHANNEL_COUNT,
+             WATER_CHANNEL_COUNT > 1 ? "s" : "");
 }
 
-void updatePumpController() {
+static void updatePumpChannel(uint8_t channel) {
+    PumpChannel& pump = pumps[channel];
 
         // Check global pump state - stop if disabled
-    if (!pumpGlobalEnabled && pumpRunning) {
-        digitalWrite(PUMP_RELAY_PIN, HIGH);
-        pumpRunning = false;
-        LOG_INFO("Pump stopped - globally disabled");
+    if (!pumpGlobalEnabled && pump.running) {
+        relayOff(channel);
+        LOG_INFO("Pump %d stopped - globally disabled", channel);
+        tracePumpStop(channel, TRACE_STOP_DISABLED, runMs(pump));
+        postAlgorithmEvent(ALGO_EVENT_PUMP_FINISHED, channel);
         return;
     }
 
-    if (pumpRunning && (millis() - pumpStartTime >= pumpDuration)) {
+    if (pump.running && runMs(pump) >= pump.duration) {
         // Stop pump and log event
-        digitalWrite(PUMP_RELAY_PIN, HIGH);
-        pumpRunning = false;
+        uint32_t ranMs = runMs(pump);
+        relayOff(channel);
         
-        uint16_t actualDuration = (millis() - pumpStartTime) / 1000;
+        uint16_t actualDuration = ranMs / 1000;
+        tracePumpStop(channel, TRACE_STOP_TIMER, ranMs);
         // uint16_t volumeML = actualDuration * currentPumpSettings.volumePerSecond;
         uint16_t volumeML = (uint16_t)round(actualDuration * currentPumpSettings.volumePerSecond);
         
-        LOG_INFO("Pump stopped after %d seconds, estimated volume: %d ml", 
-                 actualDuration, volumeML);
+        LOG_INFO("Pump %d stopped after %d seconds, estimated volume: %d ml", 
+                 channel, actualDuration, volumeML);
 
-        if (currentActionType == "MANUAL_NORMAL") {
+        if (pump.actionType == "MANUAL_NORMAL") {
             // Access water algorithm to update daily volume
-            waterAlgorithm.addManualVolume(volumeML);
+            waterChannels[channel].addManualVolume(volumeML);
             LOG_INFO("✅ MANUAL_NORMAL volume added to daily total: %dml", volumeML);
-        } else if (currentActionType == "MANUAL_EXTENDED") {
+        } else if (pump.actionType == "MANUAL_EXTENDED") {
             LOG_INFO("ℹ️ MANUAL_EXTENDED (calibration) - NOT added to daily volume");
         }
 
-        if (!currentActionType.startsWith("AUTO")) {
+        if (!pump.actionType.startsWith("AUTO")) {
             uint32_t unixTime = getUnixTimestamp();
-            logEventToVPS(currentActionType, volumeML, unixTime);
+            logEventToVPS(pump.actionType, volumeML, unixTime, channel);
         }
-        currentActionType = "";       
+        pump.actionType = "";       
+        postAlgorithmEvent(ALGO_EVENT_PUMP_FINISHED, channel);
     }
 
-      static bool wasManualActive = false;
-    if (wasManualActive && !manualPumpActive && !pumpRunning) {
-        waterAlgorithm.onManualPumpComplete();
-        wasManualActive = false;
+    if (pump.wasManualActive && !pump.manualActive && !pump.running) {
+        waterChannels[channel].onManualPumpComplete();
+        pump.wasManualActive = false;
     }
-    if (manualPumpActive) {
-        wasManualActive = true;
+    if (pump.manualActive) {
+        pump.wasManualActive = true;
     }
 }
 
-bool triggerPump(uint16_t durationSeconds, const String& actionType) {
-    LOG_INFO("triggerPump called: %s for %ds", actionType.c_str(), durationSeconds);
-    
-    if (pumpRunning) {
+void updatePumpController() {
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        updatePumpChannel(ch);
+    }
+}
+
+bool triggerPump(uint16_t durationSeconds, const String& actionType, uint8_t channel) {
+    LOG_INFO("triggerPump called: %s for %ds (channel %d)", actionType.c_str(), durationSeconds, channel);
+
+    if (channel >= WATER_CHANNEL_COUNT) {
+        LOG_WARNING("No pump channel %d", channel);
+        return false;
+    }
+
+    PumpChannel& pump = pumps[channel];
+    if (pump.running) {
         LOG_WARNING("Pump already running, ignoring trigger");
         return false;
     }
@@ -90,40 +132,68 @@ bool triggerPump(uint16_t durationSeconds, const String& actionType) {
     
     // TYLKO dla manual pump notify algorithm
     if (actionType.startsWith("MANUAL")) {
-        if (!waterAlgorithm.requestManualPump(durationSeconds * 1000)) {
+        if (!waterChannels[channel].requestManualPump(durationSeconds * 1000)) {
             LOG_WARNING("Algorithm rejected manual pump request");
             return false;
         }
     }
     // Dla AUTO_PUMP nie wywołuj requestManualPump!
     
-    digitalWrite(PUMP_RELAY_PIN, LOW);
-    pumpRunning = true;
-    pumpStartTime = millis();
-    pumpDuration = durationSeconds * 1000UL;
-    currentActionType = actionType;
+    digitalWrite(WATER_CHANNEL_PINS[channel].pumpRelay, LOW);
+    pump.running = true;
+    pump.startTime = uptimeMs();
+    pump.duration = durationSeconds * 1000UL;
+    pump.actionType = actionType;
     
-    LOG_INFO("Pump started: %s for %d seconds", actionType.c_str(), durationSeconds);
+    LOG_INFO("Pump %d started: %s for %d seconds", channel, actionType.c_str(), durationSeconds);
+    if (channel == 0) {
+        traceRecord(TRACE_PUMP_START, tracePumpSource(actionType), durationSeconds);
+    }
     return true;
 }
 
-bool isPumpActive() {
-    return pumpRunning;
+bool isPumpActive(uint8_t channel) {
+    return channel < WATER_CHANNEL_COUNT && pumps[channel].running;
 }
 
-uint32_t getPumpRemainingTime() {
-    if (!pumpRunning) return 0;
+uint32_t getPumpRemainingTime(uint8_t channel) {
+    if (!isPumpActive(channel)) return 0;
     
-    unsigned long elapsed = millis() - pumpStartTime;
-    if (elapsed >= pumpDuration) return 0;
+    uint32_t elapsed = runMs(pumps[channel]);
+    if (elapsed >= pumps[channel].duration) return 0;
     
-    return (pumpDuration - elapsed) / 1000;
+    return (pumps[channel].duration - elapsed) / 1000;
+}
+
+uint32_t getPumpRemainingMs(uint8_t channel) {
+    if (!isPumpActive(channel)) return UINT32_MAX;
+
+    uint32_t elapsed = runMs(pumps[channel]);
+    if (elapsed >= pumps[channel].duration) return 0;
+
+    return pumps[channel].duration - elapsed;
+}
+
+uint32_t getNextPumpStopMs() {
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        uint32_t remaining = getPumpRemainingMs(ch);
+        if (remaining < wait) wait = remaining;
+    }
+    return wait;
+}
+
+void stopPump(uint8_t channel) {
+    if (isPumpActive(channel)) {
+        relayOff(channel);
+        LOG_INFO("Pump %d manually stopped", channel);
+        tracePumpStop(channel, TRACE_STOP_COMMAND, runMs(pumps[channel]));
+        postAlgorithmEvent(ALGO_EVENT_PUMP_FINISHED, channel);
+    }
 }
 
-void stopPump() {
-    if (pumpRunning) {
-        digitalWrite(PUMP_RELAY_PIN, HIGH);
-        pumpRunning = false;
-        LOG_INFO("Pump manually stopped");
+void stopAllPumps() {
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        stopPump(ch);
     }
 }
@@ -4,11 +4,15 @@
 #include <Arduino.h>
 
 
+// One pump per water channel (hardware_pins.h) - channel 0 by default
 void initPumpController();
-void updatePumpController();
-bool triggerPump(uint16_t durationSeconds, const String& actionType);
-bool isPumpActive();
-uint32_t getPumpRemainingTime();
-void stopPump();
+void updatePumpController();        // All channels
+bool triggerPump(uint16_t durationSeconds, const String& actionType, uint8_t channel = 0);
+bool isPumpActive(uint8_t channel = 0);
+uint32_t getPumpRemainingTime(uint8_t channel = 0);
+uint32_t getPumpRemainingMs(uint8_t channel = 0);      // UINT32_MAX when the pump is off
+uint32_t getNextPumpStopMs();       // Earliest timer stop over all channels (UINT32_MAX if none)
+void stopPump(uint8_t channel = 0);
+void stopAllPumps();
 
 #endif
\ No newline at end of file
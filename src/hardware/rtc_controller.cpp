@@ -1,11 +1,20 @@
 #include "rtc_controller.h"
 #include "../core/logging.h"
 #include "../hardware/hardware_pins.h"
+#include "i2c_bus.h"
 #include <Wire.h>
 #include <RTClib.h>
 #include <WiFi.h>
 #include <time.h>
 #include "../network/wifi_manager.h"
+#include "rtc_drift.h"
+#include <sys/time.h>
+#include <esp_sntp.h>
+#include "../algorithm/algorithm_task.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
 
 
 // ===============================
@@ -25,11 +34,48 @@ const char* POLAND_TZ = "CET-1CEST,M3.5.0,M10.5.0/3";
 // ===============================
 RTC_DS3231 rtc;
 bool rtcInitialized = false;
+static bool rtcDetected = false;   // DS3231 answered rtc.begin()
 bool useInternalRTC = false;
 bool rtcNeedsSync = false;
 bool batteryIssueDetected = false;
 bool timezoneConfigured = false;  // 🆕 Track if TZ is set
 
+// ===============================
+// CLOCK STATE
+// ===============================
+// anchorUtcUs was the UTC time (us) at esp_timer time anchorUs; slewUs is
+// the correction still being worked in at CLOCK_SLEW_RATE_PPM
+static portMUX_TYPE clockMux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t anchorUtcUs = 0;
+static int64_t anchorUs = 0;
+static int64_t slewUs = 0;
+static bool clockValid = false;
+static int64_t lastResyncUs = 0;
+static int64_t nextResyncUs = 0;
+static uint32_t clockUTCDay = 0;
+static uint32_t ntpRetryUnix = 0;
+static bool rtcAwaitingNTP = false;     // DS3231 found with an invalid time, no NTP at init
+static ClockStats clockStats = {};
+
+// getCurrentTimestamp() cache - local time of second timestampUnix, rebuilt
+// at most once per second into the buffer not handed out last
+#define TIMESTAMP_LENGTH    20      // "YYYY-MM-DD HH:MM:SS"
+static char timestampBuffers[2][TIMESTAMP_LENGTH];
+static uint8_t timestampIndex = 0;
+static uint32_t timestampUnix = 0;
+
+// DS3231 access holds the shared bus lock so FRAM fast mode never overlaps it
+static DateTime readRTCNow() {
+    I2CBusGuard guard;
+    clockStats.rtcReads++;
+    return rtc.now();
+}
+
+static void adjustRTC(const DateTime& time) {
+    I2CBusGuard guard;
+    rtc.adjust(time);
+}
+
 // Internal RTC fallback structure
 struct {
     int year = 2024;
@@ -43,7 +89,189 @@ struct {
 
 // NTP sync tracking
 unsigned long lastNTPSync = 0;
-const unsigned long NTP_SYNC_INTERVAL = 3600000;  // 1 hour
+static uint32_t lastNTPSyncUnix = 0;    // NTP time the clock was last set to
+
+static uint32_t nextNTPSyncUnix();
+static void updateNTPSync();
+
+// ===============================
+// CLOCK SERVICE
+// ===============================
+
+// Part of slewUs worked in by esp_timer time nowUs - caller holds clockMux
+static int64_t slewedUs(int64_t nowUs) {
+    int64_t limit = (nowUs - anchorUs) * CLOCK_SLEW_RATE_PPM / 1000000;
+    if (slewUs > limit) return limit;
+    if (slewUs < -limit) return -limit;
+    return slewUs;
+}
+
+// UTC in us at esp_timer time nowUs - caller holds clockMux
+static int64_t clockUtcUs(int64_t nowUs) {
+    return anchorUtcUs + (nowUs - anchorUs) + slewedUs(nowUs);
+}
+
+// count = false for the service's own reads (resync, day check)
+static uint32_t extrapolateClock(bool count = true) {
+    portENTER_CRITICAL(&clockMux);
+    uint32_t unixTime = (uint32_t)(clockUtcUs(esp_timer_get_time()) / 1000000);
+    if (count) clockStats.clockReads++;
+    portEXIT_CRITICAL(&clockMux);
+    return unixTime;
+}
+
+static void anchorClockUs(int64_t utcUs) {
+    int64_t nowUs = esp_timer_get_time();
+
+    portENTER_CRITICAL(&clockMux);
+    anchorUtcUs = utcUs;
+    anchorUs = nowUs;
+    slewUs = 0;
+    clockValid = true;
+    portEXIT_CRITICAL(&clockMux);
+
+    lastResyncUs = nowUs;
+    nextResyncUs = nowUs + CLOCK_RESYNC_INTERVAL_MS * 1000LL;
+}
+
+// A whole-second reading was taken somewhere within that second - centre it
+static void anchorClock(uint32_t unixTime) {
+    anchorClockUs((int64_t)unixTime * 1000000LL + 500000);
+}
+
+// Move the clock to utcUs - slewed (never backwards, no skipped seconds) up
+// to CLOCK_SLEW_MAX_S, stepped beyond that or before the first anchor
+static void correctClock(int64_t utcUs, const char* source) {
+    int64_t nowUs = esp_timer_get_time();
+
+    portENTER_CRITICAL(&clockMux);
+    int64_t current = clockUtcUs(nowUs);
+    int64_t error = utcUs - current;
+    bool slew = clockValid && error <= CLOCK_SLEW_MAX_S * 1000000LL && error >= -CLOCK_SLEW_MAX_S * 1000000LL;
+    if (slew) {
+        anchorUtcUs = current;
+        anchorUs = nowUs;
+        slewUs = error;
+    }
+    portEXIT_CRITICAL(&clockMux);
+
+    clockStats.lastStepSeconds = (int32_t)(error / 1000000);
+    if (slew) {
+        LOG_INFO("Clock: slewing %ldms to match %s", (long)(error / 1000), source);
+        lastResyncUs = nowUs;
+        nextResyncUs = nowUs + CLOCK_RESYNC_INTERVAL_MS * 1000LL;
+    } else {
+        LOG_WARNING("Clock stepped by %lds to match %s", (long)(error / 1000000), source);
+        anchorClockUs(utcUs);
+    }
+}
+
+// Fallback time (compile time / system time) - mktime once, then extrapolated
+static void anchorInternalTime() {
+    struct tm tm_time;
+    tm_time.tm_year = internalTime.year - 1900;
+    tm_time.tm_mon = internalTime.month - 1;
+    tm_time.tm_mday = internalTime.day;
+    tm_time.tm_hour = internalTime.hour;
+    tm_time.tm_min = internalTime.minute;
+    tm_time.tm_sec = internalTime.second;
+    tm_time.tm_isdst = 0;
+
+    anchorClock((uint32_t)mktime(&tm_time));
+}
+
+// DS3231 time with the year sanity check, up to 3 reads
+static bool readRTCUnixTime(uint32_t& unixTime) {
+    const int MAX_RETRIES = 3;
+    DateTime now;
+
+    for (int retry = 0; retry < MAX_RETRIES; retry++) {
+        now = readRTCNow();
+        if (now.year() >= 2024 && now.year() <= 2035) {
+            unixTime = now.unixtime();
+            return true;
+        }
+        if (retry < MAX_RETRIES - 1) {
+            delay(10);
+        }
+    }
+
+    LOG_ERROR("RTC read failed during clock resync, year: %d", now.year());
+    return false;
+}
+
+static void resyncClock() {
+    uint32_t unixTime;
+
+    if (useInternalRTC) {
+        // Nothing better than esp_timer until NTP has set the system time
+        time_t systemTime = time(nullptr);
+        if (systemTime < 1600000000) {
+            nextResyncUs = esp_timer_get_time() + CLOCK_RESYNC_INTERVAL_MS * 1000LL;
+            return;
+        }
+        unixTime = (uint32_t)systemTime;
+    } else if (!readRTCUnixTime(unixTime)) {
+        // Keep extrapolating from the last good reading
+        clockStats.rtcReadErrors++;
+        nextResyncUs = esp_timer_get_time() + CLOCK_RESYNC_RETRY_MS * 1000LL;
+        return;
+    }
+
+    int32_t step = (int32_t)(unixTime - extrapolateClock(false));
+    clockStats.resyncs++;
+
+    if (step > CLOCK_STEP_TOLERANCE_S || step < -CLOCK_STEP_TOLERANCE_S) {
+        correctClock((int64_t)unixTime * 1000000LL + 500000, useInternalRTC ? "the system time" : "the DS3231");
+    } else {
+        clockStats.lastStepSeconds = step;
+        // Within the read phase - keep the sub-second phase of the running clock
+        lastResyncUs = esp_timer_get_time();
+        nextResyncUs = lastResyncUs + CLOCK_RESYNC_INTERVAL_MS * 1000LL;
+    }
+}
+
+void updateClock() {
+    if (!rtcInitialized || !clockValid) {
+        return;
+    }
+
+    if (esp_timer_get_time() >= nextResyncUs) {
+        resyncClock();
+    }
+
+    // NTP - daily, weekly once the DS3231 drift is compensated (rtc_drift.h)
+    uint32_t unixNow = extrapolateClock(false);
+    if (isNTPSyncRunning()) {
+        updateNTPSync();
+    } else if (isWiFiConnected() && unixNow >= ntpRetryUnix && unixNow >= nextNTPSyncUnix()) {
+        if (!startNTPSync()) {
+            ntpRetryUnix = unixNow + RTC_NTP_RETRY_S;
+        }
+    }
+
+    // Midnight, or a resync / NTP step across it - wake the algorithm task
+    uint32_t day = extrapolateClock(false) / 86400;
+    if (day != clockUTCDay) {
+        if (clockUTCDay != 0) {
+            LOG_INFO("Clock: UTC day %lu -> %lu", (unsigned long)clockUTCDay, (unsigned long)day);
+            postAlgorithmEvent(ALGO_EVENT_DAY_CHANGE);
+        }
+        clockUTCDay = day;
+    }
+}
+
+ClockStats getClockStats() {
+    portENTER_CRITICAL(&clockMux);
+    ClockStats stats = clockStats;
+    int64_t remaining = slewUs - slewedUs(esp_timer_get_time());
+    portEXIT_CRITICAL(&clockMux);
+
+    stats.slewRemainingMs = (int32_t)(remaining / 1000);
+
+    stats.syncAgeSeconds = clockValid ? (uint32_t)((esp_timer_get_time() - lastResyncUs) / 1000000) : 0;
+    return stats;
+}
 
 // ===============================
 // TIMEZONE CONFIGURATION
@@ -93,6 +321,8 @@ void initInternalTimeFromCompileTime() {
     internalTime.second = sec;
     internalTime.lastUpdate = millis();
     
+    anchorInternalTime();
+
     LOG_INFO("Internal RTC set to compile time: %04d-%02d-%02d %02d:%02d:%02d",
              year, month, day, hour, min, sec);
 }
@@ -101,84 +331,251 @@ void initInternalTimeFromCompileTime() {
 // NTP SYNCHRONIZATION
 // ===============================
 
-bool syncTimeFromNTP() {
-    if (!isWiFiConnected()) {
-        LOG_WARNING("Cannot sync NTP - WiFi not connected");
+// DS3231 - NTP in us, taken at a DS3231 seconds edge: reads every
+// RTC_EDGE_POLL_MS for up to ~1 s, once per NTP sync
+static bool measureRTCOffsetUs(int64_t& offsetUs) {
+    DateTime first = readRTCNow();
+    if (first.year() < 2024 || first.year() > 2035) {
         return false;
     }
     
-    // ✅ Ensure timezone is configured BEFORE NTP sync
-    configureTimezone();
-    
-    LOG_INFO("Attempting NTP synchronization...");
-    LOG_INFO("NTP servers: %s, %s, %s", NTP_SERVER_1, NTP_SERVER_2, NTP_SERVER_3);
-    
-    // ✅ Use configTzTime with multiple servers
-    configTzTime(POLAND_TZ, NTP_SERVER_1, NTP_SERVER_2, NTP_SERVER_3);
-    
-    // ✅ Increased timeout - wait up to 20 seconds
-    int attempts = 0;
-    time_t now = 0;
-    struct tm timeinfo;
-    
-    while (attempts < 40) {  // 40 * 500ms = 20 seconds
-        time(&now);
-        if (now > 1600000000) {  // Sprawdź czy timestamp jest sensowny (after 2020)
-            localtime_r(&now, &timeinfo);  // ✅ Automatyczna konwersja na lokalny czas
-            
-            char timeStr[64];
-            strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S %Z", &timeinfo);
-            LOG_INFO("✅ NTP sync successful: %s", timeStr);
-            LOG_INFO("UTC timestamp: %lu", (unsigned long)now);
-            
-            lastNTPSync = millis();
+    uint32_t start = millis();
+    while (millis() - start < 1100) {
+        delay(RTC_EDGE_POLL_MS);
+        DateTime now = readRTCNow();
+        if (now.unixtime() != first.unixtime()) {
+            struct timeval tv;
+            gettimeofday(&tv, nullptr);
+            // The edge fell somewhere in the last poll interval - take the middle
+            offsetUs = (int64_t)now.unixtime() * 1000000LL + RTC_EDGE_POLL_MS * 500LL -
+                       ((int64_t)tv.tv_sec * 1000000LL + tv.tv_usec);
             return true;
         }
-        delay(500);
-        attempts++;
-        
-        // Log progress every 5 seconds
-        if (attempts % 10 == 0) {
-            LOG_INFO("NTP sync in progress... (%d/40)", attempts);
-        }
     }
     
-    LOG_ERROR("❌ NTP synchronization failed after 20 seconds");
-    LOG_WARNING("Possible causes: Firewall blocking port 123 (UDP), DNS issues, or slow connection");
+    LOG_WARNING("DS3231 seconds edge not seen - drift not measured");
     return false;
 }
 
-bool setRTCFromNTP() {
-    if (!syncTimeFromNTP()) {
-        return false;
+// Unix time the next periodic NTP sync is due
+static uint32_t nextNTPSyncUnix() {
+    if (rtcDetected && !useInternalRTC) {
+        return rtcDriftNextNtpSync();
     }
-    
-    // ✅ Pobierz UTC timestamp z systemu (NTP już zsynchronizowany)
-    time_t ntp_time;
-    time(&ntp_time);
-    
+    // No DS3231 to learn - daily while NTP is the only real time source
+    return lastNTPSyncUnix == 0 ? 0 : lastNTPSyncUnix + RTC_NTP_INTERVAL_S;
+}
+
+// ===============================
+// NTP SYNC (stepped from updateClock)
+// ===============================
+// startNTPSync() hands the request to SNTP and returns; updateNTPSync()
+// checks for the answer on later loop passes. The DS3231 part - seconds
+// edge search (~1 s) and the write at the next NTP second - runs in a short
+// one-shot task, so the loop never waits on the network or the RTC.
+
+enum NtpSyncState {
+    NTP_SYNC_IDLE,
+    NTP_SYNC_WAIT_SNTP,     // configTzTime() issued, waiting for SNTP_SYNC_STATUS_COMPLETED
+    NTP_SYNC_WAIT_RTC       // rtcWriteTask measuring and setting the DS3231
+};
+
+struct NtpSyncResult {
+    int64_t utcUs;          // NTP time at esp_timer time espUs
+    int64_t espUs;
+    int64_t rtcOffsetUs;    // DS3231 - NTP before the write
+    bool offsetValid;
+};
+
+static NtpSyncState ntpSyncState = NTP_SYNC_IDLE;
+static uint32_t ntpSyncStartMs = 0;
+static bool ntpSyncHardware = false;        // DS3231 was the time source when the sync started
+// rtcWriteTask -> loop: 1-element queue, so the whole result is copied
+// across with the ordering FreeRTOS gives (a flag + struct would not)
+static QueueHandle_t ntpSyncResultQueue = nullptr;
+
+static void logNTPTime(time_t now) {
+    struct tm timeinfo;
+    localtime_r(&now, &timeinfo);  // ✅ Automatyczna konwersja na lokalny czas
+
+    char timeStr[64];
+    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S %Z", &timeinfo);
+    LOG_INFO("✅ NTP sync successful: %s", timeStr);
+    LOG_INFO("UTC timestamp: %lu", (unsigned long)now);
+}
+
+// NTP system time now, paired with esp_timer
+static void takeNTPTime(NtpSyncResult& result) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    result.espUs = esp_timer_get_time();
+    result.utcUs = (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+// One-shot: measure the DS3231 drift, then write it at the next NTP second.
+// Sends the result to ntpSyncResultQueue and deletes itself - updateNTPSync()
+// applies it.
+static void rtcWriteTask(void* param) {
+    NtpSyncResult result = {};
+
+    // How far the DS3231 drifted since the last sync - before it is overwritten
+    result.offsetValid = ntpSyncHardware && measureRTCOffsetUs(result.rtcOffsetUs);
+
+    // Writing the seconds register restarts the DS3231 countdown, so write
+    // on the next NTP second and the RTC ticks in phase with it. Sleep up to
+    // the last ms, then spin the rest
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    int64_t edgeUs = esp_timer_get_time() + (1000000 - tv.tv_usec);
+    int64_t sleepUs = edgeUs - esp_timer_get_time() - 1000;
+    if (sleepUs > 0) {
+        delay((uint32_t)(sleepUs / 1000));
+    }
+    while (esp_timer_get_time() < edgeUs) {
+    }
+
+    takeNTPTime(result);
+    adjustRTC(DateTime((uint32_t)(result.utcUs / 1000000)));
+
+    xQueueOverwrite(ntpSyncResultQueue, &result);
+    vTaskDelete(nullptr);
+}
+
+static void failNTPSync() {
+    ntpSyncState = NTP_SYNC_IDLE;
+    ntpRetryUnix = extrapolateClock(false) + RTC_NTP_RETRY_S;
+}
+
+static void finishNTPSync(const NtpSyncResult& result) {
+    ntpSyncState = NTP_SYNC_IDLE;
+
+    // Carried forward from when the task took it
+    correctClock(result.utcUs + (esp_timer_get_time() - result.espUs), "NTP");
+
+    uint32_t ntp_time = (uint32_t)(result.utcUs / 1000000);
     LOG_INFO("NTP returned UTC timestamp: %lu", (unsigned long)ntp_time);
-    
-    // ✅ Zapisz UTC BEZPOŚREDNIO do RTC (bez żadnych offsetów)
-    rtc.adjust(DateTime(ntp_time));
-    
+
+    if (ntpSyncHardware) {
+        rtcDriftNtpSync(ntp_time, result.offsetValid, result.rtcOffsetUs);
+    }
+    lastNTPSyncUnix = ntp_time;
+    ntpRetryUnix = 0;
+    clockStats.ntpSyncs++;
+    rtcNeedsSync = false;
+
+    // initializeRTC() ran before Wi-Fi was up - the DS3231 holds NTP time now
+    if (rtcAwaitingNTP) {
+        rtcAwaitingNTP = false;
+        useInternalRTC = false;
+        batteryIssueDetected = false;
+        // Start the drift interval here - with lastSyncUnix still 0 the next
+        // sync would be due at once
+        rtcDriftNtpSync(ntp_time, false, 0);
+        LOG_INFO("✅ DS3231 restored from NTP - leaving the fallback clock");
+    }
+
+    if (!rtcDetected) {
+        return;
+    }
+
     // Weryfikacja z konwersją na lokalny czas dla loga
-    DateTime rtc_utc = rtc.now();
+    DateTime rtc_utc = readRTCNow();
     time_t rtc_timestamp = rtc_utc.unixtime();
     struct tm local_time;
     localtime_r(&rtc_timestamp, &local_time);
-    
+
     char localStr[64];
     strftime(localStr, sizeof(localStr), "%Y-%m-%d %H:%M:%S %Z", &local_time);
-    
+
     LOG_INFO("✅ RTC updated with UTC: %04d-%02d-%02d %02d:%02d:%02d",
              rtc_utc.year(), rtc_utc.month(), rtc_utc.day(),
              rtc_utc.hour(), rtc_utc.minute(), rtc_utc.second());
     LOG_INFO("Local time equivalent: %s", localStr);
-    
+}
+
+bool startNTPSync() {
+    if (ntpSyncState != NTP_SYNC_IDLE) {
+        return false;
+    }
+    if (!isWiFiConnected()) {
+        LOG_WARNING("Cannot sync NTP - WiFi not connected");
+        return false;
+    }
+
+    // ✅ Ensure timezone is configured BEFORE NTP sync
+    configureTimezone();
+
+    LOG_INFO("Attempting NTP synchronization...");
+    LOG_INFO("NTP servers: %s, %s, %s", NTP_SERVER_1, NTP_SERVER_2, NTP_SERVER_3);
+
+    // ✅ Use configTzTime with multiple servers. The system time is already
+    // set after the first sync - wait for a fresh answer, not just a sane time
+    sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
+    configTzTime(POLAND_TZ, NTP_SERVER_1, NTP_SERVER_2, NTP_SERVER_3);
+
+    ntpSyncHardware = rtcDetected && !useInternalRTC;
+    ntpSyncStartMs = millis();
+    ntpSyncState = NTP_SYNC_WAIT_SNTP;
     return true;
 }
 
+bool isNTPSyncRunning() {
+    return ntpSyncState != NTP_SYNC_IDLE;
+}
+
+// One check per loop pass, never waits
+static void updateNTPSync() {
+    switch (ntpSyncState) {
+        case NTP_SYNC_WAIT_SNTP: {
+            time_t now = time(nullptr);
+            // Sprawdź czy timestamp jest sensowny (after 2020)
+            if (now > 1600000000 && sntp_get_sync_status() == SNTP_SYNC_STATUS_COMPLETED) {
+                logNTPTime(now);
+                lastNTPSync = millis();
+
+                if (!rtcDetected) {
+                    // Nothing to measure or write - take the system time as is
+                    NtpSyncResult result = {};
+                    takeNTPTime(result);
+                    finishNTPSync(result);
+                    return;
+                }
+
+                if (ntpSyncResultQueue == nullptr) {
+                    LOG_ERROR("NTP result queue missing - DS3231 not updated");
+                    failNTPSync();
+                    return;
+                }
+                ntpSyncState = NTP_SYNC_WAIT_RTC;
+                if (xTaskCreate(rtcWriteTask, "rtc_write", RTC_WRITE_TASK_STACK, nullptr, 1, nullptr) != pdPASS) {
+                    LOG_ERROR("Failed to start the DS3231 write task");
+                    failNTPSync();
+                }
+                return;
+            }
+
+            uint32_t elapsed = millis() - ntpSyncStartMs;
+            if (elapsed >= NTP_SYNC_TIMEOUT_MS) {
+                LOG_ERROR("❌ NTP synchronization failed after %lu seconds", (unsigned long)(NTP_SYNC_TIMEOUT_MS / 1000));
+                LOG_WARNING("Possible causes: Firewall blocking port 123 (UDP), DNS issues, or slow connection");
+                failNTPSync();
+            }
+            return;
+        }
+
+        case NTP_SYNC_WAIT_RTC: {
+            NtpSyncResult result;
+            if (xQueueReceive(ntpSyncResultQueue, &result, 0) == pdTRUE) {
+                finishNTPSync(result);
+            }
+            return;
+        }
+
+        default:
+            return;
+    }
+}
+
 // ===============================
 // RTC INITIALIZATION
 // ===============================
@@ -189,25 +586,33 @@ void initializeRTC() {
     // ✅ KLUCZOWE: Ustaw strefę czasową NA POCZĄTKU, niezależnie od NTP
     configureTimezone();
     
+    if (ntpSyncResultQueue == nullptr) {
+        ntpSyncResultQueue = xQueueCreate(1, sizeof(NtpSyncResult));
+    }
+
     // Reset flags
     rtcNeedsSync = false;
     batteryIssueDetected = false;
     
     LOG_INFO("Attempting to initialize external DS3231 RTC...");
     
-    Wire.begin(RTC_SDA_PIN, RTC_SCL_PIN);
-    Wire.setClock(100000);
-    
+    // Bus started by initI2CBus() in setup()
+    lockI2CBus();
     Wire.beginTransmission(0x68);
     byte error = Wire.endTransmission();
+    unlockI2CBus();
     
     if (error == 0) {
         LOG_INFO("DS3231 detected on I2C bus");
         
         if (rtc.begin()) {
+            rtcDetected = true;
+            initRtcDrift();
+            
             // Sprawdź czy RTC stracił zasilanie (bateria wyczerpana)
             if (rtc.lostPower()) {
                 LOG_WARNING("⚠️ RTC lost power - battery dead or removed");
+                rtcDriftInvalidate();
                 LOG_INFO("Setting RTC to compile time to clear OSF flag...");
                 
                 batteryIssueDetected = true;
@@ -215,7 +620,7 @@ void initializeRTC() {
                 
                 // Ustaw na compile time aby wyczyścić flagę OSF
                 DateTime compileTime = DateTime(F(__DATE__), F(__TIME__));
-                rtc.adjust(compileTime);
+                adjustRTC(compileTime);
                 delay(100);
                 
                 if (rtc.lostPower()) {
@@ -229,25 +634,12 @@ void initializeRTC() {
                 LOG_INFO("OSF flag cleared");
                 LOG_WARNING("⚠️ Battery issue detected - replace CR2032 battery");
                 
-                // Próba synchronizacji z NTP
-                LOG_INFO("Attempting immediate NTP sync after battery loss...");
-                
-                if (setRTCFromNTP()) {
-                    LOG_INFO("✅ RTC synchronized with NTP after battery replacement");
-                    // LOG_INFO("Battery warning cleared");
-                    // batteryIssueDetected = false;  // Clear flag after successful NTP sync
-                    rtcNeedsSync = false;
-                    rtcInitialized = true;
-                    useInternalRTC = false;
-                    return;
-                } else {
-                    LOG_WARNING("⚠️ NTP sync failed - RTC will use compile time until next sync");
-                    LOG_INFO("System will retry NTP sync every hour");
-                }
+                // No Wi-Fi yet - updateClock() syncs NTP as soon as it is up
+                LOG_WARNING("⚠️ RTC will use compile time until the first NTP sync");
             }
             
             // Weryfikacja czasu RTC
-            DateTime now = rtc.now();
+            DateTime now = readRTCNow();
             DateTime compileTime = DateTime(F(__DATE__), F(__TIME__));
             
             LOG_INFO("RTC current time (UTC): %04d-%02d-%02d %02d:%02d:%02d", 
@@ -272,24 +664,19 @@ void initializeRTC() {
             if (!timeValid) {
                 LOG_ERROR("RTC has invalid time components");
                 rtcNeedsSync = true;
+                rtcDriftInvalidate();
                 
-                if (setRTCFromNTP()) {
-                    LOG_INFO("✅ RTC restored from NTP");
-                    rtcNeedsSync = false;
-                    batteryIssueDetected = false;
-                    rtcInitialized = true;
-                    useInternalRTC = false;
-                    return;
-                } else {
-                    LOG_WARNING("NTP sync failed, switching to fallback");
-                    useInternalRTC = true;
-                    rtcInitialized = true;
-                    initInternalTimeFromCompileTime();
-                    return;
-                }
+                // No Wi-Fi yet - fallback clock until updateClock() gets NTP
+                LOG_WARNING("Switching to fallback until the first NTP sync");
+                useInternalRTC = true;
+                rtcInitialized = true;
+                rtcAwaitingNTP = true;
+                initInternalTimeFromCompileTime();
+                return;
             }
             
-            // RTC OK
+            // RTC OK - the one reading the clock starts from
+            anchorClock(now.unixtime());
             LOG_INFO("✅ RTC time verification successful");
             rtcInitialized = true;
             useInternalRTC = false;
@@ -328,6 +715,7 @@ void initializeRTC() {
         internalTime.minute = timeinfo.tm_min;
         internalTime.second = timeinfo.tm_sec;
         internalTime.lastUpdate = millis();
+        anchorInternalTime();
         
         LOG_INFO("Internal RTC set from system time");
     }
@@ -337,131 +725,65 @@ void initializeRTC() {
 // PUBLIC API
 // ===============================
 
-String getCurrentTimestamp() {
-    static String lastValidTimestamp = "";
-    static uint32_t lastValidTime = 0;
-    
+const char* getCurrentTimestamp() {
     if (!rtcInitialized) {
         static uint32_t lastWarning = 0;
         if (millis() - lastWarning > 30000) {
             LOG_ERROR("RTC not initialized in getCurrentTimestamp()");
             lastWarning = millis();
         }
-        return lastValidTimestamp.length() > 0 ? lastValidTimestamp : "RTC_NOT_INITIALIZED";
+        return "RTC_NOT_INITIALIZED";
     }
     
-    const int MAX_RETRIES = 3;
-    DateTime now;
-    bool validRead = false;
-    
-    for (int retry = 0; retry < MAX_RETRIES; retry++) {
-        now = rtc.now();
-        
-        if (now.year() >= 2024 && now.year() <= 2030) {
-            validRead = true;
-            break;
-        }
-        
-        if (retry == 0) {
-            LOG_WARNING("RTC read invalid (attempt %d/%d): %04d-%02d-%02d", 
-                       retry + 1, MAX_RETRIES,
-                       now.year(), now.month(), now.day());
-        }
-        
-        delay(10);
+    if (!clockValid) {
+        return "RTC_ERROR";
     }
     
-    if (!validRead) {
-        static uint32_t lastError = 0;
-        if (millis() - lastError > 10000) {
-            LOG_ERROR("RTC read failed after %d retries", MAX_RETRIES);
-            lastError = millis();
-        }
-        
-        if (lastValidTimestamp.length() > 0 && 
-            (millis() - lastValidTime) < 10000) {
-            LOG_WARNING("Using cached timestamp (age: %dms)", millis() - lastValidTime);
-            return lastValidTimestamp;
-        }
-        
-        return "RTC_ERROR";
+    uint32_t utc = extrapolateClock();
+    
+    portENTER_CRITICAL(&clockMux);
+    bool cached = (timestampUnix == utc);
+    const char* timestamp = timestampBuffers[timestampIndex];
+    portEXIT_CRITICAL(&clockMux);
+    
+    if (cached) {
+        return timestamp;
     }
     
-    // Convert UTC → Local
-    time_t utc = now.unixtime();
+    // Convert UTC → Local (outside the critical section - localtime_r takes the TZ lock)
+    time_t utcTime = utc;
     struct tm timeinfo;
-    localtime_r(&utc, &timeinfo);
+    localtime_r(&utcTime, &timeinfo);
     
-    char buffer[32];
+    char buffer[TIMESTAMP_LENGTH];
     strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
     
-    lastValidTimestamp = String(buffer);
-    lastValidTime = millis();
+    // Publish in the other buffer - a pointer handed out before stays intact
+    portENTER_CRITICAL(&clockMux);
+    if (timestampUnix != utc) {
+        uint8_t next = timestampIndex ^ 1;
+        memcpy(timestampBuffers[next], buffer, sizeof(buffer));
+        timestampIndex = next;
+        timestampUnix = utc;
+        clockStats.timestampBuilds++;
+    }
+    timestamp = timestampBuffers[timestampIndex];
+    portEXIT_CRITICAL(&clockMux);
     
-    return String(buffer);
+    return timestamp;
 }
 
 unsigned long getUnixTimestamp() {
-    if (!rtcInitialized) {
+    if (!rtcInitialized || !clockValid) {
         return 1609459200;  // 2021-01-01 00:00:00 UTC
     }
     
-    if (useInternalRTC) {
-        struct tm tm_time;
-        tm_time.tm_year = internalTime.year - 1900;
-        tm_time.tm_mon = internalTime.month - 1;
-        tm_time.tm_mday = internalTime.day;
-        tm_time.tm_hour = internalTime.hour;
-        tm_time.tm_min = internalTime.minute;
-        tm_time.tm_sec = internalTime.second;
-        tm_time.tm_isdst = 0;
-        
-        return mktime(&tm_time);
-    } else {
-        // ✅ RETRY MECHANISM - jak w getCurrentTimestamp()
-        const int MAX_RETRIES = 3;
-        DateTime now;
-        bool validRead = false;
-        
-        for (int retry = 0; retry < MAX_RETRIES; retry++) {
-            now = rtc.now();
-            
-            // ✅ Walidacja roku
-            if (now.year() >= 2024 && now.year() <= 2035) {
-                validRead = true;
-                break;
-            }
-            
-            if (retry < MAX_RETRIES - 1) {
-                delay(10);
-            }
-        }
-        
-        if (!validRead) {
-            static uint32_t lastError = 0;
-            if (millis() - lastError > 10000) {
-                LOG_ERROR("RTC read failed in getUnixTimestamp(), year: %d", now.year());
-                lastError = millis();
-            }
-            // ✅ Fallback: zwróć sensowną wartość zamiast śmieci
-            return 1735689600;  // 2025-01-01 00:00:00 UTC
-        }
-        
-        return now.unixtime();
-    }
+    return extrapolateClock();
 }
 
+// Clock anchored on a valid reading - DS3231 or the internal fallback
 bool isRTCWorking() {
-    if (!rtcInitialized) {
-        return false;
-    }
-    
-    if (useInternalRTC) {
-        return true;  // Internal RTC zawsze "działa"
-    } else {
-        DateTime now = rtc.now();
-        return (now.year() >= 2020 && now.year() <= 2035);
-    }
+    return rtcInitialized && clockValid;
 }
 
 String getRTCInfo() {
@@ -4,7 +4,10 @@
 #include <Arduino.h>
 
 void initializeRTC();
-String getCurrentTimestamp();
+// Local time "YYYY-MM-DD HH:MM:SS", formatted at most once per second. Points
+// into a static buffer that stays valid until the second change after next
+// (>= 1 s) - copy it to keep it longer.
+const char* getCurrentTimestamp();
 bool isRTCWorking();
 unsigned long getUnixTimestamp();
 String getRTCInfo();
@@ -14,8 +17,47 @@ bool isRTCHardware();
 
 bool rtcNeedsSynchronization();
 void initInternalTimeFromCompileTime();
-bool setRTCFromNTP();
+// Starts an NTP sync in the background (updateClock() finishes it) - false
+// without Wi-Fi or while one is running
+bool startNTPSync();
+bool isNTPSyncRunning();
 
 bool isBatteryIssueDetected();
 
+// ===============================
+// CLOCK SERVICE
+// ===============================
+// The DS3231 is read once at boot and then every CLOCK_RESYNC_INTERVAL_MS;
+// in between UTC is the last reading plus the esp_timer time since then.
+// getUnixTimestamp(), isRTCWorking() and getCurrentTimestamp() never touch
+// I2C, so the control task and /api/status can call them as often as they like.
+// Corrections up to CLOCK_SLEW_MAX_S (DS3231 resync, NTP) are slewed in,
+// so the clock never runs backwards or skips a second.
+
+#define CLOCK_RESYNC_INTERVAL_MS    600000  // ms - DS3231 re-read (esp_timer drift << 1 s in 10 min)
+#define CLOCK_RESYNC_RETRY_MS       10000   // ms - after a failed DS3231 read
+#define CLOCK_STEP_TOLERANCE_S      1       // s - smaller differences are read phase, not drift
+#define CLOCK_SLEW_MAX_S            60      // s - larger corrections step the clock
+#define CLOCK_SLEW_RATE_PPM         1000    // Slew speed: 1 ms per second (1 s in ~17 min)
+#define RTC_EDGE_POLL_MS            5       // ms - DS3231 seconds edge search at NTP syncs
+#define NTP_SYNC_TIMEOUT_MS         20000   // ms - SNTP answer wait, then RTC_NTP_RETRY_S
+#define RTC_WRITE_TASK_STACK        4096    // NTP sync: DS3231 edge search + write
+
+struct ClockStats {
+    uint32_t rtcReads;          // DS3231 time reads since boot (retries included)
+    uint32_t rtcReadErrors;     // Resyncs that got no valid reading
+    uint32_t clockReads;        // Timestamps served from the clock
+    uint32_t timestampBuilds;   // getCurrentTimestamp() strings formatted (the rest came from the cache)
+    uint32_t resyncs;
+    uint32_t ntpSyncs;          // Successful NTP syncs since boot
+    int32_t lastStepSeconds;    // Reference - clock at the last resync / NTP sync
+    int32_t slewRemainingMs;    // Correction not yet worked in
+    uint32_t syncAgeSeconds;    // Since the last resync
+};
+
+// loop(): periodic DS3231 resync and NTP sync (rtc_drift.h), posts
+// ALGO_EVENT_DAY_CHANGE when the UTC day rolls over
+void updateClock();
+ClockStats getClockStats();
+
 #endif
\ No newline at end of file
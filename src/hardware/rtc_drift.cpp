@@ -0,0 +1,176 @@
+#include "rtc_drift.h"
+#include "fram_controller.h"
+#include "fram_journal.h"
+#include "i2c_bus.h"
+#include "../core/logging.h"
+#include "../crypto/crc.h"
+#include <Wire.h>
+#include <math.h>
+
+#define DS3231_ADDRESS          0x68
+#define DS3231_REG_CONTROL      0x0E
+#define DS3231_REG_AGING        0x10
+#define DS3231_CONTROL_CONV     0x20    // Start a temperature conversion (applies the aging offset)
+
+static RtcDriftBlock block;
+static bool blockLoaded = false;
+
+static uint16_t blockCRC() {
+    return crc16((const uint8_t*)&block, offsetof(RtcDriftBlock, crc));
+}
+
+static void resetBlock() {
+    memset(&block, 0, sizeof(block));
+    block.magic = RTC_DRIFT_MAGIC;
+    block.version = RTC_DRIFT_VERSION;
+}
+
+static bool loadBlock() {
+    if (!readFRAMBlock(FRAM_ADDR_RTC_DRIFT, (uint8_t*)&block, sizeof(block))) {
+        return false;
+    }
+    if (block.magic != RTC_DRIFT_MAGIC) {
+        return false;   // never written
+    }
+    if (block.crc != blockCRC()) {
+        LOG_ERROR("RTC drift: CRC error in FRAM");
+        return false;
+    }
+    if (block.version != RTC_DRIFT_VERSION || !isfinite(block.driftPpm) ||
+        fabsf(block.driftPpm) > RTC_DRIFT_MAX_PPM) {
+        LOG_WARNING("RTC drift: FRAM block rejected");
+        return false;
+    }
+    return true;
+}
+
+// Runs on the loop task (NTP sync, RTC invalidation) while the control and
+// web tasks commit their own transactions - FramTransaction::commit()
+// holds the bus lock across the shared journal, so this is safe.
+static void saveBlock() {
+    block.crc = blockCRC();
+
+    FramTransaction tx;
+    if (!tx.write(FRAM_ADDR_RTC_DRIFT, &block, sizeof(block)) || !tx.commit()) {
+        LOG_ERROR("FRAM RTC drift commit failed");
+    }
+}
+
+static bool readAgingOffset(int8_t& value) {
+    I2CBusGuard guard;
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_REG_AGING);
+    if (Wire.endTransmission(false) != 0 || Wire.requestFrom((uint8_t)DS3231_ADDRESS, (size_t)1) != 1) {
+        return false;
+    }
+    value = (int8_t)Wire.read();
+    return true;
+}
+
+static bool writeAgingOffset(int8_t value) {
+    I2CBusGuard guard;
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_REG_AGING);
+    Wire.write((uint8_t)value);
+    if (Wire.endTransmission() != 0) {
+        return false;
+    }
+
+    // Without a forced conversion the new offset applies within 64 s
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_REG_CONTROL);
+    if (Wire.endTransmission(false) != 0 || Wire.requestFrom((uint8_t)DS3231_ADDRESS, (size_t)1) != 1) {
+        return true;
+    }
+    uint8_t control = Wire.read();
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(DS3231_REG_CONTROL);
+    Wire.write(control | DS3231_CONTROL_CONV);
+    Wire.endTransmission();
+    return true;
+}
+
+static bool settled() {
+    return block.samples >= RTC_DRIFT_SETTLED_SAMPLES && fabsf(block.lastResidualPpm) <= RTC_DRIFT_SETTLED_PPM;
+}
+
+void initRtcDrift() {
+    blockLoaded = loadBlock();
+    if (!blockLoaded) {
+        resetBlock();
+    }
+
+    // The register survives on the backup battery only
+    int8_t aging = 0;
+    if (blockLoaded && readAgingOffset(aging) && aging != block.agingOffset) {
+        if (writeAgingOffset(block.agingOffset)) {
+            LOG_WARNING("RTC drift: DS3231 aging offset %d restored to %d", aging, block.agingOffset);
+        }
+    }
+
+    LOG_INFO("RTC drift: %.2f ppm (%d samples, last residual %.2f ppm), aging offset %d",
+             block.driftPpm, block.samples, block.lastResidualPpm, block.agingOffset);
+}
+
+void rtcDriftInvalidate() {
+    if (block.lastSyncUnix != 0) {
+        block.lastSyncUnix = 0;
+        saveBlock();
+    }
+}
+
+void rtcDriftNtpSync(uint32_t ntpUnix, bool offsetValid, int64_t offsetUs) {
+    uint32_t interval = ntpUnix - block.lastSyncUnix;
+
+    if (offsetValid && block.lastSyncUnix != 0 &&
+        interval >= RTC_DRIFT_MIN_INTERVAL_S && interval <= RTC_DRIFT_MAX_INTERVAL_S) {
+        float residual = (float)offsetUs / interval;    // us per s = ppm
+
+        if (fabsf(residual) > RTC_DRIFT_MAX_PPM) {
+            LOG_WARNING("RTC drift: %.1f ppm over %lus is implausible - ignored", residual, (unsigned long)interval);
+        } else {
+            float natural = residual + block.agingOffset * RTC_AGING_PPM_PER_LSB;
+            if (block.samples < 0xFFFF) block.samples++;
+            uint16_t weight = block.samples < RTC_DRIFT_LEARN_WEIGHT ? block.samples : RTC_DRIFT_LEARN_WEIGHT;
+            block.driftPpm += (natural - block.driftPpm) / weight;
+            block.lastResidualPpm = residual;
+
+            long target = lroundf(block.driftPpm / RTC_AGING_PPM_PER_LSB);
+            if (target > 127) target = 127;
+            if (target < -128) target = -128;
+
+            LOG_INFO("RTC drift: offset %ldms after %lus = %.2f ppm residual, %.2f ppm natural (estimate %.2f)",
+                     (long)(offsetUs / 1000), (unsigned long)interval, residual, natural, block.driftPpm);
+
+            if (target != block.agingOffset) {
+                if (writeAgingOffset((int8_t)target)) {
+                    LOG_INFO("RTC drift: DS3231 aging offset %d -> %ld", block.agingOffset, target);
+                    block.agingOffset = (int8_t)target;
+                } else {
+                    LOG_ERROR("RTC drift: writing the DS3231 aging offset failed");
+                }
+            }
+        }
+    }
+
+    block.lastSyncUnix = ntpUnix;
+    saveBlock();
+}
+
+uint32_t rtcDriftNextNtpSync() {
+    if (block.lastSyncUnix == 0) {
+        return 0;
+    }
+    return block.lastSyncUnix + (settled() ? RTC_NTP_INTERVAL_LONG_S : RTC_NTP_INTERVAL_S);
+}
+
+RtcDriftStats getRtcDriftStats() {
+    RtcDriftStats stats;
+    stats.driftPpm = block.driftPpm;
+    stats.lastResidualPpm = block.lastResidualPpm;
+    stats.agingOffset = block.agingOffset;
+    stats.samples = block.samples;
+    stats.lastSyncUnix = block.lastSyncUnix;
+    stats.ntpIntervalS = settled() ? RTC_NTP_INTERVAL_LONG_S : RTC_NTP_INTERVAL_S;
+    return stats;
+}
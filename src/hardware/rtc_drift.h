@@ -0,0 +1,76 @@
+#ifndef RTC_DRIFT_H
+#define RTC_DRIFT_H
+
+#include <Arduino.h>
+
+// ===============================
+// DS3231 DRIFT COMPENSATION
+// ===============================
+// At every NTP sync the DS3231 offset is measured on its seconds edge
+// (rtc_controller.cpp) before the RTC is set again. Offset / interval since
+// the previous sync is the residual drift with the current aging offset:
+//
+//     natural drift = residual + agingOffset * RTC_AGING_PPM_PER_LSB
+//
+// The natural drift (ppm, + = RTC fast) is learned as a running mean and the
+// aging offset register (0x10) is programmed to cancel it - positive values
+// slow the oscillator. Estimate and offset live in FRAM, so a power loss of
+// the DS3231 (register back to 0) is repaired at the next boot. Once the
+// residual is small, NTP syncs drop from daily to weekly.
+
+#define RTC_DRIFT_MAGIC             0x5244  // "RD"
+#define RTC_DRIFT_VERSION           1
+
+#define RTC_AGING_PPM_PER_LSB       0.1f    // DS3231 aging offset step at 25 °C
+#define RTC_DRIFT_MIN_INTERVAL_S    43200   // s - shorter sync intervals are not measured (edge ~5 ms)
+#define RTC_DRIFT_MAX_INTERVAL_S    7776000 // s - 90 days
+#define RTC_DRIFT_MAX_PPM           100.0f  // Larger residuals = RTC set or glitched in between
+#define RTC_DRIFT_LEARN_WEIGHT      4       // Running mean ~ last 4 syncs
+#define RTC_DRIFT_SETTLED_PPM       0.5f    // Residual for the long NTP interval (0.3 s / week)
+#define RTC_DRIFT_SETTLED_SAMPLES   2
+
+#define RTC_NTP_INTERVAL_S          86400   // s - NTP sync until the drift is compensated
+#define RTC_NTP_INTERVAL_LONG_S     604800  // s - once it is
+#define RTC_NTP_RETRY_S             3600    // s - after a failed sync
+
+// FRAM image (FRAM_ADDR_RTC_DRIFT) - written once per NTP sync
+struct RtcDriftBlock {
+    uint16_t magic;                 // RTC_DRIFT_MAGIC
+    uint16_t version;               // RTC_DRIFT_VERSION
+    uint32_t lastSyncUnix;          // NTP time the DS3231 was last set to (0: interval not measurable)
+    float driftPpm;                 // Natural drift estimate, without the aging offset
+    float lastResidualPpm;          // Drift measured at the last sync, aging offset included
+    uint16_t samples;               // Measured intervals (saturating)
+    int8_t agingOffset;             // Programmed into the DS3231
+    uint8_t reserved;
+    uint16_t crc;                   // CRC16 of the fields above
+    uint16_t reserved2;
+};
+
+static_assert(sizeof(RtcDriftBlock) == 24, "RtcDriftBlock must match the FRAM layout");
+
+struct RtcDriftStats {
+    float driftPpm;
+    float lastResidualPpm;
+    int8_t agingOffset;
+    uint16_t samples;
+    uint32_t lastSyncUnix;
+    uint32_t ntpIntervalS;          // Current NTP sync interval
+};
+
+// DS3231 found (initializeRTC) - loads the FRAM block and restores the aging offset
+void initRtcDrift();
+
+// The DS3231 lost power or had an invalid time - the next interval is not measured
+void rtcDriftInvalidate();
+
+// NTP sync that set the DS3231 to ntpUnix. offsetUs = DS3231 - NTP measured
+// just before (only used when offsetValid).
+void rtcDriftNtpSync(uint32_t ntpUnix, bool offsetValid, int64_t offsetUs);
+
+// Unix time the next NTP sync is due (0: now)
+uint32_t rtcDriftNextNtpSync();
+
+RtcDriftStats getRtcDriftStats();
+
+#endif
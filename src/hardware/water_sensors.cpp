@@ -4,67 +4,213 @@
 #include "../core/logging.h"
 #include "../algorithm/water_algorithm.h"
 #include "../algorithm/algorithm_config.h"
+#include "../algorithm/algorithm_task.h"
+#include "../core/metrics.h"
+#include "../core/trace_recorder.h"
+#include "../core/spsc_ring.h"
+#include <esp_timer.h>
+
+// ===============================
+// EDGE CAPTURE (ISR -> SPSC RING)
+// ===============================
+
+#define SENSOR_EDGE_QUEUE_SIZE  (32 * WATER_CHANNEL_COUNT)   // power of two
+#define SENSOR_DEBOUNCE_US      ((int64_t)SENSOR_DEBOUNCE_MS * 1000)
+
+struct SensorEdge {
+    int64_t  timestampUs;   // esp_timer time of the edge
+    uint8_t  channel;       // Water channel (hardware_pins.h)
+    uint8_t  sensor;        // 1 or 2
+    bool     triggered;     // level after the edge (LOW = triggered)
+};
+
+// Per-sensor debounce: a level is reported once it has held SENSOR_DEBOUNCE_MS.
+// The reported time is the edge that started it, not the time it was confirmed.
+struct SensorDebounce {
+    bool    stable;         // Level last reported to the algorithm
+    bool    candidate;      // Latest raw level
+    int64_t candidateUs;    // When the raw level changed to `candidate`
+};
+
+// Shared by every sensorISR<> instance - see the single-producer note in
+// spsc_ring.h. Only valid while GPIO ISRs are serialized on one core.
+#if defined(ESP_PLATFORM) && !defined(CONFIG_FREERTOS_UNICORE)
+#error "edgeQueue has several ISR producers - needs one ring per ISR on multi-core targets"
+#endif
+static SpscRing<SensorEdge, SENSOR_EDGE_QUEUE_SIZE> edgeQueue;
+static volatile bool edgeOverflow = false;
+static SensorDebounce debounce[WATER_CHANNEL_COUNT][2];
+static SensorCaptureStats captureStats = {0, 0, 0, 0};
+
+static uint8_t sensorPin(uint8_t channel, uint8_t sensor) {
+    return sensor == 1 ? WATER_CHANNEL_PINS[channel].sensor1 : WATER_CHANNEL_PINS[channel].sensor2;
+}
+
+static void IRAM_ATTR pushEdge(uint8_t channel, uint8_t sensor, uint8_t pin) {
+    SensorEdge edge;
+    edge.timestampUs = esp_timer_get_time();
+    edge.channel = channel;
+    edge.sensor = sensor;
+    edge.triggered = digitalRead(pin) == LOW;
+
+    captureStats.edges++;
+    if (!edgeQueue.push(edge)) {
+        edgeOverflow = true;
+    }
+
+    // Wake the control task - the debounce deadline is computed there
+    postAlgorithmEventFromISR(ALGO_EVENT_SENSOR_EDGE, sensor);
+}
+
+// attachInterrupt() takes a plain function - one instance per channel/sensor
+template <uint8_t CHANNEL, uint8_t SENSOR>
+static void IRAM_ATTR sensorISR() {
+    pushEdge(CHANNEL, SENSOR, SENSOR == 1 ? WATER_CHANNEL_PINS[CHANNEL].sensor1
+                                          : WATER_CHANNEL_PINS[CHANNEL].sensor2);
+}
+
+typedef void (*SensorISR)();
+
+static const SensorISR sensorISRs[][2] = {
+    { sensorISR<0, 1>, sensorISR<0, 2> },
+#if WATER_CHANNEL_COUNT > 1
+    { sensorISR<1, 1>, sensorISR<1, 2> },
+#endif
+};
+
+static_assert(sizeof(sensorISRs) / sizeof(sensorISRs[0]) == WATER_CHANNEL_COUNT,
+              "One ISR pair per water channel");
 
 void initWaterSensors() {
-    pinMode(WATER_SENSOR_1_PIN, INPUT_PULLUP);
-    pinMode(WATER_SENSOR_2_PIN, INPUT_PULLUP);
-    LOG_INFO("Water sensors initialized on pins %d and %d", 
-             WATER_SENSOR_1_PIN, WATER_SENSOR_2_PIN);
+    // Levels present at boot are the reference - only changes are reported
+    int64_t now = esp_timer_get_time();
+
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        for (uint8_t sensor = 1; sensor <= 2; sensor++) {
+            uint8_t pin = sensorPin(ch, sensor);
+            pinMode(pin, INPUT_PULLUP);
+
+            SensorDebounce& d = debounce[ch][sensor - 1];
+            d.stable = d.candidate = digitalRead(pin) == LOW;
+            d.candidateUs = now;
+
+            attachInterrupt(digitalPinToInterrupt(pin), sensorISRs[ch][sensor - 1], CHANGE);
+        }
+
+        LOG_INFO("Water sensors (channel %d) initialized on pins %d and %d (edge IRQ, %dms debounce)", 
+                 ch, WATER_CHANNEL_PINS[ch].sensor1, WATER_CHANNEL_PINS[ch].sensor2, SENSOR_DEBOUNCE_MS);
+    }
 }
 
-bool readWaterSensor1() {
-    return digitalRead(WATER_SENSOR_1_PIN) == LOW;
+bool readWaterSensor1(uint8_t channel) {
+    return channel < WATER_CHANNEL_COUNT && digitalRead(WATER_CHANNEL_PINS[channel].sensor1) == LOW;
 }
 
-bool readWaterSensor2() {
-    return digitalRead(WATER_SENSOR_2_PIN) == LOW;
+bool readWaterSensor2(uint8_t channel) {
+    return channel < WATER_CHANNEL_COUNT && digitalRead(WATER_CHANNEL_PINS[channel].sensor2) == LOW;
+}
+
+static void acceptLevel(uint8_t channel, uint8_t sensor) {
+    SensorDebounce& d = debounce[channel][sensor - 1];
+    d.stable = d.candidate;
+    captureStats.accepted++;
+
+    // Notify algorithm with the edge time (ms, same base as millis())
+    waterChannels[channel].onSensorStateChange(sensor, d.stable, (uint32_t)(d.candidateUs / 1000));
+    if (channel == 0) {
+        traceRecordAt((uint32_t)(d.candidateUs / 1000), TRACE_SENSOR, sensor, d.stable ? 1 : 0);
+    }
+
+    // Reaction latency: level became valid (edge + debounce) -> algorithm notified
+    int64_t validUs = d.candidateUs + SENSOR_DEBOUNCE_US;
+    int64_t nowUs = esp_timer_get_time();
+    if (nowUs > validUs) {
+        recordSensorReaction((uint32_t)(nowUs - validUs));
+    }
+
+    if (WATER_CHANNEL_COUNT > 1) {
+        LOG_INFO("Channel %d sensor %d: %s", channel, sensor, d.stable ? "TRIGGERED" : "NORMAL");
+    } else {
+        LOG_INFO("Sensor %d: %s", sensor, d.stable ? "TRIGGERED" : "NORMAL");
+    }
+}
+
+static void applyEdge(uint8_t channel, uint8_t sensor, bool triggered, int64_t timestampUs) {
+    SensorDebounce& d = debounce[channel][sensor - 1];
+    if (triggered == d.candidate) return;
+
+    // Previous level held long enough - it was real, even if already gone
+    if (d.candidate != d.stable && timestampUs - d.candidateUs >= SENSOR_DEBOUNCE_US) {
+        acceptLevel(channel, sensor);
+    } else if (d.candidate != d.stable) {
+        captureStats.bounces++;
+    }
+
+    d.candidate = triggered;
+    d.candidateUs = timestampUs;
 }
 
 void checkWaterSensors() {
-    static bool lastSensor1 = false;
-    static bool lastSensor2 = false;
-    static uint32_t lastDebounce1 = 0;
-    static uint32_t lastDebounce2 = 0;
-    
-    bool currentSensor1 = digitalRead(WATER_SENSOR_1_PIN) == LOW;
-    bool currentSensor2 = digitalRead(WATER_SENSOR_2_PIN) == LOW;
-    uint32_t currentTimeSeconds = millis() / 1000; // <-- Konwersja do sekund
-    
-    // Sensor 1 with debouncing
-    if (currentSensor1 != lastSensor1) {
-        if (currentTimeSeconds - lastDebounce1 > SENSOR_DEBOUNCE_TIME) { // <-- USUŃ * 1000
-            lastDebounce1 = currentTimeSeconds;
-            lastSensor1 = currentSensor1;
-            
-            // Notify algorithm
-            waterAlgorithm.onSensorStateChange(1, currentSensor1);
-            
-            LOG_INFO("Sensor 1: %s", currentSensor1 ? "TRIGGERED" : "NORMAL");
+    SensorEdge edge;
+    while (edgeQueue.pop(edge)) {
+        if (edge.channel < WATER_CHANNEL_COUNT && (edge.sensor == 1 || edge.sensor == 2)) {
+            applyEdge(edge.channel, edge.sensor, edge.triggered, edge.timestampUs);
         }
     }
-    
-    // Sensor 2 with debouncing
-    if (currentSensor2 != lastSensor2) {
-        if (currentTimeSeconds - lastDebounce2 > SENSOR_DEBOUNCE_TIME) { // <-- USUŃ * 1000
-            lastDebounce2 = currentTimeSeconds;
-            lastSensor2 = currentSensor2;
-            
-            // Notify algorithm
-            waterAlgorithm.onSensorStateChange(2, currentSensor2);
-            
-            LOG_INFO("Sensor 2: %s", currentSensor2 ? "TRIGGERED" : "NORMAL");
+
+    int64_t now = esp_timer_get_time();
+
+    // Edges were lost - fall back to the pin levels as of now
+    if (edgeOverflow) {
+        edgeOverflow = false;
+        captureStats.overflows++;
+        for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+            applyEdge(ch, 1, readWaterSensor1(ch), now);
+            applyEdge(ch, 2, readWaterSensor2(ch), now);
         }
+        LOG_WARNING("Sensor edge queue overflow - resynced from pins");
     }
+
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        for (uint8_t sensor = 1; sensor <= 2; sensor++) {
+            SensorDebounce& d = debounce[ch][sensor - 1];
+            if (d.candidate != d.stable && now - d.candidateUs >= SENSOR_DEBOUNCE_US) {
+                acceptLevel(ch, sensor);
+            }
+        }
+    }
+}
+
+SensorCaptureStats getSensorCaptureStats() {
+    return captureStats;
 }
+
+uint32_t getSensorDebounceWaitMs() {
+    int64_t now = esp_timer_get_time();
+    uint32_t wait = UINT32_MAX;
+
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        for (uint8_t i = 0; i < 2; i++) {
+            const SensorDebounce& d = debounce[ch][i];
+            if (d.candidate == d.stable) continue;
+            int64_t remainingUs = d.candidateUs + SENSOR_DEBOUNCE_US - now;
+            // Round up so the task does not wake a tick early
+            uint32_t ms = (remainingUs <= 0) ? 0 : (uint32_t)((remainingUs + 999) / 1000);
+            if (ms < wait) wait = ms;
+        }
+    }
+    return wait;
+}
+
 // Compatibility functions for old code
 void updateWaterSensors() {
     // This is now handled by checkWaterSensors
     checkWaterSensors();
 }
 
-String getWaterStatus() {
-    bool sensor1 = readWaterSensor1();
-    bool sensor2 = readWaterSensor2();
+String getWaterStatus(uint8_t channel) {
+    bool sensor1 = readWaterSensor1(channel);
+    bool sensor2 = readWaterSensor2(channel);
     
     if (sensor1 && sensor2) {
         return "BOTH_LOW";
@@ -10,13 +10,26 @@ struct SensorState {
     bool isStable;
 };
 
+// Edge capture: GPIO ISR -> SPSC ring -> ms debounce in checkWaterSensors()
+struct SensorCaptureStats {
+    uint32_t edges;          // Raw edges captured by the ISRs
+    uint32_t overflows;      // Edges lost because the ring was full (resynced from pins)
+    uint32_t accepted;       // Level changes reported to the algorithm
+    uint32_t bounces;        // Edges filtered by SENSOR_DEBOUNCE_MS
+};
+
+// One sensor pair per water channel (hardware_pins.h) - channel 0 by default
 void initWaterSensors();
 void updateWaterSensors();
-String getWaterStatus();
+String getWaterStatus(uint8_t channel = 0);
 bool isWaterLevelLow();
 bool shouldActivatePump();
-void checkWaterSensors();
-bool readWaterSensor1();
-bool readWaterSensor2();
+void checkWaterSensors();           // All channels
+bool readWaterSensor1(uint8_t channel = 0);
+bool readWaterSensor2(uint8_t channel = 0);
+SensorCaptureStats getSensorCaptureStats();
+
+// ms until a pending level change is confirmed on any channel (UINT32_MAX if none)
+uint32_t getSensorDebounceWaitMs();
 
-#endif
\ No newline at end of file
+#endif
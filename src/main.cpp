@@ -1,8 +1,12 @@
 #include <Arduino.h>
 #include "mode_config.h"
 #include "core/logging.h"
+#include "core/metrics.h"
+#include "core/uptime.h"
+#include "core/boot_profile.h"
 #include "hardware/rtc_controller.h"
 #include "hardware/fram_controller.h"
+#include "hardware/i2c_bus.h"
 #include "hardware/hardware_pins.h"
 #include "cli/cli_handler.h" 
 
@@ -28,12 +32,19 @@ void setupProductionMode();
     #include "security/rate_limiter.h"
     #include "web/web_server.h"
     #include "algorithm/water_algorithm.h"
+    #include "algorithm/algorithm_task.h"
+    #include "algorithm/flow_estimator.h"
+    #include "algorithm/adaptive_delay.h"
+    #include "core/trace_recorder.h"
 #endif
 
 void setup() {
     // Initialize core systems
     initLogging();
-    delay(5000); // Wait for serial monitor
+    initI2CBus();           // Bus lock before the first FRAM / DS3231 access
+#if MODE_PROGRAMMING
+    delay(5000); // Wait for serial monitor - the CLI banner is interactive
+#endif
     
     Serial.print("=== MODE: ");
     Serial.print(MODE_NAME);
@@ -87,54 +98,78 @@ void setupProgrammingMode() {
 }
 #else
 
+// ===============================
+// BOOT SEQUENCER
+// ===============================
+// setup() only brings up what the control loop needs - sensors, pump
+// safety, FRAM state, clock, algorithm task - and returns in a few hundred
+// ms. Wi-Fi, web server and NTP follow from loop(): updateBootSequencer()
+// only checks state, and the NTP sync itself is stepped by updateClock()
+// (SNTP answer polled per pass, DS3231 write in its own task), so neither
+// holds up a loop pass (see core/boot_profile.h for the recorded stages).
+
+enum BootNetworkState {
+    BOOT_NET_WAIT_WIFI,     // WiFi.begin() issued, web server waits for the link (max BOOT_WIFI_WAIT_MS)
+    BOOT_NET_WAIT_NTP,      // Web server up; updateClock() steps the first NTP sync in the background
+    BOOT_NET_DONE
+};
+
+static BootNetworkState bootNetworkState = BOOT_NET_WAIT_WIFI;
+static unsigned long wifiStartMs = 0;
+
 void setupProductionMode() {
     Serial.println();
     Serial.println("=== ESP32-C3 Water System Starting ===");
     Serial.println("Production Mode - Full Water System");
 
+    // Relay off and sensor interrupts before anything that can take time
     initWaterSensors();
     initPumpController();
+    bootStageReached(BOOT_STAGE_HARDWARE);
 
     initNVS();
     loadVolumeFromNVS();
-
-    bool credentials_loaded = initCredentialsManager();
-    
-    Serial.print("Device ID: ");
-    if (credentials_loaded) {
-        Serial.println(getDeviceID());
-    } else {
-        Serial.println("FALLBACK_MODE");
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        waterChannels[ch].initParams();
     }
-    
-    Serial.println("[INIT] Initializing network...");
-    initWiFi();
+    initFlowEstimator();
+    initAdaptiveDelay(waterAlgorithm.getParams());
+    bootStageReached(BOOT_STAGE_STORAGE);
 
-    LOG_INFO("[INIT] Initializing RTC...");
+    // No Wi-Fi yet - a DS3231 that needs NTP runs on the fallback clock
+    // until updateClock() gets the first sync
     initializeRTC();
     LOG_INFO("RTC Status: %s", getRTCInfo().c_str());
-    
-    LOG_INFO("[INIT] Waiting for RTC to stabilize...");
-    delay(2000);
-    
     if (!isRTCWorking()) {
         LOG_WARNING("⚠️ WARNING: RTC not working properly");
         LOG_WARNING("⚠️ Daily volume tracking may be affected");
     }
+    bootStageReached(BOOT_STAGE_CLOCK);
     
-    LOG_INFO("[INIT] Initializing daily volume tracking...");
-    waterAlgorithm.initDailyVolume();
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        waterChannels[ch].initDailyVolume();
+    }
+
+    // Trace starts with a sync point (sensors, daily volume, settings)
+    initTraceRecorder();
+    traceSyncPoint(TRACE_BOOT);
+
+    // Control loop (sensors, algorithm, pump) - event-driven task
+    initAlgorithmTask();
+    bootStageReached(BOOT_STAGE_CONTROL);
+
+    // Everything below runs beside the control task
+    bool credentials_loaded = initCredentialsManager();
+    LOG_INFO("Device ID: %s", credentials_loaded ? getDeviceID() : "FALLBACK_MODE");
 
-    // Initialize security
     initAuthManager();
     initSessionManager();
     initRateLimiter();
-    
-    // Initialize VPS logger
-    initVPSLogger();
-    
-    // Initialize web server
-    initWebServer();
+    initVPSLogger();        // Outbox in FRAM, uplink task waits for Wi-Fi
+    bootStageReached(BOOT_STAGE_SERVICES);
+
+    initWiFi();             // Non-blocking - updateBootSequencer() takes over
+    wifiStartMs = millis();
     
     // Post-init diagnostics
     Serial.println();
@@ -143,24 +178,91 @@ void setupProductionMode() {
     LOG_INFO("====================================");
     LOG_INFO("RTC Working: %s", isRTCWorking() ? "YES" : "NO");
     LOG_INFO("RTC Info: %s", getRTCInfo().c_str());
-    LOG_INFO("Current Time: %s", getCurrentTimestamp().c_str());
-    LOG_INFO("Water Algorithm:");
-    LOG_INFO("  State: %s", waterAlgorithm.getStateString());
-    LOG_INFO("  Daily Volume: %d / %d ml", 
-             waterAlgorithm.getDailyVolume(), FILL_WATER_MAX);
-    LOG_INFO("  UTC Day: %lu", waterAlgorithm.getLastResetUTCDay());
+    LOG_INFO("Current Time: %s", getCurrentTimestamp());
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        const WaterAlgorithm& channel = waterChannels[ch];
+        LOG_INFO("Water Algorithm (channel %d):", ch);
+        LOG_INFO("  State: %s", channel.getStateString());
+        LOG_INFO("  Daily Volume: %d / %d ml", 
+                 channel.getDailyVolume(), channel.getParams().fillWaterMax);
+        LOG_INFO("  UTC Day: %lu", channel.getLastResetUTCDay());
+    }
     LOG_INFO("====================================");
     Serial.println();
     
-    Serial.println("=== System initialization complete ===");
-    if (isWiFiConnected()) {
-        Serial.print("Dashboard: http://");
-        Serial.println(getLocalIP().toString());
-    }
+    Serial.println("=== Control running - network starting in background ===");
     Serial.print("Current time: ");
     Serial.println(getCurrentTimestamp());
 }
 
+// Network side of the boot, one non-blocking step per loop() pass
+static void updateBootSequencer() {
+    switch (bootNetworkState) {
+        case BOOT_NET_WAIT_WIFI:
+            if (!isWiFiConnected() && millis() - wifiStartMs < BOOT_WIFI_WAIT_MS) {
+                return;
+            }
+            if (isWiFiConnected()) {
+                bootStageReached(BOOT_STAGE_WIFI);
+            } else {
+                LOG_WARNING("WiFi not connected after %lus - starting the web server anyway",
+                            (unsigned long)(BOOT_WIFI_WAIT_MS / 1000));
+                if (!areCredentialsLoaded()) {
+                    LOG_ERROR("Consider programming correct credentials via FRAM programmer");
+                }
+            }
+            initWebServer();
+            bootStageReached(BOOT_STAGE_WEB);
+            if (isWiFiConnected()) {
+                LOG_INFO("Dashboard: http://%s", getLocalIP().toString().c_str());
+            }
+            bootNetworkState = BOOT_NET_WAIT_NTP;
+            return;
+
+        case BOOT_NET_WAIT_NTP:
+            if (isWiFiConnected()) {
+                bootStageReached(BOOT_STAGE_WIFI);     // late link after the wait
+            }
+            if (getClockStats().ntpSyncs > 0) {
+                bootStageReached(BOOT_STAGE_NTP);
+                bootNetworkState = BOOT_NET_DONE;
+            }
+            return;
+
+        default:
+            return;
+    }
+}
+
+#endif
+
+#if MODE_PRODUCTION
+static bool atRestartSafePoint() {
+    if (getNextPumpStopMs() != UINT32_MAX) return false;
+    for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+        if (waterChannels[ch].getState() != STATE_IDLE) return false;
+    }
+    return true;
+}
+
+// Restart after DAILY_RESTART_HOURS of uptime, never in the middle of a cycle
+static void checkScheduledRestart() {
+    if (!DAILY_RESTART_ENABLED || uptimeMs() < (uint64_t)DAILY_RESTART_HOURS * 3600000ULL) {
+        return;
+    }
+    if (!atRestartSafePoint()) {
+        return;
+    }
+
+    // Hold the control mutex so no cycle starts before the restart
+    AlgorithmCommand cmd;
+    if (!atRestartSafePoint()) {
+        return;
+    }
+    LOG_WARNING("=== SCHEDULED RESTART: %luh uptime reached ===", (unsigned long)DAILY_RESTART_HOURS);
+    delay(1000);   // let the log line out
+    ESP.restart();
+}
 #endif
 
 // ===============================
@@ -171,55 +273,47 @@ void loop() {
 #if MODE_PROGRAMMING
     static unsigned long lastBlink = 0;
     unsigned long now = millis();
+    updateClock();
     handleCLI();
     delay(10);
     
 #else
-    // Production mode loop - full water system (unchanged)
+    // Production mode loop - full water system
     static unsigned long lastUpdate = 0;
     unsigned long now = millis();
+    unsigned long loopStartUs = micros();
     
-    // DAILY RESTART CHECK - 24 godziny
-    if (now > 86400000UL) { // 24h w ms
-        Serial.println("=== DAILY RESTART: 24h uptime reached ===");
-        
-        if (isPumpActive()) {
-            stopPump();
-            Serial.println("Pump stopped before restart");
-            delay(1000);
-        }
-        
-        Serial.println("System restarting in 3 seconds...");
-        delay(3000);
-        ESP.restart();
-    }
+    // Optional scheduled restart (DAILY_RESTART_ENABLED, off by default)
+    checkScheduledRestart();
+
+    // Wi-Fi -> web server -> first NTP sync, after control is already up
+    updateBootSequencer();
     
-    // Update water sensors every loop
-    updateWaterSensors();
-    waterAlgorithm.update();
-    checkWaterSensors();
-    checkSystemAutoEnable();
-    checkPumpAutoEnable();
+    // Sensors, algorithm and pump run in the algorithm task;
+    // without it (ALGORITHM_EVENT_DRIVEN = false) every loop pass
+    if (!isAlgorithmTaskRunning()) {
+        runControlStep();
+    }
+
+    // DS3231 resync every CLOCK_RESYNC_INTERVAL_MS - the only I2C time reads
+    updateClock();
+
+    // Hand queued VPS records to the uplink task (never blocks on network)
+    updateVPSLogger();
 
     // Update other systems every 100ms
     if (now - lastUpdate >= 100) {
-        updatePumpController();
         updateSessionManager();
         updateRateLimiter();
         updateWiFi();
         
-        // Check for auto pump trigger
-        if (currentPumpSettings.autoModeEnabled && 
-            !isSystemDisabled() && shouldActivatePump() && !isPumpActive()) {
-            Serial.println("Auto pump triggered - water level low");
-            triggerPump(currentPumpSettings.manualCycleSeconds, "AUTO_PUMP");
-        }
-        
         lastUpdate = now;
     }
 
     static unsigned long lastBlink = 0;
     unsigned long blinkInterval = (isWiFiConnected() && isRTCWorking()) ? 2000 : 500;
+
+    recordLoopDuration(micros() - loopStartUs);
     
     delay(100);
 #endif
@@ -1,14 +1,17 @@
-
-
 #include "vps_logger.h"
+#include "vps_outbox.h"
 #include "../config/config.h"
 #include "../hardware/water_sensors.h"
+#include "../hardware/hardware_pins.h"
 #include "../network/wifi_manager.h"
 #include "../core/logging.h"
 #include "../hardware/rtc_controller.h"
-#include "../hardware/fram_controller.h" 
+#include "../hardware/fram_controller.h"
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
 #include "../algorithm/algorithm_config.h"
 #include "../algorithm/water_algorithm.h"
 
@@ -16,148 +19,442 @@
     #include "../config/credentials_manager.h"
 #endif
 
-extern WaterAlgorithm waterAlgorithm;
+// ===============================
+// UPLINK TASK HANDOFF
+// ===============================
+// Main loop: peeks up to VPS_BATCH_MAX_RECORDS from the outbox (I2C)
+//            and hands them to the task as one batch.
+// Uplink task: builds one JSON array and POSTs it over a keep-alive
+//            connection (network only).
+// Main loop: pops the whole batch once the task reports HTTP 200.
 
-void initVPSLogger() {
+struct VPSUplinkRequest {
+    uint32_t seq;       // Outbox sequence number of records[0]
+    uint8_t count;
+    VPSOutboxRecord records[VPS_BATCH_MAX_RECORDS];
+};
+
+struct VPSSendResult {
+    uint32_t seq;
+    uint8_t count;
+    bool binary;
+    int httpCode;
+    uint32_t latencyMs;
+    uint16_t payloadBytes;
+    uint32_t serializeUs;
+};
+
+static QueueHandle_t uplinkRequestQueue = nullptr;
+static QueueHandle_t uplinkResultQueue = nullptr;
+static TaskHandle_t uplinkTaskHandle = nullptr;
+
+static bool uplinkInFlight = false;
+static bool retryPending = false;
+static unsigned long lastFailureTime = 0;
+static unsigned long retryDelayMs = 0;
+static unsigned long retryBackoffMs = VPS_RETRY_MIN_MS;
+static unsigned long pendingSince = 0;   // When the outbox last went non-empty (linger)
+static bool isolateHead = false;         // Last batch was refused - send the oldest record alone
+static VPSUplinkRequest pendingRequest;  // Too big for the loop stack
+
+// Uplink task only
+static HTTPClient uplinkHttp;
+static String authHeader;
+static uint8_t payloadBuffer[VPS_PAYLOAD_BUFFER_SIZE];
+static bool binaryPayloadEnabled = VPS_BINARY_PAYLOAD;  // Cleared if the VPS answers 415
+
+static VPSUplinkMetrics uplinkMetrics = {};
+static uint64_t latencySumMs = 0;
+static uint32_t ackedRequests = 0;
+
+static const char* vpsEndpoint() {
 #if MODE_PRODUCTION
-    LOG_INFO("VPS Logger initialized - endpoint: %s", getVPSURL());  // 🆕 Dynamic URL
-    LOG_INFO("Using %s credentials", areCredentialsLoaded() ? "FRAM" : "fallback");
+    return getVPSURL();
 #else
-    LOG_INFO("VPS Logger initialized - endpoint: %s", VPS_URL);
-    LOG_INFO("Using hardcoded credentials (programming mode)");
+    return VPS_URL;
 #endif
 }
 
-bool logEventToVPS(const String& eventType, uint16_t volumeML, uint32_t unixTime) {
-    if (!pumpGlobalEnabled) {
-        return false;
+static const char* vpsAuthToken() {
+#if MODE_PRODUCTION
+    return getVPSAuthToken();
+#else
+    return VPS_AUTH_TOKEN;
+#endif
+}
+
+static const char* vpsDeviceID() {
+#if MODE_PRODUCTION
+    return getDeviceID();
+#else
+    return DEVICE_ID;
+#endif
+}
+
+static const char* vpsCredentialsSource() {
+#if MODE_PRODUCTION
+    return areCredentialsLoaded() ? "FRAM" : "FALLBACK";
+#else
+    return "HARDCODED";
+#endif
+}
+
+// ===============================
+// PAYLOAD BUILDERS (uplink task)
+// ===============================
+
+static void buildEventPayload(const VPSOutboxRecord& record, JsonObject payload) {
+    payload["device_id"] = vpsDeviceID();
+    payload["unix_time"] = record.unix_time;
+    payload["event_type"] = record.event_type;
+    payload["volume_ml"] = record.volume_ml;
+    payload["water_status"] = record.water_status;
+    payload["system_status"] = "OK";
+    if (WATER_CHANNEL_COUNT > 1) {
+        payload["channel"] = record.channel;
+    }
+
+    if (record.flags & OUTBOX_FLAG_TIME_UNCERTAIN) {
+        payload["time_uncertain"] = true;
+    }
+
+    if (record.flags & OUTBOX_FLAG_DAILY_VOLUME) {
+        payload["daily_volume_ml"] = record.daily_volume_ml;
+    }
+}
+
+static void buildCyclePayload(const VPSOutboxRecord& record, JsonObject payload) {
+    payload["device_id"] = vpsDeviceID();
+    payload["unix_time"] = record.unix_time;
+    payload["event_type"] = "AUTO_CYCLE_COMPLETE";
+    payload["volume_ml"] = record.volume_ml;
+    payload["water_status"] = record.water_status;
+    payload["system_status"] = (record.error_code == 0) ? "OK" : "ERROR";
+    if (WATER_CHANNEL_COUNT > 1) {
+        payload["channel"] = record.channel;
+    }
+
+    if (record.flags & OUTBOX_FLAG_TIME_UNCERTAIN) {
+        payload["time_uncertain"] = true;
+    }
+
+    payload["time_gap_1"] = record.time_gap_1;
+    payload["time_gap_2"] = record.time_gap_2;
+    payload["water_trigger_time"] = record.water_trigger_time;
+    payload["pump_duration"] = record.pump_duration;
+    payload["pump_attempts"] = record.pump_attempts;
+
+    payload["gap1_fail_sum"] = record.gap1_fail_sum;
+    payload["gap2_fail_sum"] = record.gap2_fail_sum;
+    payload["water_fail_sum"] = record.water_fail_sum;
+    payload["last_reset_timestamp"] = record.last_reset_timestamp;
+
+    payload["daily_volume_ml"] = record.daily_volume_ml;
+
+    payload["vps_endpoint"] = vpsEndpoint();
+    payload["credentials_source"] = vpsCredentialsSource();
+
+    // Single snprintf instead of String concatenation (no heap reallocations).
+    // Thresholds were captured with the cycle - the params may have changed since.
+    char algorithmSummary[112];
+    snprintf(algorithmSummary, sizeof(algorithmSummary),
+             "THRESHOLDS(GAP1:%ds,GAP2:%ds,WATER:%ds) CURRENT(%d-%d-%d) SUMS(%u-%u-%u)",
+             (int)record.thresholds.gap1, (int)record.thresholds.gap2, (int)record.thresholds.water,
+             (record.sensor_results & PumpCycle::RESULT_GAP1_FAIL) ? 1 : 0,
+             (record.sensor_results & PumpCycle::RESULT_GAP2_FAIL) ? 1 : 0,
+             (record.sensor_results & PumpCycle::RESULT_WATER_FAIL) ? 1 : 0,
+             record.gap1_fail_sum, record.gap2_fail_sum, record.water_fail_sum);
+    payload["algorithm_data"] = algorithmSummary;
+}
+
+// postBatch() result when the batch does not fit VPS_PAYLOAD_BUFFER_SIZE
+#define VPS_PAYLOAD_OVERFLOW    -100
+
+// Retrying the same records cannot help - the VPS refused them (4xx other
+// than timeout / rate limit / the MessagePack fallback) or they cannot be
+// serialized. 401 / 403 / 404 are the device's token or URL, not the
+// records - those back off like a network error instead of draining the outbox.
+static bool isPermanentFailure(int httpCode) {
+    if (httpCode == VPS_PAYLOAD_OVERFLOW) return true;
+    if (httpCode < 400 || httpCode >= 500) return false;
+    return httpCode != 408 && httpCode != 429 && httpCode != 415 &&
+           httpCode != 401 && httpCode != 403 && httpCode != 404;
+}
+
+static uint16_t requestTimeoutMs(const VPSOutboxRecord& record) {
+    if (record.kind == OUTBOX_KIND_CYCLE) {
+        return 10000;
     }
+    if (strcmp(record.event_type, "STATISTICS_RESET") == 0) {
+        return 3000;
+    }
+    return 5000;
+}
+
+static int postBatch(const VPSUplinkRequest& request, VPSSendResult& result) {
+    result.binary = binaryPayloadEnabled;
+    result.payloadBytes = 0;
+    result.serializeUs = 0;
 
     if (!isWiFiConnected()) {
-        LOG_WARNING("WiFi not connected, cannot log to VPS");
-        return false;
+        return -1;
     }
-    
-    uint16_t timeoutMs;
-    bool isCritical;
-    
-    if (eventType == "STATISTICS_RESET") {
-        timeoutMs = 3000;
-        isCritical = false;
-    } else if (eventType == "AUTO_CYCLE_COMPLETE") {
-        timeoutMs = 8000;
-        isCritical = true;
+
+    unsigned long serializeStart = micros();
+
+    // Single array - one element per record, same fields as before
+    JsonDocument payload;
+    JsonArray records = payload.to<JsonArray>();
+    uint16_t timeoutMs = 0;
+
+    for (uint8_t i = 0; i < request.count; i++) {
+        const VPSOutboxRecord& record = request.records[i];
+        JsonObject item = records.add<JsonObject>();
+        if (record.kind == OUTBOX_KIND_CYCLE) {
+            buildCyclePayload(record, item);
+        } else {
+            buildEventPayload(record, item);
+        }
+
+        uint16_t recordTimeout = requestTimeoutMs(record);
+        if (recordTimeout > timeoutMs) timeoutMs = recordTimeout;
+    }
+
+    // Serialize straight into the preallocated buffer (no String)
+    size_t length;
+    if (result.binary) {
+        length = serializeMsgPack(payload, payloadBuffer, sizeof(payloadBuffer));
     } else {
-        timeoutMs = 5000;
-        isCritical = true;
+        length = serializeJson(payload, (char*)payloadBuffer, sizeof(payloadBuffer));
+    }
+    result.serializeUs = micros() - serializeStart;
+
+    // Both serializers truncate silently - a full buffer means the batch did not fit
+    if (length == 0 || length >= sizeof(payloadBuffer) - 1) {
+        LOG_ERROR("VPS payload exceeds %d bytes (%d records)", sizeof(payloadBuffer), request.count);
+        return VPS_PAYLOAD_OVERFLOW;
+    }
+    result.payloadBytes = length;
+
+    // begin()/end() keep the socket open when reuse is enabled and the host is unchanged
+    uplinkHttp.begin(vpsEndpoint());
+    uplinkHttp.addHeader("Authorization", authHeader);
+    uplinkHttp.addHeader("Content-Type", result.binary ? "application/msgpack" : "application/json");
+    uplinkHttp.setTimeout(timeoutMs);
+
+    LOG_INFO("Sending to VPS (%d records, %d bytes %s, %luus)", request.count, length,
+             result.binary ? "msgpack" : "json", result.serializeUs);
+
+    int httpCode = uplinkHttp.POST(payloadBuffer, length);
+    uplinkHttp.end();
+
+    if (httpCode == 415 && result.binary) {
+        // VPS does not understand MessagePack - stay on JSON from now on
+        LOG_WARNING("VPS rejected application/msgpack - falling back to JSON");
+        binaryPayloadEnabled = false;
+    }
+
+    return httpCode;
+}
+
+static void vpsUplinkTask(void* param) {
+    static VPSUplinkRequest request;
+
+    uplinkHttp.setReuse(true);
+
+    for (;;) {
+        if (xQueueReceive(uplinkRequestQueue, &request, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        VPSSendResult result;
+        result.seq = request.seq;
+        result.count = request.count;
+
+        unsigned long startTime = millis();
+        result.httpCode = postBatch(request, result);
+        result.latencyMs = millis() - startTime;
+
+        xQueueSend(uplinkResultQueue, &result, portMAX_DELAY);
     }
-    
-    HTTPClient http;
-    
+}
+
+// ===============================
+// PUBLIC API
+// ===============================
+
+void initVPSLogger() {
+    LOG_INFO("VPS Logger initialized - endpoint: %s", vpsEndpoint());
 #if MODE_PRODUCTION
-    const char* vpsUrl = getVPSURL();
-    http.begin(vpsUrl);
-    
-    String authHeader = "Bearer " + String(getVPSAuthToken());
-    http.addHeader("Authorization", authHeader);
-    
-    JsonDocument payload;
-    payload["device_id"] = getDeviceID();
-    
-    LOG_INFO("Using dynamic VPS URL: %s (timeout: %dms)", vpsUrl, timeoutMs);
+    LOG_INFO("Using %s credentials", areCredentialsLoaded() ? "FRAM" : "fallback");
 #else
-    http.begin(VPS_URL);
-    
-    String authHeader = "Bearer " + String(VPS_AUTH_TOKEN);
-    http.addHeader("Authorization", authHeader);
-    
-    JsonDocument payload;
-    payload["device_id"] = DEVICE_ID;
+    LOG_INFO("Using hardcoded credentials (programming mode)");
 #endif
-    
-    http.addHeader("Content-Type", "application/json");
-    http.setTimeout(timeoutMs);
-    
-    payload["unix_time"] = unixTime;  // ← ZMIANA: tylko unix_time
-    payload["event_type"] = eventType;
-    payload["volume_ml"] = volumeML;
-    payload["water_status"] = getWaterStatus();
-    payload["system_status"] = "OK";
 
-    if (rtcNeedsSynchronization()) {
-        payload["time_uncertain"] = true;  // ← NOWE: optional flag
+    if (!initVPSOutbox()) {
+        LOG_ERROR("VPS outbox unavailable - VPS logging disabled");
+        return;
     }
 
-    if (eventType == "MANUAL_NORMAL") {
-        payload["daily_volume_ml"] = waterAlgorithm.getDailyVolume();
-        LOG_INFO("Including daily_volume_ml in VPS payload: %dml", 
-                 waterAlgorithm.getDailyVolume());
-    }
-    
-    String jsonString;
-    serializeJson(payload, jsonString);
-    
-    LOG_INFO("Sending to VPS (%s priority): %s", 
-             isCritical ? "HIGH" : "LOW", 
-             jsonString.c_str());
-    
-    unsigned long startTime = millis();
-    int httpCode = http.POST(jsonString);
-    unsigned long duration = millis() - startTime;
-    
-    if (httpCode == 200) {
-        LOG_INFO("✅ VPS log successful: %s (%lums)", eventType.c_str(), duration);
-        http.end();
-        return true;
-    } else {
-        if (isCritical) {
-            LOG_ERROR("❌ VPS log failed: %s HTTP %d (%lums)", eventType.c_str(), httpCode, duration);
+    // Built once - the token does not change at runtime
+    authHeader = "Bearer " + String(vpsAuthToken());
+
+    uplinkRequestQueue = xQueueCreate(1, sizeof(VPSUplinkRequest));
+    uplinkResultQueue = xQueueCreate(1, sizeof(VPSSendResult));
+
+    if (uplinkRequestQueue == nullptr || uplinkResultQueue == nullptr ||
+        xTaskCreate(vpsUplinkTask, "vps_uplink", VPS_UPLINK_TASK_STACK,
+                    nullptr, 1, &uplinkTaskHandle) != pdPASS) {
+        LOG_ERROR("Failed to start VPS uplink task");
+        uplinkTaskHandle = nullptr;
+        return;
+    }
+
+    LOG_INFO("VPS uplink task started (%d records pending)", getVPSOutboxDepth());
+}
+
+void updateVPSLogger() {
+    if (uplinkTaskHandle == nullptr) {
+        return;
+    }
+
+    VPSSendResult result;
+    if (xQueueReceive(uplinkResultQueue, &result, 0) == pdTRUE) {
+        uplinkInFlight = false;
+        uplinkMetrics.requestCount++;
+        uplinkMetrics.lastBatchSize = result.count;
+        uplinkMetrics.lastHttpCode = result.httpCode;
+        uplinkMetrics.binaryPayload = result.binary;
+        uplinkMetrics.lastPayloadBytes = result.payloadBytes;
+        uplinkMetrics.lastSerializeUs = result.serializeUs;
+        uplinkMetrics.lastLatencyMs = result.latencyMs;
+        if (result.latencyMs > uplinkMetrics.maxLatencyMs) {
+            uplinkMetrics.maxLatencyMs = result.latencyMs;
+        }
+
+        if (result.httpCode == 200) {
+            popVPSOutbox(result.seq, result.count);
+            uplinkMetrics.sentCount += result.count;
+            ackedRequests++;
+            latencySumMs += result.latencyMs;
+            uplinkMetrics.avgLatencyMs = latencySumMs / ackedRequests;
+            retryPending = false;
+            retryBackoffMs = VPS_RETRY_MIN_MS;
+            isolateHead = false;
+            LOG_INFO("✅ VPS log successful (%d records, %lums, %d pending)",
+                     result.count, result.latencyMs, getVPSOutboxDepth());
+        } else if (isPermanentFailure(result.httpCode)) {
+            // One bad record must not hold up the outbox until the ring
+            // overwrites newer data: retry the oldest alone, drop it if it
+            // still fails
+            uplinkMetrics.failedCount++;
+            retryPending = false;
+            if (result.count > 1) {
+                isolateHead = true;
+                LOG_WARNING("⚠️ VPS refused a batch of %d: HTTP %d - retrying the oldest record alone",
+                            result.count, result.httpCode);
+            } else {
+                dropVPSOutboxHead(result.seq);
+                uplinkMetrics.rejectedCount++;
+                isolateHead = false;
+                LOG_ERROR("❌ VPS refused record %lu: HTTP %d - dropped",
+                          (unsigned long)result.seq, result.httpCode);
+            }
         } else {
-            LOG_WARNING("⚠️ VPS log failed (non-critical): %s HTTP %d (%lums)", eventType.c_str(), httpCode, duration);
+            uplinkMetrics.failedCount++;
+            retryPending = true;
+            lastFailureTime = millis();
+            retryDelayMs = retryBackoffMs;
+            retryBackoffMs = (retryBackoffMs * 2 > VPS_RETRY_MAX_MS) ? VPS_RETRY_MAX_MS : retryBackoffMs * 2;
+            LOG_WARNING("⚠️ VPS log failed: HTTP %d (%lums), retry in %lus",
+                        result.httpCode, result.latencyMs, retryDelayMs / 1000);
         }
-        
-        http.end();
-        return false;
+    }
+
+    uint16_t depth = getVPSOutboxDepth();
+    if (depth == 0) {
+        pendingSince = 0;
+        return;
+    }
+
+    unsigned long now = millis();
+    if (pendingSince == 0) {
+        pendingSince = now ? now : 1;
+    }
+
+    if (uplinkInFlight || !isWiFiConnected()) {
+        return;
+    }
+
+    if (retryPending && now - lastFailureTime < retryDelayMs) {
+        return;
+    }
+
+    // Linger for a full batch unless records have waited long enough
+    if (depth < VPS_BATCH_MAX_RECORDS && !retryPending && !isolateHead &&
+        now - pendingSince < VPS_BATCH_LINGER_MS) {
+        return;
+    }
+
+    uint8_t count = (depth < VPS_BATCH_MAX_RECORDS) ? depth : VPS_BATCH_MAX_RECORDS;
+    if (isolateHead) count = 1;
+    pendingRequest.count = peekVPSOutboxBatch(pendingRequest.records, count, pendingRequest.seq);
+
+    if (pendingRequest.count == 0) {
+        return;
+    }
+
+    if (xQueueSend(uplinkRequestQueue, &pendingRequest, 0) == pdTRUE) {
+        uplinkInFlight = true;
+    }
+}
+
+static void fillRecordHeader(VPSOutboxRecord& record, uint8_t kind, uint32_t unixTime, uint8_t channel) {
+    if (channel >= WATER_CHANNEL_COUNT) channel = 0;
+
+    memset(&record, 0, sizeof(record));
+    record.kind = kind;
+    record.channel = channel;
+    record.unix_time = unixTime;
+    record.daily_volume_ml = waterChannels[channel].getDailyVolume();
+    snprintf(record.water_status, sizeof(record.water_status), "%s", getWaterStatus(channel).c_str());
+
+    if (rtcNeedsSynchronization()) {
+        record.flags |= OUTBOX_FLAG_TIME_UNCERTAIN;
     }
 }
 
-bool logCycleToVPS(const PumpCycle& cycle, uint32_t unixTime) {
+bool logEventToVPS(const String& eventType, uint16_t volumeML, uint32_t unixTime, uint8_t channel) {
     if (!pumpGlobalEnabled) {
         return false;
     }
 
-    if (!isWiFiConnected()) {
-        LOG_WARNING("WiFi not connected, cannot log cycle to VPS");
+    VPSOutboxRecord record;
+    fillRecordHeader(record, OUTBOX_KIND_EVENT, unixTime, channel);
+    record.volume_ml = volumeML;
+    snprintf(record.event_type, sizeof(record.event_type), "%s", eventType.c_str());
+
+    if (eventType == "MANUAL_NORMAL") {
+        record.flags |= OUTBOX_FLAG_DAILY_VOLUME;
+    }
+
+    if (!pushVPSOutbox(record)) {
+        LOG_ERROR("❌ Failed to queue VPS event: %s", eventType.c_str());
         return false;
     }
-    
-    HTTPClient http;
-    
-#if MODE_PRODUCTION
-    const char* vpsUrl = getVPSURL();
-    http.begin(vpsUrl);
-    
-    String authHeader = "Bearer " + String(getVPSAuthToken());
-    http.addHeader("Authorization", authHeader);
-    
-    JsonDocument payload;
-    payload["device_id"] = getDeviceID();
-#else
-    http.begin(VPS_URL);
-    
-    String authHeader = "Bearer " + String(VPS_AUTH_TOKEN);
-    http.addHeader("Authorization", authHeader);
-    
-    JsonDocument payload;
-    payload["device_id"] = DEVICE_ID;
-#endif
-    
-    http.addHeader("Content-Type", "application/json");
-    http.setTimeout(10000);
-    
+
+    LOG_INFO("VPS event queued: %s (%d pending)", eventType.c_str(), getVPSOutboxDepth());
+    return true;
+}
+
+bool logCycleToVPS(const PumpCycle& cycle, uint32_t unixTime, uint8_t channel) {
+    if (!pumpGlobalEnabled) {
+        return false;
+    }
+
     ErrorStats currentStats;
-    bool statsLoaded = loadErrorStatsFromFRAM(currentStats);
-    
+    bool statsLoaded = loadErrorStatsFromFRAM(currentStats, channel);
+
     if (!statsLoaded) {
         LOG_WARNING("Failed to load error stats from FRAM, using zeros");
         currentStats.gap1_fail_sum = 0;
@@ -165,66 +462,44 @@ bool logCycleToVPS(const PumpCycle& cycle, uint32_t unixTime) {
         currentStats.water_fail_sum = 0;
         currentStats.last_reset_timestamp = millis() / 1000;
     }
-    
-    payload["unix_time"] = unixTime;  // ← ZMIANA: tylko unix_time
-    payload["event_type"] = "AUTO_CYCLE_COMPLETE";
-    payload["volume_ml"] = cycle.volume_dose;
-    payload["water_status"] = getWaterStatus();
-    payload["system_status"] = (cycle.error_code == 0) ? "OK" : "ERROR";
-    
-    if (rtcNeedsSynchronization()) {
-        payload["time_uncertain"] = true;  // ← NOWE
-    }
-    
-    payload["time_gap_1"] = cycle.time_gap_1;
-    payload["time_gap_2"] = cycle.time_gap_2;
-    payload["water_trigger_time"] = cycle.water_trigger_time;
-    payload["pump_duration"] = cycle.pump_duration;
-    payload["pump_attempts"] = cycle.pump_attempts;
-    
-    payload["gap1_fail_sum"] = currentStats.gap1_fail_sum;
-    payload["gap2_fail_sum"] = currentStats.gap2_fail_sum;
-    payload["water_fail_sum"] = currentStats.water_fail_sum;
-    payload["last_reset_timestamp"] = currentStats.last_reset_timestamp;
-
-    payload["daily_volume_ml"] = waterAlgorithm.getDailyVolume();
-    
-#if MODE_PRODUCTION
-    payload["vps_endpoint"] = getVPSURL();
-    payload["credentials_source"] = areCredentialsLoaded() ? "FRAM" : "FALLBACK";
-#else
-    payload["vps_endpoint"] = VPS_URL;
-    payload["credentials_source"] = "HARDCODED";
-#endif
-    
-    String algorithmSummary = "";
-    algorithmSummary += "THRESHOLDS(GAP1:" + String(THRESHOLD_1) + "s,";
-    algorithmSummary += "GAP2:" + String(THRESHOLD_2) + "s,";
-    algorithmSummary += "WATER:" + String(THRESHOLD_WATER) + "s) ";
-    algorithmSummary += "CURRENT(" + String((cycle.sensor_results & PumpCycle::RESULT_GAP1_FAIL) ? 1 : 0) + "-";
-    algorithmSummary += String((cycle.sensor_results & PumpCycle::RESULT_GAP2_FAIL) ? 1 : 0) + "-";
-    algorithmSummary += String((cycle.sensor_results & PumpCycle::RESULT_WATER_FAIL) ? 1 : 0) + ") ";
-    algorithmSummary += "SUMS(" + String(currentStats.gap1_fail_sum) + "-";
-    algorithmSummary += String(currentStats.gap2_fail_sum) + "-";
-    algorithmSummary += String(currentStats.water_fail_sum) + ")";
-    payload["algorithm_data"] = algorithmSummary;
-    
-    String jsonString;
-    serializeJson(payload, jsonString);
-    
-    LOG_INFO("JSON size: %d bytes", jsonString.length());
-    LOG_INFO("Sending cycle to VPS (unix time: %lu)", (unsigned long)unixTime);
-    
-    int httpCode = http.POST(jsonString);
-    
-    if (httpCode == 200) {
-        LOG_INFO("VPS cycle log successful");
-        http.end();
-        return true;
-    } else {
-        LOG_ERROR("VPS cycle log failed: HTTP %d", httpCode);
-        http.end();
+
+    VPSOutboxRecord record;
+    fillRecordHeader(record, OUTBOX_KIND_CYCLE, unixTime, channel);
+    record.volume_ml = cycle.volume_dose;
+    record.time_gap_1 = cycle.time_gap_1;
+    record.time_gap_2 = cycle.time_gap_2;
+    record.water_trigger_time = cycle.water_trigger_time;
+    record.pump_duration = cycle.pump_duration;
+    record.pump_attempts = cycle.pump_attempts;
+    record.sensor_results = cycle.sensor_results;
+    record.error_code = cycle.error_code;
+    record.gap1_fail_sum = currentStats.gap1_fail_sum;
+    record.gap2_fail_sum = currentStats.gap2_fail_sum;
+    record.water_fail_sum = currentStats.water_fail_sum;
+    record.last_reset_timestamp = currentStats.last_reset_timestamp;
+
+    // The thresholds this cycle was judged with (control task - params are
+    // only swapped between cycles)
+    const AlgorithmParams& params = waterChannels[record.channel].getParams();
+    record.thresholds.gap1 = params.threshold1;
+    record.thresholds.gap2 = params.threshold2;
+    record.thresholds.water = params.thresholdWater;
+
+    if (!pushVPSOutbox(record)) {
+        LOG_ERROR("❌ Failed to queue VPS cycle log");
         return false;
     }
+
+    LOG_INFO("VPS cycle queued (unix time: %lu, %d pending)",
+             (unsigned long)unixTime, getVPSOutboxDepth());
+    return true;
 }
 
+VPSUplinkMetrics getVPSUplinkMetrics() {
+    VPSUplinkMetrics metrics = uplinkMetrics;
+    metrics.queueDepth = getVPSOutboxDepth();
+    metrics.queueCapacity = getVPSOutboxCapacity();
+    metrics.dropped = getVPSOutboxDropped();
+    metrics.inFlight = uplinkInFlight;
+    return metrics;
+}
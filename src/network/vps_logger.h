@@ -1,4 +1,3 @@
-
 #ifndef VPS_LOGGER_H
 #define VPS_LOGGER_H
 
@@ -7,8 +6,35 @@
 struct PumpCycle;
 class WaterAlgorithm;
 
+struct VPSUplinkMetrics {
+    uint16_t queueDepth;      // Records waiting in the FRAM outbox
+    uint16_t queueCapacity;
+    uint32_t dropped;         // Records overwritten while the outbox was full
+    uint32_t sentCount;       // Records acknowledged by the VPS
+    uint32_t failedCount;     // Failed POST requests
+    uint32_t rejectedCount;   // Records dropped: refused by the VPS on their own, or too big to send
+    uint32_t requestCount;    // POST requests (one batch each)
+    uint8_t  lastBatchSize;
+    int      lastHttpCode;
+    uint32_t lastLatencyMs;   // Duration of the last batch POST (uplink task)
+    uint32_t maxLatencyMs;
+    uint32_t avgLatencyMs;
+    bool     binaryPayload;   // Last batch sent as MessagePack (false = JSON)
+    uint16_t lastPayloadBytes;
+    uint32_t lastSerializeUs; // Payload build + serialization time (uplink task)
+    bool     inFlight;
+};
+
 void initVPSLogger();
-bool logEventToVPS(const String& eventType, uint16_t volumeML, uint32_t unixTime);
-bool logCycleToVPS(const PumpCycle& cycle, uint32_t unixTime);
 
-#endif
\ No newline at end of file
+// Called every loop() pass - hands batches of queued records to the uplink task
+void updateVPSLogger();
+
+// O(1) enqueue into the FRAM outbox - never blocks on the network.
+// channel = water channel the event belongs to (hardware_pins.h)
+bool logEventToVPS(const String& eventType, uint16_t volumeML, uint32_t unixTime, uint8_t channel = 0);
+bool logCycleToVPS(const PumpCycle& cycle, uint32_t unixTime, uint8_t channel = 0);
+
+VPSUplinkMetrics getVPSUplinkMetrics();
+
+#endif
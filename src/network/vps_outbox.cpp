@@ -0,0 +1,220 @@
+#include "vps_outbox.h"
+#include "../core/logging.h"
+#include "../crypto/crc.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define OUTBOX_MAGIC        0x4F43  // "OC" - header and records carry a CRC16
+#define OUTBOX_MAGIC_LEGACY 0x4F42  // "OB" - no CRCs (12-byte header)
+
+struct OutboxHeader {
+    uint16_t magic;
+    uint16_t head;      // next slot to write
+    uint16_t count;     // pending records
+    uint16_t dropped;   // records overwritten while full (saturating)
+    uint32_t tail_seq;  // sequence number of the oldest pending record
+    uint16_t crc;       // CRC16 of the fields above
+    uint16_t reserved;
+};
+
+static OutboxHeader header;
+static bool outboxReady = false;
+static SemaphoreHandle_t outboxMutex = nullptr;
+
+static uint16_t slotAddress(uint16_t slot) {
+    return FRAM_ADDR_OUTBOX_DATA + slot * FRAM_OUTBOX_SLOT_SIZE;
+}
+
+static uint16_t tailSlot() {
+    return (header.head + FRAM_OUTBOX_SLOTS - header.count) % FRAM_OUTBOX_SLOTS;
+}
+
+static uint16_t headerCRC() {
+    return crc16((const uint8_t*)&header, offsetof(OutboxHeader, crc));
+}
+
+static uint16_t recordCRC(const VPSOutboxRecord& record) {
+    VPSOutboxRecord copy = record;
+    copy.crc = 0;
+    return crc16((const uint8_t*)&copy, sizeof(copy));
+}
+
+static bool writeHeader() {
+    header.crc = headerCRC();
+    header.reserved = 0;
+    return writeFRAMBlock(FRAM_ADDR_OUTBOX_HEADER, (const uint8_t*)&header, sizeof(header));
+}
+
+static bool headerInRange() {
+    return header.head < FRAM_OUTBOX_SLOTS && header.count <= FRAM_OUTBOX_SLOTS;
+}
+
+// Pending records written before the CRC layout get sealed once
+static void migrateLegacyOutbox() {
+    uint16_t slot = tailSlot();
+    for (uint16_t i = 0; i < header.count; i++) {
+        VPSOutboxRecord record;
+        if (readFRAMBlock(slotAddress(slot), (uint8_t*)&record, sizeof(record))) {
+            record.crc = recordCRC(record);
+            writeFRAMBlock(slotAddress(slot), (const uint8_t*)&record, sizeof(record));
+        }
+        slot = (slot + 1) % FRAM_OUTBOX_SLOTS;
+    }
+    header.magic = OUTBOX_MAGIC;
+    writeHeader();
+    LOG_INFO("VPS outbox upgraded to CRC records (%d pending)", header.count);
+}
+
+static void resetHeader() {
+    header.magic = OUTBOX_MAGIC;
+    header.head = 0;
+    header.count = 0;
+    header.dropped = 0;
+    header.tail_seq = 0;
+}
+
+bool initVPSOutbox() {
+    if (outboxMutex == nullptr) {
+        outboxMutex = xSemaphoreCreateMutex();
+    }
+
+    if (!readFRAMBlock(FRAM_ADDR_OUTBOX_HEADER, (uint8_t*)&header, sizeof(header))) {
+        LOG_ERROR("VPS outbox: FRAM not available");
+        outboxReady = false;
+        return false;
+    }
+
+    if (header.magic == OUTBOX_MAGIC_LEGACY && headerInRange()) {
+        migrateLegacyOutbox();
+    } else if (header.magic != OUTBOX_MAGIC || !headerInRange() || header.crc != headerCRC()) {
+        LOG_WARNING("VPS outbox header invalid - starting empty");
+        resetHeader();
+        writeHeader();
+    }
+
+    outboxReady = true;
+    LOG_INFO("VPS outbox ready: %d/%d pending (dropped: %d)",
+             header.count, FRAM_OUTBOX_SLOTS, header.dropped);
+    return true;
+}
+
+bool pushVPSOutbox(const VPSOutboxRecord& record) {
+    if (!outboxReady) return false;
+
+    VPSOutboxRecord sealed = record;
+    sealed.crc = recordCRC(sealed);
+
+    xSemaphoreTake(outboxMutex, portMAX_DELAY);
+
+    if (!writeFRAMBlock(slotAddress(header.head), (const uint8_t*)&sealed, sizeof(sealed))) {
+        xSemaphoreGive(outboxMutex);
+        LOG_ERROR("VPS outbox: slot write failed");
+        return false;
+    }
+
+    header.head = (header.head + 1) % FRAM_OUTBOX_SLOTS;
+    if (header.count < FRAM_OUTBOX_SLOTS) {
+        header.count++;
+    } else {
+        // Full - oldest record was just overwritten
+        header.tail_seq++;
+        if (header.dropped < 0xFFFF) header.dropped++;
+    }
+
+    bool ok = writeHeader();
+    xSemaphoreGive(outboxMutex);
+    return ok;
+}
+
+// Caller holds outboxMutex
+static bool peekLocked(uint16_t offset, VPSOutboxRecord& record) {
+    bool ok = false;
+    while (offset < header.count) {
+        uint16_t slot = (tailSlot() + offset) % FRAM_OUTBOX_SLOTS;
+        if (!readFRAMBlock(slotAddress(slot), (uint8_t*)&record, sizeof(record))) break;
+
+        if (record.crc == recordCRC(record)) {
+            ok = true;
+            break;
+        }
+
+        LOG_WARNING("VPS outbox record %lu failed CRC", (unsigned long)(header.tail_seq + offset));
+        if (offset != 0) break;
+
+        // Corrupt oldest record would block the queue forever - drop it
+        header.count--;
+        header.tail_seq++;
+        if (header.dropped < 0xFFFF) header.dropped++;
+        writeHeader();
+    }
+    return ok;
+}
+
+uint16_t peekVPSOutboxBatch(VPSOutboxRecord* records, uint16_t max, uint32_t& firstSeq) {
+    if (!outboxReady) return 0;
+
+    xSemaphoreTake(outboxMutex, portMAX_DELAY);
+    uint16_t count = 0;
+    while (count < max && peekLocked(count, records[count])) {
+        count++;
+    }
+    // After peeking - a corrupt head record may have been dropped
+    firstSeq = header.tail_seq;
+    xSemaphoreGive(outboxMutex);
+    return count;
+}
+
+bool popVPSOutbox(uint32_t firstSeq, uint16_t count) {
+    if (!outboxReady) return false;
+
+    xSemaphoreTake(outboxMutex, portMAX_DELAY);
+
+    // Part of the range may already have been overwritten while in flight
+    uint32_t endSeq = firstSeq + count;
+    uint16_t toPop = 0;
+    if ((int32_t)(endSeq - header.tail_seq) > 0) {
+        toPop = endSeq - header.tail_seq;
+        if (toPop > header.count) toPop = header.count;
+    }
+
+    bool ok = true;
+    if (toPop > 0) {
+        header.count -= toPop;
+        header.tail_seq += toPop;
+        ok = writeHeader();
+    }
+
+    xSemaphoreGive(outboxMutex);
+    return ok;
+}
+
+bool dropVPSOutboxHead(uint32_t seq) {
+    if (!outboxReady) return false;
+
+    xSemaphoreTake(outboxMutex, portMAX_DELAY);
+    bool ok = true;
+    if (header.count > 0 && header.tail_seq == seq) {
+        header.count--;
+        header.tail_seq++;
+        if (header.dropped < 0xFFFF) header.dropped++;
+        ok = writeHeader();
+    }
+    xSemaphoreGive(outboxMutex);
+    return ok;
+}
+
+uint16_t getVPSOutboxDepth() {
+    return header.count;
+}
+
+uint16_t getVPSOutboxCapacity() {
+    return FRAM_OUTBOX_SLOTS;
+}
+
+uint32_t getVPSOutboxTailSeq() {
+    return header.tail_seq;
+}
+
+uint32_t getVPSOutboxDropped() {
+    return header.dropped;
+}
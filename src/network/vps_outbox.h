@@ -0,0 +1,81 @@
+#ifndef VPS_OUTBOX_H
+#define VPS_OUTBOX_H
+
+#include <Arduino.h>
+#include "../hardware/fram_controller.h"
+
+// ===============================
+// VPS OUTBOX (FRAM-BACKED RING)
+// ===============================
+// Records waiting for the VPS uplink task. Producers (algorithm, pump
+// controller) only push; the uplink task never touches I2C - the main
+// loop peeks records for it and pops them once the POST succeeded.
+
+#define OUTBOX_KIND_EVENT   1
+#define OUTBOX_KIND_CYCLE   2
+
+#define OUTBOX_FLAG_TIME_UNCERTAIN  0x01  // RTC needed NTP sync at enqueue time
+#define OUTBOX_FLAG_DAILY_VOLUME    0x02  // Include daily_volume_ml in event payload
+
+#define OUTBOX_EVENT_TYPE_LEN   24
+#define OUTBOX_WATER_STATUS_LEN 12
+
+// Snapshot of everything the payload needs, captured at enqueue time
+struct VPSOutboxRecord {
+    uint8_t  kind;
+    uint8_t  flags;
+    uint16_t volume_ml;
+    uint32_t unix_time;
+    uint16_t daily_volume_ml;
+    uint16_t pump_duration;
+    uint32_t time_gap_1;
+    uint32_t time_gap_2;
+    uint32_t water_trigger_time;
+    uint8_t  pump_attempts;
+    uint8_t  sensor_results;
+    uint8_t  error_code;
+    uint8_t  channel;             // Water channel (was reserved, 0 in older records)
+    uint16_t gap1_fail_sum;
+    uint16_t gap2_fail_sum;
+    uint16_t water_fail_sum;
+    uint16_t crc;                 // CRC16 of the record with this field zeroed (set by push)
+    uint32_t last_reset_timestamp;
+    union {
+        char event_type[OUTBOX_EVENT_TYPE_LEN];     // OUTBOX_KIND_EVENT
+        struct {
+            uint16_t gap1;          // Thresholds that judged the cycle (s),
+            uint16_t gap2;          // 0 in cycles queued before they were
+            uint16_t water;         // recorded
+        } thresholds;                               // OUTBOX_KIND_CYCLE
+    };
+    char     water_status[OUTBOX_WATER_STATUS_LEN];
+};
+
+static_assert(sizeof(VPSOutboxRecord) <= FRAM_OUTBOX_SLOT_SIZE,
+              "VPSOutboxRecord does not fit in an outbox slot");
+
+bool initVPSOutbox();
+
+// O(1): one slot write + one header write. Overwrites the oldest record when full.
+bool pushVPSOutbox(const VPSOutboxRecord& record);
+
+// Up to `max` oldest pending records and the seq of the first one, read
+// under one lock so a concurrent push can't shift the ring in between.
+// A record failing its CRC at the tail is dropped (counted in
+// getVPSOutboxDropped); elsewhere the batch stops short of it.
+uint16_t peekVPSOutboxBatch(VPSOutboxRecord* records, uint16_t max, uint32_t& firstSeq);
+
+// Pop records [firstSeq, firstSeq + count) that are still queued.
+// Records already overwritten by pushVPSOutbox() are skipped.
+bool popVPSOutbox(uint32_t firstSeq, uint16_t count);
+
+// Drop the oldest record if it is still firstSeq (counted in
+// getVPSOutboxDropped) - for a record the VPS will never accept
+bool dropVPSOutboxHead(uint32_t seq);
+
+uint16_t getVPSOutboxDepth();
+uint16_t getVPSOutboxCapacity();
+uint32_t getVPSOutboxTailSeq();
+uint32_t getVPSOutboxDropped();
+
+#endif
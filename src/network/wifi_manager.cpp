@@ -30,34 +30,25 @@ void initWiFi() {
     LOG_INFO("Connecting to WiFi: %s (hardcoded - programming mode)", ssid);
 #endif
     
+    // Non-blocking - the boot sequencer (main.cpp) waits for the connection
+    // from loop(), updateWiFi() retries every RECONNECT_INTERVAL
     WiFi.begin(ssid, password);
-    
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        attempts++;
-        LOG_INFO("WiFi connection attempt %d/20", attempts);
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        LOG_INFO("WiFi connected - IP: %s", WiFi.localIP().toString().c_str());
-#if MODE_PRODUCTION
-        LOG_INFO("Using %s credentials", areCredentialsLoaded() ? "FRAM" : "fallback");
-#else
-        LOG_INFO("Using hardcoded credentials (programming mode)");
-#endif
-    } else {
-        LOG_ERROR("WiFi connection failed after 20 attempts");
-#if MODE_PRODUCTION
-        if (!areCredentialsLoaded()) {
-            LOG_ERROR("Consider programming correct credentials via FRAM programmer");
-        }
-#endif
-    }
+    lastReconnectAttempt = millis();
 }
 
 void updateWiFi() {
-    if (WiFi.status() != WL_CONNECTED) {
+    static bool wasConnected = false;
+    bool connected = (WiFi.status() == WL_CONNECTED);
+    if (connected != wasConnected) {
+        if (connected) {
+            LOG_INFO("WiFi connected - IP: %s", WiFi.localIP().toString().c_str());
+        } else {
+            LOG_WARNING("WiFi connection lost");
+        }
+        wasConnected = connected;
+    }
+
+    if (!connected) {
         unsigned long now = millis();
         if (now - lastReconnectAttempt > RECONNECT_INTERVAL) {
             LOG_WARNING("WiFi reconnecting...");
@@ -2,16 +2,17 @@
 #include "../config/config.h"
 #include "../security/auth_manager.h"
 #include "../core/logging.h"
+#include "../core/uptime.h"
 #include <map>
 #include <vector>
 
 static std::map<uint32_t, String> ipStringCache;
 
 struct RateLimitData {
-    std::vector<unsigned long> requestTimes;
+    std::vector<uint64_t> requestTimes;     // uptimeMs() - compared directly, no wrap
     int failedAttempts;
-    unsigned long blockUntil;
-    unsigned long lastRequest;
+    uint64_t blockUntil;
+    uint64_t lastRequest;
 };
 
 std::map<String, RateLimitData> rateLimitData;
@@ -22,10 +23,10 @@ void initRateLimiter() {
 }
 
 void updateRateLimiter() {
-    unsigned long now = millis();
+    uint64_t now = uptimeMs();
     
     // Clean old data every 5 minutes
-    static unsigned long lastCleanup = 0;
+    static uint64_t lastCleanup = 0;
     if (now - lastCleanup > 300000) {
         for (auto it = rateLimitData.begin(); it != rateLimitData.end();) {
             if (now - it->second.lastRequest > 300000) {
@@ -49,7 +50,7 @@ bool isRateLimited(IPAddress ip) {
     }
     
     RateLimitData& data = rateLimitData[ipStr];
-    unsigned long now = millis();
+    uint64_t now = uptimeMs();
     
     // Check if blocked
     if (data.blockUntil > now) {
@@ -59,7 +60,7 @@ bool isRateLimited(IPAddress ip) {
     // Clean old requests
     data.requestTimes.erase(
         std::remove_if(data.requestTimes.begin(), data.requestTimes.end(),
-                      [now](unsigned long time) { return now - time > RATE_LIMIT_WINDOW_MS; }),
+                      [now](uint64_t time) { return now - time > RATE_LIMIT_WINDOW_MS; }),
         data.requestTimes.end());
     
     return data.requestTimes.size() >= MAX_REQUESTS_PER_SECOND;
@@ -70,7 +71,7 @@ void recordRequest(IPAddress ip) {
     uint32_t ipUint = ip;
  
     String ipStr = ip.toString();
-    unsigned long now = millis();
+    uint64_t now = uptimeMs();
     
     auto cachedIP = ipStringCache.find(ipUint);
     if (cachedIP != ipStringCache.end()) {
@@ -95,7 +96,7 @@ void recordRequest(IPAddress ip) {
     // ✅ CZYŚĆ STARE przed dodaniem nowego
     data.requestTimes.erase(
         std::remove_if(data.requestTimes.begin(), data.requestTimes.end(),
-                      [now](unsigned long time) { 
+                      [now](uint64_t time) { 
                           return now - time > RATE_LIMIT_WINDOW_MS; 
                       }),
         data.requestTimes.end());
@@ -128,7 +129,7 @@ void recordFailedAttempt(IPAddress ip) {
     }
     
     String ipStr = ip.toString();
-    unsigned long now = millis();
+    uint64_t now = uptimeMs();
     
     RateLimitData& data = rateLimitData[ipStr];
     data.failedAttempts++;
@@ -148,5 +149,5 @@ bool isIPBlocked(IPAddress ip) {
     if (rateLimitData.find(ipStr) == rateLimitData.end()) {
         return false;
     }
-    return rateLimitData[ipStr].blockUntil > millis();
+    return rateLimitData[ipStr].blockUntil > uptimeMs();
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "session_manager.h"
 #include "../config/config.h"
 #include "../core/logging.h"
+#include "../core/uptime.h"
 
 // ✅ FIX 3: Add session limits to prevent memory exhaustion
 static const size_t MAX_TOTAL_SESSIONS = 10;       // Maximum total sessions
@@ -44,7 +45,7 @@ size_t countSessionsForIP(IPAddress ip) {
 }
 
 void updateSessionManager() {
-    unsigned long now = millis();
+    uint64_t now = uptimeMs();
     
     for (auto it = activeSessions.begin(); it != activeSessions.end();) {
         if (!it->isValid || (now - it->lastActivity > SESSION_TIMEOUT_MS)) {
@@ -95,8 +96,8 @@ String createSession(IPAddress ip) {
     }
     
     newSession.ip = ip;
-    newSession.createdAt = millis();
-    newSession.lastActivity = millis();
+    newSession.createdAt = uptimeMs();
+    newSession.lastActivity = newSession.createdAt;
     newSession.isValid = true;
     
     // ✅ Double-check we're not exceeding limits (paranoid check)
@@ -119,12 +120,13 @@ bool validateSession(const String& token, IPAddress ip) {
     
     for (auto& session : activeSessions) {
         if (session.token == token && session.ip == ip && session.isValid) {
-            if (millis() - session.lastActivity > SESSION_TIMEOUT_MS) {
+            uint64_t now = uptimeMs();
+            if (now - session.lastActivity > SESSION_TIMEOUT_MS) {
                 session.isValid = false;
                 LOG_INFO("Session expired for IP: %s", ip.toString().c_str());
                 return false;
             }
-            session.lastActivity = millis();
+            session.lastActivity = now;
             return true;
         }
     }
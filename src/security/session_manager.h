@@ -9,8 +9,8 @@
 struct Session {
     String token;
     IPAddress ip;
-    unsigned long createdAt;
-    unsigned long lastActivity;
+    uint64_t createdAt;             // uptimeMs()
+    uint64_t lastActivity;
     bool isValid;
 };
 
@@ -1,4 +1,3 @@
-
 #ifndef HTML_PAGES_H
 #define HTML_PAGES_H
 
@@ -6,8 +5,18 @@
 #include "../mode_config.h"
 
 #if ENABLE_WEB_SERVER
-    String getDashboardHTML();
-    String getLoginHTML();
+    #include <ESPAsyncWebServer.h>
+
+    // ===============================
+    // HTML PAGES
+    // ===============================
+    // Pages are edited in src/web/pages/ and turned into gzipped PROGMEM
+    // arrays by tools/web_assets.py at build time (html_assets.h). They are
+    // streamed straight from flash with Content-Encoding: gzip; a browser
+    // that already has the current version gets 304 Not Modified.
+
+    void sendDashboardPage(AsyncWebServerRequest* request);
+    void sendLoginPage(AsyncWebServerRequest* request);
 #endif
 
-#endif
\ No newline at end of file
+#endif
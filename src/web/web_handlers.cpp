@@ -11,23 +11,52 @@
     #include "../hardware/pump_controller.h"
     #include "../hardware/water_sensors.h"
     #include "../hardware/rtc_controller.h"
+    #include "../hardware/rtc_drift.h"
     #include "../network/wifi_manager.h"
+    #include "../network/vps_logger.h"
+    #include "../core/metrics.h"
+    #include "../hardware/fram_cache.h"
     #include "../config/config.h"
     #include "../core/logging.h"
+    #include "../core/uptime.h"
+    #include "../core/boot_profile.h"
+    #include "../algorithm/algorithm_task.h"
+    #include "../algorithm/flow_estimator.h"
+    #include "../algorithm/adaptive_delay.h"
+    #include "../core/trace_recorder.h"
     #include <ArduinoJson.h>
     #include "../config/config.h"
     #include "../algorithm/water_algorithm.h"
     // ... RESZTA KODU POZOSTAJE BEZ ZMIAN ...
+
+// Optional "channel" form/query parameter of the pump endpoints (default 0).
+// Returns false for a channel this build does not have.
+static bool requestChannel(AsyncWebServerRequest* request, uint8_t& channel) {
+    channel = 0;
+    const AsyncWebParameter* param = request->hasParam("channel", true) ? request->getParam("channel", true)
+                                                                        : request->getParam("channel");
+    if (param == nullptr) return true;
+
+    long value = param->value().toInt();
+    if (value < 0 || value >= WATER_CHANNEL_COUNT) return false;
+    channel = (uint8_t)value;
+    return true;
+}
+
+static void sendChannelError(AsyncWebServerRequest* request) {
+    request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid channel\"}");
+}
+
 void handleDashboard(AsyncWebServerRequest* request) {
     if (!checkAuthentication(request)) {
         request->redirect("/login");
         return;
     }
-    request->send(200, "text/html", getDashboardHTML());
+    sendDashboardPage(request);
 }
 
 void handleLoginPage(AsyncWebServerRequest* request) {
-    request->send(200, "text/html", getLoginHTML());
+    sendLoginPage(request);
 }
 
 void handleLogin(AsyncWebServerRequest* request) {
@@ -151,8 +180,134 @@ void handleStatus(AsyncWebServerRequest* request) {
     json["rtc_hardware"] = isRTCHardware(); 
     json["rtc_needs_sync"] = rtcNeedsSynchronization();
     json["rtc_battery_issue"] = isBatteryIssueDetected();
+    ClockStats clock = getClockStats();
+    json["clock_rtc_reads"] = clock.rtcReads;
+    json["clock_rtc_errors"] = clock.rtcReadErrors;
+    json["clock_reads"] = clock.clockReads;
+    json["clock_timestamp_builds"] = clock.timestampBuilds;
+    json["clock_resyncs"] = clock.resyncs;
+    json["clock_last_step_s"] = clock.lastStepSeconds;
+    json["clock_sync_age_s"] = clock.syncAgeSeconds;
+    json["clock_slew_ms"] = clock.slewRemainingMs;
+    json["clock_ntp_syncs"] = clock.ntpSyncs;
+    RtcDriftStats drift = getRtcDriftStats();
+    json["rtc_drift_ppm"] = drift.driftPpm;
+    json["rtc_drift_residual_ppm"] = drift.lastResidualPpm;
+    json["rtc_drift_samples"] = drift.samples;
+    json["rtc_aging_offset"] = drift.agingOffset;
+    json["rtc_ntp_last_sync"] = drift.lastSyncUnix;
+    json["rtc_ntp_interval_s"] = drift.ntpIntervalS;
     json["free_heap"] = ESP.getFreeHeap();
-    json["uptime"] = millis();
+    json["uptime"] = uptimeMs();
+
+    // Boot stages - ms since boot, 0 = not reached yet
+    json["boot_stage"] = getBootStageName(getBootStage());
+    for (uint8_t i = 0; i < BOOT_STAGE_COUNT; i++) {
+        char key[24];
+        snprintf(key, sizeof(key), "boot_%s_ms", getBootStageName((BootStage)i));
+        json[key] = getBootStageMs((BootStage)i);
+    }
+
+    // ============================================
+    // VPS UPLINK + LOOP HEALTH
+    // ============================================
+    VPSUplinkMetrics vps = getVPSUplinkMetrics();
+    json["vps_queue_depth"] = vps.queueDepth;
+    json["vps_queue_capacity"] = vps.queueCapacity;
+    json["vps_dropped"] = vps.dropped;
+    json["vps_sent"] = vps.sentCount;
+    json["vps_failed"] = vps.failedCount;
+    json["vps_rejected"] = vps.rejectedCount;
+    json["vps_requests"] = vps.requestCount;
+    json["vps_last_batch"] = vps.lastBatchSize;
+    json["vps_last_http_code"] = vps.lastHttpCode;
+    json["vps_last_latency_ms"] = vps.lastLatencyMs;
+    json["vps_avg_latency_ms"] = vps.avgLatencyMs;
+    json["vps_max_latency_ms"] = vps.maxLatencyMs;
+    json["vps_payload_format"] = vps.binaryPayload ? "msgpack" : "json";
+    json["vps_payload_bytes"] = vps.lastPayloadBytes;
+    json["vps_serialize_us"] = vps.lastSerializeUs;
+
+    const LoopMetrics& loopStats = getLoopMetrics();
+    json["loop_last_us"] = loopStats.lastLoopUs;
+    json["loop_max_us"] = loopStats.maxLoopUs;
+    json["loop_stalls"] = loopStats.stallCount;
+
+    const StorageMetrics& storage = getStorageMetrics();
+    json["fram_cycle_save_us"] = storage.lastCycleSaveUs;
+    json["fram_cycle_save_max_us"] = storage.maxCycleSaveUs;
+    json["fram_cycle_load_us"] = storage.cycleLoadUs;
+    json["fram_cycle_load_count"] = storage.cycleLoadCount;
+
+    const FramCacheStats& framCache = getFramCacheStats();
+    json["fram_cache_hits"] = framCache.hits;
+    json["fram_cache_misses"] = framCache.misses;
+
+    SensorCaptureStats sensorCapture = getSensorCaptureStats();
+    json["sensor_edges"] = sensorCapture.edges;
+    json["sensor_edge_overflows"] = sensorCapture.overflows;
+    json["sensor_bounces"] = sensorCapture.bounces;
+
+    const ControlMetrics& control = getControlMetrics();
+    json["control_mode"] = isAlgorithmTaskRunning() ? "task" : "loop";
+    json["control_wakeups_per_min"] = control.stepsPerMin;
+    json["control_busy_permille"] = control.busyPermille;
+    json["control_max_step_us"] = control.maxStepUs;
+    json["sensor_reaction_us"] = control.reactionLastUs;
+    json["sensor_reaction_avg_us"] = control.reactionAvgUs;
+    json["sensor_reaction_max_us"] = control.reactionMaxUs;
+
+    TraceStats trace = getTraceStats();
+    json["trace_records"] = trace.count;
+    json["trace_capacity"] = trace.capacity;
+    json["trace_dropped"] = trace.dropped;
+
+    // ============================================
+    // PUMP FLOW ESTIMATE
+    // ============================================
+    FlowEstimate flow = getFlowEstimate();
+    json["flow_state"] = getFlowEstimatorStateString(flow.state);
+    json["flow_baseline_samples"] = flow.baselineSamples;
+    json["flow_samples"] = flow.windowSamples;
+    json["flow_rejected"] = flow.rejectedSamples;
+    json["flow_ratio"] = flow.ratio;
+    json["flow_ratio_low"] = flow.ratioLow;
+    json["flow_ratio_high"] = flow.ratioHigh;
+    json["flow_estimate"] = flow.estimatedVolumePerSecond;
+    json["flow_recommend"] = flow.recommend;
+    json["flow_recommended_volume_per_second"] = flow.recommendedVolumePerSecond;
+    json["flow_auto_adjust"] = flow.autoAdjust;
+    json["flow_adjustments"] = flow.adjustCount;
+
+    AdaptiveDelayStats adaptive = getAdaptiveDelayStats();
+    json["adaptive_enabled"] = adaptive.enabled;
+    json["adaptive_samples"] = adaptive.samples;
+    json["adaptive_gap1_ref"] = adaptive.gap1Ref;
+    json["adaptive_interval_ref"] = adaptive.intervalRef;
+    json["adaptive_last_delay"] = adaptive.lastDelay;
+    json["adaptive_min_delay"] = adaptive.minDelay;
+    json["adaptive_max_delay"] = adaptive.maxDelay;
+
+    // ============================================
+    // WATER CHANNELS (fields above = channel 0)
+    // ============================================
+    json["channel_count"] = WATER_CHANNEL_COUNT;
+    if (WATER_CHANNEL_COUNT > 1) {
+        JsonArray channels = json["channels"].to<JsonArray>();
+        for (uint8_t ch = 0; ch < WATER_CHANNEL_COUNT; ch++) {
+            const WaterAlgorithm& algorithm = waterChannels[ch];
+            JsonObject entry = channels.add<JsonObject>();
+            entry["channel"] = ch;
+            entry["state"] = algorithm.getStateString();
+            entry["sensor1_active"] = readWaterSensor1(ch);
+            entry["sensor2_active"] = readWaterSensor2(ch);
+            entry["pump_active"] = isPumpActive(ch);
+            entry["pump_remaining"] = getPumpRemainingTime(ch);
+            entry["remaining_seconds"] = algorithm.getRemainingSeconds();
+            entry["daily_volume"] = algorithm.getDailyVolume();
+            entry["system_error"] = (algorithm.getState() == STATE_ERROR);
+        }
+    }
     
     // ============================================
     // DEVICE INFO
@@ -187,12 +342,26 @@ void handlePumpNormal(AsyncWebServerRequest* request) {
         return;
     }
     
-    bool success = triggerPump(currentPumpSettings.manualCycleSeconds, "MANUAL_NORMAL");
+    uint8_t channel;
+    if (!requestChannel(request, channel)) {
+        sendChannelError(request);
+        return;
+    }
+
+    bool success;
+    {
+        AlgorithmCommand cmd;
+        if (channel == 0) {
+            traceRecord(TRACE_COMMAND, TRACE_CMD_PUMP_NORMAL, currentPumpSettings.manualCycleSeconds);
+        }
+        success = triggerPump(currentPumpSettings.manualCycleSeconds, "MANUAL_NORMAL", channel);
+    }
     
     JsonDocument json;
     json["success"] = success;
     json["duration"] = currentPumpSettings.manualCycleSeconds;
     json["volume_ml"] = currentPumpSettings.manualCycleSeconds * currentPumpSettings.volumePerSecond;
+    json["channel"] = channel;
     
     String response;
     serializeJson(json, response);
@@ -207,12 +376,26 @@ void handlePumpExtended(AsyncWebServerRequest* request) {
         return;
     }
     
-    bool success = triggerPump(currentPumpSettings.calibrationCycleSeconds, "MANUAL_EXTENDED");
+    uint8_t channel;
+    if (!requestChannel(request, channel)) {
+        sendChannelError(request);
+        return;
+    }
+
+    bool success;
+    {
+        AlgorithmCommand cmd;
+        if (channel == 0) {
+            traceRecord(TRACE_COMMAND, TRACE_CMD_PUMP_EXTENDED, currentPumpSettings.calibrationCycleSeconds);
+        }
+        success = triggerPump(currentPumpSettings.calibrationCycleSeconds, "MANUAL_EXTENDED", channel);
+    }
     
     JsonDocument json;
     json["success"] = success;
     json["duration"] = currentPumpSettings.calibrationCycleSeconds;
     json["type"] = "extended";
+    json["channel"] = channel;
     
     String response;
     serializeJson(json, response);
@@ -227,7 +410,19 @@ void handlePumpStop(AsyncWebServerRequest* request) {
         return;
     }
     
-    stopPump();
+    uint8_t channel;
+    if (!requestChannel(request, channel)) {
+        sendChannelError(request);
+        return;
+    }
+
+    {
+        AlgorithmCommand cmd;
+        if (channel == 0) {
+            traceRecord(TRACE_COMMAND, TRACE_CMD_PUMP_STOP);
+        }
+        stopPump(channel);
+    }
     
     JsonDocument json;
     json["success"] = true;
@@ -276,6 +471,10 @@ void handlePumpSettings(AsyncWebServerRequest* request) {
         
         currentPumpSettings.volumePerSecond = newVolume;
 
+        uint32_t volumeBits;
+        memcpy(&volumeBits, &newVolume, sizeof(volumeBits));
+        traceRecord(TRACE_SETTINGS, 0, volumeBits);
+
         // Save to NVS (non-volatile storage)
         saveVolumeToNVS();
         
@@ -305,8 +504,7 @@ void handlePumpToggle(AsyncWebServerRequest* request) {
         json["enabled"] = pumpGlobalEnabled;
         
         if (!pumpGlobalEnabled && pumpDisabledTime > 0) {
-            unsigned long remaining = PUMP_AUTO_ENABLE_MS - (millis() - pumpDisabledTime);
-            json["remaining_seconds"] = remaining / 1000;
+            json["remaining_seconds"] = uptimeRemainingMs(pumpDisabledTime, PUMP_AUTO_ENABLE_MS) / 1000;
         } else {
             json["remaining_seconds"] = 0;
         }
@@ -317,7 +515,11 @@ void handlePumpToggle(AsyncWebServerRequest* request) {
         
     } else if (request->method() == HTTP_POST) {
         // Toggle pump state
-        setPumpGlobalState(!pumpGlobalEnabled);
+        {
+            AlgorithmCommand cmd;
+            traceRecord(TRACE_COMMAND, TRACE_CMD_PUMP_TOGGLE, !pumpGlobalEnabled);
+            setPumpGlobalState(!pumpGlobalEnabled);
+        }
         
         JsonDocument json;
         json["success"] = true;
@@ -343,7 +545,12 @@ void handleResetStatistics(AsyncWebServerRequest* request) {
     }
     
     // Reset statistics
-    bool success = waterAlgorithm.resetErrorStatistics();
+    bool success;
+    {
+        AlgorithmCommand cmd;
+        traceRecord(TRACE_COMMAND, TRACE_CMD_RESET_STATS);
+        success = waterAlgorithm.resetErrorStatistics();
+    }
     
     JsonDocument json;
     json["success"] = success;
@@ -408,7 +615,7 @@ void handleGetDailyVolume(AsyncWebServerRequest* request) {
     String response = "{";
     response += "\"success\":true,";
     response += "\"daily_volume\":" + String(waterAlgorithm.getDailyVolume()) + ",";
-    response += "\"max_volume\":" + String(FILL_WATER_MAX) + ",";
+    response += "\"max_volume\":" + String(waterAlgorithm.getParams().fillWaterMax) + ",";
     response += "\"last_reset_utc_day\":" + String(waterAlgorithm.getLastResetUTCDay());  // ← ZMIANA
     response += "}";
     
@@ -434,7 +641,12 @@ void handleResetDailyVolume(AsyncWebServerRequest* request) {
     LOG_INFO("Daily volume reset requested from %s", clientIP.toString().c_str());
     
     // Perform reset
-    bool success = waterAlgorithm.resetDailyVolume();
+    bool success;
+    {
+        AlgorithmCommand cmd;
+        traceRecord(TRACE_COMMAND, TRACE_CMD_RESET_DAILY_VOLUME);
+        success = waterAlgorithm.resetDailyVolume();
+    }
     
     if (success) {
         String response = "{";
@@ -471,14 +683,7 @@ void handleSystemToggle(AsyncWebServerRequest* request) {
         json["system_disabled"] = systemDisableRequested;
         
         if (systemDisableRequested && systemDisabledTime > 0) {
-            unsigned long elapsed = millis() - systemDisabledTime;
-            unsigned long remaining = 0;
-            
-            if (elapsed < SYSTEM_AUTO_ENABLE_MS) {
-                remaining = (SYSTEM_AUTO_ENABLE_MS - elapsed) / 1000;
-            }
-            
-            json["remaining_seconds"] = remaining;
+            json["remaining_seconds"] = uptimeRemainingMs(systemDisabledTime, SYSTEM_AUTO_ENABLE_MS) / 1000;
         } else {
             json["remaining_seconds"] = 0;
         }
@@ -505,11 +710,13 @@ void handleSystemToggle(AsyncWebServerRequest* request) {
                  wasDisabled ? "DISABLED" : "ENABLED",
                  shouldDisable ? "DISABLED" : "ENABLED");
         
-        // Set new state directly
+        // Set new state directly (algorithm task picks it up on wake-up)
+        AlgorithmCommand cmd;
+        traceRecord(TRACE_COMMAND, TRACE_CMD_SYSTEM_TOGGLE, shouldDisable);
         if (shouldDisable) {
             // DISABLE system
             systemDisableRequested = true;
-            systemDisabledTime = millis();
+            systemDisabledTime = uptimeMs();
             LOG_INFO("🛑 System disable requested via web");
         } else {
             // ENABLE system
@@ -546,5 +753,142 @@ void handleSystemToggle(AsyncWebServerRequest* request) {
     }
 }
 
+// ========================================
+// ALGORITHM PARAMETERS (algorithm_params.h)
+// ========================================
+
+static void writeAlgorithmParams(JsonObject target, const AlgorithmParams& params) {
+    for (uint8_t i = 0; i < ALGORITHM_PARAM_COUNT; i++) {
+        target[ALGORITHM_PARAM_FIELDS[i].key] = params.*ALGORITHM_PARAM_FIELDS[i].member;
+    }
+}
+
+static void sendParamsError(AsyncWebServerRequest* request, const String& error) {
+    JsonDocument json;
+    json["success"] = false;
+    json["error"] = error;
+
+    String response;
+    serializeJson(json, response);
+    request->send(400, "application/json", response);
+}
+
+void handleAlgorithmParams(AsyncWebServerRequest* request) {
+    if (!checkAuthentication(request)) {
+        request->send(401, "text/plain", "Unauthorized");
+        return;
+    }
+
+    if (request->method() == HTTP_POST) {
+        // Form parameters, any subset of the keys - the rest keep their
+        // current (or still pending) value. reset=1 restores the defaults.
+        AlgorithmParams params;
+        {
+            AlgorithmCommand cmd;
+            params = waterAlgorithm.getPendingParams();
+        }
+        if (request->hasParam("reset", true)) {
+            params = getDefaultAlgorithmParams();
+        }
+
+        for (uint8_t i = 0; i < ALGORITHM_PARAM_COUNT; i++) {
+            const AlgorithmParamField& field = ALGORITHM_PARAM_FIELDS[i];
+            if (!request->hasParam(field.key, true)) continue;
+
+            long value = request->getParam(field.key, true)->value().toInt();
+            if (value < 1 || value > 0xFFFF) {
+                sendParamsError(request, String(field.key) + " must be 1-65535");
+                return;
+            }
+            params.*field.member = (uint16_t)value;
+        }
+
+        const char* error = nullptr;
+        bool success;
+        {
+            AlgorithmCommand cmd;
+            // Parameters are shared by all channels (one FRAM block)
+            success = waterAlgorithm.setParams(params, &error);
+            for (uint8_t ch = 1; success && ch < WATER_CHANNEL_COUNT; ch++) {
+                waterChannels[ch].setParams(params);
+            }
+        }
+        if (!success) {
+            LOG_WARNING("Algorithm params rejected: %s", error);
+            sendParamsError(request, error);
+            return;
+        }
+        LOG_INFO("Algorithm params updated via web");
+    }
+
+    JsonDocument json;
+    bool pending;
+    {
+        AlgorithmCommand cmd;
+        pending = waterAlgorithm.hasPendingParams();
+        writeAlgorithmParams(json["active"].to<JsonObject>(), waterAlgorithm.getParams());
+        if (pending) {
+            writeAlgorithmParams(json["pending_params"].to<JsonObject>(), waterAlgorithm.getPendingParams());
+        }
+    }
+    json["success"] = true;
+    json["pending"] = pending;
+    writeAlgorithmParams(json["defaults"].to<JsonObject>(), getDefaultAlgorithmParams());
+
+    if (request->method() == HTTP_POST) {
+        json["message"] = pending ? "Saved - applied when the current cycle returns to IDLE"
+                                  : "Saved and applied";
+    }
+
+    String response;
+    serializeJson(json, response);
+    request->send(200, "application/json", response);
+}
+
+// ========================================
+// TRACE DOWNLOAD (replay on the host)
+// ========================================
+
+void handleTraceDownload(AsyncWebServerRequest* request) {
+    if (!checkAuthentication(request)) {
+        request->send(401, "text/plain", "Unauthorized");
+        return;
+    }
+
+    size_t size = beginTraceDump();
+    if (size == 0) {
+        request->send(409, "text/plain", "Trace download already in progress");
+        return;
+    }
+    request->onDisconnect([]() { endTraceDump(); });
+
+    // Streamed from FRAM in chunks - no RAM copy of the ring. Chunked, so the
+    // body can end early if the writer overtakes the download.
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+        [](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return readTraceDump(buffer, maxLen, index);
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=\"trace.bin\"");
+    request->send(response);
+
+    LOG_INFO("Trace download: %u bytes", (unsigned)size);
+}
+
+void handleTraceClear(AsyncWebServerRequest* request) {
+    if (!checkAuthentication(request)) {
+        request->send(401, "text/plain", "Unauthorized");
+        return;
+    }
+
+    bool success = clearTrace();
+
+    JsonDocument json;
+    json["success"] = success;
+
+    String response;
+    serializeJson(json, response);
+    request->send(200, "application/json", response);
+}
+
 #endif // ENABLE_WEB_SERVER
 
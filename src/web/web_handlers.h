@@ -34,6 +34,13 @@ void handleGetDailyVolume(AsyncWebServerRequest *request);
 void handleResetDailyVolume(AsyncWebServerRequest *request);
 void handleSystemToggle(AsyncWebServerRequest *request);
 
+// Runtime algorithm parameters (algorithm/algorithm_params.h)
+void handleAlgorithmParams(AsyncWebServerRequest *request);
+
+// Trace recorder (core/trace_recorder.h)
+void handleTraceDownload(AsyncWebServerRequest *request);
+void handleTraceClear(AsyncWebServerRequest *request);
+
 #endif
 
 #endif
\ No newline at end of file
@@ -33,6 +33,10 @@
         server.on("/api/daily-volume", HTTP_GET, handleGetDailyVolume);
         server.on("/api/reset-daily-volume", HTTP_POST, handleResetDailyVolume);
         server.on("/api/system-toggle", HTTP_GET | HTTP_POST, handleSystemToggle);
+        server.on("/api/algorithm-params", HTTP_GET | HTTP_POST, handleAlgorithmParams);
+
+        server.on("/api/trace", HTTP_GET, handleTraceDownload);
+        server.on("/api/trace/clear", HTTP_POST, handleTraceClear);
         
         // 404 handler
         server.onNotFound([](AsyncWebServerRequest* request) {
@@ -0,0 +1,96 @@
+# ===============================
+# WEB ASSETS (PlatformIO pre-build step)
+# ===============================
+# Minifies and gzips src/web/pages/*.html into src/web/html_assets.h:
+# one PROGMEM byte array per page plus its length and an ETag taken from a
+# hash of the compressed bytes. The web server sends the arrays as-is with
+# Content-Encoding: gzip (html_pages.cpp), so a page load never copies the
+# HTML to the heap.
+#
+# Runs before every build of an env that lists it in extra_scripts; the
+# header is only rewritten when a page changed. Standalone:
+#   python tools/web_assets.py
+
+import gzip
+import hashlib
+import os
+import re
+
+PAGES = [
+    # (source file, C identifier)
+    ("login.html", "LOGIN_HTML"),
+    ("dashboard.html", "DASHBOARD_HTML"),
+]
+
+HTML_COMMENT = re.compile(r"<!--.*?-->", re.S)
+CSS_COMMENT = re.compile(r"/\*.*?\*/", re.S)
+STYLE_BLOCK = re.compile(r"(<style[^>]*>)(.*?)(</style>)", re.S | re.I)
+
+
+def minify(html):
+    # Conservative: drops comments, indentation and blank lines but keeps
+    # every line break, so JS relying on automatic semicolons is unchanged
+    html = HTML_COMMENT.sub("", html)
+    html = STYLE_BLOCK.sub(lambda m: m.group(1) + CSS_COMMENT.sub("", m.group(2)) + m.group(3), html)
+
+    lines = []
+    for line in html.splitlines():
+        line = line.strip()
+        # Whole-line // comments (commented-out JS and CSS)
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    return "\n".join(lines) + "\n"
+
+
+def compress(data):
+    # mtime=0 keeps the output (and the ETag) identical between builds
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def to_c_array(name, data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "static const uint8_t %s_GZ[] PROGMEM = {\n%s\n};\n" % (name, "\n".join(rows))
+
+
+def generate(root):
+    pages_dir = os.path.join(root, "src", "web", "pages")
+    out_path = os.path.join(root, "src", "web", "html_assets.h")
+
+    parts = [
+        "// Generated by tools/web_assets.py from src/web/pages/ - do not edit\n",
+        "#ifndef HTML_ASSETS_H\n#define HTML_ASSETS_H\n\n#include <Arduino.h>\n",
+    ]
+    summary = []
+    for filename, name in PAGES:
+        with open(os.path.join(pages_dir, filename), "r", encoding="utf-8") as f:
+            source = f.read().encode("utf-8")
+        packed = compress(minify(source.decode("utf-8")).encode("utf-8"))
+        etag = '"%s"' % hashlib.sha256(packed).hexdigest()[:16]
+
+        parts.append("\n// %s: %d B source -> %d B gzip\n" % (filename, len(source), len(packed)))
+        parts.append(to_c_array(name, packed))
+        parts.append("#define %s_GZ_LEN  %d\n" % (name, len(packed)))
+        parts.append("#define %s_ETAG    \"%s\"\n" % (name, etag.replace('"', '\\"')))
+        summary.append("%s %d -> %d B" % (filename, len(source), len(packed)))
+
+    parts.append("\n#endif\n")
+    content = "".join(parts)
+
+    old = None
+    if os.path.exists(out_path):
+        with open(out_path, "r", encoding="utf-8") as f:
+            old = f.read()
+    if content != old:
+        with open(out_path, "w", encoding="utf-8") as f:
+            f.write(content)
+        print("web_assets: " + ", ".join(summary))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))